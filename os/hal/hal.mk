@@ -1,6 +1,7 @@
 include ${CHIBIOS}/os/hal/hal.mk
 
 HALSRC += ${CHIBIOS_CONTRIB}/os/hal/src/hal_community.c \
+          ${CHIBIOS_CONTRIB}/os/hal/src/hal_ioblockv.c \
           ${CHIBIOS_CONTRIB}/os/hal/src/hal_nand.c \
           ${CHIBIOS_CONTRIB}/os/hal/src/hal_onewire.c \
           ${CHIBIOS_CONTRIB}/os/hal/src/hal_eicu.c \
@@ -76,6 +76,7 @@
 #endif
 
 /* Abstract interfaces.*/
+#include "hal_ioblockv.h"
 
 /* Shared headers.*/
 
@@ -75,6 +75,14 @@ typedef enum {
 #include "hal_crc_lld.h"
 #include "crcsw.h" /* Include software LL driver */
 
+/**
+ * @brief   The LLD only consumes whole 32 bits words, most significant byte
+ *          of each word first and without reflections.
+ */
+#if !defined(CRC_LLD_WORD_ONLY) || defined(__DOXYGEN__)
+#define CRC_LLD_WORD_ONLY                   FALSE
+#endif
+
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
@@ -139,9 +147,13 @@ extern "C" {
   void crcResetI(CRCDriver *crcp);
   uint32_t crcCalc(CRCDriver *crcp, size_t n, const void *buf);
   uint32_t crcCalcI(CRCDriver *crcp, size_t n, const void *buf);
+  uint32_t crcCombine(CRCDriver *crcp, uint32_t crc1, uint32_t crc2,
+                      size_t n2);
 #if CRC_USE_DMA == TRUE
   void crcStartCalc(CRCDriver *crcp, size_t n, const void *buf);
   void crcStartCalcI(CRCDriver *crcp, size_t n, const void *buf);
+  uint32_t crcCalcSplit(CRCDriver *crcp, size_t n, const void *buf,
+                        size_t n_cpu);
 #endif
 #if CRC_USE_MUTUAL_EXCLUSION == TRUE
   void crcAcquireUnit(CRCDriver *crcp);
@@ -0,0 +1,159 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_ioblockv.h
+ * @brief   Vectored block devices interface header.
+ * @details Extends the @p BaseBlockDevice interface with scatter-gather
+ *          read and write methods, a single request moves consecutive
+ *          blocks from or to several separate buffers.
+ * @note    The base @p BaseBlockDevice VMT has no room for a capability
+ *          flag so vectored VMTs are registered with
+ *          @p ioblockvRegisterVMT(), @p ioblockvRead() and
+ *          @p ioblockvWrite() only use @p readv and @p writev on devices
+ *          whose VMT has been registered.
+ *
+ * @addtogroup IO_BLOCKV
+ * @{
+ */
+
+#ifndef HAL_IOBLOCKV_H
+#define HAL_IOBLOCKV_H
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of registered vectored VMTs.
+ */
+#if !defined(IOBLOCKV_MAX_VMTS) || defined(__DOXYGEN__)
+#define IOBLOCKV_MAX_VMTS                   4
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Block I/O vector element.
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the buffer, it is only read by write operations.
+   */
+  void                      *buffer;
+  /**
+   * @brief   Number of blocks in the buffer.
+   */
+  uint32_t                  n;
+} blkiov_t;
+
+/**
+ * @brief   @p BaseVectoredBlockDevice specific methods.
+ */
+#define _base_vectored_block_device_methods                                 \
+  _base_block_device_methods                                                \
+  /* Reads consecutive blocks into a buffers vector.*/                      \
+  bool (*readv)(void *instance, uint32_t startblk,                          \
+                const blkiov_t *iov, uint32_t iovcnt);                      \
+  /* Writes consecutive blocks from a buffers vector.*/                     \
+  bool (*writev)(void *instance, uint32_t startblk,                         \
+                 const blkiov_t *iov, uint32_t iovcnt);
+
+/**
+ * @brief   @p BaseVectoredBlockDevice specific data.
+ */
+#define _base_vectored_block_device_data                                    \
+  _base_block_device_data
+
+/**
+ * @brief   @p BaseVectoredBlockDevice virtual methods table.
+ */
+struct BaseVectoredBlockDeviceVMT {
+  _base_vectored_block_device_methods
+};
+
+/**
+ * @brief   Base vectored block device class.
+ * @details Any @p BaseVectoredBlockDevice is also a @p BaseBlockDevice.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BaseVectoredBlockDeviceVMT *vmt;
+  _base_vectored_block_device_data
+} BaseVectoredBlockDevice;
+
+/**
+ * @name    Macro Functions (BaseVectoredBlockDevice)
+ * @{
+ */
+/**
+ * @brief   Reads consecutive blocks into a buffers vector.
+ * @pre     The device must implement @p BaseVectoredBlockDevice, use
+ *          @p ioblockvRead() on a generic @p BaseBlockDevice.
+ *
+ * @param[in] ip        pointer to a @p BaseVectoredBlockDevice or derived
+ *                      class
+ * @param[in] startblk  first block to read
+ * @param[in] iov       pointer to the I/O vector
+ * @param[in] iovcnt    number of elements in the I/O vector
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define blkReadV(ip, startblk, iov, iovcnt)                                 \
+  ((ip)->vmt->readv(ip, startblk, iov, iovcnt))
+
+/**
+ * @brief   Writes consecutive blocks from a buffers vector.
+ * @pre     The device must implement @p BaseVectoredBlockDevice, use
+ *          @p ioblockvWrite() on a generic @p BaseBlockDevice.
+ *
+ * @param[in] ip        pointer to a @p BaseVectoredBlockDevice or derived
+ *                      class
+ * @param[in] startblk  first block to write
+ * @param[in] iov       pointer to the I/O vector
+ * @param[in] iovcnt    number of elements in the I/O vector
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define blkWriteV(ip, startblk, iov, iovcnt)                                \
+  ((ip)->vmt->writev(ip, startblk, iov, iovcnt))
+/** @} */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void ioblockvRegisterVMT(const struct BaseVectoredBlockDeviceVMT *vmtp);
+  bool ioblockvIsVectored(const BaseBlockDevice *bbdp);
+  uint32_t ioblockvGetBlocks(const blkiov_t *iov, uint32_t iovcnt);
+  bool ioblockvRead(BaseBlockDevice *bbdp, uint32_t startblk,
+                    const blkiov_t *iov, uint32_t iovcnt);
+  bool ioblockvWrite(BaseBlockDevice *bbdp, uint32_t startblk,
+                     const blkiov_t *iov, uint32_t iovcnt);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_IOBLOCKV_H */
+
+/** @} */
@@ -39,10 +39,29 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @name    USB_MSD configuration options
+ * @{
+ */
+/**
+ * @brief   Size of the user supplied data buffer in blocks.
+ * @details With 2 or more blocks the data phase is pipelined: the buffer
+ *          is split in two halves, the bulk transfer of one half being
+ *          armed while the other one is read from or written to the medium.
+ */
+#if !defined(USB_MSD_BLKBUF_BLOCKS) || defined(__DOXYGEN__)
+#define USB_MSD_BLKBUF_BLOCKS           1
+#endif
+/** @} */
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if USB_MSD_BLKBUF_BLOCKS < 1
+#error "USB_MSD_BLKBUF_BLOCKS must be at least 1"
+#endif
+
 #if !HAL_USE_USB
 #error "Mass storage Driver requires HAL_USE_USB"
 #endif
@@ -106,6 +125,18 @@ typedef struct {
    * @brief   USB endpoint number.
    */
   usbep_t   ep;
+  /**
+   * @brief   Direction of the asynchronous transfer in progress.
+   */
+  bool      tx;
+  /**
+   * @brief   Length of the asynchronous transfer in progress.
+   */
+  size_t    len;
+  /**
+   * @brief   Bytes moved in the data phase of the current command.
+   */
+  uint32_t  moved;
 } usb_scsi_transport_handler_t;
 
 
@@ -52,6 +52,10 @@
 #define HAL_USBH_USE_ADDITIONAL_CLASS_DRIVERS	FALSE
 #endif
 
+#ifndef HAL_USBH_USE_THREAD
+#define HAL_USBH_USE_THREAD FALSE
+#endif
+
 #define HAL_USBH_USE_IAD     HAL_USBH_USE_UVC
 
 #if (HAL_USE_USBH == TRUE) || defined(__DOXYGEN__)
@@ -70,6 +74,29 @@
 #define USBH_MAX_ADDRESSES				(HAL_USBHHUB_MAX_PORTS + 1)
 #endif
 
+#if HAL_USBH_USE_THREAD
+/* internal host thread stack size */
+#ifndef HAL_USBH_THREAD_WA_SIZE
+#define HAL_USBH_THREAD_WA_SIZE			1024
+#endif
+
+/* internal host thread priority */
+#ifndef HAL_USBH_THREAD_PRIO
+#define HAL_USBH_THREAD_PRIO			NORMALPRIO
+#endif
+
+/* the thread also wakes up after this time without events, as a safety net
+ * for status changes not reported by the low level driver */
+#ifndef HAL_USBH_THREAD_POLL_INTERVAL
+#define HAL_USBH_THREAD_POLL_INTERVAL	OSAL_MS2I(1000)
+#endif
+#endif
+
+/* host events, they wake up the internal host thread */
+#define USBH_EVENT_ROOTHUB				(1 << 0)	/* root port status change */
+#define USBH_EVENT_HUB					(1 << 1)	/* hub status change */
+#define USBH_EVENT_POLL					(1 << 2)	/* usbhMainLoop() called */
+
 enum usbh_status {
 	USBH_STATUS_STOPPED = 0,
 	USBH_STATUS_STARTED,
@@ -250,6 +277,14 @@ struct USBHDriver {
 	struct list_head hubs;
 #endif
 
+#if HAL_USBH_USE_THREAD
+	/* internal main loop */
+	uint32_t events;
+	thread_reference_t waitingThread;
+	thread_t *thread;
+	THD_WORKING_AREA(waThread, HAL_USBH_THREAD_WA_SIZE);
+#endif
+
 	/* Low level part */
 	_usbhdriver_ll_data
 
@@ -420,11 +455,62 @@ struct usbh_classdriver_vmt {
 	/* TODO: add power control, suspend, etc */
 };
 
+/* match_flags of usbh_device_id_t: fields that must match */
+#define USBH_MATCH_VID				(1 << 0)
+#define USBH_MATCH_PID				(1 << 1)
+#define USBH_MATCH_TYPE				(1 << 2)	/* device, IAD or interface descriptor */
+#define USBH_MATCH_CLASS			(1 << 3)
+#define USBH_MATCH_SUBCLASS			(1 << 4)
+#define USBH_MATCH_PROTOCOL			(1 << 5)
+#define USBH_MATCH_IFNUM			(1 << 6)	/* bFirstInterface for IADs */
+
+/* Match table entry. Class, subclass and protocol are those of the descriptor
+ * offered to the driver (device, interface association or interface).
+ * Tables are terminated by an entry with match_flags = 0. */
+typedef struct usbh_device_id {
+	uint16_t match_flags;
+	uint16_t idVendor;
+	uint16_t idProduct;
+	uint8_t bDescriptorType;
+	uint8_t bClass;
+	uint8_t bSubClass;
+	uint8_t bProtocol;
+	uint8_t bInterfaceNumber;
+} usbh_device_id_t;
+
+#define USBH_ID_VID_PID(vid, pid)									\
+	{USBH_MATCH_VID | USBH_MATCH_PID, (vid), (pid), 0, 0, 0, 0, 0}
+
+#define USBH_ID_DESCRIPTOR(type, _class, subclass, protocol)			\
+	{USBH_MATCH_TYPE | USBH_MATCH_CLASS | USBH_MATCH_SUBCLASS			\
+		| USBH_MATCH_PROTOCOL, 0, 0, (type), (_class), (subclass), (protocol), 0}
+
+#define USBH_ID_VID_PID_DESCRIPTOR(vid, pid, type, _class, subclass, protocol)	\
+	{USBH_MATCH_VID | USBH_MATCH_PID | USBH_MATCH_TYPE | USBH_MATCH_CLASS	\
+		| USBH_MATCH_SUBCLASS | USBH_MATCH_PROTOCOL,						\
+		(vid), (pid), (type), (_class), (subclass), (protocol), 0}
+
+#define USBH_ID_END													\
+	{0, 0, 0, 0, 0, 0, 0, 0}
+
 struct usbh_classdriverinfo {
 	const char *name;
 	const usbh_classdriver_vmt_t *vmt;
+	/* optional; load() is only called for descriptors matching an entry,
+	 * or for every descriptor if NULL */
+	const usbh_device_id_t *id_table;
 };
 
+/* class driver registry node */
+typedef struct usbh_classdriver_node {
+	struct list_head node;
+	const usbh_classdriverinfo_t *info;
+} usbh_classdriver_node_t;
+
+/* called before loading a matching driver; return false to deny loading it */
+typedef bool (*usbh_classdriver_hook_t)(usbh_device_t *dev,
+		const usbh_classdriverinfo_t *info, const uint8_t *descriptor, uint16_t rem);
+
 #define _usbh_base_classdriver_data		\
 	const usbh_classdriverinfo_t *info;	\
 	usbh_device_t *dev;					\
@@ -434,6 +520,18 @@ struct usbh_baseclassdriver {
 	_usbh_base_classdriver_data
 };
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+	/* Class driver registry */
+	void usbhClassDriverRegister(usbh_classdriver_node_t *node,
+			const usbh_classdriverinfo_t *info);
+	void usbhClassDriverUnregister(usbh_classdriver_node_t *node);
+	void usbhClassDriverSetHook(usbh_classdriver_hook_t hook);
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
 #endif /* HAL_USBH_H_ */
@@ -19,6 +19,7 @@
 #define USBH_HID_H_
 
 #include "hal_usbh.h"
+#include <string.h>
 
 #if HAL_USE_USBH && HAL_USBH_USE_HID
 
@@ -34,9 +35,54 @@
 #define HAL_USBHHID_USE_INTERRUPT_OUT 				FALSE
 #endif
 
+/* Fetch and compile the report descriptor into a field table at load time */
+#if !defined(HAL_USBHHID_USE_REPORT_PARSER)
+#define HAL_USBHHID_USE_REPORT_PARSER 				FALSE
+#endif
+
+#if !defined(HAL_USBHHID_MAX_FIELDS)
+#define HAL_USBHHID_MAX_FIELDS 						32
+#endif
+
+#if !defined(HAL_USBHHID_MAX_REPORT_DESCRIPTOR_SIZE)
+#define HAL_USBHHID_MAX_REPORT_DESCRIPTOR_SIZE 		256
+#endif
+
+/* Queue incoming reports in a ring of buffers, read with usbhhidReadReport */
+#if !defined(HAL_USBHHID_USE_REPORT_QUEUE)
+#define HAL_USBHHID_USE_REPORT_QUEUE 				FALSE
+#endif
+
+#if !defined(HAL_USBHHID_REPORT_QUEUE_LEN)
+#define HAL_USBHHID_REPORT_QUEUE_LEN 				8
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
+#if HAL_USBHHID_USE_REPORT_PARSER
+#if (HAL_USBHHID_MAX_FIELDS < 1) || (HAL_USBHHID_MAX_FIELDS > 255)
+#error "HAL_USBHHID_MAX_FIELDS must be in the 1..255 range"
+#endif
+#endif
+
+#if HAL_USBHHID_USE_REPORT_QUEUE
+#if (HAL_USBHHID_REPORT_QUEUE_LEN < 2) || (HAL_USBHHID_REPORT_QUEUE_LEN > 255)
+#error "HAL_USBHHID_REPORT_QUEUE_LEN must be in the 2..255 range"
+#endif
+#endif
+
+/* field flags, as found in the Input/Output/Feature main item */
+#define USBHHID_FIELD_FLAG_CONSTANT		0x01
+#define USBHHID_FIELD_FLAG_VARIABLE		0x02
+#define USBHHID_FIELD_FLAG_RELATIVE		0x04
+#define USBHHID_FIELD_FLAG_WRAP			0x08
+#define USBHHID_FIELD_FLAG_NONLINEAR	0x10
+#define USBHHID_FIELD_FLAG_NOPREFERRED	0x20
+#define USBHHID_FIELD_FLAG_NULLSTATE	0x40
+
+/* the extractors always load an 8-byte window from the report buffer */
+#define USBHHID_FIELD_WINDOW			8
 
 
 /*===========================================================================*/
@@ -67,16 +113,57 @@ typedef enum {
 	USBHHID_PROTOCOL_REPORT = 1,
 } usbhhid_protocol_t;
 
+typedef enum {
+	USBHHID_QUEUE_OVERWRITE = 0,	/* full queue: drop the oldest report */
+	USBHHID_QUEUE_BLOCK = 1,		/* full queue: stop polling until a report is read */
+} usbhhid_queue_policy_t;
+
+typedef struct {
+	systime_t timestamp;
+	uint16_t len;
+} usbhhid_report_info_t;
+
 typedef struct USBHHIDDriver USBHHIDDriver;
 typedef struct USBHHIDConfig USBHHIDConfig;
 
 typedef void (*usbhhid_report_callback)(USBHHIDDriver *hidp, uint16_t len);
 
+/* A run of report elements sharing size, logical range and report.
+ *
+ * Variable fields: element i carries usage min(usage_min + i, usage_max).
+ * Array fields: every element holds a usage index; usage_min..usage_max is
+ * the range of usages the array can report.
+ *
+ * bit_offset is counted from the start of the report as received, i.e.
+ * including the report ID byte when the device uses report IDs.
+ */
+typedef struct {
+	uint16_t usage_page;
+	uint16_t usage_min;
+	uint16_t usage_max;
+	uint16_t bit_offset;
+	uint16_t count;
+	uint16_t report_len;	/* in bytes, including the ID; at least USBHHID_FIELD_WINDOW */
+	uint8_t bit_size;
+	uint8_t report_id;
+	uint8_t report_type;	/* usbhhid_reporttype_t */
+	uint8_t flags;			/* USBHHID_FIELD_FLAG_xxx */
+	int32_t logical_min;
+	int32_t logical_max;
+	uint32_t mask;			/* (1 << bit_size) - 1 */
+	uint32_t sign;			/* sign bit of the field if logical_min < 0, else 0 */
+} usbhhid_field_t;
+
 struct USBHHIDConfig {
 	usbhhid_report_callback cb_report;
 	void *report_buffer;
 	uint16_t report_len;
 	usbhhid_protocol_t protocol;
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	/* report_buffer holds HAL_USBHHID_REPORT_QUEUE_LEN slots of report_len bytes;
+	 * cb_report becomes a notification, reports are read with usbhhidReadReport */
+	usbhhid_queue_policy_t queue_policy;
+#endif
 };
 
 struct USBHHIDDriver {
@@ -97,6 +184,23 @@ struct USBHHIDDriver {
 	const USBHHIDConfig *config;
 
 	semaphore_t sem;
+
+#if HAL_USBHHID_USE_REPORT_PARSER
+	usbhhid_field_t fields[HAL_USBHHID_MAX_FIELDS];
+	uint8_t nfields;
+#endif
+
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	/* while polling, one slot is owned by in_urb: the overwrite policy keeps at
+	 * most LEN - 1 reports, the block policy fills all LEN and stops polling */
+	usbhhid_report_info_t queue[HAL_USBHHID_REPORT_QUEUE_LEN];
+	uint8_t q_rd;
+	uint8_t q_wr;
+	uint8_t q_counter;
+	bool q_held;
+	uint32_t q_dropped;
+	threads_queue_t q_waiting;
+#endif
 };
 
 
@@ -134,7 +238,53 @@ extern "C" {
 		return hidp->state;
 	}
 
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	msg_t usbhhidReadReport(USBHHIDDriver *hidp, void *buf, uint16_t size,
+			usbhhid_report_info_t *info, systime_t timeout);
+
+	static inline uint32_t usbhhidGetDroppedReports(USBHHIDDriver *hidp) {
+		return hidp->q_dropped;
+	}
+#endif
+
 	void usbhhidStart(USBHHIDDriver *hidp, const USBHHIDConfig *cfg);
+
+	/* Report descriptor parser */
+	bool usbhhidParseReportDescriptor(const uint8_t *desc, uint16_t len,
+			usbhhid_field_t *fields, uint16_t *nfields);
+
+	/* Field extraction. The report buffer must be at least field->report_len
+	 * bytes long; indexes must be below field->count. Little-endian targets. */
+	static inline uint32_t usbhhidFieldGetRaw(const usbhhid_field_t *field,
+			const void *report, uint16_t index) {
+		uint32_t bit = field->bit_offset + (uint32_t)index * field->bit_size;
+		uint32_t byte = bit >> 3;
+		uint32_t last = field->report_len - USBHHID_FIELD_WINDOW;
+		uint64_t w;
+
+		/* clamp the window inside the report; the field still fits in it */
+		byte = (byte < last) ? byte : last;
+		memcpy(&w, (const uint8_t *)report + byte, sizeof(w));
+		return (uint32_t)(w >> (bit - (byte << 3))) & field->mask;
+	}
+
+	static inline int32_t usbhhidFieldGetValue(const usbhhid_field_t *field,
+			const void *report, uint16_t index) {
+		uint32_t v = usbhhidFieldGetRaw(field, report, index);
+		return (int32_t)((v ^ field->sign) - field->sign);
+	}
+
+#if HAL_USBHHID_USE_REPORT_PARSER
+	const usbhhid_field_t *usbhhidFindField(USBHHIDDriver *hidp,
+			usbhhid_reporttype_t type, uint16_t usage_page, uint16_t usage,
+			uint16_t *index);
+
+	static inline const usbhhid_field_t *usbhhidGetFields(USBHHIDDriver *hidp,
+			uint8_t *nfields) {
+		*nfields = hidp->nfields;
+		return hidp->fields;
+	}
+#endif
 #ifdef __cplusplus
 }
 #endif
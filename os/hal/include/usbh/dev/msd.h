@@ -33,6 +33,32 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Maximum number of blocks transferred by a single READ/WRITE
+ *          command, zero leaves the limit to the device.
+ * @note    The limit reported by the device Block Limits VPD page and the
+ *          CDB length limit (0xFFFF blocks for READ/WRITE(10)) always apply.
+ */
+#if !defined(HAL_USBHMSD_MAX_TRANSFER_BLOCKS) || defined(__DOXYGEN__)
+#define HAL_USBHMSD_MAX_TRANSFER_BLOCKS		0
+#endif
+
+/**
+ * @brief   Number of times a failed READ/WRITE/SYNCHRONIZE CACHE command is
+ *          retried before the error is reported.
+ */
+#if !defined(HAL_USBHMSD_MAX_RETRIES) || defined(__DOXYGEN__)
+#define HAL_USBHMSD_MAX_RETRIES				3
+#endif
+
+/**
+ * @brief   Delay before the first retry in milliseconds, doubled at each
+ *          further retry.
+ */
+#if !defined(HAL_USBHMSD_RETRY_DELAY_MS) || defined(__DOXYGEN__)
+#define HAL_USBHMSD_RETRY_DELAY_MS			50
+#endif
+
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
@@ -44,7 +70,7 @@
 /*===========================================================================*/
 
 #define _usbhmsd_driver_methods                                                 \
-	_base_block_device_methods
+	_base_vectored_block_device_methods
 
 struct USBHMassStorageDriverVMT {
 	_usbhmsd_driver_methods
@@ -53,6 +79,22 @@ struct USBHMassStorageDriverVMT {
 typedef struct USBHMassStorageLUNDriver USBHMassStorageLUNDriver;
 typedef struct USBHMassStorageDriver USBHMassStorageDriver;
 
+/* Per LUN error counters */
+typedef struct {
+	/* bulk-only transport errors, each one followed by a reset recovery */
+	uint32_t transport_errors;
+	/* commands completed with a failed status */
+	uint32_t failed_commands;
+	/* commands retried */
+	uint32_t retries;
+	/* errors reported to the caller after the retries */
+	uint32_t unrecovered;
+	/* sense data of the last failed command */
+	uint8_t sense_key;
+	uint8_t asc;
+	uint8_t ascq;
+} usbhmsd_lun_errors_t;
+
 struct USBHMassStorageLUNDriver {
 	/* inherited from abstract block driver */
 	const struct USBHMassStorageDriverVMT *vmt;
@@ -64,6 +106,13 @@ struct USBHMassStorageLUNDriver {
 	BlockDeviceInfo info;
 	USBHMassStorageDriver *msdp;
 
+	/* use READ/WRITE(16), the capacity needs READ CAPACITY(16) */
+	bool use16;
+	/* maximum number of blocks per READ/WRITE command */
+	uint32_t max_blocks;
+
+	usbhmsd_lun_errors_t errors;
+
 	USBHMassStorageLUNDriver *next;
 };
 
@@ -91,10 +140,16 @@ extern "C" {
 					uint8_t *buffer, uint32_t n);
 	bool usbhmsdLUNWrite(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
 					const uint8_t *buffer, uint32_t n);
+	bool usbhmsdLUNReadV(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
+					const blkiov_t *iov, uint32_t iovcnt);
+	bool usbhmsdLUNWriteV(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
+					const blkiov_t *iov, uint32_t iovcnt);
 	bool usbhmsdLUNSync(USBHMassStorageLUNDriver *lunp);
 	bool usbhmsdLUNGetInfo(USBHMassStorageLUNDriver *lunp, BlockDeviceInfo *bdip);
 	bool usbhmsdLUNIsInserted(USBHMassStorageLUNDriver *lunp);
 	bool usbhmsdLUNIsProtected(USBHMassStorageLUNDriver *lunp);
+	void usbhmsdLUNGetErrors(USBHMassStorageLUNDriver *lunp, usbhmsd_lun_errors_t *errors);
+	void usbhmsdLUNClearErrors(USBHMassStorageLUNDriver *lunp);
 #ifdef __cplusplus
 }
 #endif
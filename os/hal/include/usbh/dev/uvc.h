@@ -28,12 +28,41 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Enables the frame assembler.
+ * @details When frame buffers are assigned with @p usbhuvcSetFrames(), the
+ *          ISO payloads are gathered into them and whole frames are posted
+ *          to the mailbox instead of single packets.
+ */
+#if !defined(HAL_USBHUVC_USE_FRAME_ASSEMBLER) || defined(__DOXYGEN__)
+#define HAL_USBHUVC_USE_FRAME_ASSEMBLER		FALSE
+#endif
+
+/**
+ * @brief   Enables the stream statistics.
+ */
+#if !defined(HAL_USBHUVC_USE_STATS) || defined(__DOXYGEN__)
+#define HAL_USBHUVC_USE_STATS				FALSE
+#endif
+
+/**
+ * @brief   Number of bins of the inter-frame jitter histogram.
+ * @details Bin 0 counts frame intervals within 1ms of the previous one,
+ *          bin n deviations of 2^(n-1) to 2^n - 1 ms; the last bin also
+ *          collects everything above.
+ */
+#if !defined(HAL_USBHUVC_JITTER_BINS) || defined(__DOXYGEN__)
+#define HAL_USBHUVC_JITTER_BINS				8
+#endif
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 #define USBHUVC_MAX_STATUS_PACKET_SZ	16
 
+/* largest payload header that can be received in place (PTS + SCR) */
+#define USBHUVC_MAX_PAYLOAD_HEADER_SZ	12
+
 
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
@@ -312,6 +341,7 @@ typedef struct USBHUVCDriver USBHUVCDriver;
 
 #define USBHUVC_MESSAGETYPE_STATUS	1
 #define USBHUVC_MESSAGETYPE_DATA	2
+#define USBHUVC_MESSAGETYPE_FRAME	3
 
 
 #define _usbhuvc_message_base_data				\
@@ -333,6 +363,69 @@ typedef struct {
 	USBH_DECLARE_STRUCT_MEMBER(uint8_t data[USBHUVC_MAX_STATUS_PACKET_SZ]);
 } usbhuvc_message_status_t;
 
+#if HAL_USBHUVC_USE_FRAME_ASSEMBLER
+#define USBHUVC_FRAME_FLAG_ERROR		(1 << 0)	/* a packet was lost or had the ERR bit set */
+#define USBHUVC_FRAME_FLAG_OVERFLOW		(1 << 1)	/* the frame didn't fit in the buffer, data truncated */
+#define USBHUVC_FRAME_FLAG_INCOMPLETE	(1 << 2)	/* FID toggled before EOF */
+#define USBHUVC_FRAME_FLAG_STILL		(1 << 3)	/* still image */
+#define USBHUVC_FRAME_FLAG_PTS			(1 << 4)	/* pts is valid */
+#define USBHUVC_FRAME_FLAG_SCR			(1 << 5)	/* scr_stc and scr_sof are valid */
+
+typedef struct {
+	_usbhuvc_message_base_data		/* type = USBHUVC_MESSAGETYPE_FRAME, length is not used */
+	uint8_t *buf;					/* payload data, headers stripped */
+	uint32_t size;					/* size of buf */
+	uint32_t datalen;				/* bytes of payload in buf */
+	uint32_t seq;					/* frame sequence number, counts dropped frames too */
+	uint32_t dropped;				/* frames dropped just before this one */
+	uint32_t pts;					/* dwPresentationTime */
+	uint32_t scr_stc;				/* SCR, source time clock */
+	uint16_t scr_sof;				/* SCR, 1KHz SOF token counter */
+	uint8_t flags;
+	bool busy;						/* owned by the driver or the application */
+} usbhuvc_frame_t;
+
+typedef struct {
+	usbhuvc_frame_t *frames;
+	uint8_t count;
+	uint8_t next;
+	uint8_t state;
+	uint8_t fid;
+	uint8_t hlen;
+	uint8_t saved_len;
+	uint8_t saved[USBHUVC_MAX_PAYLOAD_HEADER_SZ];
+	usbhuvc_frame_t *frame;			/* frame being filled */
+	usbhuvc_frame_t *armed;			/* frame the URB points into, NULL if scratch */
+	uint32_t seq;
+	uint32_t dropped;
+} usbhuvc_frame_assembler_t;
+#endif
+
+
+#if HAL_USBHUVC_USE_STATS
+typedef struct {
+	systime_t start;				/* time of the last reset */
+	systime_t elapsed;				/* time since start, set by usbhuvcGetStats */
+	uint64_t bytes;					/* payload bytes, headers excluded */
+	uint32_t packets;				/* ISO packets with a valid header */
+	uint32_t frames;				/* frames seen (EOF or FID toggle) */
+	uint32_t drop_pool;				/* data packets lost, data pool empty */
+	uint32_t drop_status;			/* status packets lost, status pool empty */
+	uint32_t drop_mailbox;			/* packets or frames lost, mailbox full */
+	uint32_t drop_header;			/* packets with an invalid payload header */
+	uint32_t drop_urb;				/* failed ISO transfers */
+	uint32_t drop_frames;			/* frames lost, no free frame buffer */
+	uint16_t pool_used;				/* data buffers or frames in use */
+	uint16_t pool_hwm;				/* pool_used high-watermark */
+	uint16_t mb_used;				/* mailbox depth, set by usbhuvcGetStats */
+	uint16_t mb_hwm;				/* mailbox depth high-watermark */
+	systime_t last_frame;
+	uint32_t last_interval;
+	uint32_t interval_min;			/* shortest frame interval, in ticks */
+	uint32_t interval_max;			/* longest frame interval, in ticks */
+	uint32_t jitter[HAL_USBHUVC_JITTER_BINS];
+} usbhuvc_stats_t;
+#endif
 
 typedef enum {
 	USBHUVC_STATE_UNINITIALIZED = 0,	//must call usbhuvcObjectInit
@@ -366,12 +459,23 @@ struct USBHUVCDriver {
 	mailbox_t mb;
 	msg_t mb_buff[HAL_USBHUVC_MAX_MAILBOX_SZ];
 
+	mailbox_t mb_status;
+	msg_t mb_status_buff[HAL_USBHUVC_STATUS_PACKETS_COUNT];
+
 	memory_pool_t mp_data;
 	void *mp_data_buffer;
 
 	memory_pool_t mp_status;
 	usbhuvc_message_status_t mp_status_buffer[HAL_USBHUVC_STATUS_PACKETS_COUNT];
 
+#if HAL_USBHUVC_USE_FRAME_ASSEMBLER
+	usbhuvc_frame_assembler_t fa;
+#endif
+
+#if HAL_USBHUVC_USE_STATS
+	usbhuvc_stats_t stats;
+#endif
+
 	mutex_t mtx;
 };
 
@@ -441,15 +545,51 @@ extern "C" {
 		osalSysUnlock();
 		return ret;
 	}
+	static inline msg_t usbhuvcFetchStatusS(USBHUVCDriver *uvcdp, msg_t *msg, systime_t timeout) {
+		return chMBFetchTimeoutS(&uvcdp->mb_status, msg, timeout);
+	}
+	static inline msg_t usbhuvcFetchStatus(USBHUVCDriver *uvcdp, msg_t *msg, systime_t timeout) {
+		return chMBFetchTimeout(&uvcdp->mb_status, msg, timeout);
+	}
 	static inline void usbhuvcUnlock(USBHUVCDriver *uvcdp) {
 		chMtxUnlock(&uvcdp->mtx);
 	}
 	static inline void usbhuvcFreeDataMessage(USBHUVCDriver *uvcdp, usbhuvc_message_data_t *msg) {
+#if HAL_USBHUVC_USE_STATS
+		osalSysLock();
+		chPoolFreeI(&uvcdp->mp_data, msg);
+		uvcdp->stats.pool_used--;
+		osalSysUnlock();
+#else
 		chPoolFree(&uvcdp->mp_data, msg);
+#endif
 	}
 	static inline void usbhuvcFreeStatusMessage(USBHUVCDriver *uvcdp, usbhuvc_message_status_t *msg) {
 		chPoolFree(&uvcdp->mp_status, msg);
 	}
+#if HAL_USBHUVC_USE_FRAME_ASSEMBLER
+	void usbhuvcFrameObjectInit(usbhuvc_frame_t *frame, uint8_t *buf, uint32_t size);
+	bool usbhuvcSetFrames(USBHUVCDriver *uvcdp, usbhuvc_frame_t *frames, uint8_t count);
+	static inline void usbhuvcReleaseFrame(USBHUVCDriver *uvcdp, usbhuvc_frame_t *frame) {
+		(void)uvcdp;
+		osalSysLock();
+#if HAL_USBHUVC_USE_STATS
+		/* a frame released twice is only counted once */
+		if (frame->busy)
+			uvcdp->stats.pool_used--;
+#endif
+		frame->busy = false;
+		osalSysUnlock();
+	}
+#endif
+#if HAL_USBHUVC_USE_STATS
+	void usbhuvcGetStats(USBHUVCDriver *uvcdp, usbhuvc_stats_t *stats, bool reset);
+	static inline uint32_t usbhuvcStatsRate(const usbhuvc_stats_t *stats, uint64_t count) {
+		if (stats->elapsed == 0)
+			return 0;
+		return (uint32_t)(count * OSAL_ST_FREQUENCY / stats->elapsed);
+	}
+#endif
 #ifdef __cplusplus
 }
 #endif
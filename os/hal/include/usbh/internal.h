@@ -50,6 +50,11 @@ void _usbhub_port_object_init(usbh_port_t *port, USBHDriver *usbh, uint8_t numbe
 #endif
 
 void _usbh_port_disconnected(usbh_port_t *port);
+#if HAL_USBH_USE_THREAD
+void _usbh_signal_eventI(USBHDriver *host, uint32_t events);
+#else
+#define _usbh_signal_eventI(host, events) do {} while(0)
+#endif
 void _usbh_urb_completeI(usbh_urb_t *urb, usbh_urbstatus_t status);
 bool _usbh_urb_abortI(usbh_urb_t *urb, usbh_urbstatus_t status);
 void _usbh_urb_abort_and_waitS(usbh_urb_t *urb, usbh_urbstatus_t status);
@@ -319,6 +319,17 @@ void crc_lld_start_calc(CRCDriver *crcp, size_t n, const void *buf) {
 
   dmaStreamEnable(crcp->dma);
 }
+
+/**
+ * @brief   Returns the CRC accumulated by the unit since the last reset.
+ *
+ * @param[in] crcp      pointer to the @p CRCDriver object
+ *
+ * @notapi
+ */
+uint32_t crc_lld_get_crc(CRCDriver *crcp) {
+  return crcp->crc->DR ^ crcp->config->final_val;
+}
 #endif
 
 #endif /* CRCSW_USE_CRC1 */
@@ -117,6 +117,17 @@
 #endif
 #endif
 
+/**
+ * @brief   Non programmable units only consume whole 32 bits words.
+ * @details Each word is shifted in starting from its most significant bit
+ *          and neither the data nor the remainder are reflected.
+ */
+#if (STM32_CRC_USE_CRC1 && !STM32_CRC_PROGRAMMABLE) || defined(__DOXYGEN__)
+#define CRC_LLD_WORD_ONLY                   TRUE
+#else
+#define CRC_LLD_WORD_ONLY                   FALSE
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -235,6 +246,7 @@ extern "C" {
   uint32_t crc_lld_calc(CRCDriver *crcp, size_t n, const void *buf);
 #if CRC_USE_DMA
   void crc_lld_start_calc(CRCDriver *crcp, size_t n, const void *buf);
+  uint32_t crc_lld_get_crc(CRCDriver *crcp);
 #endif
 #ifdef __cplusplus
 }
@@ -127,6 +127,84 @@ static inline void _save_dt_mask(usbh_ep_t *ep, uint32_t hctsiz) {
 	ep->dt_mask = hctsiz & HCTSIZ_DPID_MASK;
 }
 
+/* FIFO copy routines. Word aligned buffers are copied in bursts of 4 words,
+ * so that the compiler can use LDM/STM on the memory side; unaligned buffers
+ * fall back to unaligned word accesses. The trailing partial word is copied
+ * bytewise, so the buffers are never accessed past len. */
+static inline void _fifo_read(uint8_t *dest, volatile uint32_t *fifo, uint32_t len) {
+	uint32_t words = len / 4;
+	const uint32_t bytes = len & 3;
+
+	if (((uintptr_t)dest & 3) == 0) {
+		uint32_t *d = (uint32_t *)dest;
+		while (words >= 4) {
+			const uint32_t w0 = *fifo;
+			const uint32_t w1 = *fifo;
+			const uint32_t w2 = *fifo;
+			const uint32_t w3 = *fifo;
+			d[0] = w0;
+			d[1] = w1;
+			d[2] = w2;
+			d[3] = w3;
+			d += 4;
+			words -= 4;
+		}
+		while (words--) {
+			*d++ = *fifo;
+		}
+		dest = (uint8_t *)d;
+	} else {
+		while (words--) {
+			const uint32_t w = *fifo;
+			memcpy(dest, &w, 4);
+			dest += 4;
+		}
+	}
+
+	if (bytes) {
+		const uint32_t w = *fifo;
+		memcpy(dest, &w, bytes);
+	}
+}
+
+static inline void _fifo_write(volatile uint32_t *fifo, const uint8_t *src, uint32_t len) {
+	uint32_t words = len / 4;
+	const uint32_t bytes = len & 3;
+
+	if (((uintptr_t)src & 3) == 0) {
+		const uint32_t *s = (const uint32_t *)src;
+		while (words >= 4) {
+			const uint32_t w0 = s[0];
+			const uint32_t w1 = s[1];
+			const uint32_t w2 = s[2];
+			const uint32_t w3 = s[3];
+			*fifo = w0;
+			*fifo = w1;
+			*fifo = w2;
+			*fifo = w3;
+			s += 4;
+			words -= 4;
+		}
+		while (words--) {
+			*fifo = *s++;
+		}
+		src = (const uint8_t *)s;
+	} else {
+		while (words--) {
+			uint32_t w;
+			memcpy(&w, src, 4);
+			*fifo = w;
+			src += 4;
+		}
+	}
+
+	if (bytes) {
+		uint32_t w = 0;
+		memcpy(&w, src, bytes);
+		*fifo = w;
+	}
+}
+
 /*===========================================================================*/
 /* Functions called from many places.                                        */
 /*===========================================================================*/
@@ -512,12 +590,8 @@ static uint32_t _write_packet(struct list_head *list, uint32_t space_available)
 		if ((int32_t)written > rem)
 			written = rem;
 
-		volatile uint32_t *dest = ep->xfer.hcm->fifo;
-		uint32_t *src = (uint32_t *)ep->xfer.buf;
 		udbgf("\t%s: write %d words (%dB), partial=%d", ep->name, words, written, ep->xfer.partial);
-		while (words--) {
-			*dest = *src++;
-		}
+		_fifo_write(ep->xfer.hcm->fifo, ep->xfer.buf, written);
 
 		ep->xfer.buf += written;
 		ep->xfer.partial += written;
@@ -1100,26 +1174,10 @@ static inline void _rxflvl_int(USBHDriver *host) {
 					(hctsiz & HCTSIZ_PKTCNT_MASK) >> 19);
 
 			/* Read */
-			uint32_t *dest = (uint32_t *)ep->xfer.buf;
-			volatile uint32_t *const src = hcm->fifo;
-
 			uint32_t bcnt = (grxstsp & GRXSTSP_BCNT_MASK) >> GRXSTSP_BCNT_OFF;
 			osalDbgCheck(bcnt + ep->xfer.partial <= ep->xfer.len);
 
-			//TODO: optimize this
-			uint32_t words = bcnt / 4;
-			uint8_t bytes = bcnt & 3;
-			while (words--) {
-				*dest++ = *src;
-			}
-			if (bytes) {
-				uint32_t r = *src;
-				uint8_t *bsrc = (uint8_t *)&r;
-				uint8_t *bdest = (uint8_t *)dest;
-				do {
-					*bdest++ = *bsrc++;
-				} while (--bytes);
-			}
+			_fifo_read(ep->xfer.buf, hcm->fifo, bcnt);
 
 			ep->xfer.buf += bcnt;
 			ep->xfer.partial += bcnt;
@@ -1330,6 +1388,8 @@ static void usb_lld_serve_interrupt(USBHDriver *host) {
 
 	otg->GINTSTS = gintsts;
 
+	const uint16_t c_status = host->rootport.lld_c_status;
+
 	if (gintsts & GINTSTS_SOF)
 		_sof_int(host);
 	if (gintsts & GINTSTS_RXFLVL)
@@ -1347,6 +1407,10 @@ static void usb_lld_serve_interrupt(USBHDriver *host) {
 	if (gintsts & GINTSTS_IPXFR) {
 		uerr("IPXFRM");
 	}
+
+	/* wake up the host on new root port changes */
+	if (host->rootport.lld_c_status & ~c_status)
+		_usbh_signal_eventI(host, USBH_EVENT_ROOTHUB);
 }
 
 
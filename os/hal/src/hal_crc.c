@@ -37,6 +37,166 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Reflects the lower @p width bits of @p value.
+ */
+static uint32_t crc_reflect(uint32_t value, uint32_t width) {
+  uint32_t result = 0U;
+
+  while (width > 0U) {
+    result = (result << 1) | (value & 1U);
+    value >>= 1;
+    width--;
+  }
+
+  return result;
+}
+
+/**
+ * @brief   Multiplies two polynomials modulo the configured polynomial.
+ * @note    Operands and result are non reflected remainders.
+ */
+static uint32_t crc_gf2_mul(const CRCConfig *config, uint32_t a, uint32_t b) {
+  uint32_t top  = 1U << (config->poly_size - 1U);
+  uint32_t mask = top | (top - 1U);
+  uint32_t bit  = top;
+  uint32_t p    = 0U;
+
+  /* Horner scheme, MSB first: p = p * x + a * b[bit] mod poly.*/
+  while (bit != 0U) {
+    p = ((p & top) != 0U) ? ((p << 1) ^ config->poly) & mask :
+                            (p << 1) & mask;
+    if ((b & bit) != 0U) {
+      p ^= a;
+    }
+    bit >>= 1;
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Computes x^(8*n) modulo the configured polynomial.
+ */
+static uint32_t crc_gf2_xpow8n(const CRCConfig *config, size_t n) {
+  uint32_t top  = 1U << (config->poly_size - 1U);
+  uint32_t mask = top | (top - 1U);
+  uint32_t result = 1U & mask;
+  uint32_t base = 1U;
+  unsigned i;
+
+  /* x^8, eight multiplications by x.*/
+  for (i = 0U; i < 8U; i++) {
+    base = ((base & top) != 0U) ? ((base << 1) ^ config->poly) & mask :
+                                  (base << 1) & mask;
+  }
+
+  /* Square and multiply.*/
+  while (n > 0U) {
+    if ((n & 1U) != 0U) {
+      result = crc_gf2_mul(config, result, base);
+    }
+    base = crc_gf2_mul(config, base, base);
+    n >>= 1;
+  }
+
+  return result;
+}
+
+#if (CRC_LLD_WORD_ONLY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Parameters actually applied by a word only unit.
+ * @details These units never reflect, whatever the configuration says, and
+ *          the CRCs they return must be combined accordingly.
+ *
+ * @param[in] config    pointer to the @p CRCConfig object
+ * @param[out] unit     storage for the effective configuration
+ * @return              Pointer to @p unit.
+ */
+static const CRCConfig *crc_unit_config(const CRCConfig *config,
+                                        CRCConfig *unit) {
+  *unit = *config;
+  unit->reflect_data      = false;
+  unit->reflect_remainder = false;
+  return unit;
+}
+#endif
+
+#if (CRC_USE_DMA == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   CPU side CRC used by @p crcCalcSplit().
+ * @details Nibble table driven, the 16 entries table is built on the stack
+ *          for the current configuration. When the LLD only consumes whole
+ *          words the bytes of each word are processed in the same order as
+ *          the unit, most significant first.
+ *
+ * @param[in] config    pointer to the @p CRCConfig object
+ * @param[in] n         number of bytes to process
+ * @param[in] buf       the pointer to the buffer
+ * @return              The CRC of the buffer, as if calculated from reset.
+ */
+static uint32_t crc_cpu_calc(const CRCConfig *config, size_t n,
+                             const uint8_t *buf) {
+  uint32_t width = config->poly_size;
+  uint32_t top   = 1U << (width - 1U);
+  uint32_t mask  = top | (top - 1U);
+  uint32_t table[16];
+  uint32_t crc;
+  unsigned i, bit;
+#if CRC_LLD_WORD_ONLY == TRUE
+  const size_t swap = 3U;
+#else
+  const size_t swap = 0U;
+#endif
+  size_t k;
+
+  if (config->reflect_data) {
+    uint32_t rpoly = crc_reflect(config->poly, width);
+
+    for (i = 0U; i < 16U; i++) {
+      crc = i;
+      for (bit = 0U; bit < 4U; bit++) {
+        crc = ((crc & 1U) != 0U) ? (crc >> 1) ^ rpoly : crc >> 1;
+      }
+      table[i] = crc;
+    }
+
+    crc = crc_reflect(config->initial_val, width);
+    for (k = 0U; k < n; k++) {
+      crc ^= buf[k ^ swap];
+      crc = table[crc & 0x0FU] ^ (crc >> 4);
+      crc = table[crc & 0x0FU] ^ (crc >> 4);
+    }
+  }
+  else {
+    osalDbgAssert(width >= 4U, "unsupported polynomial size");
+
+    for (i = 0U; i < 16U; i++) {
+      crc = i << (width - 4U);
+      for (bit = 0U; bit < 4U; bit++) {
+        crc = ((crc & top) != 0U) ? (crc << 1) ^ config->poly : crc << 1;
+      }
+      table[i] = crc & mask;
+    }
+
+    crc = config->initial_val;
+    for (k = 0U; k < n; k++) {
+      uint32_t data = buf[k ^ swap];
+
+      crc = table[((crc >> (width - 4U)) ^ (data >> 4)) & 0x0FU] ^ (crc << 4);
+      crc = table[((crc >> (width - 4U)) ^ data) & 0x0FU] ^ (crc << 4);
+    }
+  }
+
+  crc &= mask;
+  if (config->reflect_data != config->reflect_remainder) {
+    crc = crc_reflect(crc, width);
+  }
+
+  return (crc ^ config->final_val) & mask;
+}
+#endif /* CRC_USE_DMA == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -227,6 +387,135 @@ void crcStartCalcI(CRCDriver *crcp, size_t n, const void *buf) {
 }
 #endif
 
+/**
+ * @brief   Combines the CRCs of two consecutive blocks.
+ * @details Given the CRC of a block A and the CRC of a block B of @p n2
+ *          bytes, both calculated from reset with the current configuration,
+ *          returns the CRC of A followed by B. This allows splitting a large
+ *          buffer between independent CRC engines and merging the results
+ *          with O(log(n2)) polynomial multiplications.
+ * @pre     The driver must have been configured.
+ *
+ * @param[in] crcp      pointer to the @p CRCDriver object
+ * @param[in] crc1      CRC of the first block
+ * @param[in] crc2      CRC of the second block
+ * @param[in] n2        size in bytes of the second block
+ * @return              The CRC of the two blocks concatenated.
+ * @note    On word only units (@p CRC_LLD_WORD_ONLY) the first block must
+ *          be a multiple of 4 bytes and the CRCs are combined the way the
+ *          unit computes them, without reflections.
+ *
+ * @api
+ */
+uint32_t crcCombine(CRCDriver *crcp, uint32_t crc1, uint32_t crc2, size_t n2) {
+  const CRCConfig *config;
+  uint32_t r;
+#if CRC_LLD_WORD_ONLY == TRUE
+  CRCConfig unit;
+#endif
+
+  osalDbgCheck(crcp != NULL);
+  osalDbgAssert(crcp->config != NULL, "not configured");
+
+  config = crcp->config;
+#if CRC_LLD_WORD_ONLY == TRUE
+  config = crc_unit_config(config, &unit);
+#endif
+  if (n2 == 0U) {
+    return crc1;
+  }
+
+  /* Back to the raw remainder left by the first block, the contribution of
+     the initial value is already part of crc2.*/
+  r = crc1 ^ config->final_val;
+  if (config->reflect_remainder) {
+    r = crc_reflect(r, config->poly_size);
+  }
+  r ^= config->initial_val;
+
+  /* Shifting the remainder through n2 zero bytes.*/
+  r = crc_gf2_mul(config, r, crc_gf2_xpow8n(config, n2));
+  if (config->reflect_remainder) {
+    r = crc_reflect(r, config->poly_size);
+  }
+
+  return r ^ crc2;
+}
+
+#if (CRC_USE_DMA == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Performs a CRC calculation split between the DMA and the CPU.
+ * @details The first @p n - @p n_cpu bytes are handed to the DMA while the
+ *          calling thread computes the CRC of the last @p n_cpu bytes, the
+ *          two results are then merged using @p crcCombine().
+ * @pre     In order to use this function the driver must have been configured
+ *          without callbacks (@p end_cb = @p NULL).
+ * @note    The CPU part is considerably slower than the CRC unit, @p n_cpu
+ *          should be sized so that both parts complete at about the same
+ *          time.
+ * @note    The bytes handled by the CPU are not accumulated into the CRC
+ *          unit, reset the driver before starting another calculation.
+ * @note    If the LLD only consumes whole words (@p CRC_LLD_WORD_ONLY, STM32
+ *          units without programmable polynomial) both @p n and @p n_cpu
+ *          must be multiples of 4, the CRC is then the one the unit would
+ *          compute over the whole buffer.
+ *
+ * @param[in] crcp      pointer to the @p CRCDriver object
+ * @param[in] n         number of bytes to process
+ * @param[in] buf       the pointer to the buffer
+ * @param[in] n_cpu     number of bytes, at the end of @p buf, processed by
+ *                      the CPU
+ * @return              The CRC of the whole buffer.
+ *
+ * @api
+ */
+uint32_t crcCalcSplit(CRCDriver *crcp, size_t n, const void *buf,
+                      size_t n_cpu) {
+  size_t n_dma;
+  uint32_t crc1, crc2;
+  const CRCConfig *config;
+#if CRC_LLD_WORD_ONLY == TRUE
+  CRCConfig unit;
+#endif
+
+  osalDbgCheck((crcp != NULL) && (n > 0U) && (buf != NULL) && (n_cpu <= n));
+
+  n_dma = n - n_cpu;
+#if CRC_LLD_WORD_ONLY == TRUE
+  osalDbgAssert(((n_dma & 3U) == 0U) && ((n_cpu & 3U) == 0U),
+                "word only unit, unaligned split");
+#endif
+  if (n_cpu == 0U) {
+    return crcCalc(crcp, n, buf);
+  }
+
+  osalSysLock();
+  osalDbgAssert(crcp->state == CRC_READY, "not ready");
+  osalDbgAssert(crcp->config->end_cb == NULL, "callback defined");
+  if (n_dma > 0U) {
+    crcp->state = CRC_ACTIVE;
+    crc_lld_start_calc(crcp, n_dma, buf);
+  }
+  osalSysUnlock();
+
+  /* CPU part, in parallel with the DMA transfer.*/
+  config = crcp->config;
+#if CRC_LLD_WORD_ONLY == TRUE
+  config = crc_unit_config(config, &unit);
+#endif
+  crc2 = crc_cpu_calc(config, n_cpu, (const uint8_t *)buf + n_dma);
+
+  osalSysLock();
+  if (crcp->state == CRC_ACTIVE) {
+    (void) osalThreadSuspendS(&crcp->thread);
+  }
+  crc1 = crc_lld_get_crc(crcp);
+  osalSysUnlock();
+
+  return crcCombine(crcp, crc1, crc2, n_cpu);
+}
+#endif /* CRC_USE_DMA == TRUE */
+
 #if (CRC_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Gains exclusive access to the CRC unit.
@@ -0,0 +1,181 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_ioblockv.c
+ * @brief   Vectored block devices interface code.
+ *
+ * @addtogroup IO_BLOCKV
+ * @{
+ */
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Registered vectored VMTs, unused slots are @p NULL.
+ */
+static const struct BaseVectoredBlockDeviceVMT *vectored_vmts[IOBLOCKV_MAX_VMTS];
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers a @p BaseVectoredBlockDevice VMT.
+ * @details Devices using a registered VMT are recognized by
+ *          @p ioblockvIsVectored(), registering the same VMT again has
+ *          no effect.
+ *
+ * @param[in] vmtp      pointer to the vectored VMT
+ *
+ * @init
+ */
+void ioblockvRegisterVMT(const struct BaseVectoredBlockDeviceVMT *vmtp) {
+  unsigned i;
+
+  osalDbgCheck((vmtp != NULL) && (vmtp->readv != NULL) &&
+               (vmtp->writev != NULL));
+
+  for (i = 0U; i < IOBLOCKV_MAX_VMTS; i++) {
+    if (vectored_vmts[i] == vmtp) {
+      return;
+    }
+    if (vectored_vmts[i] == NULL) {
+      vectored_vmts[i] = vmtp;
+      return;
+    }
+  }
+  osalDbgAssert(false, "too many vectored VMTs");
+}
+
+/**
+ * @brief   Checks if a block device implements the vectored interface.
+ *
+ * @param[in] bbdp      pointer to a @p BaseBlockDevice or derived class
+ * @return              The check result.
+ * @retval false        @p readv and @p writev are not available.
+ * @retval true         the device is a @p BaseVectoredBlockDevice.
+ *
+ * @api
+ */
+bool ioblockvIsVectored(const BaseBlockDevice *bbdp) {
+  unsigned i;
+
+  osalDbgCheck(bbdp != NULL);
+
+  for (i = 0U; (i < IOBLOCKV_MAX_VMTS) && (vectored_vmts[i] != NULL); i++) {
+    if ((const void *)bbdp->vmt == (const void *)vectored_vmts[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief   Returns the total number of blocks described by an I/O vector.
+ *
+ * @param[in] iov       pointer to the I/O vector
+ * @param[in] iovcnt    number of elements in the I/O vector
+ * @return              The number of blocks.
+ *
+ * @api
+ */
+uint32_t ioblockvGetBlocks(const blkiov_t *iov, uint32_t iovcnt) {
+  uint32_t n = 0U;
+
+  while (iovcnt-- > 0U) {
+    n += iov++->n;
+  }
+  return n;
+}
+
+/**
+ * @brief   Reads consecutive blocks into a buffers vector.
+ * @details Devices implementing @p BaseVectoredBlockDevice are served by
+ *          a single @p blkReadV(), on other devices one @p blkRead() is
+ *          performed for each vector element.
+ *
+ * @param[in] bbdp      pointer to a @p BaseBlockDevice or derived class
+ * @param[in] startblk  first block to read
+ * @param[in] iov       pointer to the I/O vector
+ * @param[in] iovcnt    number of elements in the I/O vector
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool ioblockvRead(BaseBlockDevice *bbdp, uint32_t startblk,
+                  const blkiov_t *iov, uint32_t iovcnt) {
+
+  osalDbgCheck((bbdp != NULL) && ((iov != NULL) || (iovcnt == 0U)));
+
+  if (ioblockvIsVectored(bbdp)) {
+    return blkReadV((BaseVectoredBlockDevice *)bbdp, startblk, iov, iovcnt);
+  }
+
+  while (iovcnt-- > 0U) {
+    if ((iov->n > 0U) &&
+        (blkRead(bbdp, startblk, (uint8_t *)iov->buffer, iov->n) != HAL_SUCCESS)) {
+      return HAL_FAILED;
+    }
+    startblk += iov->n;
+    iov++;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes consecutive blocks from a buffers vector.
+ * @details Devices implementing @p BaseVectoredBlockDevice are served by
+ *          a single @p blkWriteV(), on other devices one @p blkWrite() is
+ *          performed for each vector element.
+ *
+ * @param[in] bbdp      pointer to a @p BaseBlockDevice or derived class
+ * @param[in] startblk  first block to write
+ * @param[in] iov       pointer to the I/O vector
+ * @param[in] iovcnt    number of elements in the I/O vector
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool ioblockvWrite(BaseBlockDevice *bbdp, uint32_t startblk,
+                   const blkiov_t *iov, uint32_t iovcnt) {
+
+  osalDbgCheck((bbdp != NULL) && ((iov != NULL) || (iovcnt == 0U)));
+
+  if (ioblockvIsVectored(bbdp)) {
+    return blkWriteV((BaseVectoredBlockDevice *)bbdp, startblk, iov, iovcnt);
+  }
+
+  while (iovcnt-- > 0U) {
+    if ((iov->n > 0U) &&
+        (blkWrite(bbdp, startblk, (const uint8_t *)iov->buffer, iov->n) != HAL_SUCCESS)) {
+      return HAL_FAILED;
+    }
+    startblk += iov->n;
+    iov++;
+  }
+  return HAL_SUCCESS;
+}
+
+/** @} */
@@ -41,6 +41,7 @@
 #define MSD_THD_PRIO                    NORMALPRIO
 
 #define CBW_FLAGS_RESERVED_MASK         0b01111111
+#define CBW_FLAGS_DEV2HOST              0b10000000
 #define CBW_LUN_RESERVED_MASK           0b11110000
 #define CBW_CMD_LEN_RESERVED_MASK       0b11000000
 
@@ -169,8 +170,10 @@ static uint32_t scsi_transport_transmit(const SCSITransport *transport,
 
   usb_scsi_transport_handler_t *trp = transport->handler;
   msg_t status = usbTransmit(trp->usbp, trp->ep, data, len);
-  if (MSG_OK == status)
+  if (MSG_OK == status) {
+    trp->moved += len;
     return len;
+  }
   else
     return 0;
 }
@@ -191,18 +194,139 @@ static uint32_t scsi_transport_receive(const SCSITransport *transport,
 
   usb_scsi_transport_handler_t *trp = transport->handler;
   msg_t status = usbReceive(trp->usbp, trp->ep, data, len);
-  if (MSG_RESET != status)
+  if (MSG_RESET != status) {
+    trp->moved += status;
     return status;
+  }
   else
     return 0;
 }
 
+/**
+ * @brief   SCSI transport asynchronous transmit start function.
+ *
+ * @param[in] transport pointer to the @p SCSITransport object
+ * @param[in] data      payload
+ * @param[in] len       number of bytes to be transmitted
+ *
+ * @notapi
+ */
+static void scsi_transport_start_transmit(const SCSITransport *transport,
+                                          const uint8_t *data, size_t len) {
+
+  usb_scsi_transport_handler_t *trp = transport->handler;
+
+  osalSysLock();
+  trp->tx  = true;
+  trp->len = len;
+  if (usbGetDriverStateI(trp->usbp) == USB_ACTIVE) {
+    usbStartTransmitI(trp->usbp, trp->ep, data, len);
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   SCSI transport asynchronous receive start function.
+ *
+ * @param[in] transport pointer to the @p SCSITransport object
+ * @param[in] data      payload
+ * @param[in] len       number of bytes to be received
+ *
+ * @notapi
+ */
+static void scsi_transport_start_receive(const SCSITransport *transport,
+                                         uint8_t *data, size_t len) {
+
+  usb_scsi_transport_handler_t *trp = transport->handler;
+
+  osalSysLock();
+  trp->tx  = false;
+  trp->len = len;
+  if (usbGetDriverStateI(trp->usbp) == USB_ACTIVE) {
+    usbStartReceiveI(trp->usbp, trp->ep, data, len);
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   SCSI transport asynchronous transfer wait function.
+ * @details The thread is suspended only if the endpoint is still busy, a
+ *          transfer already completed is not waited for.
+ *
+ * @param[in] transport pointer to the @p SCSITransport object
+ *
+ * @return              Number of successfully transferred bytes.
+ *
+ * @notapi
+ */
+static uint32_t scsi_transport_wait(const SCSITransport *transport) {
+
+  usb_scsi_transport_handler_t *trp = transport->handler;
+  USBDriver *usbp = trp->usbp;
+  msg_t msg;
+
+  osalSysLock();
+  if (usbGetDriverStateI(usbp) != USB_ACTIVE) {
+    msg = MSG_RESET;
+  }
+  else if (trp->tx) {
+    if (usbGetTransmitStatusI(usbp, trp->ep)) {
+      msg = osalThreadSuspendS(&usbp->epc[trp->ep]->in_state->thread);
+    }
+    else {
+      msg = MSG_OK;
+    }
+  }
+  else {
+    if (usbGetReceiveStatusI(usbp, trp->ep)) {
+      msg = osalThreadSuspendS(&usbp->epc[trp->ep]->out_state->thread);
+    }
+    else {
+      msg = (msg_t)usbp->epc[trp->ep]->out_state->rxcnt;
+    }
+  }
+  osalSysUnlock();
+
+  if (MSG_RESET == msg) {
+    return 0;
+  }
+  else if (trp->tx) {
+    trp->moved += trp->len;
+    return trp->len;
+  }
+  else {
+    trp->moved += msg;
+    return msg;
+  }
+}
+
+/**
+ * @brief   Data residue of the current command.
+ * @details Difference between the data length announced in the CBW and
+ *          the bytes actually moved by the transport.
+ *
+ * @param[in] msdp      pointer to the @p USBMassStorageDriver object
+ *
+ * @return              Number of bytes not transferred.
+ *
+ * @notapi
+ */
+static uint32_t data_residue(const USBMassStorageDriver *msdp) {
+
+  const uint32_t moved = msdp->usb_scsi_transport_handler.moved;
+
+  if (moved >= msdp->cbw.data_len)
+    return 0;
+  else
+    return msdp->cbw.data_len - moved;
+}
+
 /**
  * @brief   Fills and sends CSW message.
  *
  * @param[in] msdp      pointer to the @p USBMassStorageDriver object
  * @param[in] status    status returned by SCSI layer
- * @param[in] residue   number of residue bytes in case of failed transaction
+ * @param[in] residue   number of bytes announced in the CBW not transferred
  *
  * @notapi
  */
@@ -236,11 +360,30 @@ static THD_FUNCTION(usb_msd_worker, arg) {
       osalThreadSleepMilliseconds(50);
     }
     else if (cbw_valid(&msdp->cbw, status) && cbw_meaningful(&msdp->cbw)) {
-      if (SCSI_SUCCESS == scsiExecCmd(&msdp->scsi_target, msdp->cbw.cmd_data)) {
-        send_csw(msdp, CSW_STATUS_PASSED, 0);
+      bool ret;
+      uint32_t residue;
+
+      msdp->usb_scsi_transport_handler.moved = 0;
+      ret = scsiExecCmd(&msdp->scsi_target, msdp->cbw.cmd_data);
+      residue = data_residue(msdp);
+      if (SCSI_SUCCESS == ret) {
+        send_csw(msdp, CSW_STATUS_PASSED, residue);
       }
       else {
-        send_csw(msdp, CSW_STATUS_FAILED, scsiResidue(&msdp->scsi_target));
+        if (residue != 0) {
+          /* the data phase was cut short, halt the pipe so the host stops
+           * moving data and fetches the CSW after clearing the stall, a
+           * command without data phase has no residue and no stall */
+          osalSysLock();
+          if ((msdp->cbw.flags & CBW_FLAGS_DEV2HOST) != 0) {
+            usbStallTransmitI(msdp->usbp, USB_MSD_DATA_EP);
+          }
+          else {
+            usbStallReceiveI(msdp->usbp, USB_MSD_DATA_EP);
+          }
+          osalSysUnlock();
+        }
+        send_csw(msdp, CSW_STATUS_FAILED, residue);
       }
     }
     else {
@@ -378,7 +521,8 @@ void msdStop(USBMassStorageDriver *msdp) {
  * @param[in] usbp      pointer to the @p USBDriver object
  * @param[in] blkdev    pointer to the @p BaseBlockDevice object
  * @param[in] blkbuf    pointer to the working area buffer, must be allocated
- *                      by user, must be big enough to store 1 data block
+ *                      by user, must be big enough to store
+ *                      @p USB_MSD_BLKBUF_BLOCKS data blocks
  * @param[in] inquiry   pointer to the SCSI inquiry response structure,
  *                      set it to @p NULL to use default hardcoded value.
  *
@@ -400,6 +544,9 @@ void msdStart(USBMassStorageDriver *msdp, USBDriver *usbp,
   msdp->scsi_transport.handler  = &msdp->usb_scsi_transport_handler;
   msdp->scsi_transport.transmit = scsi_transport_transmit;
   msdp->scsi_transport.receive  = scsi_transport_receive;
+  msdp->scsi_transport.start_transmit = scsi_transport_start_transmit;
+  msdp->scsi_transport.start_receive  = scsi_transport_start_receive;
+  msdp->scsi_transport.wait           = scsi_transport_wait;
 
   if (NULL == inquiry) {
     msdp->scsi_config.inquiry_response = &default_scsi_inquiry_response;
@@ -414,6 +561,7 @@ void msdStart(USBMassStorageDriver *msdp, USBDriver *usbp,
     msdp->scsi_config.unit_serial_number_inquiry_response = serialInquiry;
   }
   msdp->scsi_config.blkbuf = blkbuf;
+  msdp->scsi_config.blkbuf_blocks = USB_MSD_BLKBUF_BLOCKS;
   msdp->scsi_config.blkdev = blkdev;
   msdp->scsi_config.transport = &msdp->scsi_transport;
 
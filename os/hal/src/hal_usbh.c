@@ -57,6 +57,9 @@
 
 static void _classdriver_process_device(usbh_device_t *dev);
 static bool _classdriver_load(usbh_device_t *dev, uint8_t *descbuff, uint16_t rem);
+#if HAL_USBH_USE_THREAD
+static void _usbh_thread(void *arg);
+#endif
 
 #if HAL_USBH_USE_ADDITIONAL_CLASS_DRIVERS
 #include "usbh_additional_class_drivers.h"
@@ -112,6 +115,13 @@ void usbhStart(USBHDriver *usbh) {
 	usbh_lld_start(usbh);
 	usbh->status = USBH_STATUS_STARTED;
 	osalSysUnlock();
+
+#if HAL_USBH_USE_THREAD
+	if (usbh->thread == NULL) {
+		usbh->thread = chThdCreateStatic(usbh->waThread, sizeof(usbh->waThread),
+				HAL_USBH_THREAD_PRIO, _usbh_thread, usbh);
+	}
+#endif
 }
 
 void usbhStop(USBHDriver *usbh) {
@@ -1163,7 +1173,7 @@ static void _hub_process(USBHDriver *host) {
 /*===========================================================================*/
 /* Main processing loop (enumeration, loading/unloading drivers, etc).       */
 /*===========================================================================*/
-void usbhMainLoop(USBHDriver *usbh) {
+static void _main_loop(USBHDriver *usbh) {
 
 	if (usbh->status == USBH_STATUS_STOPPED)
 		return;
@@ -1183,6 +1193,42 @@ void usbhMainLoop(USBHDriver *usbh) {
 #endif
 }
 
+#if HAL_USBH_USE_THREAD
+void _usbh_signal_eventI(USBHDriver *host, uint32_t events) {
+	host->events |= events;
+	osalThreadResumeI(&host->waitingThread, MSG_OK);
+}
+
+static void _usbh_thread(void *arg) {
+	USBHDriver *const usbh = (USBHDriver *)arg;
+
+	chRegSetThreadName("USBH");
+	while (true) {
+		osalSysLock();
+		if (usbh->events == 0)
+			osalThreadSuspendTimeoutS(&usbh->waitingThread, HAL_USBH_THREAD_POLL_INTERVAL);
+		/* events signaled while processing are served by the next pass */
+		usbh->events = 0;
+		osalSysUnlock();
+
+		_main_loop(usbh);
+	}
+}
+
+/* With the internal thread, the processing is done there: this only wakes it
+ * up, so that applications polling the host keep working. */
+void usbhMainLoop(USBHDriver *usbh) {
+	osalSysLock();
+	_usbh_signal_eventI(usbh, USBH_EVENT_POLL);
+	osalOsRescheduleS();
+	osalSysUnlock();
+}
+#else
+void usbhMainLoop(USBHDriver *usbh) {
+	_main_loop(usbh);
+}
+#endif
+
 /*===========================================================================*/
 /* Class driver loader.                                                      */
 /*===========================================================================*/
@@ -1245,7 +1291,7 @@ bool _usbh_match_descriptor(const uint8_t *descriptor, uint16_t rem,
 	return HAL_FAILED;
 }
 
-static const usbh_classdriverinfo_t *usbh_classdrivers_lookup[] = {
+static const usbh_classdriverinfo_t *const usbh_classdrivers_builtin[] = {
 #if HAL_USBH_USE_ADDITIONAL_CLASS_DRIVERS
 	/* user-defined out of tree class drivers */
 	HAL_USBH_ADDITIONAL_CLASS_DRIVERS
@@ -1265,19 +1311,108 @@ static const usbh_classdriverinfo_t *usbh_classdrivers_lookup[] = {
 #if HAL_USBH_USE_HID
 	&usbhhidClassDriverInfo,
 #endif
-#if HAL_USBH_USE_UVC
-	&usbhuvcClassDriverInfo,
-#endif
 #if HAL_USBH_USE_AOA
 	&usbhaoaClassDriverInfo,	/* Leave always last */
 #endif
 };
 
+static usbh_classdriver_node_t usbh_classdrivers_builtin_nodes[sizeof_array(usbh_classdrivers_builtin)];
+
+/* registered class drivers, in load priority order */
+static LIST_HEAD(usbh_classdrivers);
+static usbh_classdriver_hook_t usbh_classdriver_hook;
+
+/* fields of the descriptor offered to the drivers, matched against the id tables */
+typedef struct {
+	uint8_t type;
+	uint8_t _class;
+	uint8_t subclass;
+	uint8_t protocol;
+	int16_t ifnum;
+} _match_key_t;
+
+static void _classdriver_match_key(_match_key_t *key, const uint8_t *descriptor, uint16_t rem) {
+	memset(key, 0, sizeof(*key));
+	key->ifnum = -1;
+
+	if ((rem < 2) || (rem < descriptor[0]))
+		return;
+
+	key->type = descriptor[1];
+	switch (key->type) {
+	case USBH_DT_DEVICE: {
+		if (rem < USBH_DT_DEVICE_SIZE)
+			break;
+		const usbh_device_descriptor_t *const desc = (const usbh_device_descriptor_t *)descriptor;
+		key->_class = desc->bDeviceClass;
+		key->subclass = desc->bDeviceSubClass;
+		key->protocol = desc->bDeviceProtocol;
+	}	break;
+	case USBH_DT_INTERFACE: {
+		if (rem < USBH_DT_INTERFACE_SIZE)
+			break;
+		const usbh_interface_descriptor_t *const desc = (const usbh_interface_descriptor_t *)descriptor;
+		key->_class = desc->bInterfaceClass;
+		key->subclass = desc->bInterfaceSubClass;
+		key->protocol = desc->bInterfaceProtocol;
+		key->ifnum = desc->bInterfaceNumber;
+	}	break;
+	case USBH_DT_INTERFACE_ASSOCIATION: {
+		if (rem < USBH_DT_INTERFACE_ASSOCIATION_SIZE)
+			break;
+		const usbh_ia_descriptor_t *const desc = (const usbh_ia_descriptor_t *)descriptor;
+		key->_class = desc->bFunctionClass;
+		key->subclass = desc->bFunctionSubClass;
+		key->protocol = desc->bFunctionProtocol;
+		key->ifnum = desc->bFirstInterface;
+	}	break;
+	default:
+		break;
+	}
+}
+
+static bool _classdriver_match(const usbh_device_t *dev, const usbh_device_id_t *id,
+		const _match_key_t *key) {
+
+	for (; id->match_flags; id++) {
+		const uint16_t flags = id->match_flags;
+		if ((flags & USBH_MATCH_VID) && (id->idVendor != dev->devDesc.idVendor))
+			continue;
+		if ((flags & USBH_MATCH_PID) && (id->idProduct != dev->devDesc.idProduct))
+			continue;
+		if ((flags & USBH_MATCH_TYPE) && (id->bDescriptorType != key->type))
+			continue;
+		if ((flags & USBH_MATCH_CLASS) && (id->bClass != key->_class))
+			continue;
+		if ((flags & USBH_MATCH_SUBCLASS) && (id->bSubClass != key->subclass))
+			continue;
+		if ((flags & USBH_MATCH_PROTOCOL) && (id->bProtocol != key->protocol))
+			continue;
+		if ((flags & USBH_MATCH_IFNUM) && (id->bInterfaceNumber != key->ifnum))
+			continue;
+		return true;
+	}
+	return false;
+}
+
 static bool _classdriver_load(usbh_device_t *dev, uint8_t *descbuff, uint16_t rem) {
-	uint8_t i;
 	usbh_baseclassdriver_t *drv = NULL;
-	for (i = 0; i < sizeof_array(usbh_classdrivers_lookup); i++) {
-		const usbh_classdriverinfo_t *const info = usbh_classdrivers_lookup[i];
+	usbh_classdriver_node_t *cd;
+	_match_key_t key;
+
+	_classdriver_match_key(&key, descbuff, rem);
+
+	list_for_each_entry(cd, usbh_classdriver_node_t, &usbh_classdrivers, node) {
+		const usbh_classdriverinfo_t *const info = cd->info;
+
+		if ((info->id_table != NULL) && !_classdriver_match(dev, info->id_table, &key))
+			continue;
+
+		if ((usbh_classdriver_hook != NULL)
+				&& !usbh_classdriver_hook(dev, info, descbuff, rem)) {
+			uinfof("Driver %s denied by hook", info->name);
+			continue;
+		}
 
 		uinfof("Try load driver %s", info->name);
 		drv = info->vmt->load(dev, descbuff, rem);
@@ -1397,12 +1532,45 @@ exit:
 	}
 }
 
+/* Registered drivers take precedence over the built-in ones and over the
+ * drivers registered before them. Drivers must be registered before any
+ * device they handle is connected, and unregistered only when no instance
+ * is loaded. */
+void usbhClassDriverRegister(usbh_classdriver_node_t *node,
+		const usbh_classdriverinfo_t *info) {
+	osalDbgCheck((node != NULL) && (info != NULL) && (info->vmt != NULL));
+
+	node->info = info;
+	if (info->vmt->init) {
+		info->vmt->init();
+	}
+
+	osalSysLock();
+	list_add(&node->node, &usbh_classdrivers);
+	osalSysUnlock();
+}
+
+void usbhClassDriverUnregister(usbh_classdriver_node_t *node) {
+	osalDbgCheck(node != NULL);
+
+	osalSysLock();
+	list_del(&node->node);
+	osalSysUnlock();
+}
+
+void usbhClassDriverSetHook(usbh_classdriver_hook_t hook) {
+	usbh_classdriver_hook = hook;
+}
+
 void usbhInit(void) {
 	uint8_t i;
-	for (i = 0; i < sizeof_array(usbh_classdrivers_lookup); i++) {
-		if (usbh_classdrivers_lookup[i]->vmt->init) {
-			usbh_classdrivers_lookup[i]->vmt->init();
+	for (i = 0; i < sizeof_array(usbh_classdrivers_builtin); i++) {
+		usbh_classdriver_node_t *const node = &usbh_classdrivers_builtin_nodes[i];
+		node->info = usbh_classdrivers_builtin[i];
+		if (node->info->vmt->init) {
+			node->info->vmt->init();
 		}
+		list_add_tail(&node->node, &usbh_classdrivers);
 	}
 	usbh_lld_init();
 }
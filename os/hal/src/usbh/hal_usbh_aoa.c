@@ -132,8 +132,9 @@ static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_aoa_unload
 };
 
+/* no id table: any device may be switched to accessory mode */
 const usbh_classdriverinfo_t usbhaoaClassDriverInfo = {
-	"AOA", &class_driver_vmt
+	"AOA", &class_driver_vmt, NULL
 };
 
 #if defined(HAL_USBHAOA_FILTER_CALLBACK)
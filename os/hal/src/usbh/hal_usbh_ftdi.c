@@ -76,8 +76,18 @@ static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_ftdi_unload
 };
 
+static const usbh_device_id_t id_table[] = {
+	USBH_ID_VID_PID_DESCRIPTOR(0x0403, 0x6001, USBH_DT_INTERFACE, 0xff, 0xff, 0xff),
+	USBH_ID_VID_PID_DESCRIPTOR(0x0403, 0x6010, USBH_DT_INTERFACE, 0xff, 0xff, 0xff),
+	USBH_ID_VID_PID_DESCRIPTOR(0x0403, 0x6011, USBH_DT_INTERFACE, 0xff, 0xff, 0xff),
+	USBH_ID_VID_PID_DESCRIPTOR(0x0403, 0x6014, USBH_DT_INTERFACE, 0xff, 0xff, 0xff),
+	USBH_ID_VID_PID_DESCRIPTOR(0x0403, 0x6015, USBH_DT_INTERFACE, 0xff, 0xff, 0xff),
+	USBH_ID_VID_PID_DESCRIPTOR(0x0403, 0xE2E6, USBH_DT_INTERFACE, 0xff, 0xff, 0xff),
+	USBH_ID_END
+};
+
 const usbh_classdriverinfo_t usbhftdiClassDriverInfo = {
-	"FTDI", &class_driver_vmt
+	"FTDI", &class_driver_vmt, id_table
 };
 
 static USBHFTDIPortDriver *_find_port(void) {
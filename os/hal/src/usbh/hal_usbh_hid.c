@@ -68,6 +68,9 @@
 #define USBH_HID_REQ_SET_IDLE		0x0A
 #define USBH_HID_REQ_SET_PROTOCOL	0x0B
 
+#define USBH_HID_DT_HID				0x21
+#define USBH_HID_DT_REPORT			0x22
+
 /*===========================================================================*/
 /* USB Class driver loader for HID								 		 	 */
 /*===========================================================================*/
@@ -78,6 +81,10 @@ static void _hid_init(void);
 static usbh_baseclassdriver_t *_hid_load(usbh_device_t *dev, const uint8_t *descriptor, uint16_t rem);
 static void _hid_unload(usbh_baseclassdriver_t *drv);
 static void _stop_locked(USBHHIDDriver *hidp);
+#if HAL_USBHHID_USE_REPORT_PARSER
+static void _load_report_descriptor(USBHHIDDriver *hidp, usbh_device_t *dev,
+		const uint8_t *descriptor, uint16_t rem);
+#endif
 
 static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_hid_init,
@@ -85,8 +92,13 @@ static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_hid_unload
 };
 
+static const usbh_device_id_t id_table[] = {
+	{USBH_MATCH_TYPE | USBH_MATCH_CLASS, 0, 0, USBH_DT_INTERFACE, 0x03, 0, 0, 0},
+	USBH_ID_END
+};
+
 const usbh_classdriverinfo_t usbhhidClassDriverInfo = {
-	"HID", &class_driver_vmt
+	"HID", &class_driver_vmt, id_table
 };
 
 static usbh_baseclassdriver_t *_hid_load(usbh_device_t *dev, const uint8_t *descriptor, uint16_t rem) {
@@ -174,6 +186,10 @@ alloc_ok:
 		goto deinit;
 	}
 
+#if HAL_USBHHID_USE_REPORT_PARSER
+	_load_report_descriptor(hidp, dev, descriptor, rem);
+#endif
+
 	hidp->state = USBHHID_STATE_ACTIVE;
 
 	return (usbh_baseclassdriver_t *)hidp;
@@ -191,17 +207,63 @@ static void _hid_unload(usbh_baseclassdriver_t *drv) {
 	chSemSignal(&hidp->sem);
 }
 
+#if HAL_USBHHID_USE_REPORT_QUEUE
+static inline uint8_t _queue_next(uint8_t i) {
+	return (i == HAL_USBHHID_REPORT_QUEUE_LEN - 1) ? 0 : i + 1;
+}
+
+static inline uint8_t *_queue_slot(USBHHIDDriver *hidp, uint8_t i) {
+	return (uint8_t *)hidp->config->report_buffer + i * hidp->config->report_len;
+}
+
+static void _queue_putI(USBHHIDDriver *hidp, uint16_t len) {
+	hidp->queue[hidp->q_wr].timestamp = osalOsGetSystemTimeX();
+	hidp->queue[hidp->q_wr].len = len;
+	hidp->q_wr = _queue_next(hidp->q_wr);
+	if (++hidp->q_counter == HAL_USBHHID_REPORT_QUEUE_LEN) {
+		/* no free slot left for the URB */
+		if (hidp->config->queue_policy == USBHHID_QUEUE_BLOCK) {
+			hidp->q_held = true;
+		} else {
+			hidp->q_rd = _queue_next(hidp->q_rd);
+			hidp->q_counter--;
+			hidp->q_dropped++;
+		}
+	}
+	chThdDequeueNextI(&hidp->q_waiting, Q_OK);
+}
+#endif
+
+static void _submit_inI(USBHHIDDriver *hidp) {
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	hidp->in_urb.buff = _queue_slot(hidp, hidp->q_wr);
+#endif
+	usbhURBObjectResetI(&hidp->in_urb);
+	usbhURBSubmitI(&hidp->in_urb);
+}
+
 static void _in_cb(usbh_urb_t *urb) {
 	USBHHIDDriver *const hidp = (USBHHIDDriver *)urb->userData;
 	switch (urb->status) {
 	case USBH_URBSTATUS_OK:
+#if HAL_USBHHID_USE_REPORT_QUEUE
+		_queue_putI(hidp, urb->actualLength);
+#endif
 		if (hidp->config->cb_report) {
 			hidp->config->cb_report(hidp, urb->actualLength);
 		}
+#if HAL_USBHHID_USE_REPORT_QUEUE
+		if (hidp->q_held) {
+			/* resubmitted by usbhhidReadReport */
+			return;
+		}
+#endif
 		break;
 	case USBH_URBSTATUS_DISCONNECTED:
 		uwarn("HID: URB IN disconnected");
-
+#if HAL_USBHHID_USE_REPORT_QUEUE
+		chThdDequeueAllI(&hidp->q_waiting, Q_RESET);
+#endif
 		return;
 	case USBH_URBSTATUS_TIMEOUT:
 		//no data
@@ -210,13 +272,52 @@ static void _in_cb(usbh_urb_t *urb) {
 		uerrf("HID: URB IN status unexpected = %d", urb->status);
 		break;
 	}
-	usbhURBObjectResetI(&hidp->in_urb);
-	usbhURBSubmitI(&hidp->in_urb);
+	_submit_inI(hidp);
+}
+
+#if HAL_USBHHID_USE_REPORT_QUEUE
+/* Copies the oldest queued report (truncated to size bytes) to buf. The
+ * report is copied with the system locked: keep report_len small. */
+msg_t usbhhidReadReport(USBHHIDDriver *hidp, void *buf, uint16_t size,
+		usbhhid_report_info_t *info, systime_t timeout) {
+	osalDbgCheck(hidp && buf);
+
+	osalSysLock();
+	while (hidp->q_counter == 0) {
+		if (hidp->state != USBHHID_STATE_READY) {
+			osalSysUnlock();
+			return Q_RESET;
+		}
+		msg_t msg = chThdEnqueueTimeoutS(&hidp->q_waiting, timeout);
+		if (msg != Q_OK) {
+			osalSysUnlock();
+			return msg;
+		}
+	}
+
+	const usbhhid_report_info_t *const r = &hidp->queue[hidp->q_rd];
+	memcpy(buf, _queue_slot(hidp, hidp->q_rd), (r->len < size) ? r->len : size);
+	if (info)
+		*info = *r;
+	hidp->q_rd = _queue_next(hidp->q_rd);
+	hidp->q_counter--;
+
+	if (hidp->q_held) {
+		hidp->q_held = false;
+		_submit_inI(hidp);
+	}
+	osalSysUnlock();
+
+	return Q_OK;
 }
+#endif
 
 void usbhhidStart(USBHHIDDriver *hidp, const USBHHIDConfig *cfg) {
 	osalDbgCheck(hidp && cfg);
 	osalDbgCheck(cfg->report_buffer && (cfg->protocol <= USBHHID_PROTOCOL_REPORT));
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	osalDbgCheck(cfg->report_len && (cfg->queue_policy <= USBHHID_QUEUE_BLOCK));
+#endif
 
 	chSemWait(&hidp->sem);
 	if (hidp->state == USBHHID_STATE_READY) {
@@ -227,10 +328,25 @@ void usbhhidStart(USBHHIDDriver *hidp, const USBHHIDConfig *cfg) {
 
 	hidp->config = cfg;
 
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	hidp->q_rd = hidp->q_wr = hidp->q_counter = 0;
+	hidp->q_held = false;
+	hidp->q_dropped = 0;
+#endif
+
 	/* init the URBs */
 	uint32_t report_len = hidp->epin.wMaxPacketSize;
 	if (report_len > cfg->report_len)
 		report_len = cfg->report_len;
+#if HAL_USBHHID_USE_REPORT_PARSER
+	/* the field extractors read whole windows out of the report buffer */
+	uint8_t i;
+	for (i = 0; i < hidp->nfields; i++) {
+		osalDbgAssert((hidp->fields[i].report_type != USBHHID_REPORTTYPE_INPUT)
+				|| (cfg->report_len >= hidp->fields[i].report_len),
+				"report buffer too small for the field extractors");
+	}
+#endif
 	usbhURBObjectInit(&hidp->in_urb, &hidp->epin, _in_cb, hidp,
 			cfg->report_buffer, report_len);
 
@@ -263,6 +379,13 @@ static void _stop_locked(USBHHIDDriver *hidp) {
 	}
 #endif
 	hidp->state = USBHHID_STATE_ACTIVE;
+
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	osalSysLock();
+	chThdDequeueAllI(&hidp->q_waiting, Q_RESET);
+	osalOsRescheduleS();
+	osalSysUnlock();
+#endif
 }
 
 void usbhhidStop(USBHHIDDriver *hidp) {
@@ -320,12 +443,367 @@ usbh_urbstatus_t usbhhidSetProtocol(USBHHIDDriver *hidp, uint8_t protocol) {
 			protocol, hidp->ifnum, 0, NULL);
 }
 
+/*===========================================================================*/
+/* Report descriptor parser.                                                 */
+/*===========================================================================*/
+
+#define _HID_MAX_USAGES			16
+#define _HID_MAX_REPORTS		16
+#define _HID_STACK_DEPTH		4
+
+typedef struct {
+	uint16_t usage_page;
+	uint8_t report_id;
+	int32_t logical_min;
+	int32_t logical_max;
+	uint32_t logical_max_u;
+	uint32_t report_size;
+	uint32_t report_count;
+} _hid_globals_t;
+
+typedef struct {
+	uint8_t type;
+	uint8_t id;
+	uint32_t bits;
+} _hid_report_t;
+
+static _hid_report_t *_report_get(_hid_report_t *reports, uint8_t *nreports,
+		uint8_t type, uint8_t id) {
+	uint8_t i;
+	for (i = 0; i < *nreports; i++) {
+		if ((reports[i].type == type) && (reports[i].id == id))
+			return &reports[i];
+	}
+	if (*nreports == _HID_MAX_REPORTS)
+		return NULL;
+	reports[i].type = type;
+	reports[i].id = id;
+	reports[i].bits = id ? 8 : 0;
+	(*nreports)++;
+	return &reports[i];
+}
+
+static void _field_init(usbhhid_field_t *f, const _hid_globals_t *g,
+		uint8_t type, uint8_t flags, uint32_t bit, uint32_t usage) {
+	f->usage_page = usage >> 16;
+	f->usage_min = f->usage_max = usage & 0xffff;
+	f->bit_offset = bit;
+	f->count = 1;
+	f->bit_size = g->report_size;
+	f->report_id = g->report_id;
+	f->report_type = type;
+	f->flags = flags;
+	f->logical_min = g->logical_min;
+	/* many devices encode an unsigned maximum in too few bytes */
+	f->logical_max = ((g->logical_min >= 0) && (g->logical_max < g->logical_min)) ?
+			(int32_t)g->logical_max_u : g->logical_max;
+}
+
+/* Compiles a report descriptor into a field table. On entry *nfields holds the
+ * capacity of the table, on exit the number of fields found. Constant
+ * (padding) items produce no fields. Returns HAL_FAILED if the descriptor is
+ * malformed or the table is too small; the fields returned are valid anyway. */
+bool usbhhidParseReportDescriptor(const uint8_t *desc, uint16_t len,
+		usbhhid_field_t *fields, uint16_t *nfields) {
+	_hid_globals_t g, stack[_HID_STACK_DEPTH];
+	uint8_t sp = 0;
+	uint32_t usages[_HID_MAX_USAGES];
+	uint8_t nusages = 0;
+	uint32_t usage_min = 0, usage_max = 0;
+	bool has_range = false;
+	_hid_report_t reports[_HID_MAX_REPORTS];
+	uint8_t nreports = 0;
+	const uint16_t max = *nfields;
+	uint16_t n = 0;
+	bool ret = HAL_SUCCESS;
+	uint16_t i;
+
+	osalDbgCheck(desc && fields && nfields);
+
+	memset(&g, 0, sizeof(g));
+
+	while (len) {
+		const uint8_t prefix = desc[0];
+
+		if (prefix == 0xfe) {
+			/* long item, none defined yet: skip */
+			if ((len < 3) || (len < 3 + desc[1]))
+				goto malformed;
+			len -= 3 + desc[1];
+			desc += 3 + desc[1];
+			continue;
+		}
+
+		uint8_t size = prefix & 3;
+		if (size == 3) size = 4;
+		if (len < 1 + size)
+			goto malformed;
+
+		uint32_t data = 0;
+		for (i = 0; i < size; i++)
+			data |= (uint32_t)desc[1 + i] << (8 * i);
+		const int32_t sdata = (size == 0) ? 0 : (size == 4) ? (int32_t)data :
+				(int32_t)(data << (32 - 8 * size)) >> (32 - 8 * size);
+
+		len -= 1 + size;
+		desc += 1 + size;
+
+		switch (prefix & 0xfc) {
+		/* main items */
+		case 0x80:	/* Input */
+		case 0x90:	/* Output */
+		case 0xb0: {	/* Feature */
+			const uint8_t type = (prefix & 0xfc) == 0x80 ? USBHHID_REPORTTYPE_INPUT :
+					(prefix & 0xfc) == 0x90 ? USBHHID_REPORTTYPE_OUTPUT : USBHHID_REPORTTYPE_FEATURE;
+			const uint8_t flags = (uint8_t)data;
+			_hid_report_t *const rep = _report_get(reports, &nreports, type, g.report_id);
+			if (rep == NULL)
+				goto malformed;
+
+			const uint32_t bit = rep->bits;
+			rep->bits += g.report_size * g.report_count;
+			if ((g.report_size > 32) || (g.report_count > 0xffff)
+					|| (rep->bits > 0xffff))
+				goto malformed;
+
+			if ((flags & USBHHID_FIELD_FLAG_CONSTANT)
+					|| (g.report_size == 0) || (g.report_count == 0))
+				goto reset_locals;
+
+			if (flags & USBHHID_FIELD_FLAG_VARIABLE) {
+				/* one field per run of consecutive (or repeated) usages */
+				usbhhid_field_t *f = NULL;
+				uint32_t prev = 0;
+				bool repeating = false;
+				for (i = 0; i < g.report_count; i++) {
+					uint32_t usage;
+					if (nusages) {
+						usage = usages[(i < nusages) ? i : nusages - 1];
+					} else if (has_range) {
+						usage = (usage_min + i < usage_max) ? usage_min + i : usage_max;
+					} else {
+						usage = (uint32_t)g.usage_page << 16;
+					}
+
+					if (f && ((usage >> 16) == (prev >> 16))) {
+						if ((usage == prev + 1) && !repeating) {
+							f->usage_max = usage & 0xffff;
+							f->count++;
+							prev = usage;
+							continue;
+						}
+						if (usage == prev) {
+							repeating = true;
+							f->count++;
+							continue;
+						}
+					}
+
+					if (n == max) {
+						ret = HAL_FAILED;
+						break;
+					}
+					f = &fields[n++];
+					_field_init(f, &g, type, flags, bit + i * g.report_size, usage);
+					prev = usage;
+					repeating = false;
+				}
+			} else {
+				/* array: elements are usage indexes */
+				if (n == max) {
+					ret = HAL_FAILED;
+					goto reset_locals;
+				}
+				usbhhid_field_t *const f = &fields[n++];
+				uint32_t first = (uint32_t)g.usage_page << 16, last = first;
+				if (has_range) {
+					first = usage_min;
+					last = usage_max;
+				} else if (nusages) {
+					first = usages[0];
+					last = usages[nusages - 1];
+				}
+				_field_init(f, &g, type, flags, bit, first);
+				f->usage_max = last & 0xffff;
+				f->count = g.report_count;
+			}
+		}
+		/* fall through */
+		case 0xa0:	/* Collection */
+		case 0xc0:	/* End Collection */
+reset_locals:
+			nusages = 0;
+			has_range = false;
+			usage_min = usage_max = 0;
+			break;
+
+		/* global items */
+		case 0x04:	/* Usage Page */
+			g.usage_page = data;
+			break;
+		case 0x14:	/* Logical Minimum */
+			g.logical_min = sdata;
+			break;
+		case 0x24:	/* Logical Maximum */
+			g.logical_max = sdata;
+			g.logical_max_u = data;
+			break;
+		case 0x74:	/* Report Size */
+			g.report_size = data;
+			break;
+		case 0x84:	/* Report ID */
+			if ((data == 0) || (data > 0xff))
+				goto malformed;
+			g.report_id = data;
+			break;
+		case 0x94:	/* Report Count */
+			g.report_count = data;
+			break;
+		case 0xa4:	/* Push */
+			if (sp == _HID_STACK_DEPTH)
+				goto malformed;
+			stack[sp++] = g;
+			break;
+		case 0xb4:	/* Pop */
+			if (sp == 0)
+				goto malformed;
+			g = stack[--sp];
+			break;
+
+		/* local items; short usages take the current usage page */
+		case 0x08:	/* Usage */
+			if (size < 4)
+				data |= (uint32_t)g.usage_page << 16;
+			if (nusages < _HID_MAX_USAGES)
+				usages[nusages++] = data;
+			break;
+		case 0x18:	/* Usage Minimum */
+			usage_min = (size < 4) ? (data | (uint32_t)g.usage_page << 16) : data;
+			has_range = true;
+			break;
+		case 0x28:	/* Usage Maximum */
+			usage_max = (size < 4) ? (data | (uint32_t)g.usage_page << 16) : data;
+			has_range = true;
+			break;
+
+		default:
+			break;
+		}
+	}
+	goto done;
+
+malformed:
+	ret = HAL_FAILED;
+
+done:
+	/* now that the reports are complete, fill in the lengths and masks */
+	for (i = 0; i < n; i++) {
+		usbhhid_field_t *const f = &fields[i];
+		const _hid_report_t *const rep = _report_get(reports, &nreports, f->report_type, f->report_id);
+		uint16_t report_len = (rep->bits + 7) >> 3;
+		f->report_len = (report_len < USBHHID_FIELD_WINDOW) ? USBHHID_FIELD_WINDOW : report_len;
+		f->mask = 0xffffffffU >> (32 - f->bit_size);
+		f->sign = (f->logical_min < 0) ? (1U << (f->bit_size - 1)) : 0;
+	}
+	*nfields = n;
+	return ret;
+}
+
+#if HAL_USBHHID_USE_REPORT_PARSER
+static USBH_DEFINE_BUFFER(uint8_t _report_desc[HAL_USBHHID_MAX_REPORT_DESCRIPTOR_SIZE]);
+
+static void _load_report_descriptor(USBHHIDDriver *hidp, usbh_device_t *dev,
+		const uint8_t *descriptor, uint16_t rem) {
+	generic_iterator_t iif, ics;
+	uint16_t len = 0;
+	uint8_t i;
+
+	hidp->nfields = 0;
+
+	/* the HID descriptor follows the interface descriptor */
+	iif.curr = descriptor;
+	iif.rem = rem;
+	iif.valid = 1;
+	for (cs_iter_init(&ics, &iif); ics.valid; cs_iter_next(&ics)) {
+		const uint8_t *const hiddesc = ics.curr;
+		if ((hiddesc[1] != USBH_HID_DT_HID) || (hiddesc[0] < 9))
+			continue;
+		for (i = 0; (i < hiddesc[5]) && (9 + 3 * i <= hiddesc[0]); i++) {
+			if (hiddesc[6 + 3 * i] == USBH_HID_DT_REPORT) {
+				len = hiddesc[7 + 3 * i] | (hiddesc[8 + 3 * i] << 8);
+				break;
+			}
+		}
+		break;
+	}
+
+	if (len == 0) {
+		uwarn("HID: no report descriptor");
+		return;
+	}
+	if (len > HAL_USBHHID_MAX_REPORT_DESCRIPTOR_SIZE) {
+		uwarnf("HID: report descriptor too large (%d bytes)", len);
+		return;
+	}
+
+	USBH_DEFINE_BUFFER(const usbh_control_request_t req) = {
+		USBH_REQTYPE_STANDARDIN(USBH_REQTYPE_RECIP_INTERFACE),
+		USBH_REQ_GET_DESCRIPTOR,
+		USBH_HID_DT_REPORT << 8,
+		hidp->ifnum,
+		len
+	};
+	uint32_t actual_len;
+	if ((usbhControlRequestExtended(dev, &req, _report_desc, &actual_len,
+			HAL_USBH_CONTROL_REQUEST_DEFAULT_TIMEOUT) != USBH_URBSTATUS_OK)
+			|| (actual_len == 0)) {
+		uwarn("HID: can't read the report descriptor");
+		return;
+	}
+
+	uint16_t n = HAL_USBHHID_MAX_FIELDS;
+	if (usbhhidParseReportDescriptor(_report_desc, actual_len, hidp->fields, &n) != HAL_SUCCESS) {
+		uwarnf("HID: report descriptor partially parsed (%d fields)", n);
+	}
+	hidp->nfields = (uint8_t)n;
+	uinfof("HID: %d report fields", n);
+}
+
+const usbhhid_field_t *usbhhidFindField(USBHHIDDriver *hidp,
+		usbhhid_reporttype_t type, uint16_t usage_page, uint16_t usage,
+		uint16_t *index) {
+	uint8_t i;
+
+	osalDbgCheck(hidp);
+
+	for (i = 0; i < hidp->nfields; i++) {
+		const usbhhid_field_t *const f = &hidp->fields[i];
+		if ((f->report_type != type) || (f->usage_page != usage_page)
+				|| (usage < f->usage_min) || (usage > f->usage_max))
+			continue;
+		if (index) {
+			*index = 0;
+			if (f->flags & USBHHID_FIELD_FLAG_VARIABLE) {
+				*index = usage - f->usage_min;
+				if (*index >= f->count)
+					*index = f->count - 1;
+			}
+		}
+		return f;
+	}
+	return NULL;
+}
+#endif
+
 static void _hid_object_init(USBHHIDDriver *hidp) {
 	osalDbgCheck(hidp != NULL);
 	memset(hidp, 0, sizeof(*hidp));
 	hidp->info = &usbhhidClassDriverInfo;
 	hidp->state = USBHHID_STATE_STOP;
 	chSemObjectInit(&hidp->sem, 1);
+#if HAL_USBHHID_USE_REPORT_QUEUE
+	chThdQueueObjectInit(&hidp->q_waiting);
+#endif
 }
 
 static void _hid_init(void) {
@@ -72,8 +72,13 @@ static const usbh_classdriver_vmt_t usbhhubClassDriverVMT = {
 	_hub_unload
 };
 
+static const usbh_device_id_t usbhhubIdTable[] = {
+	USBH_ID_DESCRIPTOR(USBH_DT_DEVICE, 0x09, 0x00, 0x00),
+	USBH_ID_END
+};
+
 const usbh_classdriverinfo_t usbhhubClassDriverInfo = {
-	"HUB", &usbhhubClassDriverVMT
+	"HUB", &usbhhubClassDriverVMT, usbhhubIdTable
 };
 
 
@@ -127,6 +132,8 @@ static void _urb_complete(usbh_urb_t *urb) {
 			*sc++ |= *r++;
 
 		uinfof("HUB: change, %08x", hubdp->statuschange);
+		if (hubdp->statuschange)
+			_usbh_signal_eventI(hubdp->dev->host, USBH_EVENT_HUB);
 	}	break;
 	case USBH_URBSTATUS_DISCONNECTED:
 		uwarn("HUB: URB disconnected, aborting poll");
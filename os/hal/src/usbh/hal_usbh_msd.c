@@ -90,8 +90,13 @@ static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_msd_unload
 };
 
+static const usbh_device_id_t id_table[] = {
+	USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x08, 0x06, 0x50),
+	USBH_ID_END
+};
+
 const usbh_classdriverinfo_t usbhmsdClassDriverInfo = {
-	"MSD", &class_driver_vmt
+	"MSD", &class_driver_vmt, id_table
 };
 
 #define MSD_REQ_RESET							0xFF
@@ -258,6 +263,14 @@ typedef struct {
 	uint32_t data_processed;
 } msd_transaction_t;
 
+/* Data phase position inside an I/O vector, bs is the size of the
+   vector units in bytes. */
+typedef struct {
+	const blkiov_t *iov;
+	uint32_t bs;
+	uint32_t offset;
+} msd_data_cursor_t;
+
 typedef enum {
 	MSD_BOTRESULT_OK,
 	MSD_BOTRESULT_DISCONNECTED,
@@ -279,6 +292,7 @@ typedef enum {
 static bool _msd_bot_reset(USBHMassStorageDriver *msdp) {
 
 	usbh_urbstatus_t res;
+	bool in_ok, out_ok;
 	res = usbhControlRequest(msdp->dev,
 			USBH_REQTYPE_CLASSOUT(USBH_REQTYPE_RECIP_INTERFACE),
 			0xFF, 0, msdp->ifnum, 0, NULL);
@@ -288,10 +302,13 @@ static bool _msd_bot_reset(USBHMassStorageDriver *msdp) {
 
 	osalThreadSleepMilliseconds(100);
 
-	return usbhEPReset(&msdp->epin) && usbhEPReset(&msdp->epout);
+	/* both pipes must be cleared, HAL_SUCCESS is false */
+	in_ok = (usbhEPReset(&msdp->epin) == HAL_SUCCESS);
+	out_ok = (usbhEPReset(&msdp->epout) == HAL_SUCCESS);
+	return in_ok && out_ok;
 }
 
-static msd_bot_result_t _msd_bot_transaction(msd_transaction_t *tran, USBHMassStorageLUNDriver *lunp, void *data) {
+static msd_bot_result_t _msd_bot_transaction(msd_transaction_t *tran, USBHMassStorageLUNDriver *lunp, msd_data_cursor_t *cur) {
 
 	uint32_t data_actual_len, actual_len;
 	usbh_urbstatus_t status;
@@ -306,7 +323,7 @@ static msd_bot_result_t _msd_bot_transaction(msd_transaction_t *tran, USBHMassSt
 	status = usbhBulkTransfer(&lunp->msdp->epout, tran->cbw,
 					sizeof(*tran->cbw), &actual_len, OSAL_MS2I(1000));
 
-	if (status == USBH_URBSTATUS_CANCELLED) {
+	if ((status == USBH_URBSTATUS_CANCELLED) || (status == USBH_URBSTATUS_DISCONNECTED)) {
 		uerr("\tMSD: Control phase: USBH_URBSTATUS_CANCELLED");
 		return MSD_BOTRESULT_DISCONNECTED;
 	}
@@ -319,17 +336,41 @@ static msd_bot_result_t _msd_bot_transaction(msd_transaction_t *tran, USBHMassSt
 	}
 
 
-	/* data phase */
+	/* data phase, one bulk transfer for each vector element */
 	data_actual_len = 0;
 	if (tran->cbw->dCBWDataTransferLength) {
 		usbh_ep_t *const ep = tran->cbw->bmCBWFlags & MSD_CBWFLAGS_D2H ? &lunp->msdp->epin : &lunp->msdp->epout;
-		status = usbhBulkTransfer(
-				ep,
-				data,
-				tran->cbw->dCBWDataTransferLength,
-				&data_actual_len, OSAL_MS2I(20000));
+		uint32_t remaining = tran->cbw->dCBWDataTransferLength;
+		uint32_t len, seg_actual_len;
+
+		do {
+			len = cur->iov->n * cur->bs - cur->offset;
+			if (len == 0) {
+				cur->iov++;
+				cur->offset = 0;
+				continue;
+			}
+			if (len > remaining) {
+				len = remaining;
+			}
+			status = usbhBulkTransfer(
+					ep,
+					(uint8_t *)cur->iov->buffer + cur->offset,
+					len,
+					&seg_actual_len, OSAL_MS2I(20000));
+			if (status != USBH_URBSTATUS_OK) {
+				break;
+			}
+			data_actual_len += seg_actual_len;
+			cur->offset += seg_actual_len;
+			remaining -= seg_actual_len;
+			if (seg_actual_len < len) {
+				/* short packet, the device ended the data phase */
+				break;
+			}
+		} while (remaining);
 
-		if (status == USBH_URBSTATUS_CANCELLED) {
+		if ((status == USBH_URBSTATUS_CANCELLED) || (status == USBH_URBSTATUS_DISCONNECTED)) {
 			uerr("\tMSD: Data phase: USBH_URBSTATUS_CANCELLED");
 			return MSD_BOTRESULT_DISCONNECTED;
 		}
@@ -362,7 +403,7 @@ static msd_bot_result_t _msd_bot_transaction(msd_transaction_t *tran, USBHMassSt
 		}
 	}
 
-	if (status == USBH_URBSTATUS_CANCELLED) {
+	if ((status == USBH_URBSTATUS_CANCELLED) || (status == USBH_URBSTATUS_DISCONNECTED)) {
 		uerr("\tMSD: Status phase: USBH_URBSTATUS_CANCELLED");
 		return MSD_BOTRESULT_DISCONNECTED;
 	}
@@ -426,6 +467,10 @@ static msd_bot_result_t _msd_bot_transaction(msd_transaction_t *tran, USBHMassSt
 #define SCSI_CMD_READ_10 						0x28
 #define SCSI_CMD_WRITE_10						0x2A
 
+/* Read 16 and Write 16 */
+#define SCSI_CMD_READ_16 						0x88
+#define SCSI_CMD_WRITE_16						0x8A
+
 /* Request sense */
 #define SCSI_CMD_REQUEST_SENSE 					0x03
 typedef PACKED_STRUCT {
@@ -483,6 +528,23 @@ typedef PACKED_STRUCT {
 	uint32_t block_size;
 } scsi_readcapacity10_response_t;
 
+/* Read Capacity 16 */
+#define SCSI_CMD_SERVICE_ACTION_IN_16			0x9E
+#define SCSI_SA_READ_CAPACITY_16				0x10
+typedef PACKED_STRUCT {
+	uint32_t last_block_addr_hi;
+	uint32_t last_block_addr_lo;
+	uint32_t block_size;
+	uint8_t res[20];
+} scsi_readcapacity16_response_t;
+
+/* Vital product data pages */
+#define SCSI_VPD_SUPPORTED_PAGES				0x00
+#define SCSI_VPD_BLOCK_LIMITS					0xB0
+typedef PACKED_STRUCT {
+	uint8_t byte[64];
+} scsi_vpd_response_t;
+
 /* Start/Stop Unit */
 #define SCSI_CMD_START_STOP_UNIT				0x1B
 typedef PACKED_STRUCT {
@@ -499,11 +561,28 @@ typedef PACKED_STRUCT {
 
 static msd_result_t scsi_requestsense(USBHMassStorageLUNDriver *lunp, scsi_sense_response_t *resp);
 
-static msd_result_t _scsi_perform_transaction(USBHMassStorageLUNDriver *lunp,
-		msd_transaction_t *transaction, void *data) {
+static void _msd_auto_sense(USBHMassStorageLUNDriver *lunp) {
+	USBH_DEFINE_BUFFER(scsi_sense_response_t sense);
+
+	uwarn("\tMSD: Command failed, auto-sense");
+	if (scsi_requestsense(lunp, &sense) == MSD_RESULT_OK) {
+		uwarnf("\tMSD: REQUEST SENSE: Sense key=%x, ASC=%02x, ASCQ=%02x",
+				sense.byte[2] & 0xf, sense.byte[12], sense.byte[13]);
+		lunp->errors.sense_key = sense.byte[2] & 0xf;
+		lunp->errors.asc = sense.byte[12];
+		lunp->errors.ascq = sense.byte[13];
+	} else {
+		lunp->errors.sense_key = SCSI_SENSE_KEY_GOOD;
+		lunp->errors.asc = SCSI_ASENSE_NO_ADDITIONAL_INFORMATION;
+		lunp->errors.ascq = SCSI_ASENSEQ_NO_QUALIFIER;
+	}
+}
+
+static msd_result_t _scsi_perform_transaction_v(USBHMassStorageLUNDriver *lunp,
+		msd_transaction_t *transaction, msd_data_cursor_t *cur) {
 
 	msd_bot_result_t res;
-	res = _msd_bot_transaction(transaction, lunp, data);
+	res = _msd_bot_transaction(transaction, lunp, cur);
 	if (res != MSD_BOTRESULT_OK) {
 		return (msd_result_t)res;
 	}
@@ -511,12 +590,7 @@ static msd_result_t _scsi_perform_transaction(USBHMassStorageLUNDriver *lunp,
 	if (transaction->csw_status == CSW_STATUS_FAILED) {
 		if (transaction->cbw->CBWCB[0] != SCSI_CMD_REQUEST_SENSE) {
 			/* do auto-sense (except for SCSI_CMD_REQUEST_SENSE!) */
-			uwarn("\tMSD: Command failed, auto-sense");
-			USBH_DEFINE_BUFFER(scsi_sense_response_t sense);
-			if (scsi_requestsense(lunp, &sense) == MSD_RESULT_OK) {
-				uwarnf("\tMSD: REQUEST SENSE: Sense key=%x, ASC=%02x, ASCQ=%02x",
-						sense.byte[2] & 0xf, sense.byte[12], sense.byte[13]);
-			}
+			_msd_auto_sense(lunp);
 		}
 		return MSD_RESULT_FAILED;
 	}
@@ -524,6 +598,15 @@ static msd_result_t _scsi_perform_transaction(USBHMassStorageLUNDriver *lunp,
 	return MSD_RESULT_OK;
 }
 
+static msd_result_t _scsi_perform_transaction(USBHMassStorageLUNDriver *lunp,
+		msd_transaction_t *transaction, void *data) {
+
+	blkiov_t iov = {data, 1};
+	msd_data_cursor_t cur = {&iov, transaction->cbw->dCBWDataTransferLength, 0};
+
+	return _scsi_perform_transaction_v(lunp, transaction, &cur);
+}
+
 static msd_result_t scsi_inquiry(USBHMassStorageLUNDriver *lunp, scsi_inquiry_response_t *resp) {
 	USBH_DEFINE_BUFFER(msd_cbw_t cbw);
 	msd_transaction_t transaction;
@@ -610,31 +693,24 @@ static msd_result_t scsi_readcapacity10(USBHMassStorageLUNDriver *lunp, scsi_rea
 }
 
 
-static msd_result_t scsi_read10(USBHMassStorageLUNDriver *lunp, uint32_t lba, uint16_t n, uint8_t *data, uint32_t *actual_len) {
+static msd_result_t scsi_readcapacity16(USBHMassStorageLUNDriver *lunp, scsi_readcapacity16_response_t *resp) {
 	USBH_DEFINE_BUFFER(msd_cbw_t cbw);
 	msd_transaction_t transaction;
 	msd_result_t res;
 
 	memset(cbw.CBWCB, 0, sizeof(cbw.CBWCB));
-	cbw.dCBWDataTransferLength = n * lunp->info.blk_size;
+	cbw.dCBWDataTransferLength = sizeof(scsi_readcapacity16_response_t);
 	cbw.bmCBWFlags = MSD_CBWFLAGS_D2H;
-	cbw.bCBWCBLength = 10;
-	cbw.CBWCB[0] = SCSI_CMD_READ_10;
-	cbw.CBWCB[2] = (uint8_t)(lba >> 24);
-	cbw.CBWCB[3] = (uint8_t)(lba >> 16);
-	cbw.CBWCB[4] = (uint8_t)(lba >> 8);
-	cbw.CBWCB[5] = (uint8_t)(lba);
-	cbw.CBWCB[7] = (uint8_t)(n >> 8);
-	cbw.CBWCB[8] = (uint8_t)(n);
+	cbw.bCBWCBLength = 16;
+	cbw.CBWCB[0] = SCSI_CMD_SERVICE_ACTION_IN_16;
+	cbw.CBWCB[1] = SCSI_SA_READ_CAPACITY_16;
+	cbw.CBWCB[13] = sizeof(scsi_readcapacity16_response_t);
 	transaction.cbw = &cbw;
 
-	res = _scsi_perform_transaction(lunp, &transaction, data);
-	if (actual_len) {
-		*actual_len = transaction.data_processed;
-	}
+	res = _scsi_perform_transaction(lunp, &transaction, resp);
 	if (res == MSD_RESULT_OK) {
 		//transaction is OK; check length
-		if (transaction.data_processed < cbw.dCBWDataTransferLength) {
+		if (transaction.data_processed < 12) {
 			res = MSD_RESULT_TRANSPORT_ERROR;
 		}
 	}
@@ -642,31 +718,26 @@ static msd_result_t scsi_read10(USBHMassStorageLUNDriver *lunp, uint32_t lba, ui
 	return res;
 }
 
-static msd_result_t scsi_write10(USBHMassStorageLUNDriver *lunp, uint32_t lba, uint16_t n, const uint8_t *data, uint32_t *actual_len) {
+static msd_result_t scsi_inquiry_vpd(USBHMassStorageLUNDriver *lunp, uint8_t page, scsi_vpd_response_t *resp) {
 	USBH_DEFINE_BUFFER(msd_cbw_t cbw);
 	msd_transaction_t transaction;
 	msd_result_t res;
 
+	memset(resp, 0, sizeof(*resp));
 	memset(cbw.CBWCB, 0, sizeof(cbw.CBWCB));
-	cbw.dCBWDataTransferLength = n * lunp->info.blk_size;
-	cbw.bmCBWFlags = MSD_CBWFLAGS_H2D;
-	cbw.bCBWCBLength = 10;
-	cbw.CBWCB[0] = SCSI_CMD_WRITE_10;
-	cbw.CBWCB[2] = (uint8_t)(lba >> 24);
-	cbw.CBWCB[3] = (uint8_t)(lba >> 16);
-	cbw.CBWCB[4] = (uint8_t)(lba >> 8);
-	cbw.CBWCB[5] = (uint8_t)(lba);
-	cbw.CBWCB[7] = (uint8_t)(n >> 8);
-	cbw.CBWCB[8] = (uint8_t)(n);
+	cbw.dCBWDataTransferLength = sizeof(scsi_vpd_response_t);
+	cbw.bmCBWFlags = MSD_CBWFLAGS_D2H;
+	cbw.bCBWCBLength = 6;
+	cbw.CBWCB[0] = SCSI_CMD_INQUIRY;
+	cbw.CBWCB[1] = 0x01;	/* EVPD */
+	cbw.CBWCB[2] = page;
+	cbw.CBWCB[4] = sizeof(scsi_vpd_response_t);
 	transaction.cbw = &cbw;
 
-	res = _scsi_perform_transaction(lunp, &transaction, (void *)data);
-	if (actual_len) {
-		*actual_len = transaction.data_processed;
-	}
+	res = _scsi_perform_transaction(lunp, &transaction, resp);
 	if (res == MSD_RESULT_OK) {
-		//transaction is OK; check length
-		if (transaction.data_processed < cbw.dCBWDataTransferLength) {
+		//transaction is OK; VPD pages are variable length
+		if ((transaction.data_processed < 4) || (resp->byte[1] != page)) {
 			res = MSD_RESULT_TRANSPORT_ERROR;
 		}
 	}
@@ -674,6 +745,489 @@ static msd_result_t scsi_write10(USBHMassStorageLUNDriver *lunp, uint32_t lba, u
 	return res;
 }
 
+static uint32_t _vpd_max_transfer_blocks(USBHMassStorageLUNDriver *lunp) {
+	USBH_DEFINE_BUFFER(scsi_vpd_response_t vpd);
+	uint8_t i;
+
+	/* look for the Block Limits page in the supported pages list */
+	if (scsi_inquiry_vpd(lunp, SCSI_VPD_SUPPORTED_PAGES, &vpd) != MSD_RESULT_OK) {
+		return 0;
+	}
+	for (i = 4; (i < 4 + vpd.byte[3]) && (i < sizeof(vpd.byte)); i++) {
+		if (vpd.byte[i] == SCSI_VPD_BLOCK_LIMITS) {
+			break;
+		}
+	}
+	if ((i == 4 + vpd.byte[3]) || (i == sizeof(vpd.byte))) {
+		return 0;
+	}
+
+	/* MAXIMUM TRANSFER LENGTH, zero means no limit */
+	if ((scsi_inquiry_vpd(lunp, SCSI_VPD_BLOCK_LIMITS, &vpd) != MSD_RESULT_OK)
+			|| (vpd.byte[3] < 8)) {
+		return 0;
+	}
+	return ((uint32_t)vpd.byte[8] << 24) | ((uint32_t)vpd.byte[9] << 16)
+			| ((uint32_t)vpd.byte[10] << 8) | (uint32_t)vpd.byte[11];
+}
+
+
+/* ----------------------------------------------------- */
+/* Chained READ/WRITE commands                           */
+/* ----------------------------------------------------- */
+
+/* All the URBs of a command (CBW, data, CSW) are queued at once, the CSW
+ * completion callback validates the status and immediately queues the next
+ * command of the transfer, so the pipes are never idle waiting for the
+ * thread to be rescheduled.
+ * A device ends the data phase early with a short packet or a STALL: the
+ * data URBs left are cancelled so that the CSW is received by its own URB,
+ * the halted pipe is cleared by the thread and the command is judged by
+ * its CSW as in _msd_bot_transaction. */
+
+/* Maximum number of data URBs (I/O vector elements) per command */
+#define MSD_CHAIN_MAX_SEGMENTS					4
+
+typedef struct {
+	USBHMassStorageLUNDriver *lunp;
+	msd_data_cursor_t cur;
+	uint32_t lba;
+	uint32_t remaining;
+	uint32_t blocks;		/* blocks of the command in flight */
+	uint32_t commands;		/* completed commands */
+	bool write;
+	bool done;
+	bool csw_stalled;		/* the CSW must be read after clearing the halt */
+	uint8_t segments;
+	usbh_ep_t *halted;		/* data pipe halted by the device */
+	msd_result_t result;
+	thread_reference_t thread;
+	usbh_urb_t cbw_urb;
+	usbh_urb_t csw_urb;
+	usbh_urb_t data_urb[MSD_CHAIN_MAX_SEGMENTS];
+	USBH_DECLARE_STRUCT_MEMBER(msd_cbw_t cbw);
+	USBH_DECLARE_STRUCT_MEMBER(msd_csw_t csw);
+} msd_chain_t;
+
+static void _chain_dataI(usbh_urb_t *urb);
+static void _chain_cswI(usbh_urb_t *urb);
+
+static void _chain_finishI(msd_chain_t *chain, msd_result_t result) {
+	chain->result = result;
+	chain->done = true;
+	osalThreadResumeI(&chain->thread, MSG_OK);
+}
+
+static void _chain_armI(msd_chain_t *chain) {
+	USBHMassStorageLUNDriver *const lunp = chain->lunp;
+	USBHMassStorageDriver *const msdp = lunp->msdp;
+	usbh_ep_t *const ep = chain->write ? &msdp->epout : &msdp->epin;
+	msd_cbw_t *const cbw = &chain->cbw;
+	const uint32_t bs = chain->cur.bs;
+	const blkiov_t *iov = chain->cur.iov;
+	uint32_t offset = chain->cur.offset;
+	uint32_t blocks = 0;
+	uint32_t max = chain->remaining;
+	uint32_t n;
+	uint8_t i;
+
+	if (max > lunp->max_blocks) {
+		max = lunp->max_blocks;
+	}
+
+	/* one data URB per I/O vector element */
+	for (i = 0; (i < MSD_CHAIN_MAX_SEGMENTS) && (blocks < max); iov++, offset = 0) {
+		n = iov->n - offset / bs;
+		if (n == 0) {
+			continue;
+		}
+		if (n > max - blocks) {
+			n = max - blocks;
+		}
+		usbhURBObjectInit(&chain->data_urb[i++], ep, _chain_dataI, chain,
+				(uint8_t *)iov->buffer + offset, n * bs);
+		blocks += n;
+	}
+	chain->segments = i;
+	chain->blocks = blocks;
+	chain->halted = NULL;
+	chain->csw_stalled = false;
+
+	memset(cbw->CBWCB, 0, sizeof(cbw->CBWCB));
+	cbw->dCBWSignature = MSD_CBW_SIGNATURE;
+	cbw->dCBWTag = ++msdp->tag;
+	cbw->bCBWLUN = (uint8_t)(lunp - &msdp->luns[0]);
+	cbw->dCBWDataTransferLength = blocks * bs;
+	cbw->bmCBWFlags = chain->write ? MSD_CBWFLAGS_H2D : MSD_CBWFLAGS_D2H;
+	if (lunp->use16) {
+		cbw->bCBWCBLength = 16;
+		cbw->CBWCB[0] = chain->write ? SCSI_CMD_WRITE_16 : SCSI_CMD_READ_16;
+		cbw->CBWCB[6] = (uint8_t)(chain->lba >> 24);
+		cbw->CBWCB[7] = (uint8_t)(chain->lba >> 16);
+		cbw->CBWCB[8] = (uint8_t)(chain->lba >> 8);
+		cbw->CBWCB[9] = (uint8_t)(chain->lba);
+		cbw->CBWCB[10] = (uint8_t)(blocks >> 24);
+		cbw->CBWCB[11] = (uint8_t)(blocks >> 16);
+		cbw->CBWCB[12] = (uint8_t)(blocks >> 8);
+		cbw->CBWCB[13] = (uint8_t)(blocks);
+	} else {
+		cbw->bCBWCBLength = 10;
+		cbw->CBWCB[0] = chain->write ? SCSI_CMD_WRITE_10 : SCSI_CMD_READ_10;
+		cbw->CBWCB[2] = (uint8_t)(chain->lba >> 24);
+		cbw->CBWCB[3] = (uint8_t)(chain->lba >> 16);
+		cbw->CBWCB[4] = (uint8_t)(chain->lba >> 8);
+		cbw->CBWCB[5] = (uint8_t)(chain->lba);
+		cbw->CBWCB[7] = (uint8_t)(blocks >> 8);
+		cbw->CBWCB[8] = (uint8_t)(blocks);
+	}
+
+	usbhURBObjectInit(&chain->cbw_urb, &msdp->epout, NULL, NULL, cbw, sizeof(*cbw));
+	usbhURBObjectInit(&chain->csw_urb, &msdp->epin, _chain_cswI, chain,
+			&chain->csw, sizeof(chain->csw));
+	usbhURBSubmitI(&chain->cbw_urb);
+	for (i = 0; i < chain->segments; i++) {
+		usbhURBSubmitI(&chain->data_urb[i]);
+	}
+	usbhURBSubmitI(&chain->csw_urb);
+}
+
+static void _chain_dataI(usbh_urb_t *urb) {
+	msd_chain_t *const chain = (msd_chain_t *)urb->userData;
+	uint8_t i;
+
+	if (chain->done || (urb->status == USBH_URBSTATUS_CANCELLED)) {
+		return;
+	}
+
+	if (urb->status == USBH_URBSTATUS_DISCONNECTED) {
+		_chain_finishI(chain, MSD_RESULT_DISCONNECTED);
+		return;
+	}
+
+	if (urb->status == USBH_URBSTATUS_STALL) {
+		chain->halted = urb->ep;
+	} else if (urb->status != USBH_URBSTATUS_OK) {
+		_chain_finishI(chain, MSD_RESULT_TRANSPORT_ERROR);
+		return;
+	} else if (urb->actualLength == urb->requestedLength) {
+		return;
+	}
+
+	/* the device ended the data phase, the following URBs would receive
+	 * the CSW (short packet) or fail on the halted pipe (STALL) */
+	for (i = (uint8_t)(urb - &chain->data_urb[0]) + 1; i < chain->segments; i++) {
+		usbhURBCancelI(&chain->data_urb[i]);
+	}
+}
+
+/* Judges a command by its CSW, it does not advance the chain */
+static msd_result_t _chain_check(msd_chain_t *chain, uint32_t csw_len) {
+	const msd_csw_t *const csw = &chain->csw;
+	const uint32_t expected = chain->blocks * chain->cur.bs;
+	uint32_t actual = 0;
+	uint8_t i;
+
+	if ((csw_len != sizeof(*csw))
+			|| (csw->dCSWSignature != MSD_CSW_SIGNATURE)
+			|| (csw->dCSWTag != chain->cbw.dCBWTag)
+			|| (csw->bCSWStatus >= CSW_STATUS_PHASE_ERROR)
+			|| (csw->dCSWDataResidue > expected)) {
+		/* not valid or not meaningful, or phase error */
+		return MSD_RESULT_TRANSPORT_ERROR;
+	}
+
+	if (csw->bCSWStatus == CSW_STATUS_FAILED) {
+		return MSD_RESULT_FAILED;
+	}
+
+	for (i = 0; i < chain->segments; i++) {
+		actual += chain->data_urb[i].actualLength;
+	}
+	if ((csw->dCSWDataResidue != 0) || (actual != expected)) {
+		/* passed, but not all the blocks were transferred */
+		return MSD_RESULT_FAILED;
+	}
+
+	return MSD_RESULT_OK;
+}
+
+/* Moves the chain past the command just completed */
+static void _chain_advance(msd_chain_t *chain) {
+	uint32_t bytes = chain->blocks * chain->cur.bs;
+	uint32_t avail;
+
+	while (bytes) {
+		avail = chain->cur.iov->n * chain->cur.bs - chain->cur.offset;
+		if (avail > bytes) {
+			chain->cur.offset += bytes;
+			break;
+		}
+		bytes -= avail;
+		chain->cur.iov++;
+		chain->cur.offset = 0;
+	}
+	chain->lba += chain->blocks;
+	chain->remaining -= chain->blocks;
+	chain->commands++;
+}
+
+static void _chain_cswI(usbh_urb_t *urb) {
+	msd_chain_t *const chain = (msd_chain_t *)urb->userData;
+	msd_result_t res;
+	uint8_t i;
+
+	if (chain->done) {
+		/* cancelled by the thread after a failure */
+		return;
+	}
+
+	if ((urb->status == USBH_URBSTATUS_CANCELLED)
+			|| (urb->status == USBH_URBSTATUS_DISCONNECTED)) {
+		_chain_finishI(chain, MSD_RESULT_DISCONNECTED);
+		return;
+	}
+
+	if (chain->cbw_urb.status != USBH_URBSTATUS_OK) {
+		_chain_finishI(chain, MSD_RESULT_TRANSPORT_ERROR);
+		return;
+	}
+
+	/* the CSW ended a data phase still pending on the OUT pipe, the device
+	 * may have halted it: the thread cancels the URBs and clears it */
+	for (i = 0; i < chain->segments; i++) {
+		if (usbhURBIsBusy(&chain->data_urb[i])) {
+			chain->halted = chain->data_urb[i].ep;
+		}
+	}
+
+	if (urb->status == USBH_URBSTATUS_STALL) {
+		/* the thread clears the halt and reads the CSW again */
+		chain->csw_stalled = true;
+		_chain_finishI(chain, MSD_RESULT_TRANSPORT_ERROR);
+		return;
+	}
+
+	if (urb->status != USBH_URBSTATUS_OK) {
+		_chain_finishI(chain, MSD_RESULT_TRANSPORT_ERROR);
+		return;
+	}
+
+	res = _chain_check(chain, urb->actualLength);
+	if (res != MSD_RESULT_OK) {
+		_chain_finishI(chain, res);
+		return;
+	}
+
+	_chain_advance(chain);
+
+	if (chain->remaining && (chain->halted == NULL)) {
+		_chain_armI(chain);
+	} else {
+		_chain_finishI(chain, MSD_RESULT_OK);
+	}
+}
+
+/* Reads the CSW of a command whose status phase was stalled */
+static msd_result_t _chain_read_csw(msd_chain_t *chain) {
+	USBHMassStorageDriver *const msdp = chain->lunp->msdp;
+	usbh_urbstatus_t status;
+	uint32_t actual_len;
+
+	status = usbhBulkTransfer(&msdp->epin, &chain->csw,
+				sizeof(chain->csw), &actual_len, OSAL_MS2I(1000));
+
+	if (status == USBH_URBSTATUS_STALL) {
+		uwarn("\tMSD: Status phase: USBH_URBSTATUS_STALL, clear halt and retry");
+
+		status = (usbhEPReset(&msdp->epin) == HAL_SUCCESS) ? USBH_URBSTATUS_OK : USBH_URBSTATUS_ERROR;
+
+		if (status == USBH_URBSTATUS_OK) {
+			status = usbhBulkTransfer(&msdp->epin, &chain->csw,
+						sizeof(chain->csw), &actual_len, OSAL_MS2I(1000));
+		}
+	}
+
+	if ((status == USBH_URBSTATUS_CANCELLED) || (status == USBH_URBSTATUS_DISCONNECTED)) {
+		return MSD_RESULT_DISCONNECTED;
+	}
+
+	if (status != USBH_URBSTATUS_OK) {
+		return MSD_RESULT_TRANSPORT_ERROR;
+	}
+
+	return _chain_check(chain, actual_len);
+}
+
+/* Runs the chain from its current position, on failure the position is
+   left at the first command not completed so that it can be resumed. */
+static msd_result_t _chain_transfer(msd_chain_t *chain) {
+
+	USBHMassStorageLUNDriver *const lunp = chain->lunp;
+	msd_result_t res;
+	uint32_t commands;
+	uint8_t i;
+
+	do {
+		chain->done = false;
+		chain->thread = NULL;
+
+		osalSysLock();
+		_chain_armI(chain);
+		while (!chain->done) {
+			/* the timeout only expires if no command completed meanwhile */
+			commands = chain->commands;
+			if ((osalThreadSuspendTimeoutS(&chain->thread, OSAL_MS2I(20000)) == MSG_TIMEOUT)
+					&& (chain->commands == commands)) {
+				break;
+			}
+		}
+		res = chain->done ? chain->result : MSD_RESULT_TRANSPORT_ERROR;
+		chain->done = true;
+
+		/* cancel anything still queued after a failure */
+		if (usbhURBIsBusy(&chain->csw_urb)) {
+			usbhURBCancelAndWaitS(&chain->csw_urb);
+		}
+		for (i = 0; i < chain->segments; i++) {
+			if (usbhURBIsBusy(&chain->data_urb[i])) {
+				usbhURBCancelAndWaitS(&chain->data_urb[i]);
+			}
+		}
+		if (usbhURBIsBusy(&chain->cbw_urb)) {
+			usbhURBCancelAndWaitS(&chain->cbw_urb);
+		}
+		osalSysUnlock();
+
+		if (res == MSD_RESULT_DISCONNECTED) {
+			return res;
+		}
+
+		/* the device ended the data phase with a STALL */
+		if (chain->halted != NULL) {
+			uwarnf("\tMSD: %s: data phase stalled at LBA %u, clear halt",
+					chain->write ? "WRITE" : "READ", chain->lba);
+			if (usbhEPReset(chain->halted) != HAL_SUCCESS) {
+				res = MSD_RESULT_TRANSPORT_ERROR;
+				break;
+			}
+		}
+
+		if (chain->csw_stalled) {
+			res = _chain_read_csw(chain);
+			if (res == MSD_RESULT_OK) {
+				_chain_advance(chain);
+			}
+		}
+	} while ((res == MSD_RESULT_OK) && chain->remaining);
+
+	if (res == MSD_RESULT_FAILED) {
+		_msd_auto_sense(lunp);
+	} else if (res == MSD_RESULT_TRANSPORT_ERROR) {
+		uerrf("\tMSD: %s: transport error at LBA %u, resetting",
+				chain->write ? "WRITE" : "READ", chain->lba);
+		_msd_bot_reset(lunp->msdp);
+	}
+
+	return res;
+}
+
+/* Synchronize Cache 10 */
+#define SCSI_CMD_SYNCHRONIZE_CACHE_10			0x35
+
+static msd_result_t scsi_synchronizecache10(USBHMassStorageLUNDriver *lunp) {
+	USBH_DEFINE_BUFFER(msd_cbw_t cbw);
+	msd_transaction_t transaction;
+
+	memset(cbw.CBWCB, 0, sizeof(cbw.CBWCB));
+	cbw.dCBWDataTransferLength = 0;
+	cbw.bmCBWFlags = MSD_CBWFLAGS_H2D;
+	cbw.bCBWCBLength = 10;
+	cbw.CBWCB[0] = SCSI_CMD_SYNCHRONIZE_CACHE_10;
+	transaction.cbw = &cbw;
+
+	return _scsi_perform_transaction(lunp, &transaction, NULL);
+}
+
+
+/* ----------------------------------------------------- */
+/* Retry policy                                          */
+/* ----------------------------------------------------- */
+
+/* Decides whether a failed command is retried, based on the transport
+ * result and on the sense data, and updates the error counters. */
+static bool _msd_retry_policy(USBHMassStorageLUNDriver *lunp, msd_result_t res,
+		uint8_t attempt, uint32_t *delay_ms) {
+
+	*delay_ms = (uint32_t)HAL_USBHMSD_RETRY_DELAY_MS << attempt;
+
+	switch (res) {
+	case MSD_RESULT_DISCONNECTED:
+		return false;
+	case MSD_RESULT_TRANSPORT_ERROR:
+		/* the reset recovery has already been performed */
+		lunp->errors.transport_errors++;
+		return attempt < HAL_USBHMSD_MAX_RETRIES;
+	case MSD_RESULT_FAILED:
+		lunp->errors.failed_commands++;
+		break;
+	default:
+		return false;
+	}
+
+	if (attempt >= HAL_USBHMSD_MAX_RETRIES) {
+		return false;
+	}
+
+	switch (lunp->errors.sense_key) {
+	case SCSI_SENSE_KEY_UNIT_ATTENTION:
+		/* reset or medium change notification, the command can be reissued */
+		*delay_ms = 0;
+		return true;
+	case SCSI_SENSE_KEY_NOT_READY:
+		return lunp->errors.asc != SCSI_ASENSE_MEDIUM_NOT_PRESENT;
+	case SCSI_SENSE_KEY_GOOD:
+	case SCSI_SENSE_KEY_RECOVERED_ERROR:
+	case SCSI_SENSE_KEY_MEDIUM_ERROR:
+	case SCSI_SENSE_KEY_HARDWARE_ERROR:
+	case SCSI_SENSE_KEY_ABORTED_COMMAND:
+		/* escalate to a reset recovery before the last attempt */
+		if (attempt + 1 == HAL_USBHMSD_MAX_RETRIES) {
+			uwarn("\tMSD: Persistent failure, resetting");
+			_msd_bot_reset(lunp->msdp);
+		}
+		return true;
+	default:
+		/* ILLEGAL REQUEST, DATA PROTECT, ... will not succeed on retry */
+		return false;
+	}
+}
+
+static bool _lun_sync(USBHMassStorageLUNDriver *lunp) {
+	msd_result_t res;
+	uint32_t delay;
+	uint8_t attempt;
+
+	for (attempt = 0; ; attempt++) {
+		res = scsi_synchronizecache10(lunp);
+		if (res == MSD_RESULT_OK) {
+			return HAL_SUCCESS;
+		}
+		if ((res == MSD_RESULT_FAILED)
+				&& (lunp->errors.sense_key == SCSI_SENSE_KEY_ILLEGAL_REQUEST)) {
+			/* no cache to synchronize */
+			return HAL_SUCCESS;
+		}
+		if (!_msd_retry_policy(lunp, res, attempt, &delay)) {
+			lunp->errors.unrecovered++;
+			return HAL_FAILED;
+		}
+		lunp->errors.retries++;
+		if (delay) {
+			osalThreadSleepMilliseconds(delay);
+		}
+	}
+}
+
 
 
 /*===========================================================================*/
@@ -690,7 +1244,9 @@ static const struct USBHMassStorageDriverVMT blk_vmt = {
 	(bool (*)(void *, uint32_t, uint8_t *, uint32_t))usbhmsdLUNRead,
 	(bool (*)(void *, uint32_t,	const uint8_t *, uint32_t))usbhmsdLUNWrite,
 	(bool (*)(void *))usbhmsdLUNSync,
-	(bool (*)(void *, BlockDeviceInfo *))usbhmsdLUNGetInfo
+	(bool (*)(void *, BlockDeviceInfo *))usbhmsdLUNGetInfo,
+	(bool (*)(void *, uint32_t, const blkiov_t *, uint32_t))usbhmsdLUNReadV,
+	(bool (*)(void *, uint32_t, const blkiov_t *, uint32_t))usbhmsdLUNWriteV
 };
 
 static void _lun_object_deinit(USBHMassStorageLUNDriver *lunp) {
@@ -699,6 +1255,7 @@ static void _lun_object_deinit(USBHMassStorageLUNDriver *lunp) {
 	lunp->msdp = NULL;
 	lunp->next = NULL;
 	memset(&lunp->info, 0, sizeof(lunp->info));
+	memset(&lunp->errors, 0, sizeof(lunp->errors));
 	lunp->state = BLK_STOP;
 	chSemSignal(&lunp->sem);
 }
@@ -720,6 +1277,7 @@ bool usbhmsdLUNConnect(USBHMassStorageLUNDriver *lunp) {
 	osalDbgCheck(lunp != NULL);
 	osalDbgCheck(lunp->msdp != NULL);
 	msd_result_t res;
+	uint8_t version;
 
 	chSemWait(&lunp->sem);
 	osalDbgAssert((lunp->state == BLK_READY) || (lunp->state == BLK_ACTIVE), "invalid state");
@@ -728,6 +1286,7 @@ bool usbhmsdLUNConnect(USBHMassStorageLUNDriver *lunp) {
 		return HAL_SUCCESS;
 	}
 	lunp->state = BLK_CONNECTING;
+	version = 0;
 
     {
 		USBH_DEFINE_BUFFER(scsi_inquiry_response_t inq);
@@ -748,6 +1307,7 @@ bool usbhmsdLUNConnect(USBHMassStorageLUNDriver *lunp) {
 			uerr("\tUnsupported PDT");
 			goto failed;
 		}
+		version = inq.version;
 	}
 
 	// Test if unit ready
@@ -787,8 +1347,50 @@ bool usbhmsdLUNConnect(USBHMassStorageLUNDriver *lunp) {
 
 		lunp->info.blk_size = __REV(cap.block_size);
 		lunp->info.blk_num = __REV(cap.last_block_addr) + 1;
+		lunp->use16 = false;
+		lunp->max_blocks = 0xffff;
+
+		if (cap.last_block_addr == 0xffffffff) {
+			USBH_DEFINE_BUFFER(scsi_readcapacity16_response_t cap16);
+			uinfo("READ CAPACITY(16)...");
+			res = scsi_readcapacity16(lunp, &cap16);
+			if (res == MSD_RESULT_DISCONNECTED) {
+				goto failed;
+			} else if (res == MSD_RESULT_TRANSPORT_ERROR) {
+				//retry?
+				goto failed;
+			} else if (res == MSD_RESULT_FAILED) {
+				//retry?
+				goto failed;
+			}
+
+			lunp->info.blk_size = __REV(cap16.block_size);
+			if ((cap16.last_block_addr_hi != 0) || (cap16.last_block_addr_lo == 0xffffffff)) {
+				/* the block device interface uses 32 bit block addresses */
+				uwarn("\tCapacity truncated to 2^32-1 blocks");
+				lunp->info.blk_num = 0xffffffff;
+			} else {
+				lunp->info.blk_num = __REV(cap16.last_block_addr_lo) + 1;
+			}
+			lunp->use16 = true;
+			lunp->max_blocks = 0xffffffff;
+		}
 	}
 
+	/* Block Limits VPD page is only queried on SPC-3 or later devices */
+	if (version >= 0x05) {
+		uint32_t max = _vpd_max_transfer_blocks(lunp);
+		if ((max != 0) && (max < lunp->max_blocks)) {
+			lunp->max_blocks = max;
+		}
+	}
+#if HAL_USBHMSD_MAX_TRANSFER_BLOCKS
+	if (lunp->max_blocks > HAL_USBHMSD_MAX_TRANSFER_BLOCKS) {
+		lunp->max_blocks = HAL_USBHMSD_MAX_TRANSFER_BLOCKS;
+	}
+#endif
+	uinfof("\tMax transfer=%u blocks%s", lunp->max_blocks, lunp->use16 ? ", 16 byte CDBs" : "");
+
 	uinfof("\tBlock size=%dbytes, blocks=%u (~%u MB)", lunp->info.blk_size, lunp->info.blk_num,
 		(uint32_t)(((uint64_t)lunp->info.blk_size * lunp->info.blk_num) / (1024UL * 1024UL)));
 
@@ -816,7 +1418,10 @@ bool usbhmsdLUNDisconnect(USBHMassStorageLUNDriver *lunp) {
 	}
 	lunp->state = BLK_DISCONNECTING;
 
-	//TODO: complete: sync, etc.
+	/* flush the device cache, the device may be gone already */
+	if (_lun_sync(lunp) != HAL_SUCCESS) {
+		uwarn("\tMSD: Sync failed on disconnect");
+	}
 
 	lunp->state = BLK_ACTIVE;
 	chSemSignal(&lunp->sem);
@@ -824,41 +1429,46 @@ bool usbhmsdLUNDisconnect(USBHMassStorageLUNDriver *lunp) {
 	return HAL_SUCCESS;
 }
 
-bool usbhmsdLUNRead(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
-                uint8_t *buffer, uint32_t n) {
+static bool _lun_transfer(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
+		const blkiov_t *iov, uint32_t iovcnt, bool write) {
 
-	osalDbgCheck(lunp != NULL);
 	bool ret = HAL_FAILED;
-	uint16_t blocks;
+	USBH_DEFINE_BUFFER(msd_chain_t chain);
 	msd_result_t res;
-	uint32_t actual_len;
+	uint32_t delay;
+	uint8_t attempt;
 
 	chSemWait(&lunp->sem);
 	if (lunp->state != BLK_READY) {
 		chSemSignal(&lunp->sem);
 		return ret;
 	}
-	lunp->state = BLK_READING;
-
-	while (n) {
-		if (n > 0xffff) {
-			blocks = 0xffff;
-		} else {
-			blocks = (uint16_t)n;
+	lunp->state = write ? BLK_WRITING : BLK_READING;
+
+	chain.lunp = lunp;
+	chain.cur.iov = iov;
+	chain.cur.bs = lunp->info.blk_size;
+	chain.cur.offset = 0;
+	chain.lba = startblk;
+	chain.remaining = ioblockvGetBlocks(iov, iovcnt);
+	chain.commands = 0;
+	chain.write = write;
+
+	/* a retry resumes from the first command not completed */
+	for (attempt = 0; chain.remaining; attempt++) {
+		res = _chain_transfer(&chain);
+		if (res == MSD_RESULT_OK) {
+			break;
 		}
-		res = scsi_read10(lunp, startblk, blocks, buffer, &actual_len);
-		if (res == MSD_RESULT_DISCONNECTED) {
-			goto exit;
-		} else if (res == MSD_RESULT_TRANSPORT_ERROR) {
-			//retry?
-			goto exit;
-		} else if (res == MSD_RESULT_FAILED) {
-			//retry?
+		if (!_msd_retry_policy(lunp, res, attempt, &delay)) {
+			lunp->errors.unrecovered++;
 			goto exit;
 		}
-		n -= blocks;
-		startblk += blocks;
-		buffer += blocks * lunp->info.blk_size;
+		uwarnf("\tMSD: Retry %d at LBA %u in %ums", attempt + 1, chain.lba, delay);
+		lunp->errors.retries++;
+		if (delay) {
+			osalThreadSleepMilliseconds(delay);
+		}
 	}
 
 	ret = HAL_SUCCESS;
@@ -869,58 +1479,62 @@ exit:
 	return ret;
 }
 
+bool usbhmsdLUNRead(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
+                uint8_t *buffer, uint32_t n) {
+
+	osalDbgCheck(lunp != NULL);
+	blkiov_t iov = {buffer, n};
+
+	return _lun_transfer(lunp, startblk, &iov, 1, false);
+}
+
 bool usbhmsdLUNWrite(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
                 const uint8_t *buffer, uint32_t n) {
 
+	osalDbgCheck(lunp != NULL);
+	blkiov_t iov = {(void *)buffer, n};
+
+	return _lun_transfer(lunp, startblk, &iov, 1, true);
+}
+
+/* Scatter-gather variants, each SCSI command spans up to
+   MSD_CHAIN_MAX_SEGMENTS vector elements, the elements should be multiple
+   of the endpoint packet size (always true for 512 bytes blocks) to avoid
+   short packets in between. */
+bool usbhmsdLUNReadV(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
+                const blkiov_t *iov, uint32_t iovcnt) {
+
+	osalDbgCheck(lunp != NULL);
+	osalDbgCheck((iov != NULL) || (iovcnt == 0));
+
+	return _lun_transfer(lunp, startblk, iov, iovcnt, false);
+}
+
+bool usbhmsdLUNWriteV(USBHMassStorageLUNDriver *lunp, uint32_t startblk,
+                const blkiov_t *iov, uint32_t iovcnt) {
+
+	osalDbgCheck(lunp != NULL);
+	osalDbgCheck((iov != NULL) || (iovcnt == 0));
+
+	return _lun_transfer(lunp, startblk, iov, iovcnt, true);
+}
+
+bool usbhmsdLUNSync(USBHMassStorageLUNDriver *lunp) {
 	osalDbgCheck(lunp != NULL);
 	bool ret = HAL_FAILED;
-	uint16_t blocks;
-	msd_result_t res;
-	uint32_t actual_len;
 
 	chSemWait(&lunp->sem);
 	if (lunp->state != BLK_READY) {
 		chSemSignal(&lunp->sem);
 		return ret;
 	}
-	lunp->state = BLK_WRITING;
-
-	while (n) {
-		if (n > 0xffff) {
-			blocks = 0xffff;
-		} else {
-			blocks = (uint16_t)n;
-		}
-		res = scsi_write10(lunp, startblk, blocks, buffer, &actual_len);
-		if (res == MSD_RESULT_DISCONNECTED) {
-			goto exit;
-		} else if (res == MSD_RESULT_TRANSPORT_ERROR) {
-			//retry?
-			goto exit;
-		} else if (res == MSD_RESULT_FAILED) {
-			//retry?
-			goto exit;
-		}
-		n -= blocks;
-		startblk += blocks;
-		buffer += blocks * lunp->info.blk_size;
-	}
-
-	ret = HAL_SUCCESS;
-
-exit:
+	lunp->state = BLK_SYNCING;
+	ret = _lun_sync(lunp);
 	lunp->state = BLK_READY;
 	chSemSignal(&lunp->sem);
 	return ret;
 }
 
-bool usbhmsdLUNSync(USBHMassStorageLUNDriver *lunp) {
-	osalDbgCheck(lunp != NULL);
-	(void)lunp;
-	//TODO: Do SCSI Sync
-	return HAL_SUCCESS;
-}
-
 bool usbhmsdLUNGetInfo(USBHMassStorageLUNDriver *lunp, BlockDeviceInfo *bdip) {
 	osalDbgCheck(lunp != NULL);
 	osalDbgCheck(bdip != NULL);
@@ -946,6 +1560,23 @@ bool usbhmsdLUNIsProtected(USBHMassStorageLUNDriver *lunp) {
 	return FALSE;
 }
 
+void usbhmsdLUNGetErrors(USBHMassStorageLUNDriver *lunp, usbhmsd_lun_errors_t *errors) {
+	osalDbgCheck(lunp != NULL);
+	osalDbgCheck(errors != NULL);
+
+	chSemWait(&lunp->sem);
+	*errors = lunp->errors;
+	chSemSignal(&lunp->sem);
+}
+
+void usbhmsdLUNClearErrors(USBHMassStorageLUNDriver *lunp) {
+	osalDbgCheck(lunp != NULL);
+
+	chSemWait(&lunp->sem);
+	memset(&lunp->errors, 0, sizeof(lunp->errors));
+	chSemSignal(&lunp->sem);
+}
+
 static void _msd_object_init(USBHMassStorageDriver *msdp) {
 	osalDbgCheck(msdp != NULL);
 	memset(msdp, 0, sizeof(*msdp));
@@ -960,5 +1591,6 @@ static void _msd_init(void) {
 	for (i = 0; i < HAL_USBHMSD_MAX_LUNS; i++) {
 		_lun_object_init(&MSBLKD[i]);
 	}
+	ioblockvRegisterVMT((const struct BaseVectoredBlockDeviceVMT *)&blk_vmt);
 }
 #endif
@@ -76,8 +76,13 @@ static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_uvc_load,
 	_uvc_unload
 };
+static const usbh_device_id_t id_table[] = {
+	USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE_ASSOCIATION, 0x0e, 0x03, 0x00),
+	USBH_ID_END
+};
+
 const usbh_classdriverinfo_t usbhuvcClassDriverInfo = {
-	"UVC", &class_driver_vmt
+	"UVC", &class_driver_vmt, id_table
 };
 
 static bool _request(USBHUVCDriver *uvcdp,
@@ -198,27 +203,120 @@ void usbhuvcPrintProbeCommit(const usbh_uvc_ctrl_vs_probecommit_data_t *pc) {
 }
 #endif
 
+#if HAL_USBHUVC_USE_STATS
+#define _stats_inc(uvcdp, field)	((uvcdp)->stats.field++)
+
+static void _stats_reset(USBHUVCDriver *uvcdp) {
+	memset(&uvcdp->stats, 0, sizeof(uvcdp->stats));
+	uvcdp->stats.start = osalOsGetSystemTimeX();
+}
+
+static void _stats_packet(USBHUVCDriver *uvcdp, uint32_t payload) {
+	uvcdp->stats.packets++;
+	uvcdp->stats.bytes += payload;
+}
+
+static void _stats_alloc(USBHUVCDriver *uvcdp) {
+	usbhuvc_stats_t *const st = &uvcdp->stats;
+	if (++st->pool_used > st->pool_hwm)
+		st->pool_hwm = st->pool_used;
+}
+
+static void _stats_free(USBHUVCDriver *uvcdp) {
+	uvcdp->stats.pool_used--;
+}
+
+static void _stats_post(USBHUVCDriver *uvcdp) {
+	const uint16_t used = (uint16_t)chMBGetUsedCountI(&uvcdp->mb);
+	if (used > uvcdp->stats.mb_hwm)
+		uvcdp->stats.mb_hwm = used;
+}
+
+static void _stats_frame(USBHUVCDriver *uvcdp) {
+	usbhuvc_stats_t *const st = &uvcdp->stats;
+	const systime_t now = osalOsGetSystemTimeX();
+
+	if (st->frames) {
+		const uint32_t interval = (uint32_t)(now - st->last_frame);
+		if ((st->frames == 1) || (interval < st->interval_min))
+			st->interval_min = interval;
+		if (interval > st->interval_max)
+			st->interval_max = interval;
+
+		if (st->frames > 1) {
+			uint32_t dev = (interval > st->last_interval) ?
+					interval - st->last_interval : st->last_interval - interval;
+			uint8_t bin = 0;
+			dev = (uint32_t)((uint64_t)dev * 1000 / OSAL_ST_FREQUENCY);
+			while (dev && (bin < HAL_USBHUVC_JITTER_BINS - 1)) {
+				dev >>= 1;
+				bin++;
+			}
+			st->jitter[bin]++;
+		}
+		st->last_interval = interval;
+	}
+	st->last_frame = now;
+	st->frames++;
+}
+
+void usbhuvcGetStats(USBHUVCDriver *uvcdp, usbhuvc_stats_t *stats, bool reset) {
+	osalDbgCheck(uvcdp && stats);
+
+	osalSysLock();
+	*stats = uvcdp->stats;
+	stats->elapsed = osalOsGetSystemTimeX() - stats->start;
+	stats->mb_used = (uint16_t)chMBGetUsedCountI(&uvcdp->mb);
+	if (reset) {
+		/* pool usage is a level, not a counter: carry it over */
+		_stats_reset(uvcdp);
+		uvcdp->stats.pool_used = uvcdp->stats.pool_hwm = stats->pool_used;
+		uvcdp->stats.mb_hwm = stats->mb_used;
+	}
+	osalSysUnlock();
+}
+#else
+#define _stats_inc(uvcdp, field)	do {} while(0)
+#define _stats_reset(uvcdp)			do {} while(0)
+#define _stats_packet(uvcdp, payload)	do {} while(0)
+#define _stats_alloc(uvcdp)			do {} while(0)
+#define _stats_free(uvcdp)			do {} while(0)
+#define _stats_post(uvcdp)			do {} while(0)
+#define _stats_frame(uvcdp)			do {} while(0)
+#endif
+
 static void _post(USBHUVCDriver *uvcdp, usbh_urb_t *urb, memory_pool_t *mp, uint16_t type) {
+	mailbox_t *const mb = (type == USBHUVC_MESSAGETYPE_STATUS) ? &uvcdp->mb_status : &uvcdp->mb;
 	usbhuvc_message_base_t *const msg = (usbhuvc_message_base_t *)((uint8_t *)urb->buff - offsetof(usbhuvc_message_data_t, data));
 	msg->timestamp = osalOsGetSystemTimeX();
 
 	usbhuvc_message_base_t *const new_msg = (usbhuvc_message_base_t *)chPoolAllocI(mp);
 	if (new_msg != NULL) {
 		/* allocated the new buffer, now try to post the message to the mailbox */
-		if (chMBPostI(&uvcdp->mb, (msg_t)msg) == MSG_OK) {
+		if (chMBPostI(mb, (msg_t)msg) == MSG_OK) {
 			/* everything OK, complete the missing fields */
 			msg->type = type;
 			msg->length = urb->actualLength;
 
 			/* change the URB's buffer to the newly allocated one */
 			urb->buff = ((usbhuvc_message_data_t *)new_msg)->data;
+
+			if (mp == &uvcdp->mp_data) {
+				_stats_post(uvcdp);
+				_stats_alloc(uvcdp);
+			}
 		} else {
 			/* couldn't post the message, free the newly allocated buffer */
 			uerr("UVC: error, mailbox overrun");
-			chPoolFreeI(&uvcdp->mp_status, new_msg);
+			chPoolFreeI(mp, new_msg);
+			_stats_inc(uvcdp, drop_mailbox);
 		}
 	} else {
 		uerrf("UVC: error, %s pool overrun", mp == &uvcdp->mp_data ? "data" : "status");
+		if (mp == &uvcdp->mp_data)
+			_stats_inc(uvcdp, drop_pool);
+		else
+			_stats_inc(uvcdp, drop_status);
 	}
 }
 
@@ -260,13 +358,20 @@ static void _cb_iso(usbh_urb_t *urb) {
 
 	if (urb->status != USBH_URBSTATUS_OK) {
 		uerrf("UVC: ISO IN error, unexpected status = %d", urb->status);
+		_stats_inc(uvcdp, drop_urb);
 	} else if (urb->actualLength >= 2) {
 		const uint8_t *const buff = (const uint8_t *)urb->buff;
 		if (buff[0] < 2) {
 			uerrf("UVC: ISO IN, bHeaderLength=%d", buff[0]);
+			_stats_inc(uvcdp, drop_header);
 		} else if (buff[0] > urb->actualLength) {
 			uerrf("UVC: ISO IN, bHeaderLength=%d > actualLength=%d", buff[0], urb->actualLength);
+			_stats_inc(uvcdp, drop_header);
 		} else {
+			_stats_packet(uvcdp, urb->actualLength - buff[0]);
+			if (buff[1] & UVC_HDR_EOF)
+				_stats_frame(uvcdp);
+
 			udbgf("UVC: ISO IN len=%d, hdr=%d, FID=%d, EOF=%d, ERR=%d, EOH=%d",
 						urb->actualLength,
 						buff[0],
@@ -290,12 +395,300 @@ static void _cb_iso(usbh_urb_t *urb) {
 		}
 	} else if (urb->actualLength > 0) {
 		uerrf("UVC: ISO IN, actualLength=%d", urb->actualLength);
+		_stats_inc(uvcdp, drop_header);
 	}
 
 	usbhURBObjectResetI(urb);
 	usbhURBSubmitI(urb);
 }
 
+#if HAL_USBHUVC_USE_FRAME_ASSEMBLER
+#define FA_WAIT		0	/* wait for the FID to toggle before starting a frame */
+#define FA_IDLE		1	/* the current packet starts a new frame */
+#define FA_ACTIVE	2	/* receiving a frame; fa->frame is NULL if it is being dropped */
+
+void usbhuvcFrameObjectInit(usbhuvc_frame_t *frame, uint8_t *buf, uint32_t size) {
+	osalDbgCheck(frame && buf && size);
+	memset(frame, 0, sizeof(*frame));
+	frame->type = USBHUVC_MESSAGETYPE_FRAME;
+	frame->buf = buf;
+	frame->size = size;
+}
+
+bool usbhuvcSetFrames(USBHUVCDriver *uvcdp, usbhuvc_frame_t *frames, uint8_t count) {
+	osalDbgCheck(uvcdp && ((frames == NULL) == (count == 0)));
+
+	osalSysLock();
+	if ((uvcdp->state == USBHUVC_STATE_STREAMING)
+			|| (uvcdp->state == USBHUVC_STATE_BUSY)) {
+		osalSysUnlock();
+		return HAL_FAILED;
+	}
+	uvcdp->fa.frames = frames;
+	uvcdp->fa.count = count;
+	osalSysUnlock();
+	return HAL_SUCCESS;
+}
+
+static usbhuvc_frame_t *_frame_get(USBHUVCDriver *uvcdp) {
+	usbhuvc_frame_assembler_t *const fa = &uvcdp->fa;
+	uint8_t i;
+
+	for (i = 0; i < fa->count; i++) {
+		usbhuvc_frame_t *const frame = &fa->frames[fa->next];
+		if (++fa->next == fa->count)
+			fa->next = 0;
+		if (!frame->busy) {
+			frame->busy = true;
+			frame->datalen = 0;
+			frame->flags = 0;
+			frame->seq = fa->seq++;
+			frame->dropped = fa->dropped;
+			fa->dropped = 0;
+			_stats_alloc(uvcdp);
+			return frame;
+		}
+	}
+
+	/* the application holds all the buffers */
+	fa->seq++;
+	fa->dropped++;
+	_stats_inc(uvcdp, drop_frames);
+	return NULL;
+}
+
+static void _frame_post(USBHUVCDriver *uvcdp, usbhuvc_frame_t *frame) {
+	frame->timestamp = osalOsGetSystemTimeX();
+	if (chMBPostI(&uvcdp->mb, (msg_t)frame) != MSG_OK) {
+		uerr("UVC: error, mailbox overrun");
+		frame->busy = false;
+		uvcdp->fa.dropped++;
+		_stats_free(uvcdp);
+		_stats_inc(uvcdp, drop_mailbox);
+	} else {
+		_stats_post(uvcdp);
+	}
+}
+
+static void _frame_header(usbhuvc_frame_t *frame, const uint8_t *hdr) {
+	const uint8_t hlen = hdr[0];
+	const uint8_t info = hdr[1];
+	uint8_t i = 2;
+
+	if (info & UVC_HDR_ERR)
+		frame->flags |= USBHUVC_FRAME_FLAG_ERROR;
+	if (info & UVC_HDR_STILL)
+		frame->flags |= USBHUVC_FRAME_FLAG_STILL;
+
+	if (info & UVC_HDR_PT) {
+		if ((hlen >= i + 4) && !(frame->flags & USBHUVC_FRAME_FLAG_PTS)) {
+			frame->pts = hdr[i] | (hdr[i + 1] << 8)
+					| (hdr[i + 2] << 16) | ((uint32_t)hdr[i + 3] << 24);
+			frame->flags |= USBHUVC_FRAME_FLAG_PTS;
+		}
+		i += 4;
+	}
+
+	if ((info & UVC_HDR_SCR) && (hlen >= i + 6)
+			&& !(frame->flags & USBHUVC_FRAME_FLAG_SCR)) {
+		frame->scr_stc = hdr[i] | (hdr[i + 1] << 8)
+				| (hdr[i + 2] << 16) | ((uint32_t)hdr[i + 3] << 24);
+		frame->scr_sof = hdr[i + 4] | (hdr[i + 5] << 8);
+		frame->flags |= USBHUVC_FRAME_FLAG_SCR;
+	}
+}
+
+static void _frame_put(usbhuvc_frame_t *frame, const uint8_t *src, uint32_t len) {
+	uint8_t *const dest = frame->buf + frame->datalen;
+
+	if (len > frame->size - frame->datalen) {
+		len = frame->size - frame->datalen;
+		frame->flags |= USBHUVC_FRAME_FLAG_OVERFLOW;
+	}
+
+	/* src == dest when the packet was received in place */
+	if (src != dest)
+		memmove(dest, src, len);
+	frame->datalen += len;
+}
+
+static void _frame_packet(USBHUVCDriver *uvcdp, usbh_urb_t *urb) {
+	usbhuvc_frame_assembler_t *const fa = &uvcdp->fa;
+	uint8_t *buff = (uint8_t *)urb->buff;
+	const uint8_t hlen = buff[0];
+	const uint8_t info = buff[1];
+	const uint8_t fid = info & UVC_HDR_FID;
+
+	_stats_packet(uvcdp, urb->actualLength - hlen);
+
+	if (fa->state == FA_WAIT) {
+		if ((fa->fid != 0xff) && (fid != fa->fid))
+			fa->state = FA_IDLE;
+		fa->fid = fid;
+	} else if ((fa->state == FA_ACTIVE) && (fid != fa->fid)) {
+		/* FID toggled without EOF; this packet starts the next frame */
+		if (fa->armed) {
+			/* move it out of the previous frame's buffer */
+			memcpy(uvcdp->mp_data_buffer, buff, urb->actualLength);
+			memcpy(buff, fa->saved, fa->saved_len);
+			buff = (uint8_t *)uvcdp->mp_data_buffer;
+			fa->armed = NULL;
+		}
+		if (fa->frame) {
+			fa->frame->flags |= USBHUVC_FRAME_FLAG_INCOMPLETE;
+			_frame_post(uvcdp, fa->frame);
+		}
+		_stats_frame(uvcdp);
+		fa->state = FA_IDLE;
+	}
+
+	if (fa->state == FA_IDLE) {
+		fa->frame = _frame_get(uvcdp);
+		fa->fid = fid;
+		fa->state = FA_ACTIVE;
+	}
+
+	if ((fa->state == FA_ACTIVE) && (fa->frame != NULL)) {
+		_frame_header(fa->frame, buff);
+		_frame_put(fa->frame, buff + hlen, urb->actualLength - hlen);
+	}
+
+	/* put back the bytes overwritten by the header */
+	if (fa->armed) {
+		memcpy(buff, fa->saved, fa->saved_len);
+		fa->armed = NULL;
+	}
+
+	if (hlen <= USBHUVC_MAX_PAYLOAD_HEADER_SZ)
+		fa->hlen = hlen;
+
+	if (info & UVC_HDR_EOF) {
+		if (fa->state == FA_ACTIVE) {
+			if (fa->frame != NULL)
+				_frame_post(uvcdp, fa->frame);
+			_stats_frame(uvcdp);
+		}
+		fa->frame = NULL;
+		/* header-only packets may follow with the same FID */
+		fa->state = FA_WAIT;
+	}
+}
+
+static void _frame_arm(USBHUVCDriver *uvcdp, usbh_urb_t *urb) {
+	usbhuvc_frame_assembler_t *const fa = &uvcdp->fa;
+	usbhuvc_frame_t *const frame = (fa->state == FA_ACTIVE) ? fa->frame : NULL;
+
+	/* Receive the next packet so that its payload lands right after the
+	 * data already in the frame: the header overwrites the last hlen bytes,
+	 * which are saved here and put back on completion. */
+	if (frame != NULL) {
+		const uint32_t off = (frame->datalen > fa->hlen) ? frame->datalen - fa->hlen : 0;
+		if (off + uvcdp->ep_iso.wMaxPacketSize <= frame->size) {
+			fa->saved_len = frame->datalen - off;
+			memcpy(fa->saved, frame->buf + off, fa->saved_len);
+			fa->armed = frame;
+			urb->buff = frame->buf + off;
+			return;
+		}
+	}
+
+	fa->armed = NULL;
+	urb->buff = uvcdp->mp_data_buffer;
+}
+
+static void _cb_iso_frame(usbh_urb_t *urb) {
+	USBHUVCDriver *uvcdp = (USBHUVCDriver *)urb->userData;
+	usbhuvc_frame_assembler_t *const fa = &uvcdp->fa;
+	const uint8_t *const buff = (const uint8_t *)urb->buff;
+	bool error = true;
+
+	if ((urb->status == USBH_URBSTATUS_DISCONNECTED)
+			|| (urb->status == USBH_URBSTATUS_CANCELLED)) {
+		uwarn("UVC: ISO IN status = DISCONNECTED/CANCELLED, aborting");
+		return;
+	}
+
+	if (urb->status != USBH_URBSTATUS_OK) {
+		uerrf("UVC: ISO IN error, unexpected status = %d", urb->status);
+		_stats_inc(uvcdp, drop_urb);
+	} else if (urb->actualLength >= 2) {
+		if (buff[0] < 2) {
+			uerrf("UVC: ISO IN, bHeaderLength=%d", buff[0]);
+			_stats_inc(uvcdp, drop_header);
+		} else if (buff[0] > urb->actualLength) {
+			uerrf("UVC: ISO IN, bHeaderLength=%d > actualLength=%d", buff[0], urb->actualLength);
+			_stats_inc(uvcdp, drop_header);
+		} else {
+			_frame_packet(uvcdp, urb);
+			error = false;
+		}
+	} else if (urb->actualLength > 0) {
+		uerrf("UVC: ISO IN, actualLength=%d", urb->actualLength);
+		_stats_inc(uvcdp, drop_header);
+	} else {
+		error = false;
+	}
+
+	if (error && (fa->state == FA_ACTIVE) && (fa->frame != NULL))
+		fa->frame->flags |= USBHUVC_FRAME_FLAG_ERROR;
+
+	if (fa->armed) {
+		memcpy(urb->buff, fa->saved, fa->saved_len);
+		fa->armed = NULL;
+	}
+
+	_frame_arm(uvcdp, urb);
+	usbhURBObjectResetI(urb);
+	usbhURBSubmitI(urb);
+}
+
+static bool _frame_start(USBHUVCDriver *uvcdp) {
+	usbhuvc_frame_assembler_t *const fa = &uvcdp->fa;
+	uint8_t i;
+
+	if (fa->count > HAL_USBHUVC_MAX_MAILBOX_SZ) {
+		uwarn("Mailbox may overflow, use a larger HAL_USBHUVC_MAX_MAILBOX_SZ.");
+	}
+
+	/* the work RAM is the scratch buffer for packets that can't be received in place */
+	if (uvcdp->ep_iso.wMaxPacketSize > HAL_USBHUVC_WORK_RAM_SIZE) {
+		uerr("Not enough work RAM");
+		return HAL_FAILED;
+	}
+
+	/* frames held by the application across a stop stay busy until released */
+	for (i = 0; i < fa->count; i++) {
+		if (fa->frames[i].busy)
+			_stats_alloc(uvcdp);
+	}
+	fa->next = 0;
+	fa->state = FA_WAIT;
+	fa->fid = 0xff;
+	fa->hlen = USBHUVC_MAX_PAYLOAD_HEADER_SZ;
+	fa->frame = NULL;
+	fa->armed = NULL;
+	fa->seq = 0;
+	fa->dropped = 0;
+	return HAL_SUCCESS;
+}
+
+static void _frame_stopI(USBHUVCDriver *uvcdp) {
+	usbhuvc_frame_assembler_t *const fa = &uvcdp->fa;
+	msg_t msg;
+
+	/* reclaim the frames posted but not fetched, and the one being filled */
+	while (chMBFetchI(&uvcdp->mb, &msg) == MSG_OK) {
+		((usbhuvc_frame_t *)msg)->busy = false;
+		_stats_free(uvcdp);
+	}
+	if (fa->frame != NULL) {
+		fa->frame->busy = false;
+		_stats_free(uvcdp);
+	}
+	fa->frame = NULL;
+	fa->armed = NULL;
+}
+#endif
 
 bool usbhuvcStreamStart(USBHUVCDriver *uvcdp, uint16_t min_ep_sz) {
 	bool ret = HAL_FAILED;
@@ -319,11 +712,40 @@ bool usbhuvcStreamStart(USBHUVCDriver *uvcdp, uint16_t min_ep_sz) {
 	uint32_t datapackets;
 	uint32_t data_sz;
 
+	//reserve working RAM; it is kept across stop/start and freed on unload
+	if (uvcdp->mp_data_buffer == NULL) {
+		uvcdp->mp_data_buffer = chHeapAlloc(NULL, HAL_USBHUVC_WORK_RAM_SIZE);
+		if (uvcdp->mp_data_buffer == NULL) {
+			uerr("Couldn't reserve RAM");
+			goto exit;
+		}
+	}
+
 	//set the alternate setting
 	if (_set_vs_alternate(uvcdp, min_ep_sz) != HAL_SUCCESS)
 		goto exit;
 
-	//reserve working RAM
+	osalSysLock();
+	_stats_reset(uvcdp);
+	osalSysUnlock();
+
+#if HAL_USBHUVC_USE_FRAME_ASSEMBLER
+	if (uvcdp->fa.frames != NULL) {
+		if (_frame_start(uvcdp) != HAL_SUCCESS)
+			goto failed;
+		chMBResumeX(&uvcdp->mb);
+
+		usbhEPOpen(&uvcdp->ep_iso);
+		usbhURBObjectInit(&uvcdp->urb_iso, &uvcdp->ep_iso, _cb_iso_frame, uvcdp,
+				uvcdp->mp_data_buffer, uvcdp->ep_iso.wMaxPacketSize);
+		usbhURBSubmit(&uvcdp->urb_iso);
+
+		ret = HAL_SUCCESS;
+		goto exit;
+	}
+#endif
+
+	//split the working RAM in data packets
 	data_sz = (uvcdp->ep_iso.wMaxPacketSize + sizeof(usbhuvc_message_data_t) + 3) & ~3;
 	datapackets = HAL_USBHUVC_WORK_RAM_SIZE / data_sz;
 	if (datapackets == 0) {
@@ -332,18 +754,12 @@ bool usbhuvcStreamStart(USBHUVCDriver *uvcdp, uint16_t min_ep_sz) {
 	}
 
 	workramsz = datapackets * data_sz;
-	uinfof("Reserving %u bytes of RAM (%d data packets of %d bytes)", workramsz, datapackets, data_sz);
-	if (datapackets > (HAL_USBHUVC_MAX_MAILBOX_SZ - HAL_USBHUVC_STATUS_PACKETS_COUNT)) {
+	uinfof("Using %u bytes of RAM (%d data packets of %d bytes)", workramsz, datapackets, data_sz);
+	if (datapackets > HAL_USBHUVC_MAX_MAILBOX_SZ) {
 		uwarn("Mailbox may overflow, use a larger HAL_USBHUVC_MAX_MAILBOX_SZ. UVC will under-utilize the assigned work RAM.");
 	}
 	chMBResumeX(&uvcdp->mb);
 
-	uvcdp->mp_data_buffer = chHeapAlloc(NULL, workramsz);
-	if (uvcdp->mp_data_buffer == NULL) {
-		uerr("Couldn't reserve RAM");
-		goto failed;
-	}
-
 	//initialize the mempool
 	chPoolObjectInit(&uvcdp->mp_data, data_sz, NULL);
 	elem = (const uint8_t *)uvcdp->mp_data_buffer;
@@ -359,6 +775,7 @@ bool usbhuvcStreamStart(USBHUVCDriver *uvcdp, uint16_t min_ep_sz) {
 	{
 		usbhuvc_message_data_t *const msg = (usbhuvc_message_data_t *)chPoolAlloc(&uvcdp->mp_data);
 		osalDbgCheck(msg);
+		_stats_alloc(uvcdp);
 		usbhURBObjectInit(&uvcdp->urb_iso, &uvcdp->ep_iso, _cb_iso, uvcdp, msg->data, uvcdp->ep_iso.wMaxPacketSize);
 	}
 
@@ -369,8 +786,6 @@ bool usbhuvcStreamStart(USBHUVCDriver *uvcdp, uint16_t min_ep_sz) {
 
 failed:
 	_set_vs_alternate(uvcdp, 0);
-	if (uvcdp->mp_data_buffer)
-		chHeapFree(uvcdp->mp_data_buffer);
 
 exit:
 	osalSysLock();
@@ -395,15 +810,16 @@ bool usbhuvcStreamStop(USBHUVCDriver *uvcdp) {
 	//close the ISO endpoint
 	usbhEPCloseS(&uvcdp->ep_iso);
 
-	//purge the mailbox
-	chMBResetI(&uvcdp->mb);		//TODO: the status messages are lost!!
+#if HAL_USBHUVC_USE_FRAME_ASSEMBLER
+	if (uvcdp->fa.frames != NULL)
+		_frame_stopI(uvcdp);
+#endif
+
+	//purge the data mailbox; status messages are kept in their own mailbox
+	chMBResetI(&uvcdp->mb);
 	chMtxLockS(&uvcdp->mtx);
 	osalSysUnlock();
 
-	//free the working memory
-	chHeapFree(uvcdp->mp_data_buffer);
-	uvcdp->mp_data_buffer = 0;
-
 	//set alternate setting to 0
 	_set_vs_alternate(uvcdp, 0);
 
@@ -685,6 +1101,7 @@ alloc_ok:
 	for(i = 0; i < HAL_USBHUVC_STATUS_PACKETS_COUNT; i++)
 		chPoolFree(&uvcdp->mp_status, &uvcdp->mp_status_buffer[i]);
 
+	chMBResumeX(&uvcdp->mb_status);
 	usbhEPOpen(&uvcdp->ep_int);
 
 	usbhuvc_message_status_t *const msg = (usbhuvc_message_status_t *)chPoolAlloc(&uvcdp->mp_status);
@@ -707,7 +1124,16 @@ static void _uvc_unload(usbh_baseclassdriver_t *drv) {
 
 	usbhEPClose(&uvcdp->ep_int);
 
-	//TODO: free
+	osalSysLock();
+	chMBResetI(&uvcdp->mb_status);
+	osalOsRescheduleS();
+	osalSysUnlock();
+
+	//free the working memory
+	if (uvcdp->mp_data_buffer) {
+		chHeapFree(uvcdp->mp_data_buffer);
+		uvcdp->mp_data_buffer = NULL;
+	}
 
 	if (drv->dev->keepFullCfgDesc)
 		drv->dev->keepFullCfgDesc--;
@@ -722,6 +1148,7 @@ static void _object_init(USBHUVCDriver *uvcdp) {
 	memset(uvcdp, 0, sizeof(*uvcdp));
 	uvcdp->info = &usbhuvcClassDriverInfo;
 	chMBObjectInit(&uvcdp->mb, uvcdp->mb_buff, HAL_USBHUVC_MAX_MAILBOX_SZ);
+	chMBObjectInit(&uvcdp->mb_status, uvcdp->mb_status_buff, HAL_USBHUVC_STATUS_PACKETS_COUNT);
 	chMtxObjectInit(&uvcdp->mtx);
 	uvcdp->state = USBHUVC_STATE_STOP;
 }
@@ -31,6 +31,16 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of bits in a @p bitmap_word_t.
+ */
+#define BITMAP_WORD_BITS          (sizeof(bitmap_word_t) * 8U)
+
+/**
+ * @brief   Word with all bits set.
+ */
+#define BITMAP_WORD_ONES          (~(bitmap_word_t)0)
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -69,6 +79,184 @@ static inline size_t pos_in_word(size_t bit) {
   return bit % (sizeof(bitmap_word_t) * 8);
 }
 
+/**
+ * @brief Get index of the least significant set bit.
+ *
+ * @param[in] w         word to be examined, must not be zero
+ *
+ * @return              Position of the first set bit.
+ */
+static inline size_t word_ctz(bitmap_word_t w) {
+#if defined(__GNUC__)
+  return __builtin_ctz(w);
+#else
+  size_t n = 0;
+
+  while ((w & 1U) == 0U) {
+    w >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * @brief Get amount of set bits in a word.
+ *
+ * @param[in] w         word to be examined
+ *
+ * @return              Number of set bits.
+ */
+static inline size_t word_popcount(bitmap_word_t w) {
+#if defined(__GNUC__)
+  return __builtin_popcount(w);
+#else
+  size_t n = 0;
+
+  while (w != 0U) {
+    w &= w - 1U;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * @brief Get mask of the bits from position @p pos up to the word end.
+ *
+ * @param[in] pos       first bit of the mask
+ *
+ * @return              Mask value.
+ */
+static inline bitmap_word_t mask_from(size_t pos) {
+  return BITMAP_WORD_ONES << pos;
+}
+
+/**
+ * @brief Get mask of the bits below position @p pos.
+ *
+ * @param[in] pos       first bit excluded from the mask, may be equal to
+ *                      the word size
+ *
+ * @return              Mask value.
+ */
+static inline bitmap_word_t mask_below(size_t pos) {
+  return (pos == 0U) ? 0U : (BITMAP_WORD_ONES >> (BITMAP_WORD_BITS - pos));
+}
+
+/**
+ * @brief Find first bit differing from @p skip, scanning whole words.
+ *
+ * @param[in] map       the @p bitmap_t structure
+ * @param[in] from      number of the bit to start from
+ * @param[in] skip      @p BITMAP_WORD_ONES to find clear bits, zero to find
+ *                      set bits
+ *
+ * @return              Number of the found bit or @p BITMAP_NOT_FOUND.
+ */
+static size_t find_first(const bitmap_t *map, size_t from,
+                         bitmap_word_t skip) {
+  size_t w = word(from);
+  bitmap_word_t v;
+
+  if (w >= map->len)
+    return BITMAP_NOT_FOUND;
+
+  v = (map->array[w] ^ skip) & mask_from(pos_in_word(from));
+  while (v == 0U) {
+    w++;
+    if (w >= map->len)
+      return BITMAP_NOT_FOUND;
+    v = map->array[w] ^ skip;
+  }
+
+  return (w * BITMAP_WORD_BITS) + word_ctz(v);
+}
+
+/**
+ * @brief Apply @p val to a range of bits, whole words at once.
+ *
+ * @param[out] map      the @p bitmap_t structure
+ * @param[in] start     number of the first bit
+ * @param[in] len       amount of bits
+ * @param[in] val       @p BITMAP_WORD_ONES to set, zero to clear
+ */
+static void fill_range(bitmap_t *map, size_t start, size_t len,
+                       bitmap_word_t val) {
+  size_t w, last;
+  bitmap_word_t mask;
+
+  if (len == 0)
+    return;
+
+  osalDbgCheck(start + len <= bitmapGetBitsCount(map));
+
+  w = word(start);
+  last = word(start + len - 1);
+  mask = mask_from(pos_in_word(start));
+  while (w < last) {
+    map->array[w] = (map->array[w] & ~mask) | (val & mask);
+    mask = BITMAP_WORD_ONES;
+    w++;
+  }
+  mask &= mask_below(pos_in_word(start + len - 1) + 1);
+  map->array[w] = (map->array[w] & ~mask) | (val & mask);
+}
+
+/**
+ * @brief Update the summary bits describing a leaf word.
+ *
+ * @param[out] map      the @p bitmap2l_t structure
+ * @param[in] w         index of the leaf word
+ */
+static void summary_update(bitmap2l_t *map, size_t w) {
+  const bitmap_word_t v = map->leaf.array[w];
+  const bitmap_word_t bit = (bitmap_word_t)1 << pos_in_word(w);
+
+  if (v != 0U)
+    map->nonempty[word(w)] |= bit;
+  else
+    map->nonempty[word(w)] &= ~bit;
+
+  if (v != BITMAP_WORD_ONES)
+    map->notfull[word(w)] |= bit;
+  else
+    map->notfull[word(w)] &= ~bit;
+}
+
+/**
+ * @brief Find first bit differing from @p skip in a two levels map.
+ *
+ * @param[in] map       the @p bitmap2l_t structure
+ * @param[in] from      number of the bit to start from
+ * @param[in] summary   summary array flagging the candidate leaf words
+ * @param[in] skip      @p BITMAP_WORD_ONES to find clear bits, zero to find
+ *                      set bits
+ *
+ * @return              Number of the found bit or @p BITMAP_NOT_FOUND.
+ */
+static size_t find_first_2l(const bitmap2l_t *map, size_t from,
+                            bitmap_word_t *summary, bitmap_word_t skip) {
+  const bitmap_t s = {summary, map->summary_len};
+  size_t w = word(from);
+  bitmap_word_t v;
+
+  if (w >= map->leaf.len)
+    return BITMAP_NOT_FOUND;
+
+  /* Remainder of the starting leaf word.*/
+  v = (map->leaf.array[w] ^ skip) & mask_from(pos_in_word(from));
+  if (v != 0U)
+    return (w * BITMAP_WORD_BITS) + word_ctz(v);
+
+  /* Next candidate leaf word from the summary.*/
+  w = find_first(&s, w + 1, 0);
+  if ((w == BITMAP_NOT_FOUND) || (w >= map->leaf.len))
+    return BITMAP_NOT_FOUND;
+
+  return (w * BITMAP_WORD_BITS) + word_ctz(map->leaf.array[w] ^ skip);
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -155,4 +343,231 @@ bitmap_word_t bitmapGet(const bitmap_t *map, size_t bit) {
 size_t bitmapGetBitsCount(const bitmap_t *map) {
   return map->len * sizeof(bitmap_word_t) * 8;
 }
+
+/**
+ * @brief Set range of bits in an @p bitmap_t structure.
+ *
+ * @param[out] map      the @p bitmap_t structure
+ * @param[in] start     number of the first bit to be set
+ * @param[in] len       amount of bits to be set
+ */
+void bitmapSetRange(bitmap_t *map, size_t start, size_t len) {
+  fill_range(map, start, len, BITMAP_WORD_ONES);
+}
+
+/**
+ * @brief Clear range of bits in an @p bitmap_t structure.
+ *
+ * @param[out] map      the @p bitmap_t structure
+ * @param[in] start     number of the first bit to be cleared
+ * @param[in] len       amount of bits to be cleared
+ */
+void bitmapClearRange(bitmap_t *map, size_t start, size_t len) {
+  fill_range(map, start, len, 0);
+}
+
+/**
+ * @brief Find first set bit in an @p bitmap_t structure.
+ *
+ * @param[in] map       the @p bitmap_t structure
+ * @param[in] from      number of the bit to start the search from
+ *
+ * @return              Number of the first set bit not lower than @p from
+ *                      or @p BITMAP_NOT_FOUND.
+ */
+size_t bitmapFindFirstSet(const bitmap_t *map, size_t from) {
+  return find_first(map, from, 0);
+}
+
+/**
+ * @brief Find first cleared bit in an @p bitmap_t structure.
+ *
+ * @param[in] map       the @p bitmap_t structure
+ * @param[in] from      number of the bit to start the search from
+ *
+ * @return              Number of the first cleared bit not lower than
+ *                      @p from or @p BITMAP_NOT_FOUND.
+ */
+size_t bitmapFindFirstClear(const bitmap_t *map, size_t from) {
+  return find_first(map, from, BITMAP_WORD_ONES);
+}
+
+/**
+ * @brief Find run of consecutive cleared bits in an @p bitmap_t structure.
+ *
+ * @param[in] map       the @p bitmap_t structure
+ * @param[in] from      number of the bit to start the search from
+ * @param[in] len       requested amount of consecutive cleared bits
+ *
+ * @return              Number of the first bit of the run or
+ *                      @p BITMAP_NOT_FOUND.
+ */
+size_t bitmapFindNextZeroRun(const bitmap_t *map, size_t from, size_t len) {
+  const size_t total = bitmapGetBitsCount(map);
+  size_t start, end;
+
+  osalDbgCheck(len > 0);
+
+  start = bitmapFindFirstClear(map, from);
+  while (start != BITMAP_NOT_FOUND) {
+    if (len > total - start)
+      return BITMAP_NOT_FOUND;
+
+    end = bitmapFindFirstSet(map, start);
+    if (end == BITMAP_NOT_FOUND)
+      end = total;
+    if (end - start >= len)
+      return start;
+
+    start = bitmapFindFirstClear(map, end);
+  }
+
+  return BITMAP_NOT_FOUND;
+}
+
+/**
+ * @brief Get amount of set bits in an @p bitmap_t structure.
+ *
+ * @param[in] map       the @p bitmap_t structure
+ *
+ * @return              Number of set bits.
+ */
+size_t bitmapPopcount(const bitmap_t *map) {
+  size_t n = 0;
+  size_t w;
+
+  for (w = 0; w < map->len; w++) {
+    n += word_popcount(map->array[w]);
+  }
+
+  return n;
+}
+/**
+ * @brief Initializes an @p bitmap2l_t structure.
+ *
+ * @param[out] map      the @p bitmap2l_t structure to be initialized
+ * @param[in] leaf      leaf words array
+ * @param[in] leaf_len  leaf array length in words
+ * @param[in] nonempty  summary array of @p BITMAP2L_SUMMARY_LEN(leaf_len)
+ *                      words
+ * @param[in] notfull   summary array of @p BITMAP2L_SUMMARY_LEN(leaf_len)
+ *                      words
+ * @param[in] val       the value to be written in all bitmap
+ */
+void bitmap2lObjectInit(bitmap2l_t *map,
+                        bitmap_word_t *leaf, size_t leaf_len,
+                        bitmap_word_t *nonempty, bitmap_word_t *notfull,
+                        bitmap_word_t val) {
+  size_t w;
+
+  osalDbgCheck((leaf != NULL) && (nonempty != NULL) && (notfull != NULL));
+
+  map->leaf.array  = leaf;
+  map->leaf.len    = leaf_len;
+  map->nonempty    = nonempty;
+  map->notfull     = notfull;
+  map->summary_len = BITMAP2L_SUMMARY_LEN(leaf_len);
+
+  bitmapObjectInit(&map->leaf, val);
+  memset(nonempty, 0, map->summary_len * sizeof(bitmap_word_t));
+  memset(notfull, 0, map->summary_len * sizeof(bitmap_word_t));
+  for (w = 0; w < leaf_len; w++) {
+    summary_update(map, w);
+  }
+}
+
+/**
+ * @brief Set single bit in an @p bitmap2l_t structure.
+ *
+ * @param[out] map      the @p bitmap2l_t structure
+ * @param[in] bit       number of the bit to be set
+ */
+void bitmap2lSet(bitmap2l_t *map, size_t bit) {
+  bitmapSet(&map->leaf, bit);
+  summary_update(map, word(bit));
+}
+
+/**
+ * @brief Clear single bit in an @p bitmap2l_t structure.
+ *
+ * @param[out] map      the @p bitmap2l_t structure
+ * @param[in] bit       number of the bit to be cleared
+ */
+void bitmap2lClear(bitmap2l_t *map, size_t bit) {
+  bitmapClear(&map->leaf, bit);
+  summary_update(map, word(bit));
+}
+
+/**
+ * @brief Get bit value from an @p bitmap2l_t structure.
+ *
+ * @param[in] map       the @p bitmap2l_t structure
+ * @param[in] bit       number of the requested bit
+ *
+ * @return              Requested bit value.
+ */
+bitmap_word_t bitmap2lGet(const bitmap2l_t *map, size_t bit) {
+  return bitmapGet(&map->leaf, bit);
+}
+
+/**
+ * @brief Find first set bit in an @p bitmap2l_t structure.
+ *
+ * @param[in] map       the @p bitmap2l_t structure
+ * @param[in] from      number of the bit to start the search from
+ *
+ * @return              Number of the first set bit not lower than @p from
+ *                      or @p BITMAP_NOT_FOUND.
+ */
+size_t bitmap2lFindFirstSet(const bitmap2l_t *map, size_t from) {
+  return find_first_2l(map, from, map->nonempty, 0);
+}
+
+/**
+ * @brief Find first cleared bit in an @p bitmap2l_t structure.
+ *
+ * @param[in] map       the @p bitmap2l_t structure
+ * @param[in] from      number of the bit to start the search from
+ *
+ * @return              Number of the first cleared bit not lower than
+ *                      @p from or @p BITMAP_NOT_FOUND.
+ */
+size_t bitmap2lFindFirstClear(const bitmap2l_t *map, size_t from) {
+  return find_first_2l(map, from, map->notfull, BITMAP_WORD_ONES);
+}
+
+/**
+ * @brief Check for set bits in an @p bitmap2l_t structure.
+ *
+ * @param[in] map       the @p bitmap2l_t structure
+ *
+ * @return              At least one bit is set.
+ */
+bool bitmap2lAnySet(const bitmap2l_t *map) {
+  size_t w;
+
+  for (w = 0; w < map->summary_len; w++) {
+    if (map->nonempty[w] != 0U)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Check for cleared bits in an @p bitmap2l_t structure.
+ *
+ * @param[in] map       the @p bitmap2l_t structure
+ *
+ * @return              At least one bit is cleared.
+ */
+bool bitmap2lAnyClear(const bitmap2l_t *map) {
+  size_t w;
+
+  for (w = 0; w < map->summary_len; w++) {
+    if (map->notfull[w] != 0U)
+      return true;
+  }
+  return false;
+}
+
 /** @} */
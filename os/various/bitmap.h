@@ -29,6 +29,11 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Returned by the search functions when no bit matches.
+ */
+#define BITMAP_NOT_FOUND          ((size_t)-1)
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -51,10 +56,45 @@ typedef struct {
   size_t          len;    /* Array length in _words_ NOT bytes */
 } bitmap_t;
 
+/**
+ * @brief   Type of a two levels bit map.
+ * @details Each summary bit describes one word of the leaf map, so that
+ *          searches only touch the summary and a single leaf word.
+ * @note    The leaf map must only be modified through the @p bitmap2l
+ *          functions, read only @p bitmap_t functions can be used on it.
+ */
+typedef struct {
+  /**
+   * @brief   Leaf bit map holding the actual bits.
+   */
+  bitmap_t        leaf;
+  /**
+   * @brief   Summary bit set when the leaf word has at least one set bit.
+   */
+  bitmap_word_t   *nonempty;
+  /**
+   * @brief   Summary bit set when the leaf word has at least one clear bit.
+   */
+  bitmap_word_t   *notfull;
+  /**
+   * @brief   Summary arrays length in words.
+   */
+  size_t          summary_len;
+} bitmap2l_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Summary words needed by a @p bitmap2l_t.
+ *
+ * @param[in] leaf_len  leaf array length in words
+ */
+#define BITMAP2L_SUMMARY_LEN(leaf_len)                                      \
+  (((leaf_len) + (sizeof(bitmap_word_t) * 8U) - 1U) /                       \
+   (sizeof(bitmap_word_t) * 8U))
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -68,6 +108,23 @@ extern "C" {
   void bitmapInvert(bitmap_t *map, size_t bit);
   bitmap_word_t bitmapGet(const bitmap_t *map, size_t bit);
   size_t bitmapGetBitsCount(const bitmap_t *map);
+  void bitmapSetRange(bitmap_t *map, size_t start, size_t len);
+  void bitmapClearRange(bitmap_t *map, size_t start, size_t len);
+  size_t bitmapFindFirstSet(const bitmap_t *map, size_t from);
+  size_t bitmapFindFirstClear(const bitmap_t *map, size_t from);
+  size_t bitmapFindNextZeroRun(const bitmap_t *map, size_t from, size_t len);
+  size_t bitmapPopcount(const bitmap_t *map);
+  void bitmap2lObjectInit(bitmap2l_t *map,
+                          bitmap_word_t *leaf, size_t leaf_len,
+                          bitmap_word_t *nonempty, bitmap_word_t *notfull,
+                          bitmap_word_t val);
+  void bitmap2lSet(bitmap2l_t *map, size_t bit);
+  void bitmap2lClear(bitmap2l_t *map, size_t bit);
+  bitmap_word_t bitmap2lGet(const bitmap2l_t *map, size_t bit);
+  size_t bitmap2lFindFirstSet(const bitmap2l_t *map, size_t from);
+  size_t bitmap2lFindFirstClear(const bitmap2l_t *map, size_t from);
+  bool bitmap2lAnySet(const bitmap2l_t *map);
+  bool bitmap2lAnyClear(const bitmap2l_t *map);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,646 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blockcache.c
+ * @brief   Write-back block cache source.
+ * @note    The cache is not thread safe, accesses must be serialized by the
+ *          caller as for any other block device.
+ *
+ * @addtogroup blockcache
+ * @{
+ */
+
+#include "hal.h"
+
+#include "blockcache.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+#define NO_LINE                 ((uint32_t)-1)
+
+/*===========================================================================*/
+/* Driver local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Consecutive dirty blocks pending write back.
+ * @details Each I/O vector element points into a line buffer, the line
+ *          index and mask are kept so that the dirty bits are cleared only
+ *          after a successful write.
+ */
+typedef struct {
+  uint32_t                      startblk;
+  uint32_t                      n;
+  uint32_t                      iovcnt;
+  blkiov_t                      iov[BLOCKCACHE_FLUSH_IOV_SIZE];
+  uint32_t                      line[BLOCKCACHE_FLUSH_IOV_SIZE];
+  uint32_t                      mask[BLOCKCACHE_FLUSH_IOV_SIZE];
+} flush_run_t;
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool overflow(const BlockCache *bcp, uint32_t startblk, uint32_t n) {
+  return (uint64_t)startblk + n > bcp->blk_num;
+}
+
+static uint8_t *line_data(const BlockCache *bcp, uint32_t idx) {
+  const BlockCacheConfig *cfg = bcp->config;
+
+  return cfg->buffer + (size_t)idx * cfg->line_blocks * bcp->blk_size;
+}
+
+static uint32_t line_mask(uint32_t off, uint32_t cnt) {
+  if (cnt >= 32U) {
+    return 0xFFFFFFFFU;
+  }
+  return ((1U << cnt) - 1U) << off;
+}
+
+/**
+ * @brief   Number of device blocks held by the line at @p first_lba.
+ * @details The last line of a device may be truncated.
+ */
+static uint32_t line_size(const BlockCache *bcp, uint32_t first_lba) {
+  uint32_t left = bcp->blk_num - first_lba;
+
+  return (left < bcp->config->line_blocks) ? left : bcp->config->line_blocks;
+}
+
+static uint32_t line_lookup(const BlockCache *bcp, uint32_t first_lba) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  for (i = 0; i < cfg->lines_num; i++) {
+    if (cfg->lines[i].valid && (cfg->lines[i].first_lba == first_lba)) {
+      return i;
+    }
+  }
+  return NO_LINE;
+}
+
+static void line_touch(BlockCache *bcp, uint32_t idx) {
+  bcp->config->lines[idx].stamp = ++bcp->stamp;
+}
+
+/**
+ * @brief   Writes the pending run, if any.
+ */
+static bool run_write(BlockCache *bcp, flush_run_t *rp) {
+  uint32_t i;
+
+  if (rp->iovcnt == 0U) {
+    return HAL_SUCCESS;
+  }
+  if (HAL_SUCCESS != ioblockvWrite(bcp->config->blkdev, rp->startblk,
+                                   rp->iov, rp->iovcnt)) {
+    return HAL_FAILED;
+  }
+  for (i = 0; i < rp->iovcnt; i++) {
+    bcp->config->lines[rp->line[i]].dirty &= ~rp->mask[i];
+  }
+  rp->iovcnt = 0;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Appends the dirty blocks of a line to the pending run.
+ * @details A dirty run not continuing the pending one, or not fitting in
+ *          its I/O vector, causes the pending run to be written first.
+ */
+static bool run_add(BlockCache *bcp, flush_run_t *rp, uint32_t idx) {
+  const blockcache_line_t *lp = &bcp->config->lines[idx];
+  uint8_t *data = line_data(bcp, idx);
+  uint32_t b = 0;
+
+  while (lp->dirty >> b) {
+    uint32_t len = 0;
+
+    while (((lp->dirty >> b) & 1U) == 0U) {
+      b++;
+    }
+    while ((b + len < 32U) && (((lp->dirty >> (b + len)) & 1U) != 0U)) {
+      len++;
+    }
+    if ((rp->iovcnt > 0U) &&
+        ((rp->startblk + rp->n != lp->first_lba + b) ||
+         (rp->iovcnt >= BLOCKCACHE_FLUSH_IOV_SIZE))) {
+      if (HAL_SUCCESS != run_write(bcp, rp)) {
+        return HAL_FAILED;
+      }
+    }
+    if (rp->iovcnt == 0U) {
+      rp->startblk = lp->first_lba + b;
+      rp->n = 0;
+    }
+    rp->iov[rp->iovcnt].buffer = data + (size_t)b * bcp->blk_size;
+    rp->iov[rp->iovcnt].n = len;
+    rp->line[rp->iovcnt] = idx;
+    rp->mask[rp->iovcnt] = line_mask(b, len);
+    rp->iovcnt++;
+    rp->n += len;
+    b += len;
+    if (b >= 32U) {
+      break;
+    }
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes back dirty blocks of a line.
+ * @details Consecutive dirty blocks are written with a single call.
+ */
+static bool line_flush(BlockCache *bcp, uint32_t idx) {
+  flush_run_t run;
+
+  run.iovcnt = 0;
+  if (HAL_SUCCESS != run_add(bcp, &run, idx)) {
+    return HAL_FAILED;
+  }
+  return run_write(bcp, &run);
+}
+
+/**
+ * @brief   Selects a line to be reused, writing it back if dirty.
+ * @details Invalid lines are used first, then the least recently used.
+ */
+static uint32_t line_victim(BlockCache *bcp) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i, victim = 0;
+
+  for (i = 0; i < cfg->lines_num; i++) {
+    if (!cfg->lines[i].valid) {
+      return i;
+    }
+    if ((int32_t)(cfg->lines[i].stamp - cfg->lines[victim].stamp) < 0) {
+      victim = i;
+    }
+  }
+  if (HAL_SUCCESS != line_flush(bcp, victim)) {
+    return NO_LINE;
+  }
+  cfg->lines[victim].valid = false;
+  return victim;
+}
+
+/**
+ * @brief   Assigns a line to the blocks starting at @p first_lba.
+ * @details The line data is not loaded, the caller must fill it.
+ */
+static uint32_t line_alloc(BlockCache *bcp, uint32_t first_lba) {
+  uint32_t idx = line_victim(bcp);
+  blockcache_line_t *lp;
+
+  if (NO_LINE == idx) {
+    return NO_LINE;
+  }
+  lp = &bcp->config->lines[idx];
+  lp->first_lba = first_lba;
+  lp->dirty = 0;
+  lp->valid = true;
+  line_touch(bcp, idx);
+  return idx;
+}
+
+/**
+ * @brief   Loads the line starting at @p first_lba from the device.
+ */
+static uint32_t line_fill(BlockCache *bcp, uint32_t first_lba) {
+  uint32_t idx = line_alloc(bcp, first_lba);
+
+  if (NO_LINE == idx) {
+    return NO_LINE;
+  }
+  if (HAL_SUCCESS != blkRead(bcp->config->blkdev, first_lba,
+                             line_data(bcp, idx),
+                             line_size(bcp, first_lba))) {
+    bcp->config->lines[idx].valid = false;
+    return NO_LINE;
+  }
+  return idx;
+}
+
+/**
+ * @brief   Prefetches the lines following @p first_lba.
+ * @details Failures are ignored, the data is read again on demand.
+ */
+static void read_ahead(BlockCache *bcp, uint32_t first_lba) {
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  for (i = 0; i < cfg->readahead; i++) {
+    first_lba += cfg->line_blocks;
+    if (first_lba >= bcp->blk_num) {
+      break;
+    }
+    if (NO_LINE == line_lookup(bcp, first_lba)) {
+      (void)line_fill(bcp, first_lba);
+    }
+  }
+}
+
+/**
+ * @brief   Counts blocks of whole, consecutive, not cached lines.
+ * @details Runs of at least two lines bypass the cache and are transferred
+ *          with a single call, so that streaming does not evict metadata.
+ */
+static uint32_t uncached_run(const BlockCache *bcp, uint32_t startblk,
+                             uint32_t n) {
+  const uint32_t lb = bcp->config->line_blocks;
+  uint32_t run = 0;
+
+  if ((startblk & (lb - 1U)) != 0U) {
+    return 0;
+  }
+  while ((n - run >= lb) && (NO_LINE == line_lookup(bcp, startblk + run))) {
+    run += lb;
+  }
+  return (run >= 2U * lb) ? run : 0U;
+}
+
+/*
+ * Interface implementation.
+ */
+static bool is_inserted(void *instance) {
+  BlockCache *bcp = instance;
+  return blkIsInserted(bcp->config->blkdev);
+}
+
+static bool is_protected(void *instance) {
+  BlockCache *bcp = instance;
+  if (BLK_READY == bcp->state) {
+    return blkIsWriteProtected(bcp->config->blkdev);
+  }
+  else {
+    return true;
+  }
+}
+
+static bool connect(void *instance) {
+  BlockCache *bcp = instance;
+  if (HAL_SUCCESS != blkConnect(bcp->config->blkdev)) {
+    return HAL_FAILED;
+  }
+  if (BLK_STOP == bcp->state) {
+    blockcacheInvalidate(bcp);
+    bcp->state = BLK_READY;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool disconnect(void *instance) {
+  BlockCache *bcp = instance;
+  if (BLK_STOP != bcp->state) {
+    if (HAL_SUCCESS != blockcacheFlush(bcp)) {
+      return HAL_FAILED;
+    }
+    bcp->state = BLK_STOP;
+  }
+  return blkDisconnect(bcp->config->blkdev);
+}
+
+static bool read(void *instance, uint32_t startblk,
+                 uint8_t *buffer, uint32_t n) {
+
+  BlockCache *bcp = instance;
+  const uint32_t lb = bcp->config->line_blocks;
+  const uint32_t bs = bcp->blk_size;
+  const bool sequential = (startblk == bcp->next_lba);
+
+  if (overflow(bcp, startblk, n)) {
+    return HAL_FAILED;
+  }
+
+  bcp->next_lba = startblk + n;
+  while (n > 0) {
+    uint32_t first = startblk & ~(lb - 1U);
+    uint32_t off = startblk - first;
+    uint32_t cnt = (lb - off < n) ? lb - off : n;
+    uint32_t idx = line_lookup(bcp, first);
+    bool prefetch = false;
+
+    if (NO_LINE == idx) {
+      uint32_t run = uncached_run(bcp, startblk, n);
+
+      if (run > 0) {
+        bcp->misses += run;
+        if (HAL_SUCCESS != blkRead(bcp->config->blkdev, startblk,
+                                   buffer, run)) {
+          return HAL_FAILED;
+        }
+        startblk += run;
+        buffer += (size_t)run * bs;
+        n -= run;
+        continue;
+      }
+      bcp->misses += cnt;
+      idx = line_fill(bcp, first);
+      if (NO_LINE == idx) {
+        return HAL_FAILED;
+      }
+      prefetch = sequential;
+    }
+    else {
+      bcp->hits += cnt;
+      line_touch(bcp, idx);
+    }
+
+    memcpy(buffer, line_data(bcp, idx) + (size_t)off * bs, (size_t)cnt * bs);
+    if (prefetch) {
+      /* After the copy, prefetching may evict the line.*/
+      read_ahead(bcp, first);
+    }
+    startblk += cnt;
+    buffer += (size_t)cnt * bs;
+    n -= cnt;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool write(void *instance, uint32_t startblk,
+                  const uint8_t *buffer, uint32_t n) {
+
+  BlockCache *bcp = instance;
+  const uint32_t lb = bcp->config->line_blocks;
+  const uint32_t bs = bcp->blk_size;
+
+  if (overflow(bcp, startblk, n)) {
+    return HAL_FAILED;
+  }
+
+  while (n > 0) {
+    uint32_t first = startblk & ~(lb - 1U);
+    uint32_t off = startblk - first;
+    uint32_t cnt = (lb - off < n) ? lb - off : n;
+    uint32_t idx = line_lookup(bcp, first);
+
+    if (NO_LINE == idx) {
+      uint32_t run = uncached_run(bcp, startblk, n);
+
+      if (run > 0) {
+        /* Whole lines are written through, already coalesced.*/
+        if (HAL_SUCCESS != blkWrite(bcp->config->blkdev, startblk,
+                                    buffer, run)) {
+          return HAL_FAILED;
+        }
+        startblk += run;
+        buffer += (size_t)run * bs;
+        n -= run;
+        continue;
+      }
+      bcp->misses += cnt;
+      if ((0U == off) && (cnt == line_size(bcp, first))) {
+        /* Whole line overwritten, nothing to read.*/
+        idx = line_alloc(bcp, first);
+      }
+      else {
+        /* Partial line, read-modify-write.*/
+        idx = line_fill(bcp, first);
+      }
+      if (NO_LINE == idx) {
+        return HAL_FAILED;
+      }
+    }
+    else {
+      bcp->hits += cnt;
+      line_touch(bcp, idx);
+    }
+
+    memcpy(line_data(bcp, idx) + (size_t)off * bs, buffer, (size_t)cnt * bs);
+    bcp->config->lines[idx].dirty |= line_mask(off, cnt);
+    startblk += cnt;
+    buffer += (size_t)cnt * bs;
+    n -= cnt;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool sync(void *instance) {
+
+  BlockCache *bcp = instance;
+  if (BLK_READY != bcp->state) {
+    return HAL_FAILED;
+  }
+  else if (HAL_SUCCESS != blockcacheFlush(bcp)) {
+    return HAL_FAILED;
+  }
+  else {
+    return blkSync(bcp->config->blkdev);
+  }
+}
+
+static bool get_info(void *instance, BlockDeviceInfo *bdip) {
+
+  BlockCache *bcp = instance;
+  if (BLK_READY != bcp->state) {
+    return HAL_FAILED;
+  }
+  else {
+    bdip->blk_num = bcp->blk_num;
+    bdip->blk_size = bcp->blk_size;
+    return HAL_SUCCESS;
+  }
+}
+
+/**
+ *
+ */
+static const struct BaseBlockDeviceVMT vmt = {
+    is_inserted,
+    is_protected,
+    connect,
+    disconnect,
+    read,
+    write,
+    sync,
+    get_info
+};
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Block cache object initialization.
+ *
+ * @param[in] bcp   pointer to @p BlockCache object
+ *
+ * @init
+ */
+void blockcacheObjectInit(BlockCache *bcp) {
+
+  bcp->vmt = &vmt;
+  bcp->state = BLK_STOP;
+  bcp->config = NULL;
+}
+
+/**
+ * @brief   Starts block cache.
+ * @details If the cache is already started its dirty blocks are written
+ *          back to the previously configured device before the cache is
+ *          invalidated, if that fails the cache is left unchanged.
+ * @pre     The cached device must be ready, its geometry is read here.
+ *
+ * @param[in] bcp       pointer to @p BlockCache object
+ * @param[in] config    pointer to @p BlockCacheConfig object
+ *
+ * @api
+ */
+void blockcacheStart(BlockCache *bcp, const BlockCacheConfig *config) {
+
+  BlockDeviceInfo bdi;
+
+  osalDbgCheck((bcp != NULL) && (config != NULL) &&
+               (config->blkdev != NULL) && (config->lines != NULL) &&
+               (config->buffer != NULL) && (config->lines_num > 0U));
+  osalDbgCheck((config->line_blocks > 0U) &&
+               (config->line_blocks <= BLOCKCACHE_MAX_LINE_BLOCKS) &&
+               ((config->line_blocks & (config->line_blocks - 1U)) == 0U));
+  osalDbgAssert((bcp->state == BLK_STOP) || (bcp->state == BLK_READY),
+                "invalid state");
+
+  if ((BLK_READY == bcp->state) && (HAL_SUCCESS != blockcacheFlush(bcp))) {
+    osalDbgAssert(false, "write back failed");
+    return;
+  }
+  if (HAL_SUCCESS != blkGetInfo(config->blkdev, &bdi)) {
+    osalDbgAssert(false, "device not ready");
+    return;
+  }
+
+  bcp->config   = config;
+  bcp->blk_size = bdi.blk_size;
+  bcp->blk_num  = bdi.blk_num;
+  blockcacheInvalidate(bcp);
+  bcp->state    = BLK_READY;
+}
+
+/**
+ * @brief   Stops block cache.
+ * @details Dirty blocks are written back before stopping.
+ *
+ * @param[in] bcp       pointer to @p BlockCache object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the cache has been stopped.
+ * @retval HAL_FAILED   the write back failed, the cache is still ready
+ *                      and keeps the blocks not written.
+ *
+ * @api
+ */
+bool blockcacheStop(BlockCache *bcp) {
+
+  osalDbgCheck(bcp != NULL);
+  osalDbgAssert((bcp->state == BLK_STOP) || (bcp->state == BLK_READY),
+                "invalid state");
+
+  if ((BLK_READY == bcp->state) && (HAL_SUCCESS != blockcacheFlush(bcp))) {
+    return HAL_FAILED;
+  }
+  bcp->state = BLK_STOP;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes back all dirty blocks.
+ * @details Lines are written in address order, consecutive dirty blocks
+ *          are written with a single vectored write also when they span
+ *          several lines. The cached device is not synchronized, use
+ *          @p blkSync() for that.
+ *
+ * @param[in] bcp       pointer to @p BlockCache object
+ *
+ * @return              The operation status.
+ *
+ * @api
+ */
+bool blockcacheFlush(BlockCache *bcp) {
+
+  const BlockCacheConfig *cfg = bcp->config;
+  flush_run_t run;
+  uint32_t last = 0;
+  bool first = true;
+
+  run.iovcnt = 0;
+
+  while (true) {
+    uint32_t i, idx = NO_LINE;
+
+    for (i = 0; i < cfg->lines_num; i++) {
+      const blockcache_line_t *lp = &cfg->lines[i];
+
+      if (lp->valid && (lp->dirty != 0U) &&
+          (first || (lp->first_lba > last)) &&
+          ((NO_LINE == idx) || (lp->first_lba < cfg->lines[idx].first_lba))) {
+        idx = i;
+      }
+    }
+    if (NO_LINE == idx) {
+      return run_write(bcp, &run);
+    }
+    if (HAL_SUCCESS != run_add(bcp, &run, idx)) {
+      return HAL_FAILED;
+    }
+    last = cfg->lines[idx].first_lba;
+    first = false;
+  }
+}
+
+/**
+ * @brief   Drops all cached data.
+ * @note    Dirty blocks are discarded, call @p blockcacheFlush() first if
+ *          they must be preserved.
+ *
+ * @param[in] bcp       pointer to @p BlockCache object
+ *
+ * @api
+ */
+void blockcacheInvalidate(BlockCache *bcp) {
+
+  const BlockCacheConfig *cfg = bcp->config;
+  uint32_t i;
+
+  for (i = 0; i < cfg->lines_num; i++) {
+    cfg->lines[i].valid = false;
+    cfg->lines[i].dirty = 0;
+    cfg->lines[i].stamp = 0;
+  }
+  bcp->stamp    = 0;
+  bcp->next_lba = (uint32_t)-1;
+  bcp->hits     = 0;
+  bcp->misses   = 0;
+}
+
+/** @} */
@@ -0,0 +1,173 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blockcache.h
+ * @brief   Write-back block cache header.
+ *
+ * @addtogroup blockcache
+ * @{
+ */
+
+#ifndef BLOCKCACHE_H_
+#define BLOCKCACHE_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of blocks in a cache line.
+ */
+#define BLOCKCACHE_MAX_LINE_BLOCKS      32U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of dirty runs merged in a single write back.
+ * @details Consecutive dirty runs, also spanning several lines, are
+ *          written with one vectored write of up to this many elements.
+ */
+#if !defined(BLOCKCACHE_FLUSH_IOV_SIZE) || defined(__DOXYGEN__)
+#define BLOCKCACHE_FLUSH_IOV_SIZE       8U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if BLOCKCACHE_FLUSH_IOV_SIZE < 1U
+#error "invalid BLOCKCACHE_FLUSH_IOV_SIZE value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a block cache object.
+ */
+typedef struct BlockCache BlockCache;
+
+/**
+ * @brief   Cache line descriptor.
+ * @details A line holds @p line_blocks consecutive blocks starting from a
+ *          line aligned address.
+ */
+typedef struct {
+  /**
+   * @brief   Address of the first block in the line.
+   */
+  uint32_t                      first_lba;
+  /**
+   * @brief   Last access time stamp, used for LRU eviction.
+   */
+  uint32_t                      stamp;
+  /**
+   * @brief   Dirty blocks mask, bit 0 is the first block in the line.
+   */
+  uint32_t                      dirty;
+  /**
+   * @brief   The line holds valid data.
+   */
+  bool                          valid;
+} blockcache_line_t;
+
+/**
+ * @brief   Block cache configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the cached @p BaseBlockDevice object.
+   */
+  BaseBlockDevice               *blkdev;
+  /**
+   * @brief   Pointer to line descriptors array.
+   */
+  blockcache_line_t             *lines;
+  /**
+   * @brief   Pointer to data buffer, must hold
+   *          @p lines_num * @p line_blocks blocks.
+   */
+  uint8_t                       *buffer;
+  /**
+   * @brief   Number of cache lines.
+   */
+  uint32_t                      lines_num;
+  /**
+   * @brief   Number of blocks in a line, power of two up to
+   *          @p BLOCKCACHE_MAX_LINE_BLOCKS.
+   */
+  uint32_t                      line_blocks;
+  /**
+   * @brief   Number of lines prefetched after a sequential miss, zero
+   *          disables read-ahead.
+   */
+  uint32_t                      readahead;
+} BlockCacheConfig;
+
+/**
+ * @brief   @p BlockCache specific data.
+ */
+#define _blockcache_device_data                                             \
+  _base_block_device_data                                                   \
+  const BlockCacheConfig        *config;                                    \
+  uint32_t                      blk_size;                                   \
+  uint32_t                      blk_num;                                    \
+  uint32_t                      stamp;                                      \
+  uint32_t                      next_lba;                                   \
+  uint32_t                      hits;                                       \
+  uint32_t                      misses;
+
+/**
+ * @brief   Block cache object.
+ * @details Wraps a @p BaseBlockDevice and is itself a @p BaseBlockDevice.
+ *          Writes are kept in memory until the line is evicted or the
+ *          device is synchronized, dirty blocks are then written back in
+ *          address order with one vectored write per consecutive run, runs
+ *          continuing into the following line are merged.
+ */
+struct BlockCache {
+  /** @brief Virtual Methods Table.*/
+  const struct BaseBlockDeviceVMT *vmt;
+  _blockcache_device_data
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void blockcacheObjectInit(BlockCache *bcp);
+  void blockcacheStart(BlockCache *bcp, const BlockCacheConfig *config);
+  bool blockcacheStop(BlockCache *bcp);
+  bool blockcacheFlush(BlockCache *bcp);
+  void blockcacheInvalidate(BlockCache *bcp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLOCKCACHE_H_ */
+
+/** @} */
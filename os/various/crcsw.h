@@ -59,10 +59,30 @@
 #define CRCSW_CRC16_TABLE               FALSE
 #endif
 
+/**
+ * @brief   Number of bytes processed per step by the table driven CRC.
+ * @details Using 4, 8 or 16 enables the slice-by-N algorithm, the lookup
+ *          tables grow to @p CRCSW_SLICE_BY slices of 1kB each.
+ * @note    The default is 1, the classic byte-at-a-time table.
+ */
+#if !defined(CRCSW_SLICE_BY) || defined(__DOXYGEN__)
+#define CRCSW_SLICE_BY                  1
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CRCSW_SLICE_BY != 1) && (CRCSW_SLICE_BY != 4) &&                      \
+    (CRCSW_SLICE_BY != 8) && (CRCSW_SLICE_BY != 16)
+#error "CRCSW_SLICE_BY must be 1, 4, 8 or 16"
+#endif
+
+#if (CRCSW_SLICE_BY > 1) && defined(__BYTE_ORDER__) &&                     \
+    (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "CRCSW_SLICE_BY requires a little endian architecture"
+#endif
+
 #if CRCSW_USE_CRC1 && CRC_USE_DMA
 #error "Software CRC does not support DMA(CRC_USE_DMA)"
 #endif
@@ -113,6 +133,12 @@ typedef struct {
    * @brief The crc lookup table to use when calculating CRC.
    */
   const uint32_t           *table;
+  /**
+   * @brief Number of consecutive 256 entries slices in @p table.
+   * @note  The slice-by-N algorithm is used when at least
+   *        @p CRCSW_SLICE_BY slices are available.
+   */
+  uint32_t                 table_slices;
 } CRCConfig;
 
 
@@ -0,0 +1,1659 @@
+/*
+    ChibiOS - Copyright (C) 2015 Michael D. Spradling
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    crcsw_tables.h
+ * @brief   CRC software driver lookup tables.
+ * @note    Generated by tools/crcsw_tables.py, do not edit.
+ *
+ * @addtogroup CRC
+ * @{
+ */
+
+#ifndef CRCSW_TABLES_H
+#define CRCSW_TABLES_H
+
+#if (CRCSW_CRC32_TABLE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   CRC32 lookup table, reflected polynomial 0x4C11DB7.
+ */
+static const uint32_t crc32_table[CRCSW_SLICE_BY][256] = {
+  {
+    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba,
+    0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
+    0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
+    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91,
+    0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
+    0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
+    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec,
+    0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5,
+    0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
+    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
+    0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940,
+    0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
+    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116,
+    0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f,
+    0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
+    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d,
+    0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a,
+    0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
+    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818,
+    0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
+    0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
+    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457,
+    0x65b0d9c6, 0x12b7e950, 0x8bbeb8ea, 0xfcb9887c,
+    0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
+    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
+    0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb,
+    0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
+    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9,
+    0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086,
+    0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4,
+    0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad,
+    0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
+    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683,
+    0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
+    0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
+    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe,
+    0xf762575d, 0x806567cb, 0x196c3671, 0x6e6b06e7,
+    0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
+    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
+    0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252,
+    0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
+    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60,
+    0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79,
+    0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
+    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f,
+    0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04,
+    0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
+    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a,
+    0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
+    0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
+    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21,
+    0x86d3d2d4, 0xf1d4e242, 0x68ddb3f8, 0x1fda836e,
+    0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
+    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
+    0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45,
+    0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
+    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db,
+    0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0,
+    0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6,
+    0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
+    0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
+    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+  },
+#if CRCSW_SLICE_BY >= 4
+  {
+    0x00000000, 0x191b3141, 0x32366282, 0x2b2d53c3,
+    0x646cc504, 0x7d77f445, 0x565aa786, 0x4f4196c7,
+    0xc8d98a08, 0xd1c2bb49, 0xfaefe88a, 0xe3f4d9cb,
+    0xacb54f0c, 0xb5ae7e4d, 0x9e832d8e, 0x87981ccf,
+    0x4ac21251, 0x53d92310, 0x78f470d3, 0x61ef4192,
+    0x2eaed755, 0x37b5e614, 0x1c98b5d7, 0x05838496,
+    0x821b9859, 0x9b00a918, 0xb02dfadb, 0xa936cb9a,
+    0xe6775d5d, 0xff6c6c1c, 0xd4413fdf, 0xcd5a0e9e,
+    0x958424a2, 0x8c9f15e3, 0xa7b24620, 0xbea97761,
+    0xf1e8e1a6, 0xe8f3d0e7, 0xc3de8324, 0xdac5b265,
+    0x5d5daeaa, 0x44469feb, 0x6f6bcc28, 0x7670fd69,
+    0x39316bae, 0x202a5aef, 0x0b07092c, 0x121c386d,
+    0xdf4636f3, 0xc65d07b2, 0xed705471, 0xf46b6530,
+    0xbb2af3f7, 0xa231c2b6, 0x891c9175, 0x9007a034,
+    0x179fbcfb, 0x0e848dba, 0x25a9de79, 0x3cb2ef38,
+    0x73f379ff, 0x6ae848be, 0x41c51b7d, 0x58de2a3c,
+    0xf0794f05, 0xe9627e44, 0xc24f2d87, 0xdb541cc6,
+    0x94158a01, 0x8d0ebb40, 0xa623e883, 0xbf38d9c2,
+    0x38a0c50d, 0x21bbf44c, 0x0a96a78f, 0x138d96ce,
+    0x5ccc0009, 0x45d73148, 0x6efa628b, 0x77e153ca,
+    0xbabb5d54, 0xa3a06c15, 0x888d3fd6, 0x91960e97,
+    0xded79850, 0xc7cca911, 0xece1fad2, 0xf5facb93,
+    0x7262d75c, 0x6b79e61d, 0x4054b5de, 0x594f849f,
+    0x160e1258, 0x0f152319, 0x243870da, 0x3d23419b,
+    0x65fd6ba7, 0x7ce65ae6, 0x57cb0925, 0x4ed03864,
+    0x0191aea3, 0x188a9fe2, 0x33a7cc21, 0x2abcfd60,
+    0xad24e1af, 0xb43fd0ee, 0x9f12832d, 0x8609b26c,
+    0xc94824ab, 0xd05315ea, 0xfb7e4629, 0xe2657768,
+    0x2f3f79f6, 0x362448b7, 0x1d091b74, 0x04122a35,
+    0x4b53bcf2, 0x52488db3, 0x7965de70, 0x607eef31,
+    0xe7e6f3fe, 0xfefdc2bf, 0xd5d0917c, 0xcccba03d,
+    0x838a36fa, 0x9a9107bb, 0xb1bc5478, 0xa8a76539,
+    0x3b83984b, 0x2298a90a, 0x09b5fac9, 0x10aecb88,
+    0x5fef5d4f, 0x46f46c0e, 0x6dd93fcd, 0x74c20e8c,
+    0xf35a1243, 0xea412302, 0xc16c70c1, 0xd8774180,
+    0x9736d747, 0x8e2de606, 0xa500b5c5, 0xbc1b8484,
+    0x71418a1a, 0x685abb5b, 0x4377e898, 0x5a6cd9d9,
+    0x152d4f1e, 0x0c367e5f, 0x271b2d9c, 0x3e001cdd,
+    0xb9980012, 0xa0833153, 0x8bae6290, 0x92b553d1,
+    0xddf4c516, 0xc4eff457, 0xefc2a794, 0xf6d996d5,
+    0xae07bce9, 0xb71c8da8, 0x9c31de6b, 0x852aef2a,
+    0xca6b79ed, 0xd37048ac, 0xf85d1b6f, 0xe1462a2e,
+    0x66de36e1, 0x7fc507a0, 0x54e85463, 0x4df36522,
+    0x02b2f3e5, 0x1ba9c2a4, 0x30849167, 0x299fa026,
+    0xe4c5aeb8, 0xfdde9ff9, 0xd6f3cc3a, 0xcfe8fd7b,
+    0x80a96bbc, 0x99b25afd, 0xb29f093e, 0xab84387f,
+    0x2c1c24b0, 0x350715f1, 0x1e2a4632, 0x07317773,
+    0x4870e1b4, 0x516bd0f5, 0x7a468336, 0x635db277,
+    0xcbfad74e, 0xd2e1e60f, 0xf9ccb5cc, 0xe0d7848d,
+    0xaf96124a, 0xb68d230b, 0x9da070c8, 0x84bb4189,
+    0x03235d46, 0x1a386c07, 0x31153fc4, 0x280e0e85,
+    0x674f9842, 0x7e54a903, 0x5579fac0, 0x4c62cb81,
+    0x8138c51f, 0x9823f45e, 0xb30ea79d, 0xaa1596dc,
+    0xe554001b, 0xfc4f315a, 0xd7626299, 0xce7953d8,
+    0x49e14f17, 0x50fa7e56, 0x7bd72d95, 0x62cc1cd4,
+    0x2d8d8a13, 0x3496bb52, 0x1fbbe891, 0x06a0d9d0,
+    0x5e7ef3ec, 0x4765c2ad, 0x6c48916e, 0x7553a02f,
+    0x3a1236e8, 0x230907a9, 0x0824546a, 0x113f652b,
+    0x96a779e4, 0x8fbc48a5, 0xa4911b66, 0xbd8a2a27,
+    0xf2cbbce0, 0xebd08da1, 0xc0fdde62, 0xd9e6ef23,
+    0x14bce1bd, 0x0da7d0fc, 0x268a833f, 0x3f91b27e,
+    0x70d024b9, 0x69cb15f8, 0x42e6463b, 0x5bfd777a,
+    0xdc656bb5, 0xc57e5af4, 0xee530937, 0xf7483876,
+    0xb809aeb1, 0xa1129ff0, 0x8a3fcc33, 0x9324fd72
+  },
+  {
+    0x00000000, 0x01c26a37, 0x0384d46e, 0x0246be59,
+    0x0709a8dc, 0x06cbc2eb, 0x048d7cb2, 0x054f1685,
+    0x0e1351b8, 0x0fd13b8f, 0x0d9785d6, 0x0c55efe1,
+    0x091af964, 0x08d89353, 0x0a9e2d0a, 0x0b5c473d,
+    0x1c26a370, 0x1de4c947, 0x1fa2771e, 0x1e601d29,
+    0x1b2f0bac, 0x1aed619b, 0x18abdfc2, 0x1969b5f5,
+    0x1235f2c8, 0x13f798ff, 0x11b126a6, 0x10734c91,
+    0x153c5a14, 0x14fe3023, 0x16b88e7a, 0x177ae44d,
+    0x384d46e0, 0x398f2cd7, 0x3bc9928e, 0x3a0bf8b9,
+    0x3f44ee3c, 0x3e86840b, 0x3cc03a52, 0x3d025065,
+    0x365e1758, 0x379c7d6f, 0x35dac336, 0x3418a901,
+    0x3157bf84, 0x3095d5b3, 0x32d36bea, 0x331101dd,
+    0x246be590, 0x25a98fa7, 0x27ef31fe, 0x262d5bc9,
+    0x23624d4c, 0x22a0277b, 0x20e69922, 0x2124f315,
+    0x2a78b428, 0x2bbade1f, 0x29fc6046, 0x283e0a71,
+    0x2d711cf4, 0x2cb376c3, 0x2ef5c89a, 0x2f37a2ad,
+    0x709a8dc0, 0x7158e7f7, 0x731e59ae, 0x72dc3399,
+    0x7793251c, 0x76514f2b, 0x7417f172, 0x75d59b45,
+    0x7e89dc78, 0x7f4bb64f, 0x7d0d0816, 0x7ccf6221,
+    0x798074a4, 0x78421e93, 0x7a04a0ca, 0x7bc6cafd,
+    0x6cbc2eb0, 0x6d7e4487, 0x6f38fade, 0x6efa90e9,
+    0x6bb5866c, 0x6a77ec5b, 0x68315202, 0x69f33835,
+    0x62af7f08, 0x636d153f, 0x612bab66, 0x60e9c151,
+    0x65a6d7d4, 0x6464bde3, 0x662203ba, 0x67e0698d,
+    0x48d7cb20, 0x4915a117, 0x4b531f4e, 0x4a917579,
+    0x4fde63fc, 0x4e1c09cb, 0x4c5ab792, 0x4d98dda5,
+    0x46c49a98, 0x4706f0af, 0x45404ef6, 0x448224c1,
+    0x41cd3244, 0x400f5873, 0x4249e62a, 0x438b8c1d,
+    0x54f16850, 0x55330267, 0x5775bc3e, 0x56b7d609,
+    0x53f8c08c, 0x523aaabb, 0x507c14e2, 0x51be7ed5,
+    0x5ae239e8, 0x5b2053df, 0x5966ed86, 0x58a487b1,
+    0x5deb9134, 0x5c29fb03, 0x5e6f455a, 0x5fad2f6d,
+    0xe1351b80, 0xe0f771b7, 0xe2b1cfee, 0xe373a5d9,
+    0xe63cb35c, 0xe7fed96b, 0xe5b86732, 0xe47a0d05,
+    0xef264a38, 0xeee4200f, 0xeca29e56, 0xed60f461,
+    0xe82fe2e4, 0xe9ed88d3, 0xebab368a, 0xea695cbd,
+    0xfd13b8f0, 0xfcd1d2c7, 0xfe976c9e, 0xff5506a9,
+    0xfa1a102c, 0xfbd87a1b, 0xf99ec442, 0xf85cae75,
+    0xf300e948, 0xf2c2837f, 0xf0843d26, 0xf1465711,
+    0xf4094194, 0xf5cb2ba3, 0xf78d95fa, 0xf64fffcd,
+    0xd9785d60, 0xd8ba3757, 0xdafc890e, 0xdb3ee339,
+    0xde71f5bc, 0xdfb39f8b, 0xddf521d2, 0xdc374be5,
+    0xd76b0cd8, 0xd6a966ef, 0xd4efd8b6, 0xd52db281,
+    0xd062a404, 0xd1a0ce33, 0xd3e6706a, 0xd2241a5d,
+    0xc55efe10, 0xc49c9427, 0xc6da2a7e, 0xc7184049,
+    0xc25756cc, 0xc3953cfb, 0xc1d382a2, 0xc011e895,
+    0xcb4dafa8, 0xca8fc59f, 0xc8c97bc6, 0xc90b11f1,
+    0xcc440774, 0xcd866d43, 0xcfc0d31a, 0xce02b92d,
+    0x91af9640, 0x906dfc77, 0x922b422e, 0x93e92819,
+    0x96a63e9c, 0x976454ab, 0x9522eaf2, 0x94e080c5,
+    0x9fbcc7f8, 0x9e7eadcf, 0x9c381396, 0x9dfa79a1,
+    0x98b56f24, 0x99770513, 0x9b31bb4a, 0x9af3d17d,
+    0x8d893530, 0x8c4b5f07, 0x8e0de15e, 0x8fcf8b69,
+    0x8a809dec, 0x8b42f7db, 0x89044982, 0x88c623b5,
+    0x839a6488, 0x82580ebf, 0x801eb0e6, 0x81dcdad1,
+    0x8493cc54, 0x8551a663, 0x8717183a, 0x86d5720d,
+    0xa9e2d0a0, 0xa820ba97, 0xaa6604ce, 0xaba46ef9,
+    0xaeeb787c, 0xaf29124b, 0xad6fac12, 0xacadc625,
+    0xa7f18118, 0xa633eb2f, 0xa4755576, 0xa5b73f41,
+    0xa0f829c4, 0xa13a43f3, 0xa37cfdaa, 0xa2be979d,
+    0xb5c473d0, 0xb40619e7, 0xb640a7be, 0xb782cd89,
+    0xb2cddb0c, 0xb30fb13b, 0xb1490f62, 0xb08b6555,
+    0xbbd72268, 0xba15485f, 0xb853f606, 0xb9919c31,
+    0xbcde8ab4, 0xbd1ce083, 0xbf5a5eda, 0xbe9834ed
+  },
+  {
+    0x00000000, 0xb8bc6765, 0xaa09c88b, 0x12b5afee,
+    0x8f629757, 0x37def032, 0x256b5fdc, 0x9dd738b9,
+    0xc5b428ef, 0x7d084f8a, 0x6fbde064, 0xd7018701,
+    0x4ad6bfb8, 0xf26ad8dd, 0xe0df7733, 0x58631056,
+    0x5019579f, 0xe8a530fa, 0xfa109f14, 0x42acf871,
+    0xdf7bc0c8, 0x67c7a7ad, 0x75720843, 0xcdce6f26,
+    0x95ad7f70, 0x2d111815, 0x3fa4b7fb, 0x8718d09e,
+    0x1acfe827, 0xa2738f42, 0xb0c620ac, 0x087a47c9,
+    0xa032af3e, 0x188ec85b, 0x0a3b67b5, 0xb28700d0,
+    0x2f503869, 0x97ec5f0c, 0x8559f0e2, 0x3de59787,
+    0x658687d1, 0xdd3ae0b4, 0xcf8f4f5a, 0x7733283f,
+    0xeae41086, 0x525877e3, 0x40edd80d, 0xf851bf68,
+    0xf02bf8a1, 0x48979fc4, 0x5a22302a, 0xe29e574f,
+    0x7f496ff6, 0xc7f50893, 0xd540a77d, 0x6dfcc018,
+    0x359fd04e, 0x8d23b72b, 0x9f9618c5, 0x272a7fa0,
+    0xbafd4719, 0x0241207c, 0x10f48f92, 0xa848e8f7,
+    0x9b14583d, 0x23a83f58, 0x311d90b6, 0x89a1f7d3,
+    0x1476cf6a, 0xaccaa80f, 0xbe7f07e1, 0x06c36084,
+    0x5ea070d2, 0xe61c17b7, 0xf4a9b859, 0x4c15df3c,
+    0xd1c2e785, 0x697e80e0, 0x7bcb2f0e, 0xc377486b,
+    0xcb0d0fa2, 0x73b168c7, 0x6104c729, 0xd9b8a04c,
+    0x446f98f5, 0xfcd3ff90, 0xee66507e, 0x56da371b,
+    0x0eb9274d, 0xb6054028, 0xa4b0efc6, 0x1c0c88a3,
+    0x81dbb01a, 0x3967d77f, 0x2bd27891, 0x936e1ff4,
+    0x3b26f703, 0x839a9066, 0x912f3f88, 0x299358ed,
+    0xb4446054, 0x0cf80731, 0x1e4da8df, 0xa6f1cfba,
+    0xfe92dfec, 0x462eb889, 0x549b1767, 0xec277002,
+    0x71f048bb, 0xc94c2fde, 0xdbf98030, 0x6345e755,
+    0x6b3fa09c, 0xd383c7f9, 0xc1366817, 0x798a0f72,
+    0xe45d37cb, 0x5ce150ae, 0x4e54ff40, 0xf6e89825,
+    0xae8b8873, 0x1637ef16, 0x048240f8, 0xbc3e279d,
+    0x21e91f24, 0x99557841, 0x8be0d7af, 0x335cb0ca,
+    0xed59b63b, 0x55e5d15e, 0x47507eb0, 0xffec19d5,
+    0x623b216c, 0xda874609, 0xc832e9e7, 0x708e8e82,
+    0x28ed9ed4, 0x9051f9b1, 0x82e4565f, 0x3a58313a,
+    0xa78f0983, 0x1f336ee6, 0x0d86c108, 0xb53aa66d,
+    0xbd40e1a4, 0x05fc86c1, 0x1749292f, 0xaff54e4a,
+    0x322276f3, 0x8a9e1196, 0x982bbe78, 0x2097d91d,
+    0x78f4c94b, 0xc048ae2e, 0xd2fd01c0, 0x6a4166a5,
+    0xf7965e1c, 0x4f2a3979, 0x5d9f9697, 0xe523f1f2,
+    0x4d6b1905, 0xf5d77e60, 0xe762d18e, 0x5fdeb6eb,
+    0xc2098e52, 0x7ab5e937, 0x680046d9, 0xd0bc21bc,
+    0x88df31ea, 0x3063568f, 0x22d6f961, 0x9a6a9e04,
+    0x07bda6bd, 0xbf01c1d8, 0xadb46e36, 0x15080953,
+    0x1d724e9a, 0xa5ce29ff, 0xb77b8611, 0x0fc7e174,
+    0x9210d9cd, 0x2aacbea8, 0x38191146, 0x80a57623,
+    0xd8c66675, 0x607a0110, 0x72cfaefe, 0xca73c99b,
+    0x57a4f122, 0xef189647, 0xfdad39a9, 0x45115ecc,
+    0x764dee06, 0xcef18963, 0xdc44268d, 0x64f841e8,
+    0xf92f7951, 0x41931e34, 0x5326b1da, 0xeb9ad6bf,
+    0xb3f9c6e9, 0x0b45a18c, 0x19f00e62, 0xa14c6907,
+    0x3c9b51be, 0x842736db, 0x96929935, 0x2e2efe50,
+    0x2654b999, 0x9ee8defc, 0x8c5d7112, 0x34e11677,
+    0xa9362ece, 0x118a49ab, 0x033fe645, 0xbb838120,
+    0xe3e09176, 0x5b5cf613, 0x49e959fd, 0xf1553e98,
+    0x6c820621, 0xd43e6144, 0xc68bceaa, 0x7e37a9cf,
+    0xd67f4138, 0x6ec3265d, 0x7c7689b3, 0xc4caeed6,
+    0x591dd66f, 0xe1a1b10a, 0xf3141ee4, 0x4ba87981,
+    0x13cb69d7, 0xab770eb2, 0xb9c2a15c, 0x017ec639,
+    0x9ca9fe80, 0x241599e5, 0x36a0360b, 0x8e1c516e,
+    0x866616a7, 0x3eda71c2, 0x2c6fde2c, 0x94d3b949,
+    0x090481f0, 0xb1b8e695, 0xa30d497b, 0x1bb12e1e,
+    0x43d23e48, 0xfb6e592d, 0xe9dbf6c3, 0x516791a6,
+    0xccb0a91f, 0x740cce7a, 0x66b96194, 0xde0506f1
+  },
+#endif
+#if CRCSW_SLICE_BY >= 8
+  {
+    0x00000000, 0x3d6029b0, 0x7ac05360, 0x47a07ad0,
+    0xf580a6c0, 0xc8e08f70, 0x8f40f5a0, 0xb220dc10,
+    0x30704bc1, 0x0d106271, 0x4ab018a1, 0x77d03111,
+    0xc5f0ed01, 0xf890c4b1, 0xbf30be61, 0x825097d1,
+    0x60e09782, 0x5d80be32, 0x1a20c4e2, 0x2740ed52,
+    0x95603142, 0xa80018f2, 0xefa06222, 0xd2c04b92,
+    0x5090dc43, 0x6df0f5f3, 0x2a508f23, 0x1730a693,
+    0xa5107a83, 0x98705333, 0xdfd029e3, 0xe2b00053,
+    0xc1c12f04, 0xfca106b4, 0xbb017c64, 0x866155d4,
+    0x344189c4, 0x0921a074, 0x4e81daa4, 0x73e1f314,
+    0xf1b164c5, 0xccd14d75, 0x8b7137a5, 0xb6111e15,
+    0x0431c205, 0x3951ebb5, 0x7ef19165, 0x4391b8d5,
+    0xa121b886, 0x9c419136, 0xdbe1ebe6, 0xe681c256,
+    0x54a11e46, 0x69c137f6, 0x2e614d26, 0x13016496,
+    0x9151f347, 0xac31daf7, 0xeb91a027, 0xd6f18997,
+    0x64d15587, 0x59b17c37, 0x1e1106e7, 0x23712f57,
+    0x58f35849, 0x659371f9, 0x22330b29, 0x1f532299,
+    0xad73fe89, 0x9013d739, 0xd7b3ade9, 0xead38459,
+    0x68831388, 0x55e33a38, 0x124340e8, 0x2f236958,
+    0x9d03b548, 0xa0639cf8, 0xe7c3e628, 0xdaa3cf98,
+    0x3813cfcb, 0x0573e67b, 0x42d39cab, 0x7fb3b51b,
+    0xcd93690b, 0xf0f340bb, 0xb7533a6b, 0x8a3313db,
+    0x0863840a, 0x3503adba, 0x72a3d76a, 0x4fc3feda,
+    0xfde322ca, 0xc0830b7a, 0x872371aa, 0xba43581a,
+    0x9932774d, 0xa4525efd, 0xe3f2242d, 0xde920d9d,
+    0x6cb2d18d, 0x51d2f83d, 0x167282ed, 0x2b12ab5d,
+    0xa9423c8c, 0x9422153c, 0xd3826fec, 0xeee2465c,
+    0x5cc29a4c, 0x61a2b3fc, 0x2602c92c, 0x1b62e09c,
+    0xf9d2e0cf, 0xc4b2c97f, 0x8312b3af, 0xbe729a1f,
+    0x0c52460f, 0x31326fbf, 0x7692156f, 0x4bf23cdf,
+    0xc9a2ab0e, 0xf4c282be, 0xb362f86e, 0x8e02d1de,
+    0x3c220dce, 0x0142247e, 0x46e25eae, 0x7b82771e,
+    0xb1e6b092, 0x8c869922, 0xcb26e3f2, 0xf646ca42,
+    0x44661652, 0x79063fe2, 0x3ea64532, 0x03c66c82,
+    0x8196fb53, 0xbcf6d2e3, 0xfb56a833, 0xc6368183,
+    0x74165d93, 0x49767423, 0x0ed60ef3, 0x33b62743,
+    0xd1062710, 0xec660ea0, 0xabc67470, 0x96a65dc0,
+    0x248681d0, 0x19e6a860, 0x5e46d2b0, 0x6326fb00,
+    0xe1766cd1, 0xdc164561, 0x9bb63fb1, 0xa6d61601,
+    0x14f6ca11, 0x2996e3a1, 0x6e369971, 0x5356b0c1,
+    0x70279f96, 0x4d47b626, 0x0ae7ccf6, 0x3787e546,
+    0x85a73956, 0xb8c710e6, 0xff676a36, 0xc2074386,
+    0x4057d457, 0x7d37fde7, 0x3a978737, 0x07f7ae87,
+    0xb5d77297, 0x88b75b27, 0xcf1721f7, 0xf2770847,
+    0x10c70814, 0x2da721a4, 0x6a075b74, 0x576772c4,
+    0xe547aed4, 0xd8278764, 0x9f87fdb4, 0xa2e7d404,
+    0x20b743d5, 0x1dd76a65, 0x5a7710b5, 0x67173905,
+    0xd537e515, 0xe857cca5, 0xaff7b675, 0x92979fc5,
+    0xe915e8db, 0xd475c16b, 0x93d5bbbb, 0xaeb5920b,
+    0x1c954e1b, 0x21f567ab, 0x66551d7b, 0x5b3534cb,
+    0xd965a31a, 0xe4058aaa, 0xa3a5f07a, 0x9ec5d9ca,
+    0x2ce505da, 0x11852c6a, 0x562556ba, 0x6b457f0a,
+    0x89f57f59, 0xb49556e9, 0xf3352c39, 0xce550589,
+    0x7c75d999, 0x4115f029, 0x06b58af9, 0x3bd5a349,
+    0xb9853498, 0x84e51d28, 0xc34567f8, 0xfe254e48,
+    0x4c059258, 0x7165bbe8, 0x36c5c138, 0x0ba5e888,
+    0x28d4c7df, 0x15b4ee6f, 0x521494bf, 0x6f74bd0f,
+    0xdd54611f, 0xe03448af, 0xa794327f, 0x9af41bcf,
+    0x18a48c1e, 0x25c4a5ae, 0x6264df7e, 0x5f04f6ce,
+    0xed242ade, 0xd044036e, 0x97e479be, 0xaa84500e,
+    0x4834505d, 0x755479ed, 0x32f4033d, 0x0f942a8d,
+    0xbdb4f69d, 0x80d4df2d, 0xc774a5fd, 0xfa148c4d,
+    0x78441b9c, 0x4524322c, 0x028448fc, 0x3fe4614c,
+    0x8dc4bd5c, 0xb0a494ec, 0xf704ee3c, 0xca64c78c
+  },
+  {
+    0x00000000, 0xcb5cd3a5, 0x4dc8a10b, 0x869472ae,
+    0x9b914216, 0x50cd91b3, 0xd659e31d, 0x1d0530b8,
+    0xec53826d, 0x270f51c8, 0xa19b2366, 0x6ac7f0c3,
+    0x77c2c07b, 0xbc9e13de, 0x3a0a6170, 0xf156b2d5,
+    0x03d6029b, 0xc88ad13e, 0x4e1ea390, 0x85427035,
+    0x9847408d, 0x531b9328, 0xd58fe186, 0x1ed33223,
+    0xef8580f6, 0x24d95353, 0xa24d21fd, 0x6911f258,
+    0x7414c2e0, 0xbf481145, 0x39dc63eb, 0xf280b04e,
+    0x07ac0536, 0xccf0d693, 0x4a64a43d, 0x81387798,
+    0x9c3d4720, 0x57619485, 0xd1f5e62b, 0x1aa9358e,
+    0xebff875b, 0x20a354fe, 0xa6372650, 0x6d6bf5f5,
+    0x706ec54d, 0xbb3216e8, 0x3da66446, 0xf6fab7e3,
+    0x047a07ad, 0xcf26d408, 0x49b2a6a6, 0x82ee7503,
+    0x9feb45bb, 0x54b7961e, 0xd223e4b0, 0x197f3715,
+    0xe82985c0, 0x23755665, 0xa5e124cb, 0x6ebdf76e,
+    0x73b8c7d6, 0xb8e41473, 0x3e7066dd, 0xf52cb578,
+    0x0f580a6c, 0xc404d9c9, 0x4290ab67, 0x89cc78c2,
+    0x94c9487a, 0x5f959bdf, 0xd901e971, 0x125d3ad4,
+    0xe30b8801, 0x28575ba4, 0xaec3290a, 0x659ffaaf,
+    0x789aca17, 0xb3c619b2, 0x35526b1c, 0xfe0eb8b9,
+    0x0c8e08f7, 0xc7d2db52, 0x4146a9fc, 0x8a1a7a59,
+    0x971f4ae1, 0x5c439944, 0xdad7ebea, 0x118b384f,
+    0xe0dd8a9a, 0x2b81593f, 0xad152b91, 0x6649f834,
+    0x7b4cc88c, 0xb0101b29, 0x36846987, 0xfdd8ba22,
+    0x08f40f5a, 0xc3a8dcff, 0x453cae51, 0x8e607df4,
+    0x93654d4c, 0x58399ee9, 0xdeadec47, 0x15f13fe2,
+    0xe4a78d37, 0x2ffb5e92, 0xa96f2c3c, 0x6233ff99,
+    0x7f36cf21, 0xb46a1c84, 0x32fe6e2a, 0xf9a2bd8f,
+    0x0b220dc1, 0xc07ede64, 0x46eaacca, 0x8db67f6f,
+    0x90b34fd7, 0x5bef9c72, 0xdd7beedc, 0x16273d79,
+    0xe7718fac, 0x2c2d5c09, 0xaab92ea7, 0x61e5fd02,
+    0x7ce0cdba, 0xb7bc1e1f, 0x31286cb1, 0xfa74bf14,
+    0x1eb014d8, 0xd5ecc77d, 0x5378b5d3, 0x98246676,
+    0x852156ce, 0x4e7d856b, 0xc8e9f7c5, 0x03b52460,
+    0xf2e396b5, 0x39bf4510, 0xbf2b37be, 0x7477e41b,
+    0x6972d4a3, 0xa22e0706, 0x24ba75a8, 0xefe6a60d,
+    0x1d661643, 0xd63ac5e6, 0x50aeb748, 0x9bf264ed,
+    0x86f75455, 0x4dab87f0, 0xcb3ff55e, 0x006326fb,
+    0xf135942e, 0x3a69478b, 0xbcfd3525, 0x77a1e680,
+    0x6aa4d638, 0xa1f8059d, 0x276c7733, 0xec30a496,
+    0x191c11ee, 0xd240c24b, 0x54d4b0e5, 0x9f886340,
+    0x828d53f8, 0x49d1805d, 0xcf45f2f3, 0x04192156,
+    0xf54f9383, 0x3e134026, 0xb8873288, 0x73dbe12d,
+    0x6eded195, 0xa5820230, 0x2316709e, 0xe84aa33b,
+    0x1aca1375, 0xd196c0d0, 0x5702b27e, 0x9c5e61db,
+    0x815b5163, 0x4a0782c6, 0xcc93f068, 0x07cf23cd,
+    0xf6999118, 0x3dc542bd, 0xbb513013, 0x700de3b6,
+    0x6d08d30e, 0xa65400ab, 0x20c07205, 0xeb9ca1a0,
+    0x11e81eb4, 0xdab4cd11, 0x5c20bfbf, 0x977c6c1a,
+    0x8a795ca2, 0x41258f07, 0xc7b1fda9, 0x0ced2e0c,
+    0xfdbb9cd9, 0x36e74f7c, 0xb0733dd2, 0x7b2fee77,
+    0x662adecf, 0xad760d6a, 0x2be27fc4, 0xe0beac61,
+    0x123e1c2f, 0xd962cf8a, 0x5ff6bd24, 0x94aa6e81,
+    0x89af5e39, 0x42f38d9c, 0xc467ff32, 0x0f3b2c97,
+    0xfe6d9e42, 0x35314de7, 0xb3a53f49, 0x78f9ecec,
+    0x65fcdc54, 0xaea00ff1, 0x28347d5f, 0xe368aefa,
+    0x16441b82, 0xdd18c827, 0x5b8cba89, 0x90d0692c,
+    0x8dd55994, 0x46898a31, 0xc01df89f, 0x0b412b3a,
+    0xfa1799ef, 0x314b4a4a, 0xb7df38e4, 0x7c83eb41,
+    0x6186dbf9, 0xaada085c, 0x2c4e7af2, 0xe712a957,
+    0x15921919, 0xdececabc, 0x585ab812, 0x93066bb7,
+    0x8e035b0f, 0x455f88aa, 0xc3cbfa04, 0x089729a1,
+    0xf9c19b74, 0x329d48d1, 0xb4093a7f, 0x7f55e9da,
+    0x6250d962, 0xa90c0ac7, 0x2f987869, 0xe4c4abcc
+  },
+  {
+    0x00000000, 0xa6770bb4, 0x979f1129, 0x31e81a9d,
+    0xf44f2413, 0x52382fa7, 0x63d0353a, 0xc5a73e8e,
+    0x33ef4e67, 0x959845d3, 0xa4705f4e, 0x020754fa,
+    0xc7a06a74, 0x61d761c0, 0x503f7b5d, 0xf64870e9,
+    0x67de9cce, 0xc1a9977a, 0xf0418de7, 0x56368653,
+    0x9391b8dd, 0x35e6b369, 0x040ea9f4, 0xa279a240,
+    0x5431d2a9, 0xf246d91d, 0xc3aec380, 0x65d9c834,
+    0xa07ef6ba, 0x0609fd0e, 0x37e1e793, 0x9196ec27,
+    0xcfbd399c, 0x69ca3228, 0x582228b5, 0xfe552301,
+    0x3bf21d8f, 0x9d85163b, 0xac6d0ca6, 0x0a1a0712,
+    0xfc5277fb, 0x5a257c4f, 0x6bcd66d2, 0xcdba6d66,
+    0x081d53e8, 0xae6a585c, 0x9f8242c1, 0x39f54975,
+    0xa863a552, 0x0e14aee6, 0x3ffcb47b, 0x998bbfcf,
+    0x5c2c8141, 0xfa5b8af5, 0xcbb39068, 0x6dc49bdc,
+    0x9b8ceb35, 0x3dfbe081, 0x0c13fa1c, 0xaa64f1a8,
+    0x6fc3cf26, 0xc9b4c492, 0xf85cde0f, 0x5e2bd5bb,
+    0x440b7579, 0xe27c7ecd, 0xd3946450, 0x75e36fe4,
+    0xb044516a, 0x16335ade, 0x27db4043, 0x81ac4bf7,
+    0x77e43b1e, 0xd19330aa, 0xe07b2a37, 0x460c2183,
+    0x83ab1f0d, 0x25dc14b9, 0x14340e24, 0xb2430590,
+    0x23d5e9b7, 0x85a2e203, 0xb44af89e, 0x123df32a,
+    0xd79acda4, 0x71edc610, 0x4005dc8d, 0xe672d739,
+    0x103aa7d0, 0xb64dac64, 0x87a5b6f9, 0x21d2bd4d,
+    0xe47583c3, 0x42028877, 0x73ea92ea, 0xd59d995e,
+    0x8bb64ce5, 0x2dc14751, 0x1c295dcc, 0xba5e5678,
+    0x7ff968f6, 0xd98e6342, 0xe86679df, 0x4e11726b,
+    0xb8590282, 0x1e2e0936, 0x2fc613ab, 0x89b1181f,
+    0x4c162691, 0xea612d25, 0xdb8937b8, 0x7dfe3c0c,
+    0xec68d02b, 0x4a1fdb9f, 0x7bf7c102, 0xdd80cab6,
+    0x1827f438, 0xbe50ff8c, 0x8fb8e511, 0x29cfeea5,
+    0xdf879e4c, 0x79f095f8, 0x48188f65, 0xee6f84d1,
+    0x2bc8ba5f, 0x8dbfb1eb, 0xbc57ab76, 0x1a20a0c2,
+    0x8816eaf2, 0x2e61e146, 0x1f89fbdb, 0xb9fef06f,
+    0x7c59cee1, 0xda2ec555, 0xebc6dfc8, 0x4db1d47c,
+    0xbbf9a495, 0x1d8eaf21, 0x2c66b5bc, 0x8a11be08,
+    0x4fb68086, 0xe9c18b32, 0xd82991af, 0x7e5e9a1b,
+    0xefc8763c, 0x49bf7d88, 0x78576715, 0xde206ca1,
+    0x1b87522f, 0xbdf0599b, 0x8c184306, 0x2a6f48b2,
+    0xdc27385b, 0x7a5033ef, 0x4bb82972, 0xedcf22c6,
+    0x28681c48, 0x8e1f17fc, 0xbff70d61, 0x198006d5,
+    0x47abd36e, 0xe1dcd8da, 0xd034c247, 0x7643c9f3,
+    0xb3e4f77d, 0x1593fcc9, 0x247be654, 0x820cede0,
+    0x74449d09, 0xd23396bd, 0xe3db8c20, 0x45ac8794,
+    0x800bb91a, 0x267cb2ae, 0x1794a833, 0xb1e3a387,
+    0x20754fa0, 0x86024414, 0xb7ea5e89, 0x119d553d,
+    0xd43a6bb3, 0x724d6007, 0x43a57a9a, 0xe5d2712e,
+    0x139a01c7, 0xb5ed0a73, 0x840510ee, 0x22721b5a,
+    0xe7d525d4, 0x41a22e60, 0x704a34fd, 0xd63d3f49,
+    0xcc1d9f8b, 0x6a6a943f, 0x5b828ea2, 0xfdf58516,
+    0x3852bb98, 0x9e25b02c, 0xafcdaab1, 0x09baa105,
+    0xfff2d1ec, 0x5985da58, 0x686dc0c5, 0xce1acb71,
+    0x0bbdf5ff, 0xadcafe4b, 0x9c22e4d6, 0x3a55ef62,
+    0xabc30345, 0x0db408f1, 0x3c5c126c, 0x9a2b19d8,
+    0x5f8c2756, 0xf9fb2ce2, 0xc813367f, 0x6e643dcb,
+    0x982c4d22, 0x3e5b4696, 0x0fb35c0b, 0xa9c457bf,
+    0x6c636931, 0xca146285, 0xfbfc7818, 0x5d8b73ac,
+    0x03a0a617, 0xa5d7ada3, 0x943fb73e, 0x3248bc8a,
+    0xf7ef8204, 0x519889b0, 0x6070932d, 0xc6079899,
+    0x304fe870, 0x9638e3c4, 0xa7d0f959, 0x01a7f2ed,
+    0xc400cc63, 0x6277c7d7, 0x539fdd4a, 0xf5e8d6fe,
+    0x647e3ad9, 0xc209316d, 0xf3e12bf0, 0x55962044,
+    0x90311eca, 0x3646157e, 0x07ae0fe3, 0xa1d90457,
+    0x579174be, 0xf1e67f0a, 0xc00e6597, 0x66796e23,
+    0xa3de50ad, 0x05a95b19, 0x34414184, 0x92364a30
+  },
+  {
+    0x00000000, 0xccaa009e, 0x4225077d, 0x8e8f07e3,
+    0x844a0efa, 0x48e00e64, 0xc66f0987, 0x0ac50919,
+    0xd3e51bb5, 0x1f4f1b2b, 0x91c01cc8, 0x5d6a1c56,
+    0x57af154f, 0x9b0515d1, 0x158a1232, 0xd92012ac,
+    0x7cbb312b, 0xb01131b5, 0x3e9e3656, 0xf23436c8,
+    0xf8f13fd1, 0x345b3f4f, 0xbad438ac, 0x767e3832,
+    0xaf5e2a9e, 0x63f42a00, 0xed7b2de3, 0x21d12d7d,
+    0x2b142464, 0xe7be24fa, 0x69312319, 0xa59b2387,
+    0xf9766256, 0x35dc62c8, 0xbb53652b, 0x77f965b5,
+    0x7d3c6cac, 0xb1966c32, 0x3f196bd1, 0xf3b36b4f,
+    0x2a9379e3, 0xe639797d, 0x68b67e9e, 0xa41c7e00,
+    0xaed97719, 0x62737787, 0xecfc7064, 0x205670fa,
+    0x85cd537d, 0x496753e3, 0xc7e85400, 0x0b42549e,
+    0x01875d87, 0xcd2d5d19, 0x43a25afa, 0x8f085a64,
+    0x562848c8, 0x9a824856, 0x140d4fb5, 0xd8a74f2b,
+    0xd2624632, 0x1ec846ac, 0x9047414f, 0x5ced41d1,
+    0x299dc2ed, 0xe537c273, 0x6bb8c590, 0xa712c50e,
+    0xadd7cc17, 0x617dcc89, 0xeff2cb6a, 0x2358cbf4,
+    0xfa78d958, 0x36d2d9c6, 0xb85dde25, 0x74f7debb,
+    0x7e32d7a2, 0xb298d73c, 0x3c17d0df, 0xf0bdd041,
+    0x5526f3c6, 0x998cf358, 0x1703f4bb, 0xdba9f425,
+    0xd16cfd3c, 0x1dc6fda2, 0x9349fa41, 0x5fe3fadf,
+    0x86c3e873, 0x4a69e8ed, 0xc4e6ef0e, 0x084cef90,
+    0x0289e689, 0xce23e617, 0x40ace1f4, 0x8c06e16a,
+    0xd0eba0bb, 0x1c41a025, 0x92cea7c6, 0x5e64a758,
+    0x54a1ae41, 0x980baedf, 0x1684a93c, 0xda2ea9a2,
+    0x030ebb0e, 0xcfa4bb90, 0x412bbc73, 0x8d81bced,
+    0x8744b5f4, 0x4beeb56a, 0xc561b289, 0x09cbb217,
+    0xac509190, 0x60fa910e, 0xee7596ed, 0x22df9673,
+    0x281a9f6a, 0xe4b09ff4, 0x6a3f9817, 0xa6959889,
+    0x7fb58a25, 0xb31f8abb, 0x3d908d58, 0xf13a8dc6,
+    0xfbff84df, 0x37558441, 0xb9da83a2, 0x7570833c,
+    0x533b85da, 0x9f918544, 0x111e82a7, 0xddb48239,
+    0xd7718b20, 0x1bdb8bbe, 0x95548c5d, 0x59fe8cc3,
+    0x80de9e6f, 0x4c749ef1, 0xc2fb9912, 0x0e51998c,
+    0x04949095, 0xc83e900b, 0x46b197e8, 0x8a1b9776,
+    0x2f80b4f1, 0xe32ab46f, 0x6da5b38c, 0xa10fb312,
+    0xabcaba0b, 0x6760ba95, 0xe9efbd76, 0x2545bde8,
+    0xfc65af44, 0x30cfafda, 0xbe40a839, 0x72eaa8a7,
+    0x782fa1be, 0xb485a120, 0x3a0aa6c3, 0xf6a0a65d,
+    0xaa4de78c, 0x66e7e712, 0xe868e0f1, 0x24c2e06f,
+    0x2e07e976, 0xe2ade9e8, 0x6c22ee0b, 0xa088ee95,
+    0x79a8fc39, 0xb502fca7, 0x3b8dfb44, 0xf727fbda,
+    0xfde2f2c3, 0x3148f25d, 0xbfc7f5be, 0x736df520,
+    0xd6f6d6a7, 0x1a5cd639, 0x94d3d1da, 0x5879d144,
+    0x52bcd85d, 0x9e16d8c3, 0x1099df20, 0xdc33dfbe,
+    0x0513cd12, 0xc9b9cd8c, 0x4736ca6f, 0x8b9ccaf1,
+    0x8159c3e8, 0x4df3c376, 0xc37cc495, 0x0fd6c40b,
+    0x7aa64737, 0xb60c47a9, 0x3883404a, 0xf42940d4,
+    0xfeec49cd, 0x32464953, 0xbcc94eb0, 0x70634e2e,
+    0xa9435c82, 0x65e95c1c, 0xeb665bff, 0x27cc5b61,
+    0x2d095278, 0xe1a352e6, 0x6f2c5505, 0xa386559b,
+    0x061d761c, 0xcab77682, 0x44387161, 0x889271ff,
+    0x825778e6, 0x4efd7878, 0xc0727f9b, 0x0cd87f05,
+    0xd5f86da9, 0x19526d37, 0x97dd6ad4, 0x5b776a4a,
+    0x51b26353, 0x9d1863cd, 0x1397642e, 0xdf3d64b0,
+    0x83d02561, 0x4f7a25ff, 0xc1f5221c, 0x0d5f2282,
+    0x079a2b9b, 0xcb302b05, 0x45bf2ce6, 0x89152c78,
+    0x50353ed4, 0x9c9f3e4a, 0x121039a9, 0xdeba3937,
+    0xd47f302e, 0x18d530b0, 0x965a3753, 0x5af037cd,
+    0xff6b144a, 0x33c114d4, 0xbd4e1337, 0x71e413a9,
+    0x7b211ab0, 0xb78b1a2e, 0x39041dcd, 0xf5ae1d53,
+    0x2c8e0fff, 0xe0240f61, 0x6eab0882, 0xa201081c,
+    0xa8c40105, 0x646e019b, 0xeae10678, 0x264b06e6
+  },
+#endif
+#if CRCSW_SLICE_BY >= 16
+  {
+    0x00000000, 0x177b1443, 0x2ef62886, 0x398d3cc5,
+    0x5dec510c, 0x4a97454f, 0x731a798a, 0x64616dc9,
+    0xbbd8a218, 0xaca3b65b, 0x952e8a9e, 0x82559edd,
+    0xe634f314, 0xf14fe757, 0xc8c2db92, 0xdfb9cfd1,
+    0xacc04271, 0xbbbb5632, 0x82366af7, 0x954d7eb4,
+    0xf12c137d, 0xe657073e, 0xdfda3bfb, 0xc8a12fb8,
+    0x1718e069, 0x0063f42a, 0x39eec8ef, 0x2e95dcac,
+    0x4af4b165, 0x5d8fa526, 0x640299e3, 0x73798da0,
+    0x82f182a3, 0x958a96e0, 0xac07aa25, 0xbb7cbe66,
+    0xdf1dd3af, 0xc866c7ec, 0xf1ebfb29, 0xe690ef6a,
+    0x392920bb, 0x2e5234f8, 0x17df083d, 0x00a41c7e,
+    0x64c571b7, 0x73be65f4, 0x4a335931, 0x5d484d72,
+    0x2e31c0d2, 0x394ad491, 0x00c7e854, 0x17bcfc17,
+    0x73dd91de, 0x64a6859d, 0x5d2bb958, 0x4a50ad1b,
+    0x95e962ca, 0x82927689, 0xbb1f4a4c, 0xac645e0f,
+    0xc80533c6, 0xdf7e2785, 0xe6f31b40, 0xf1880f03,
+    0xde920307, 0xc9e91744, 0xf0642b81, 0xe71f3fc2,
+    0x837e520b, 0x94054648, 0xad887a8d, 0xbaf36ece,
+    0x654aa11f, 0x7231b55c, 0x4bbc8999, 0x5cc79dda,
+    0x38a6f013, 0x2fdde450, 0x1650d895, 0x012bccd6,
+    0x72524176, 0x65295535, 0x5ca469f0, 0x4bdf7db3,
+    0x2fbe107a, 0x38c50439, 0x014838fc, 0x16332cbf,
+    0xc98ae36e, 0xdef1f72d, 0xe77ccbe8, 0xf007dfab,
+    0x9466b262, 0x831da621, 0xba909ae4, 0xadeb8ea7,
+    0x5c6381a4, 0x4b1895e7, 0x7295a922, 0x65eebd61,
+    0x018fd0a8, 0x16f4c4eb, 0x2f79f82e, 0x3802ec6d,
+    0xe7bb23bc, 0xf0c037ff, 0xc94d0b3a, 0xde361f79,
+    0xba5772b0, 0xad2c66f3, 0x94a15a36, 0x83da4e75,
+    0xf0a3c3d5, 0xe7d8d796, 0xde55eb53, 0xc92eff10,
+    0xad4f92d9, 0xba34869a, 0x83b9ba5f, 0x94c2ae1c,
+    0x4b7b61cd, 0x5c00758e, 0x658d494b, 0x72f65d08,
+    0x169730c1, 0x01ec2482, 0x38611847, 0x2f1a0c04,
+    0x6655004f, 0x712e140c, 0x48a328c9, 0x5fd83c8a,
+    0x3bb95143, 0x2cc24500, 0x154f79c5, 0x02346d86,
+    0xdd8da257, 0xcaf6b614, 0xf37b8ad1, 0xe4009e92,
+    0x8061f35b, 0x971ae718, 0xae97dbdd, 0xb9eccf9e,
+    0xca95423e, 0xddee567d, 0xe4636ab8, 0xf3187efb,
+    0x97791332, 0x80020771, 0xb98f3bb4, 0xaef42ff7,
+    0x714de026, 0x6636f465, 0x5fbbc8a0, 0x48c0dce3,
+    0x2ca1b12a, 0x3bdaa569, 0x025799ac, 0x152c8def,
+    0xe4a482ec, 0xf3df96af, 0xca52aa6a, 0xdd29be29,
+    0xb948d3e0, 0xae33c7a3, 0x97befb66, 0x80c5ef25,
+    0x5f7c20f4, 0x480734b7, 0x718a0872, 0x66f11c31,
+    0x029071f8, 0x15eb65bb, 0x2c66597e, 0x3b1d4d3d,
+    0x4864c09d, 0x5f1fd4de, 0x6692e81b, 0x71e9fc58,
+    0x15889191, 0x02f385d2, 0x3b7eb917, 0x2c05ad54,
+    0xf3bc6285, 0xe4c776c6, 0xdd4a4a03, 0xca315e40,
+    0xae503389, 0xb92b27ca, 0x80a61b0f, 0x97dd0f4c,
+    0xb8c70348, 0xafbc170b, 0x96312bce, 0x814a3f8d,
+    0xe52b5244, 0xf2504607, 0xcbdd7ac2, 0xdca66e81,
+    0x031fa150, 0x1464b513, 0x2de989d6, 0x3a929d95,
+    0x5ef3f05c, 0x4988e41f, 0x7005d8da, 0x677ecc99,
+    0x14074139, 0x037c557a, 0x3af169bf, 0x2d8a7dfc,
+    0x49eb1035, 0x5e900476, 0x671d38b3, 0x70662cf0,
+    0xafdfe321, 0xb8a4f762, 0x8129cba7, 0x9652dfe4,
+    0xf233b22d, 0xe548a66e, 0xdcc59aab, 0xcbbe8ee8,
+    0x3a3681eb, 0x2d4d95a8, 0x14c0a96d, 0x03bbbd2e,
+    0x67dad0e7, 0x70a1c4a4, 0x492cf861, 0x5e57ec22,
+    0x81ee23f3, 0x969537b0, 0xaf180b75, 0xb8631f36,
+    0xdc0272ff, 0xcb7966bc, 0xf2f45a79, 0xe58f4e3a,
+    0x96f6c39a, 0x818dd7d9, 0xb800eb1c, 0xaf7bff5f,
+    0xcb1a9296, 0xdc6186d5, 0xe5ecba10, 0xf297ae53,
+    0x2d2e6182, 0x3a5575c1, 0x03d84904, 0x14a35d47,
+    0x70c2308e, 0x67b924cd, 0x5e341808, 0x494f0c4b
+  },
+  {
+    0x00000000, 0xefc26b3e, 0x04f5d03d, 0xeb37bb03,
+    0x09eba07a, 0xe629cb44, 0x0d1e7047, 0xe2dc1b79,
+    0x13d740f4, 0xfc152bca, 0x172290c9, 0xf8e0fbf7,
+    0x1a3ce08e, 0xf5fe8bb0, 0x1ec930b3, 0xf10b5b8d,
+    0x27ae81e8, 0xc86cead6, 0x235b51d5, 0xcc993aeb,
+    0x2e452192, 0xc1874aac, 0x2ab0f1af, 0xc5729a91,
+    0x3479c11c, 0xdbbbaa22, 0x308c1121, 0xdf4e7a1f,
+    0x3d926166, 0xd2500a58, 0x3967b15b, 0xd6a5da65,
+    0x4f5d03d0, 0xa09f68ee, 0x4ba8d3ed, 0xa46ab8d3,
+    0x46b6a3aa, 0xa974c894, 0x42437397, 0xad8118a9,
+    0x5c8a4324, 0xb348281a, 0x587f9319, 0xb7bdf827,
+    0x5561e35e, 0xbaa38860, 0x51943363, 0xbe56585d,
+    0x68f38238, 0x8731e906, 0x6c065205, 0x83c4393b,
+    0x61182242, 0x8eda497c, 0x65edf27f, 0x8a2f9941,
+    0x7b24c2cc, 0x94e6a9f2, 0x7fd112f1, 0x901379cf,
+    0x72cf62b6, 0x9d0d0988, 0x763ab28b, 0x99f8d9b5,
+    0x9eba07a0, 0x71786c9e, 0x9a4fd79d, 0x758dbca3,
+    0x9751a7da, 0x7893cce4, 0x93a477e7, 0x7c661cd9,
+    0x8d6d4754, 0x62af2c6a, 0x89989769, 0x665afc57,
+    0x8486e72e, 0x6b448c10, 0x80733713, 0x6fb15c2d,
+    0xb9148648, 0x56d6ed76, 0xbde15675, 0x52233d4b,
+    0xb0ff2632, 0x5f3d4d0c, 0xb40af60f, 0x5bc89d31,
+    0xaac3c6bc, 0x4501ad82, 0xae361681, 0x41f47dbf,
+    0xa32866c6, 0x4cea0df8, 0xa7ddb6fb, 0x481fddc5,
+    0xd1e70470, 0x3e256f4e, 0xd512d44d, 0x3ad0bf73,
+    0xd80ca40a, 0x37cecf34, 0xdcf97437, 0x333b1f09,
+    0xc2304484, 0x2df22fba, 0xc6c594b9, 0x2907ff87,
+    0xcbdbe4fe, 0x24198fc0, 0xcf2e34c3, 0x20ec5ffd,
+    0xf6498598, 0x198beea6, 0xf2bc55a5, 0x1d7e3e9b,
+    0xffa225e2, 0x10604edc, 0xfb57f5df, 0x14959ee1,
+    0xe59ec56c, 0x0a5cae52, 0xe16b1551, 0x0ea97e6f,
+    0xec756516, 0x03b70e28, 0xe880b52b, 0x0742de15,
+    0xe6050901, 0x09c7623f, 0xe2f0d93c, 0x0d32b202,
+    0xefeea97b, 0x002cc245, 0xeb1b7946, 0x04d91278,
+    0xf5d249f5, 0x1a1022cb, 0xf12799c8, 0x1ee5f2f6,
+    0xfc39e98f, 0x13fb82b1, 0xf8cc39b2, 0x170e528c,
+    0xc1ab88e9, 0x2e69e3d7, 0xc55e58d4, 0x2a9c33ea,
+    0xc8402893, 0x278243ad, 0xccb5f8ae, 0x23779390,
+    0xd27cc81d, 0x3dbea323, 0xd6891820, 0x394b731e,
+    0xdb976867, 0x34550359, 0xdf62b85a, 0x30a0d364,
+    0xa9580ad1, 0x469a61ef, 0xadaddaec, 0x426fb1d2,
+    0xa0b3aaab, 0x4f71c195, 0xa4467a96, 0x4b8411a8,
+    0xba8f4a25, 0x554d211b, 0xbe7a9a18, 0x51b8f126,
+    0xb364ea5f, 0x5ca68161, 0xb7913a62, 0x5853515c,
+    0x8ef68b39, 0x6134e007, 0x8a035b04, 0x65c1303a,
+    0x871d2b43, 0x68df407d, 0x83e8fb7e, 0x6c2a9040,
+    0x9d21cbcd, 0x72e3a0f3, 0x99d41bf0, 0x761670ce,
+    0x94ca6bb7, 0x7b080089, 0x903fbb8a, 0x7ffdd0b4,
+    0x78bf0ea1, 0x977d659f, 0x7c4ade9c, 0x9388b5a2,
+    0x7154aedb, 0x9e96c5e5, 0x75a17ee6, 0x9a6315d8,
+    0x6b684e55, 0x84aa256b, 0x6f9d9e68, 0x805ff556,
+    0x6283ee2f, 0x8d418511, 0x66763e12, 0x89b4552c,
+    0x5f118f49, 0xb0d3e477, 0x5be45f74, 0xb426344a,
+    0x56fa2f33, 0xb938440d, 0x520fff0e, 0xbdcd9430,
+    0x4cc6cfbd, 0xa304a483, 0x48331f80, 0xa7f174be,
+    0x452d6fc7, 0xaaef04f9, 0x41d8bffa, 0xae1ad4c4,
+    0x37e20d71, 0xd820664f, 0x3317dd4c, 0xdcd5b672,
+    0x3e09ad0b, 0xd1cbc635, 0x3afc7d36, 0xd53e1608,
+    0x24354d85, 0xcbf726bb, 0x20c09db8, 0xcf02f686,
+    0x2ddeedff, 0xc21c86c1, 0x292b3dc2, 0xc6e956fc,
+    0x104c8c99, 0xff8ee7a7, 0x14b95ca4, 0xfb7b379a,
+    0x19a72ce3, 0xf66547dd, 0x1d52fcde, 0xf29097e0,
+    0x039bcc6d, 0xec59a753, 0x076e1c50, 0xe8ac776e,
+    0x0a706c17, 0xe5b20729, 0x0e85bc2a, 0xe147d714
+  },
+  {
+    0x00000000, 0xc18edfc0, 0x586cb9c1, 0x99e26601,
+    0xb0d97382, 0x7157ac42, 0xe8b5ca43, 0x293b1583,
+    0xbac3e145, 0x7b4d3e85, 0xe2af5884, 0x23218744,
+    0x0a1a92c7, 0xcb944d07, 0x52762b06, 0x93f8f4c6,
+    0xaef6c4cb, 0x6f781b0b, 0xf69a7d0a, 0x3714a2ca,
+    0x1e2fb749, 0xdfa16889, 0x46430e88, 0x87cdd148,
+    0x1435258e, 0xd5bbfa4e, 0x4c599c4f, 0x8dd7438f,
+    0xa4ec560c, 0x656289cc, 0xfc80efcd, 0x3d0e300d,
+    0x869c8fd7, 0x47125017, 0xdef03616, 0x1f7ee9d6,
+    0x3645fc55, 0xf7cb2395, 0x6e294594, 0xafa79a54,
+    0x3c5f6e92, 0xfdd1b152, 0x6433d753, 0xa5bd0893,
+    0x8c861d10, 0x4d08c2d0, 0xd4eaa4d1, 0x15647b11,
+    0x286a4b1c, 0xe9e494dc, 0x7006f2dd, 0xb1882d1d,
+    0x98b3389e, 0x593de75e, 0xc0df815f, 0x01515e9f,
+    0x92a9aa59, 0x53277599, 0xcac51398, 0x0b4bcc58,
+    0x2270d9db, 0xe3fe061b, 0x7a1c601a, 0xbb92bfda,
+    0xd64819ef, 0x17c6c62f, 0x8e24a02e, 0x4faa7fee,
+    0x66916a6d, 0xa71fb5ad, 0x3efdd3ac, 0xff730c6c,
+    0x6c8bf8aa, 0xad05276a, 0x34e7416b, 0xf5699eab,
+    0xdc528b28, 0x1ddc54e8, 0x843e32e9, 0x45b0ed29,
+    0x78bedd24, 0xb93002e4, 0x20d264e5, 0xe15cbb25,
+    0xc867aea6, 0x09e97166, 0x900b1767, 0x5185c8a7,
+    0xc27d3c61, 0x03f3e3a1, 0x9a1185a0, 0x5b9f5a60,
+    0x72a44fe3, 0xb32a9023, 0x2ac8f622, 0xeb4629e2,
+    0x50d49638, 0x915a49f8, 0x08b82ff9, 0xc936f039,
+    0xe00de5ba, 0x21833a7a, 0xb8615c7b, 0x79ef83bb,
+    0xea17777d, 0x2b99a8bd, 0xb27bcebc, 0x73f5117c,
+    0x5ace04ff, 0x9b40db3f, 0x02a2bd3e, 0xc32c62fe,
+    0xfe2252f3, 0x3fac8d33, 0xa64eeb32, 0x67c034f2,
+    0x4efb2171, 0x8f75feb1, 0x169798b0, 0xd7194770,
+    0x44e1b3b6, 0x856f6c76, 0x1c8d0a77, 0xdd03d5b7,
+    0xf438c034, 0x35b61ff4, 0xac5479f5, 0x6ddaa635,
+    0x77e1359f, 0xb66fea5f, 0x2f8d8c5e, 0xee03539e,
+    0xc738461d, 0x06b699dd, 0x9f54ffdc, 0x5eda201c,
+    0xcd22d4da, 0x0cac0b1a, 0x954e6d1b, 0x54c0b2db,
+    0x7dfba758, 0xbc757898, 0x25971e99, 0xe419c159,
+    0xd917f154, 0x18992e94, 0x817b4895, 0x40f59755,
+    0x69ce82d6, 0xa8405d16, 0x31a23b17, 0xf02ce4d7,
+    0x63d41011, 0xa25acfd1, 0x3bb8a9d0, 0xfa367610,
+    0xd30d6393, 0x1283bc53, 0x8b61da52, 0x4aef0592,
+    0xf17dba48, 0x30f36588, 0xa9110389, 0x689fdc49,
+    0x41a4c9ca, 0x802a160a, 0x19c8700b, 0xd846afcb,
+    0x4bbe5b0d, 0x8a3084cd, 0x13d2e2cc, 0xd25c3d0c,
+    0xfb67288f, 0x3ae9f74f, 0xa30b914e, 0x62854e8e,
+    0x5f8b7e83, 0x9e05a143, 0x07e7c742, 0xc6691882,
+    0xef520d01, 0x2edcd2c1, 0xb73eb4c0, 0x76b06b00,
+    0xe5489fc6, 0x24c64006, 0xbd242607, 0x7caaf9c7,
+    0x5591ec44, 0x941f3384, 0x0dfd5585, 0xcc738a45,
+    0xa1a92c70, 0x6027f3b0, 0xf9c595b1, 0x384b4a71,
+    0x11705ff2, 0xd0fe8032, 0x491ce633, 0x889239f3,
+    0x1b6acd35, 0xdae412f5, 0x430674f4, 0x8288ab34,
+    0xabb3beb7, 0x6a3d6177, 0xf3df0776, 0x3251d8b6,
+    0x0f5fe8bb, 0xced1377b, 0x5733517a, 0x96bd8eba,
+    0xbf869b39, 0x7e0844f9, 0xe7ea22f8, 0x2664fd38,
+    0xb59c09fe, 0x7412d63e, 0xedf0b03f, 0x2c7e6fff,
+    0x05457a7c, 0xc4cba5bc, 0x5d29c3bd, 0x9ca71c7d,
+    0x2735a3a7, 0xe6bb7c67, 0x7f591a66, 0xbed7c5a6,
+    0x97ecd025, 0x56620fe5, 0xcf8069e4, 0x0e0eb624,
+    0x9df642e2, 0x5c789d22, 0xc59afb23, 0x041424e3,
+    0x2d2f3160, 0xeca1eea0, 0x754388a1, 0xb4cd5761,
+    0x89c3676c, 0x484db8ac, 0xd1afdead, 0x1021016d,
+    0x391a14ee, 0xf894cb2e, 0x6176ad2f, 0xa0f872ef,
+    0x33008629, 0xf28e59e9, 0x6b6c3fe8, 0xaae2e028,
+    0x83d9f5ab, 0x42572a6b, 0xdbb54c6a, 0x1a3b93aa
+  },
+  {
+    0x00000000, 0x9ba54c6f, 0xec3b9e9f, 0x779ed2f0,
+    0x03063b7f, 0x98a37710, 0xef3da5e0, 0x7498e98f,
+    0x060c76fe, 0x9da93a91, 0xea37e861, 0x7192a40e,
+    0x050a4d81, 0x9eaf01ee, 0xe931d31e, 0x72949f71,
+    0x0c18edfc, 0x97bda193, 0xe0237363, 0x7b863f0c,
+    0x0f1ed683, 0x94bb9aec, 0xe325481c, 0x78800473,
+    0x0a149b02, 0x91b1d76d, 0xe62f059d, 0x7d8a49f2,
+    0x0912a07d, 0x92b7ec12, 0xe5293ee2, 0x7e8c728d,
+    0x1831dbf8, 0x83949797, 0xf40a4567, 0x6faf0908,
+    0x1b37e087, 0x8092ace8, 0xf70c7e18, 0x6ca93277,
+    0x1e3dad06, 0x8598e169, 0xf2063399, 0x69a37ff6,
+    0x1d3b9679, 0x869eda16, 0xf10008e6, 0x6aa54489,
+    0x14293604, 0x8f8c7a6b, 0xf812a89b, 0x63b7e4f4,
+    0x172f0d7b, 0x8c8a4114, 0xfb1493e4, 0x60b1df8b,
+    0x122540fa, 0x89800c95, 0xfe1ede65, 0x65bb920a,
+    0x11237b85, 0x8a8637ea, 0xfd18e51a, 0x66bda975,
+    0x3063b7f0, 0xabc6fb9f, 0xdc58296f, 0x47fd6500,
+    0x33658c8f, 0xa8c0c0e0, 0xdf5e1210, 0x44fb5e7f,
+    0x366fc10e, 0xadca8d61, 0xda545f91, 0x41f113fe,
+    0x3569fa71, 0xaeccb61e, 0xd95264ee, 0x42f72881,
+    0x3c7b5a0c, 0xa7de1663, 0xd040c493, 0x4be588fc,
+    0x3f7d6173, 0xa4d82d1c, 0xd346ffec, 0x48e3b383,
+    0x3a772cf2, 0xa1d2609d, 0xd64cb26d, 0x4de9fe02,
+    0x3971178d, 0xa2d45be2, 0xd54a8912, 0x4eefc57d,
+    0x28526c08, 0xb3f72067, 0xc469f297, 0x5fccbef8,
+    0x2b545777, 0xb0f11b18, 0xc76fc9e8, 0x5cca8587,
+    0x2e5e1af6, 0xb5fb5699, 0xc2658469, 0x59c0c806,
+    0x2d582189, 0xb6fd6de6, 0xc163bf16, 0x5ac6f379,
+    0x244a81f4, 0xbfefcd9b, 0xc8711f6b, 0x53d45304,
+    0x274cba8b, 0xbce9f6e4, 0xcb772414, 0x50d2687b,
+    0x2246f70a, 0xb9e3bb65, 0xce7d6995, 0x55d825fa,
+    0x2140cc75, 0xbae5801a, 0xcd7b52ea, 0x56de1e85,
+    0x60c76fe0, 0xfb62238f, 0x8cfcf17f, 0x1759bd10,
+    0x63c1549f, 0xf86418f0, 0x8ffaca00, 0x145f866f,
+    0x66cb191e, 0xfd6e5571, 0x8af08781, 0x1155cbee,
+    0x65cd2261, 0xfe686e0e, 0x89f6bcfe, 0x1253f091,
+    0x6cdf821c, 0xf77ace73, 0x80e41c83, 0x1b4150ec,
+    0x6fd9b963, 0xf47cf50c, 0x83e227fc, 0x18476b93,
+    0x6ad3f4e2, 0xf176b88d, 0x86e86a7d, 0x1d4d2612,
+    0x69d5cf9d, 0xf27083f2, 0x85ee5102, 0x1e4b1d6d,
+    0x78f6b418, 0xe353f877, 0x94cd2a87, 0x0f6866e8,
+    0x7bf08f67, 0xe055c308, 0x97cb11f8, 0x0c6e5d97,
+    0x7efac2e6, 0xe55f8e89, 0x92c15c79, 0x09641016,
+    0x7dfcf999, 0xe659b5f6, 0x91c76706, 0x0a622b69,
+    0x74ee59e4, 0xef4b158b, 0x98d5c77b, 0x03708b14,
+    0x77e8629b, 0xec4d2ef4, 0x9bd3fc04, 0x0076b06b,
+    0x72e22f1a, 0xe9476375, 0x9ed9b185, 0x057cfdea,
+    0x71e41465, 0xea41580a, 0x9ddf8afa, 0x067ac695,
+    0x50a4d810, 0xcb01947f, 0xbc9f468f, 0x273a0ae0,
+    0x53a2e36f, 0xc807af00, 0xbf997df0, 0x243c319f,
+    0x56a8aeee, 0xcd0de281, 0xba933071, 0x21367c1e,
+    0x55ae9591, 0xce0bd9fe, 0xb9950b0e, 0x22304761,
+    0x5cbc35ec, 0xc7197983, 0xb087ab73, 0x2b22e71c,
+    0x5fba0e93, 0xc41f42fc, 0xb381900c, 0x2824dc63,
+    0x5ab04312, 0xc1150f7d, 0xb68bdd8d, 0x2d2e91e2,
+    0x59b6786d, 0xc2133402, 0xb58de6f2, 0x2e28aa9d,
+    0x489503e8, 0xd3304f87, 0xa4ae9d77, 0x3f0bd118,
+    0x4b933897, 0xd03674f8, 0xa7a8a608, 0x3c0dea67,
+    0x4e997516, 0xd53c3979, 0xa2a2eb89, 0x3907a7e6,
+    0x4d9f4e69, 0xd63a0206, 0xa1a4d0f6, 0x3a019c99,
+    0x448dee14, 0xdf28a27b, 0xa8b6708b, 0x33133ce4,
+    0x478bd56b, 0xdc2e9904, 0xabb04bf4, 0x3015079b,
+    0x428198ea, 0xd924d485, 0xaeba0675, 0x351f4a1a,
+    0x4187a395, 0xda22effa, 0xadbc3d0a, 0x36197165
+  },
+  {
+    0x00000000, 0xdd96d985, 0x605cb54b, 0xbdca6cce,
+    0xc0b96a96, 0x1d2fb313, 0xa0e5dfdd, 0x7d730658,
+    0x5a03d36d, 0x87950ae8, 0x3a5f6626, 0xe7c9bfa3,
+    0x9abab9fb, 0x472c607e, 0xfae60cb0, 0x2770d535,
+    0xb407a6da, 0x69917f5f, 0xd45b1391, 0x09cdca14,
+    0x74becc4c, 0xa92815c9, 0x14e27907, 0xc974a082,
+    0xee0475b7, 0x3392ac32, 0x8e58c0fc, 0x53ce1979,
+    0x2ebd1f21, 0xf32bc6a4, 0x4ee1aa6a, 0x937773ef,
+    0xb37e4bf5, 0x6ee89270, 0xd322febe, 0x0eb4273b,
+    0x73c72163, 0xae51f8e6, 0x139b9428, 0xce0d4dad,
+    0xe97d9898, 0x34eb411d, 0x89212dd3, 0x54b7f456,
+    0x29c4f20e, 0xf4522b8b, 0x49984745, 0x940e9ec0,
+    0x0779ed2f, 0xdaef34aa, 0x67255864, 0xbab381e1,
+    0xc7c087b9, 0x1a565e3c, 0xa79c32f2, 0x7a0aeb77,
+    0x5d7a3e42, 0x80ece7c7, 0x3d268b09, 0xe0b0528c,
+    0x9dc354d4, 0x40558d51, 0xfd9fe19f, 0x2009381a,
+    0xbd8d91ab, 0x601b482e, 0xddd124e0, 0x0047fd65,
+    0x7d34fb3d, 0xa0a222b8, 0x1d684e76, 0xc0fe97f3,
+    0xe78e42c6, 0x3a189b43, 0x87d2f78d, 0x5a442e08,
+    0x27372850, 0xfaa1f1d5, 0x476b9d1b, 0x9afd449e,
+    0x098a3771, 0xd41ceef4, 0x69d6823a, 0xb4405bbf,
+    0xc9335de7, 0x14a58462, 0xa96fe8ac, 0x74f93129,
+    0x5389e41c, 0x8e1f3d99, 0x33d55157, 0xee4388d2,
+    0x93308e8a, 0x4ea6570f, 0xf36c3bc1, 0x2efae244,
+    0x0ef3da5e, 0xd36503db, 0x6eaf6f15, 0xb339b690,
+    0xce4ab0c8, 0x13dc694d, 0xae160583, 0x7380dc06,
+    0x54f00933, 0x8966d0b6, 0x34acbc78, 0xe93a65fd,
+    0x944963a5, 0x49dfba20, 0xf415d6ee, 0x29830f6b,
+    0xbaf47c84, 0x6762a501, 0xdaa8c9cf, 0x073e104a,
+    0x7a4d1612, 0xa7dbcf97, 0x1a11a359, 0xc7877adc,
+    0xe0f7afe9, 0x3d61766c, 0x80ab1aa2, 0x5d3dc327,
+    0x204ec57f, 0xfdd81cfa, 0x40127034, 0x9d84a9b1,
+    0xa06a2517, 0x7dfcfc92, 0xc036905c, 0x1da049d9,
+    0x60d34f81, 0xbd459604, 0x008ffaca, 0xdd19234f,
+    0xfa69f67a, 0x27ff2fff, 0x9a354331, 0x47a39ab4,
+    0x3ad09cec, 0xe7464569, 0x5a8c29a7, 0x871af022,
+    0x146d83cd, 0xc9fb5a48, 0x74313686, 0xa9a7ef03,
+    0xd4d4e95b, 0x094230de, 0xb4885c10, 0x691e8595,
+    0x4e6e50a0, 0x93f88925, 0x2e32e5eb, 0xf3a43c6e,
+    0x8ed73a36, 0x5341e3b3, 0xee8b8f7d, 0x331d56f8,
+    0x13146ee2, 0xce82b767, 0x7348dba9, 0xaede022c,
+    0xd3ad0474, 0x0e3bddf1, 0xb3f1b13f, 0x6e6768ba,
+    0x4917bd8f, 0x9481640a, 0x294b08c4, 0xf4ddd141,
+    0x89aed719, 0x54380e9c, 0xe9f26252, 0x3464bbd7,
+    0xa713c838, 0x7a8511bd, 0xc74f7d73, 0x1ad9a4f6,
+    0x67aaa2ae, 0xba3c7b2b, 0x07f617e5, 0xda60ce60,
+    0xfd101b55, 0x2086c2d0, 0x9d4cae1e, 0x40da779b,
+    0x3da971c3, 0xe03fa846, 0x5df5c488, 0x80631d0d,
+    0x1de7b4bc, 0xc0716d39, 0x7dbb01f7, 0xa02dd872,
+    0xdd5ede2a, 0x00c807af, 0xbd026b61, 0x6094b2e4,
+    0x47e467d1, 0x9a72be54, 0x27b8d29a, 0xfa2e0b1f,
+    0x875d0d47, 0x5acbd4c2, 0xe701b80c, 0x3a976189,
+    0xa9e01266, 0x7476cbe3, 0xc9bca72d, 0x142a7ea8,
+    0x695978f0, 0xb4cfa175, 0x0905cdbb, 0xd493143e,
+    0xf3e3c10b, 0x2e75188e, 0x93bf7440, 0x4e29adc5,
+    0x335aab9d, 0xeecc7218, 0x53061ed6, 0x8e90c753,
+    0xae99ff49, 0x730f26cc, 0xcec54a02, 0x13539387,
+    0x6e2095df, 0xb3b64c5a, 0x0e7c2094, 0xd3eaf911,
+    0xf49a2c24, 0x290cf5a1, 0x94c6996f, 0x495040ea,
+    0x342346b2, 0xe9b59f37, 0x547ff3f9, 0x89e92a7c,
+    0x1a9e5993, 0xc7088016, 0x7ac2ecd8, 0xa754355d,
+    0xda273305, 0x07b1ea80, 0xba7b864e, 0x67ed5fcb,
+    0x409d8afe, 0x9d0b537b, 0x20c13fb5, 0xfd57e630,
+    0x8024e068, 0x5db239ed, 0xe0785523, 0x3dee8ca6
+  },
+  {
+    0x00000000, 0x9d0fe176, 0xe16ec4ad, 0x7c6125db,
+    0x19ac8f1b, 0x84a36e6d, 0xf8c24bb6, 0x65cdaac0,
+    0x33591e36, 0xae56ff40, 0xd237da9b, 0x4f383bed,
+    0x2af5912d, 0xb7fa705b, 0xcb9b5580, 0x5694b4f6,
+    0x66b23c6c, 0xfbbddd1a, 0x87dcf8c1, 0x1ad319b7,
+    0x7f1eb377, 0xe2115201, 0x9e7077da, 0x037f96ac,
+    0x55eb225a, 0xc8e4c32c, 0xb485e6f7, 0x298a0781,
+    0x4c47ad41, 0xd1484c37, 0xad2969ec, 0x3026889a,
+    0xcd6478d8, 0x506b99ae, 0x2c0abc75, 0xb1055d03,
+    0xd4c8f7c3, 0x49c716b5, 0x35a6336e, 0xa8a9d218,
+    0xfe3d66ee, 0x63328798, 0x1f53a243, 0x825c4335,
+    0xe791e9f5, 0x7a9e0883, 0x06ff2d58, 0x9bf0cc2e,
+    0xabd644b4, 0x36d9a5c2, 0x4ab88019, 0xd7b7616f,
+    0xb27acbaf, 0x2f752ad9, 0x53140f02, 0xce1bee74,
+    0x988f5a82, 0x0580bbf4, 0x79e19e2f, 0xe4ee7f59,
+    0x8123d599, 0x1c2c34ef, 0x604d1134, 0xfd42f042,
+    0x41b9f7f1, 0xdcb61687, 0xa0d7335c, 0x3dd8d22a,
+    0x581578ea, 0xc51a999c, 0xb97bbc47, 0x24745d31,
+    0x72e0e9c7, 0xefef08b1, 0x938e2d6a, 0x0e81cc1c,
+    0x6b4c66dc, 0xf64387aa, 0x8a22a271, 0x172d4307,
+    0x270bcb9d, 0xba042aeb, 0xc6650f30, 0x5b6aee46,
+    0x3ea74486, 0xa3a8a5f0, 0xdfc9802b, 0x42c6615d,
+    0x1452d5ab, 0x895d34dd, 0xf53c1106, 0x6833f070,
+    0x0dfe5ab0, 0x90f1bbc6, 0xec909e1d, 0x719f7f6b,
+    0x8cdd8f29, 0x11d26e5f, 0x6db34b84, 0xf0bcaaf2,
+    0x95710032, 0x087ee144, 0x741fc49f, 0xe91025e9,
+    0xbf84911f, 0x228b7069, 0x5eea55b2, 0xc3e5b4c4,
+    0xa6281e04, 0x3b27ff72, 0x4746daa9, 0xda493bdf,
+    0xea6fb345, 0x77605233, 0x0b0177e8, 0x960e969e,
+    0xf3c33c5e, 0x6eccdd28, 0x12adf8f3, 0x8fa21985,
+    0xd936ad73, 0x44394c05, 0x385869de, 0xa55788a8,
+    0xc09a2268, 0x5d95c31e, 0x21f4e6c5, 0xbcfb07b3,
+    0x8373efe2, 0x1e7c0e94, 0x621d2b4f, 0xff12ca39,
+    0x9adf60f9, 0x07d0818f, 0x7bb1a454, 0xe6be4522,
+    0xb02af1d4, 0x2d2510a2, 0x51443579, 0xcc4bd40f,
+    0xa9867ecf, 0x34899fb9, 0x48e8ba62, 0xd5e75b14,
+    0xe5c1d38e, 0x78ce32f8, 0x04af1723, 0x99a0f655,
+    0xfc6d5c95, 0x6162bde3, 0x1d039838, 0x800c794e,
+    0xd698cdb8, 0x4b972cce, 0x37f60915, 0xaaf9e863,
+    0xcf3442a3, 0x523ba3d5, 0x2e5a860e, 0xb3556778,
+    0x4e17973a, 0xd318764c, 0xaf795397, 0x3276b2e1,
+    0x57bb1821, 0xcab4f957, 0xb6d5dc8c, 0x2bda3dfa,
+    0x7d4e890c, 0xe041687a, 0x9c204da1, 0x012facd7,
+    0x64e20617, 0xf9ede761, 0x858cc2ba, 0x188323cc,
+    0x28a5ab56, 0xb5aa4a20, 0xc9cb6ffb, 0x54c48e8d,
+    0x3109244d, 0xac06c53b, 0xd067e0e0, 0x4d680196,
+    0x1bfcb560, 0x86f35416, 0xfa9271cd, 0x679d90bb,
+    0x02503a7b, 0x9f5fdb0d, 0xe33efed6, 0x7e311fa0,
+    0xc2ca1813, 0x5fc5f965, 0x23a4dcbe, 0xbeab3dc8,
+    0xdb669708, 0x4669767e, 0x3a0853a5, 0xa707b2d3,
+    0xf1930625, 0x6c9ce753, 0x10fdc288, 0x8df223fe,
+    0xe83f893e, 0x75306848, 0x09514d93, 0x945eace5,
+    0xa478247f, 0x3977c509, 0x4516e0d2, 0xd81901a4,
+    0xbdd4ab64, 0x20db4a12, 0x5cba6fc9, 0xc1b58ebf,
+    0x97213a49, 0x0a2edb3f, 0x764ffee4, 0xeb401f92,
+    0x8e8db552, 0x13825424, 0x6fe371ff, 0xf2ec9089,
+    0x0fae60cb, 0x92a181bd, 0xeec0a466, 0x73cf4510,
+    0x1602efd0, 0x8b0d0ea6, 0xf76c2b7d, 0x6a63ca0b,
+    0x3cf77efd, 0xa1f89f8b, 0xdd99ba50, 0x40965b26,
+    0x255bf1e6, 0xb8541090, 0xc435354b, 0x593ad43d,
+    0x691c5ca7, 0xf413bdd1, 0x8872980a, 0x157d797c,
+    0x70b0d3bc, 0xedbf32ca, 0x91de1711, 0x0cd1f667,
+    0x5a454291, 0xc74aa3e7, 0xbb2b863c, 0x2624674a,
+    0x43e9cd8a, 0xdee62cfc, 0xa2870927, 0x3f88e851
+  },
+  {
+    0x00000000, 0xb9fbdbe8, 0xa886b191, 0x117d6a79,
+    0x8a7c6563, 0x3387be8b, 0x22fad4f2, 0x9b010f1a,
+    0xcf89cc87, 0x7672176f, 0x670f7d16, 0xdef4a6fe,
+    0x45f5a9e4, 0xfc0e720c, 0xed731875, 0x5488c39d,
+    0x44629f4f, 0xfd9944a7, 0xece42ede, 0x551ff536,
+    0xce1efa2c, 0x77e521c4, 0x66984bbd, 0xdf639055,
+    0x8beb53c8, 0x32108820, 0x236de259, 0x9a9639b1,
+    0x019736ab, 0xb86ced43, 0xa911873a, 0x10ea5cd2,
+    0x88c53e9e, 0x313ee576, 0x20438f0f, 0x99b854e7,
+    0x02b95bfd, 0xbb428015, 0xaa3fea6c, 0x13c43184,
+    0x474cf219, 0xfeb729f1, 0xefca4388, 0x56319860,
+    0xcd30977a, 0x74cb4c92, 0x65b626eb, 0xdc4dfd03,
+    0xcca7a1d1, 0x755c7a39, 0x64211040, 0xdddacba8,
+    0x46dbc4b2, 0xff201f5a, 0xee5d7523, 0x57a6aecb,
+    0x032e6d56, 0xbad5b6be, 0xaba8dcc7, 0x1253072f,
+    0x89520835, 0x30a9d3dd, 0x21d4b9a4, 0x982f624c,
+    0xcafb7b7d, 0x7300a095, 0x627dcaec, 0xdb861104,
+    0x40871e1e, 0xf97cc5f6, 0xe801af8f, 0x51fa7467,
+    0x0572b7fa, 0xbc896c12, 0xadf4066b, 0x140fdd83,
+    0x8f0ed299, 0x36f50971, 0x27886308, 0x9e73b8e0,
+    0x8e99e432, 0x37623fda, 0x261f55a3, 0x9fe48e4b,
+    0x04e58151, 0xbd1e5ab9, 0xac6330c0, 0x1598eb28,
+    0x411028b5, 0xf8ebf35d, 0xe9969924, 0x506d42cc,
+    0xcb6c4dd6, 0x7297963e, 0x63eafc47, 0xda1127af,
+    0x423e45e3, 0xfbc59e0b, 0xeab8f472, 0x53432f9a,
+    0xc8422080, 0x71b9fb68, 0x60c49111, 0xd93f4af9,
+    0x8db78964, 0x344c528c, 0x253138f5, 0x9ccae31d,
+    0x07cbec07, 0xbe3037ef, 0xaf4d5d96, 0x16b6867e,
+    0x065cdaac, 0xbfa70144, 0xaeda6b3d, 0x1721b0d5,
+    0x8c20bfcf, 0x35db6427, 0x24a60e5e, 0x9d5dd5b6,
+    0xc9d5162b, 0x702ecdc3, 0x6153a7ba, 0xd8a87c52,
+    0x43a97348, 0xfa52a8a0, 0xeb2fc2d9, 0x52d41931,
+    0x4e87f0bb, 0xf77c2b53, 0xe601412a, 0x5ffa9ac2,
+    0xc4fb95d8, 0x7d004e30, 0x6c7d2449, 0xd586ffa1,
+    0x810e3c3c, 0x38f5e7d4, 0x29888dad, 0x90735645,
+    0x0b72595f, 0xb28982b7, 0xa3f4e8ce, 0x1a0f3326,
+    0x0ae56ff4, 0xb31eb41c, 0xa263de65, 0x1b98058d,
+    0x80990a97, 0x3962d17f, 0x281fbb06, 0x91e460ee,
+    0xc56ca373, 0x7c97789b, 0x6dea12e2, 0xd411c90a,
+    0x4f10c610, 0xf6eb1df8, 0xe7967781, 0x5e6dac69,
+    0xc642ce25, 0x7fb915cd, 0x6ec47fb4, 0xd73fa45c,
+    0x4c3eab46, 0xf5c570ae, 0xe4b81ad7, 0x5d43c13f,
+    0x09cb02a2, 0xb030d94a, 0xa14db333, 0x18b668db,
+    0x83b767c1, 0x3a4cbc29, 0x2b31d650, 0x92ca0db8,
+    0x8220516a, 0x3bdb8a82, 0x2aa6e0fb, 0x935d3b13,
+    0x085c3409, 0xb1a7efe1, 0xa0da8598, 0x19215e70,
+    0x4da99ded, 0xf4524605, 0xe52f2c7c, 0x5cd4f794,
+    0xc7d5f88e, 0x7e2e2366, 0x6f53491f, 0xd6a892f7,
+    0x847c8bc6, 0x3d87502e, 0x2cfa3a57, 0x9501e1bf,
+    0x0e00eea5, 0xb7fb354d, 0xa6865f34, 0x1f7d84dc,
+    0x4bf54741, 0xf20e9ca9, 0xe373f6d0, 0x5a882d38,
+    0xc1892222, 0x7872f9ca, 0x690f93b3, 0xd0f4485b,
+    0xc01e1489, 0x79e5cf61, 0x6898a518, 0xd1637ef0,
+    0x4a6271ea, 0xf399aa02, 0xe2e4c07b, 0x5b1f1b93,
+    0x0f97d80e, 0xb66c03e6, 0xa711699f, 0x1eeab277,
+    0x85ebbd6d, 0x3c106685, 0x2d6d0cfc, 0x9496d714,
+    0x0cb9b558, 0xb5426eb0, 0xa43f04c9, 0x1dc4df21,
+    0x86c5d03b, 0x3f3e0bd3, 0x2e4361aa, 0x97b8ba42,
+    0xc33079df, 0x7acba237, 0x6bb6c84e, 0xd24d13a6,
+    0x494c1cbc, 0xf0b7c754, 0xe1caad2d, 0x583176c5,
+    0x48db2a17, 0xf120f1ff, 0xe05d9b86, 0x59a6406e,
+    0xc2a74f74, 0x7b5c949c, 0x6a21fee5, 0xd3da250d,
+    0x8752e690, 0x3ea93d78, 0x2fd45701, 0x962f8ce9,
+    0x0d2e83f3, 0xb4d5581b, 0xa5a83262, 0x1c53e98a
+  },
+  {
+    0x00000000, 0xae689191, 0x87a02563, 0x29c8b4f2,
+    0xd4314c87, 0x7a59dd16, 0x539169e4, 0xfdf9f875,
+    0x73139f4f, 0xdd7b0ede, 0xf4b3ba2c, 0x5adb2bbd,
+    0xa722d3c8, 0x094a4259, 0x2082f6ab, 0x8eea673a,
+    0xe6273e9e, 0x484faf0f, 0x61871bfd, 0xcfef8a6c,
+    0x32167219, 0x9c7ee388, 0xb5b6577a, 0x1bdec6eb,
+    0x9534a1d1, 0x3b5c3040, 0x129484b2, 0xbcfc1523,
+    0x4105ed56, 0xef6d7cc7, 0xc6a5c835, 0x68cd59a4,
+    0x173f7b7d, 0xb957eaec, 0x909f5e1e, 0x3ef7cf8f,
+    0xc30e37fa, 0x6d66a66b, 0x44ae1299, 0xeac68308,
+    0x642ce432, 0xca4475a3, 0xe38cc151, 0x4de450c0,
+    0xb01da8b5, 0x1e753924, 0x37bd8dd6, 0x99d51c47,
+    0xf11845e3, 0x5f70d472, 0x76b86080, 0xd8d0f111,
+    0x25290964, 0x8b4198f5, 0xa2892c07, 0x0ce1bd96,
+    0x820bdaac, 0x2c634b3d, 0x05abffcf, 0xabc36e5e,
+    0x563a962b, 0xf85207ba, 0xd19ab348, 0x7ff222d9,
+    0x2e7ef6fa, 0x8016676b, 0xa9ded399, 0x07b64208,
+    0xfa4fba7d, 0x54272bec, 0x7def9f1e, 0xd3870e8f,
+    0x5d6d69b5, 0xf305f824, 0xdacd4cd6, 0x74a5dd47,
+    0x895c2532, 0x2734b4a3, 0x0efc0051, 0xa09491c0,
+    0xc859c864, 0x663159f5, 0x4ff9ed07, 0xe1917c96,
+    0x1c6884e3, 0xb2001572, 0x9bc8a180, 0x35a03011,
+    0xbb4a572b, 0x1522c6ba, 0x3cea7248, 0x9282e3d9,
+    0x6f7b1bac, 0xc1138a3d, 0xe8db3ecf, 0x46b3af5e,
+    0x39418d87, 0x97291c16, 0xbee1a8e4, 0x10893975,
+    0xed70c100, 0x43185091, 0x6ad0e463, 0xc4b875f2,
+    0x4a5212c8, 0xe43a8359, 0xcdf237ab, 0x639aa63a,
+    0x9e635e4f, 0x300bcfde, 0x19c37b2c, 0xb7abeabd,
+    0xdf66b319, 0x710e2288, 0x58c6967a, 0xf6ae07eb,
+    0x0b57ff9e, 0xa53f6e0f, 0x8cf7dafd, 0x229f4b6c,
+    0xac752c56, 0x021dbdc7, 0x2bd50935, 0x85bd98a4,
+    0x784460d1, 0xd62cf140, 0xffe445b2, 0x518cd423,
+    0x5cfdedf4, 0xf2957c65, 0xdb5dc897, 0x75355906,
+    0x88cca173, 0x26a430e2, 0x0f6c8410, 0xa1041581,
+    0x2fee72bb, 0x8186e32a, 0xa84e57d8, 0x0626c649,
+    0xfbdf3e3c, 0x55b7afad, 0x7c7f1b5f, 0xd2178ace,
+    0xbadad36a, 0x14b242fb, 0x3d7af609, 0x93126798,
+    0x6eeb9fed, 0xc0830e7c, 0xe94bba8e, 0x47232b1f,
+    0xc9c94c25, 0x67a1ddb4, 0x4e696946, 0xe001f8d7,
+    0x1df800a2, 0xb3909133, 0x9a5825c1, 0x3430b450,
+    0x4bc29689, 0xe5aa0718, 0xcc62b3ea, 0x620a227b,
+    0x9ff3da0e, 0x319b4b9f, 0x1853ff6d, 0xb63b6efc,
+    0x38d109c6, 0x96b99857, 0xbf712ca5, 0x1119bd34,
+    0xece04541, 0x4288d4d0, 0x6b406022, 0xc528f1b3,
+    0xade5a817, 0x038d3986, 0x2a458d74, 0x842d1ce5,
+    0x79d4e490, 0xd7bc7501, 0xfe74c1f3, 0x501c5062,
+    0xdef63758, 0x709ea6c9, 0x5956123b, 0xf73e83aa,
+    0x0ac77bdf, 0xa4afea4e, 0x8d675ebc, 0x230fcf2d,
+    0x72831b0e, 0xdceb8a9f, 0xf5233e6d, 0x5b4baffc,
+    0xa6b25789, 0x08dac618, 0x211272ea, 0x8f7ae37b,
+    0x01908441, 0xaff815d0, 0x8630a122, 0x285830b3,
+    0xd5a1c8c6, 0x7bc95957, 0x5201eda5, 0xfc697c34,
+    0x94a42590, 0x3accb401, 0x130400f3, 0xbd6c9162,
+    0x40956917, 0xeefdf886, 0xc7354c74, 0x695ddde5,
+    0xe7b7badf, 0x49df2b4e, 0x60179fbc, 0xce7f0e2d,
+    0x3386f658, 0x9dee67c9, 0xb426d33b, 0x1a4e42aa,
+    0x65bc6073, 0xcbd4f1e2, 0xe21c4510, 0x4c74d481,
+    0xb18d2cf4, 0x1fe5bd65, 0x362d0997, 0x98459806,
+    0x16afff3c, 0xb8c76ead, 0x910fda5f, 0x3f674bce,
+    0xc29eb3bb, 0x6cf6222a, 0x453e96d8, 0xeb560749,
+    0x839b5eed, 0x2df3cf7c, 0x043b7b8e, 0xaa53ea1f,
+    0x57aa126a, 0xf9c283fb, 0xd00a3709, 0x7e62a698,
+    0xf088c1a2, 0x5ee05033, 0x7728e4c1, 0xd9407550,
+    0x24b98d25, 0x8ad11cb4, 0xa319a846, 0x0d7139d7
+  },
+#endif
+};
+#endif
+
+#if (CRCSW_CRC16_TABLE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   CRC16 lookup table, reflected polynomial 0x8005.
+ */
+static const uint32_t crc16_table[CRCSW_SLICE_BY][256] = {
+  {
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+  },
+#if CRCSW_SLICE_BY >= 4
+  {
+    0x0000, 0x9001, 0x6001, 0xF000, 0xC002, 0x5003, 0xA003, 0x3002,
+    0xC007, 0x5006, 0xA006, 0x3007, 0x0005, 0x9004, 0x6004, 0xF005,
+    0xC00D, 0x500C, 0xA00C, 0x300D, 0x000F, 0x900E, 0x600E, 0xF00F,
+    0x000A, 0x900B, 0x600B, 0xF00A, 0xC008, 0x5009, 0xA009, 0x3008,
+    0xC019, 0x5018, 0xA018, 0x3019, 0x001B, 0x901A, 0x601A, 0xF01B,
+    0x001E, 0x901F, 0x601F, 0xF01E, 0xC01C, 0x501D, 0xA01D, 0x301C,
+    0x0014, 0x9015, 0x6015, 0xF014, 0xC016, 0x5017, 0xA017, 0x3016,
+    0xC013, 0x5012, 0xA012, 0x3013, 0x0011, 0x9010, 0x6010, 0xF011,
+    0xC031, 0x5030, 0xA030, 0x3031, 0x0033, 0x9032, 0x6032, 0xF033,
+    0x0036, 0x9037, 0x6037, 0xF036, 0xC034, 0x5035, 0xA035, 0x3034,
+    0x003C, 0x903D, 0x603D, 0xF03C, 0xC03E, 0x503F, 0xA03F, 0x303E,
+    0xC03B, 0x503A, 0xA03A, 0x303B, 0x0039, 0x9038, 0x6038, 0xF039,
+    0x0028, 0x9029, 0x6029, 0xF028, 0xC02A, 0x502B, 0xA02B, 0x302A,
+    0xC02F, 0x502E, 0xA02E, 0x302F, 0x002D, 0x902C, 0x602C, 0xF02D,
+    0xC025, 0x5024, 0xA024, 0x3025, 0x0027, 0x9026, 0x6026, 0xF027,
+    0x0022, 0x9023, 0x6023, 0xF022, 0xC020, 0x5021, 0xA021, 0x3020,
+    0xC061, 0x5060, 0xA060, 0x3061, 0x0063, 0x9062, 0x6062, 0xF063,
+    0x0066, 0x9067, 0x6067, 0xF066, 0xC064, 0x5065, 0xA065, 0x3064,
+    0x006C, 0x906D, 0x606D, 0xF06C, 0xC06E, 0x506F, 0xA06F, 0x306E,
+    0xC06B, 0x506A, 0xA06A, 0x306B, 0x0069, 0x9068, 0x6068, 0xF069,
+    0x0078, 0x9079, 0x6079, 0xF078, 0xC07A, 0x507B, 0xA07B, 0x307A,
+    0xC07F, 0x507E, 0xA07E, 0x307F, 0x007D, 0x907C, 0x607C, 0xF07D,
+    0xC075, 0x5074, 0xA074, 0x3075, 0x0077, 0x9076, 0x6076, 0xF077,
+    0x0072, 0x9073, 0x6073, 0xF072, 0xC070, 0x5071, 0xA071, 0x3070,
+    0x0050, 0x9051, 0x6051, 0xF050, 0xC052, 0x5053, 0xA053, 0x3052,
+    0xC057, 0x5056, 0xA056, 0x3057, 0x0055, 0x9054, 0x6054, 0xF055,
+    0xC05D, 0x505C, 0xA05C, 0x305D, 0x005F, 0x905E, 0x605E, 0xF05F,
+    0x005A, 0x905B, 0x605B, 0xF05A, 0xC058, 0x5059, 0xA059, 0x3058,
+    0xC049, 0x5048, 0xA048, 0x3049, 0x004B, 0x904A, 0x604A, 0xF04B,
+    0x004E, 0x904F, 0x604F, 0xF04E, 0xC04C, 0x504D, 0xA04D, 0x304C,
+    0x0044, 0x9045, 0x6045, 0xF044, 0xC046, 0x5047, 0xA047, 0x3046,
+    0xC043, 0x5042, 0xA042, 0x3043, 0x0041, 0x9040, 0x6040, 0xF041
+  },
+  {
+    0x0000, 0xC051, 0xC0A1, 0x00F0, 0xC141, 0x0110, 0x01E0, 0xC1B1,
+    0xC281, 0x02D0, 0x0220, 0xC271, 0x03C0, 0xC391, 0xC361, 0x0330,
+    0xC501, 0x0550, 0x05A0, 0xC5F1, 0x0440, 0xC411, 0xC4E1, 0x04B0,
+    0x0780, 0xC7D1, 0xC721, 0x0770, 0xC6C1, 0x0690, 0x0660, 0xC631,
+    0xCA01, 0x0A50, 0x0AA0, 0xCAF1, 0x0B40, 0xCB11, 0xCBE1, 0x0BB0,
+    0x0880, 0xC8D1, 0xC821, 0x0870, 0xC9C1, 0x0990, 0x0960, 0xC931,
+    0x0F00, 0xCF51, 0xCFA1, 0x0FF0, 0xCE41, 0x0E10, 0x0EE0, 0xCEB1,
+    0xCD81, 0x0DD0, 0x0D20, 0xCD71, 0x0CC0, 0xCC91, 0xCC61, 0x0C30,
+    0xD401, 0x1450, 0x14A0, 0xD4F1, 0x1540, 0xD511, 0xD5E1, 0x15B0,
+    0x1680, 0xD6D1, 0xD621, 0x1670, 0xD7C1, 0x1790, 0x1760, 0xD731,
+    0x1100, 0xD151, 0xD1A1, 0x11F0, 0xD041, 0x1010, 0x10E0, 0xD0B1,
+    0xD381, 0x13D0, 0x1320, 0xD371, 0x12C0, 0xD291, 0xD261, 0x1230,
+    0x1E00, 0xDE51, 0xDEA1, 0x1EF0, 0xDF41, 0x1F10, 0x1FE0, 0xDFB1,
+    0xDC81, 0x1CD0, 0x1C20, 0xDC71, 0x1DC0, 0xDD91, 0xDD61, 0x1D30,
+    0xDB01, 0x1B50, 0x1BA0, 0xDBF1, 0x1A40, 0xDA11, 0xDAE1, 0x1AB0,
+    0x1980, 0xD9D1, 0xD921, 0x1970, 0xD8C1, 0x1890, 0x1860, 0xD831,
+    0xE801, 0x2850, 0x28A0, 0xE8F1, 0x2940, 0xE911, 0xE9E1, 0x29B0,
+    0x2A80, 0xEAD1, 0xEA21, 0x2A70, 0xEBC1, 0x2B90, 0x2B60, 0xEB31,
+    0x2D00, 0xED51, 0xEDA1, 0x2DF0, 0xEC41, 0x2C10, 0x2CE0, 0xECB1,
+    0xEF81, 0x2FD0, 0x2F20, 0xEF71, 0x2EC0, 0xEE91, 0xEE61, 0x2E30,
+    0x2200, 0xE251, 0xE2A1, 0x22F0, 0xE341, 0x2310, 0x23E0, 0xE3B1,
+    0xE081, 0x20D0, 0x2020, 0xE071, 0x21C0, 0xE191, 0xE161, 0x2130,
+    0xE701, 0x2750, 0x27A0, 0xE7F1, 0x2640, 0xE611, 0xE6E1, 0x26B0,
+    0x2580, 0xE5D1, 0xE521, 0x2570, 0xE4C1, 0x2490, 0x2460, 0xE431,
+    0x3C00, 0xFC51, 0xFCA1, 0x3CF0, 0xFD41, 0x3D10, 0x3DE0, 0xFDB1,
+    0xFE81, 0x3ED0, 0x3E20, 0xFE71, 0x3FC0, 0xFF91, 0xFF61, 0x3F30,
+    0xF901, 0x3950, 0x39A0, 0xF9F1, 0x3840, 0xF811, 0xF8E1, 0x38B0,
+    0x3B80, 0xFBD1, 0xFB21, 0x3B70, 0xFAC1, 0x3A90, 0x3A60, 0xFA31,
+    0xF601, 0x3650, 0x36A0, 0xF6F1, 0x3740, 0xF711, 0xF7E1, 0x37B0,
+    0x3480, 0xF4D1, 0xF421, 0x3470, 0xF5C1, 0x3590, 0x3560, 0xF531,
+    0x3300, 0xF351, 0xF3A1, 0x33F0, 0xF241, 0x3210, 0x32E0, 0xF2B1,
+    0xF181, 0x31D0, 0x3120, 0xF171, 0x30C0, 0xF091, 0xF061, 0x3030
+  },
+  {
+    0x0000, 0xFC01, 0xB801, 0x4400, 0x3001, 0xCC00, 0x8800, 0x7401,
+    0x6002, 0x9C03, 0xD803, 0x2402, 0x5003, 0xAC02, 0xE802, 0x1403,
+    0xC004, 0x3C05, 0x7805, 0x8404, 0xF005, 0x0C04, 0x4804, 0xB405,
+    0xA006, 0x5C07, 0x1807, 0xE406, 0x9007, 0x6C06, 0x2806, 0xD407,
+    0xC00B, 0x3C0A, 0x780A, 0x840B, 0xF00A, 0x0C0B, 0x480B, 0xB40A,
+    0xA009, 0x5C08, 0x1808, 0xE409, 0x9008, 0x6C09, 0x2809, 0xD408,
+    0x000F, 0xFC0E, 0xB80E, 0x440F, 0x300E, 0xCC0F, 0x880F, 0x740E,
+    0x600D, 0x9C0C, 0xD80C, 0x240D, 0x500C, 0xAC0D, 0xE80D, 0x140C,
+    0xC015, 0x3C14, 0x7814, 0x8415, 0xF014, 0x0C15, 0x4815, 0xB414,
+    0xA017, 0x5C16, 0x1816, 0xE417, 0x9016, 0x6C17, 0x2817, 0xD416,
+    0x0011, 0xFC10, 0xB810, 0x4411, 0x3010, 0xCC11, 0x8811, 0x7410,
+    0x6013, 0x9C12, 0xD812, 0x2413, 0x5012, 0xAC13, 0xE813, 0x1412,
+    0x001E, 0xFC1F, 0xB81F, 0x441E, 0x301F, 0xCC1E, 0x881E, 0x741F,
+    0x601C, 0x9C1D, 0xD81D, 0x241C, 0x501D, 0xAC1C, 0xE81C, 0x141D,
+    0xC01A, 0x3C1B, 0x781B, 0x841A, 0xF01B, 0x0C1A, 0x481A, 0xB41B,
+    0xA018, 0x5C19, 0x1819, 0xE418, 0x9019, 0x6C18, 0x2818, 0xD419,
+    0xC029, 0x3C28, 0x7828, 0x8429, 0xF028, 0x0C29, 0x4829, 0xB428,
+    0xA02B, 0x5C2A, 0x182A, 0xE42B, 0x902A, 0x6C2B, 0x282B, 0xD42A,
+    0x002D, 0xFC2C, 0xB82C, 0x442D, 0x302C, 0xCC2D, 0x882D, 0x742C,
+    0x602F, 0x9C2E, 0xD82E, 0x242F, 0x502E, 0xAC2F, 0xE82F, 0x142E,
+    0x0022, 0xFC23, 0xB823, 0x4422, 0x3023, 0xCC22, 0x8822, 0x7423,
+    0x6020, 0x9C21, 0xD821, 0x2420, 0x5021, 0xAC20, 0xE820, 0x1421,
+    0xC026, 0x3C27, 0x7827, 0x8426, 0xF027, 0x0C26, 0x4826, 0xB427,
+    0xA024, 0x5C25, 0x1825, 0xE424, 0x9025, 0x6C24, 0x2824, 0xD425,
+    0x003C, 0xFC3D, 0xB83D, 0x443C, 0x303D, 0xCC3C, 0x883C, 0x743D,
+    0x603E, 0x9C3F, 0xD83F, 0x243E, 0x503F, 0xAC3E, 0xE83E, 0x143F,
+    0xC038, 0x3C39, 0x7839, 0x8438, 0xF039, 0x0C38, 0x4838, 0xB439,
+    0xA03A, 0x5C3B, 0x183B, 0xE43A, 0x903B, 0x6C3A, 0x283A, 0xD43B,
+    0xC037, 0x3C36, 0x7836, 0x8437, 0xF036, 0x0C37, 0x4837, 0xB436,
+    0xA035, 0x5C34, 0x1834, 0xE435, 0x9034, 0x6C35, 0x2835, 0xD434,
+    0x0033, 0xFC32, 0xB832, 0x4433, 0x3032, 0xCC33, 0x8833, 0x7432,
+    0x6031, 0x9C30, 0xD830, 0x2431, 0x5030, 0xAC31, 0xE831, 0x1430
+  },
+#endif
+#if CRCSW_SLICE_BY >= 8
+  {
+    0x0000, 0xC03D, 0xC079, 0x0044, 0xC0F1, 0x00CC, 0x0088, 0xC0B5,
+    0xC1E1, 0x01DC, 0x0198, 0xC1A5, 0x0110, 0xC12D, 0xC169, 0x0154,
+    0xC3C1, 0x03FC, 0x03B8, 0xC385, 0x0330, 0xC30D, 0xC349, 0x0374,
+    0x0220, 0xC21D, 0xC259, 0x0264, 0xC2D1, 0x02EC, 0x02A8, 0xC295,
+    0xC781, 0x07BC, 0x07F8, 0xC7C5, 0x0770, 0xC74D, 0xC709, 0x0734,
+    0x0660, 0xC65D, 0xC619, 0x0624, 0xC691, 0x06AC, 0x06E8, 0xC6D5,
+    0x0440, 0xC47D, 0xC439, 0x0404, 0xC4B1, 0x048C, 0x04C8, 0xC4F5,
+    0xC5A1, 0x059C, 0x05D8, 0xC5E5, 0x0550, 0xC56D, 0xC529, 0x0514,
+    0xCF01, 0x0F3C, 0x0F78, 0xCF45, 0x0FF0, 0xCFCD, 0xCF89, 0x0FB4,
+    0x0EE0, 0xCEDD, 0xCE99, 0x0EA4, 0xCE11, 0x0E2C, 0x0E68, 0xCE55,
+    0x0CC0, 0xCCFD, 0xCCB9, 0x0C84, 0xCC31, 0x0C0C, 0x0C48, 0xCC75,
+    0xCD21, 0x0D1C, 0x0D58, 0xCD65, 0x0DD0, 0xCDED, 0xCDA9, 0x0D94,
+    0x0880, 0xC8BD, 0xC8F9, 0x08C4, 0xC871, 0x084C, 0x0808, 0xC835,
+    0xC961, 0x095C, 0x0918, 0xC925, 0x0990, 0xC9AD, 0xC9E9, 0x09D4,
+    0xCB41, 0x0B7C, 0x0B38, 0xCB05, 0x0BB0, 0xCB8D, 0xCBC9, 0x0BF4,
+    0x0AA0, 0xCA9D, 0xCAD9, 0x0AE4, 0xCA51, 0x0A6C, 0x0A28, 0xCA15,
+    0xDE01, 0x1E3C, 0x1E78, 0xDE45, 0x1EF0, 0xDECD, 0xDE89, 0x1EB4,
+    0x1FE0, 0xDFDD, 0xDF99, 0x1FA4, 0xDF11, 0x1F2C, 0x1F68, 0xDF55,
+    0x1DC0, 0xDDFD, 0xDDB9, 0x1D84, 0xDD31, 0x1D0C, 0x1D48, 0xDD75,
+    0xDC21, 0x1C1C, 0x1C58, 0xDC65, 0x1CD0, 0xDCED, 0xDCA9, 0x1C94,
+    0x1980, 0xD9BD, 0xD9F9, 0x19C4, 0xD971, 0x194C, 0x1908, 0xD935,
+    0xD861, 0x185C, 0x1818, 0xD825, 0x1890, 0xD8AD, 0xD8E9, 0x18D4,
+    0xDA41, 0x1A7C, 0x1A38, 0xDA05, 0x1AB0, 0xDA8D, 0xDAC9, 0x1AF4,
+    0x1BA0, 0xDB9D, 0xDBD9, 0x1BE4, 0xDB51, 0x1B6C, 0x1B28, 0xDB15,
+    0x1100, 0xD13D, 0xD179, 0x1144, 0xD1F1, 0x11CC, 0x1188, 0xD1B5,
+    0xD0E1, 0x10DC, 0x1098, 0xD0A5, 0x1010, 0xD02D, 0xD069, 0x1054,
+    0xD2C1, 0x12FC, 0x12B8, 0xD285, 0x1230, 0xD20D, 0xD249, 0x1274,
+    0x1320, 0xD31D, 0xD359, 0x1364, 0xD3D1, 0x13EC, 0x13A8, 0xD395,
+    0xD681, 0x16BC, 0x16F8, 0xD6C5, 0x1670, 0xD64D, 0xD609, 0x1634,
+    0x1760, 0xD75D, 0xD719, 0x1724, 0xD791, 0x17AC, 0x17E8, 0xD7D5,
+    0x1540, 0xD57D, 0xD539, 0x1504, 0xD5B1, 0x158C, 0x15C8, 0xD5F5,
+    0xD4A1, 0x149C, 0x14D8, 0xD4E5, 0x1450, 0xD46D, 0xD429, 0x1414
+  },
+  {
+    0x0000, 0xD101, 0xE201, 0x3300, 0x8401, 0x5500, 0x6600, 0xB701,
+    0x4801, 0x9900, 0xAA00, 0x7B01, 0xCC00, 0x1D01, 0x2E01, 0xFF00,
+    0x9002, 0x4103, 0x7203, 0xA302, 0x1403, 0xC502, 0xF602, 0x2703,
+    0xD803, 0x0902, 0x3A02, 0xEB03, 0x5C02, 0x8D03, 0xBE03, 0x6F02,
+    0x6007, 0xB106, 0x8206, 0x5307, 0xE406, 0x3507, 0x0607, 0xD706,
+    0x2806, 0xF907, 0xCA07, 0x1B06, 0xAC07, 0x7D06, 0x4E06, 0x9F07,
+    0xF005, 0x2104, 0x1204, 0xC305, 0x7404, 0xA505, 0x9605, 0x4704,
+    0xB804, 0x6905, 0x5A05, 0x8B04, 0x3C05, 0xED04, 0xDE04, 0x0F05,
+    0xC00E, 0x110F, 0x220F, 0xF30E, 0x440F, 0x950E, 0xA60E, 0x770F,
+    0x880F, 0x590E, 0x6A0E, 0xBB0F, 0x0C0E, 0xDD0F, 0xEE0F, 0x3F0E,
+    0x500C, 0x810D, 0xB20D, 0x630C, 0xD40D, 0x050C, 0x360C, 0xE70D,
+    0x180D, 0xC90C, 0xFA0C, 0x2B0D, 0x9C0C, 0x4D0D, 0x7E0D, 0xAF0C,
+    0xA009, 0x7108, 0x4208, 0x9309, 0x2408, 0xF509, 0xC609, 0x1708,
+    0xE808, 0x3909, 0x0A09, 0xDB08, 0x6C09, 0xBD08, 0x8E08, 0x5F09,
+    0x300B, 0xE10A, 0xD20A, 0x030B, 0xB40A, 0x650B, 0x560B, 0x870A,
+    0x780A, 0xA90B, 0x9A0B, 0x4B0A, 0xFC0B, 0x2D0A, 0x1E0A, 0xCF0B,
+    0xC01F, 0x111E, 0x221E, 0xF31F, 0x441E, 0x951F, 0xA61F, 0x771E,
+    0x881E, 0x591F, 0x6A1F, 0xBB1E, 0x0C1F, 0xDD1E, 0xEE1E, 0x3F1F,
+    0x501D, 0x811C, 0xB21C, 0x631D, 0xD41C, 0x051D, 0x361D, 0xE71C,
+    0x181C, 0xC91D, 0xFA1D, 0x2B1C, 0x9C1D, 0x4D1C, 0x7E1C, 0xAF1D,
+    0xA018, 0x7119, 0x4219, 0x9318, 0x2419, 0xF518, 0xC618, 0x1719,
+    0xE819, 0x3918, 0x0A18, 0xDB19, 0x6C18, 0xBD19, 0x8E19, 0x5F18,
+    0x301A, 0xE11B, 0xD21B, 0x031A, 0xB41B, 0x651A, 0x561A, 0x871B,
+    0x781B, 0xA91A, 0x9A1A, 0x4B1B, 0xFC1A, 0x2D1B, 0x1E1B, 0xCF1A,
+    0x0011, 0xD110, 0xE210, 0x3311, 0x8410, 0x5511, 0x6611, 0xB710,
+    0x4810, 0x9911, 0xAA11, 0x7B10, 0xCC11, 0x1D10, 0x2E10, 0xFF11,
+    0x9013, 0x4112, 0x7212, 0xA313, 0x1412, 0xC513, 0xF613, 0x2712,
+    0xD812, 0x0913, 0x3A13, 0xEB12, 0x5C13, 0x8D12, 0xBE12, 0x6F13,
+    0x6016, 0xB117, 0x8217, 0x5316, 0xE417, 0x3516, 0x0616, 0xD717,
+    0x2817, 0xF916, 0xCA16, 0x1B17, 0xAC16, 0x7D17, 0x4E17, 0x9F16,
+    0xF014, 0x2115, 0x1215, 0xC314, 0x7415, 0xA514, 0x9614, 0x4715,
+    0xB815, 0x6914, 0x5A14, 0x8B15, 0x3C14, 0xED15, 0xDE15, 0x0F14
+  },
+  {
+    0x0000, 0xC010, 0xC023, 0x0033, 0xC045, 0x0055, 0x0066, 0xC076,
+    0xC089, 0x0099, 0x00AA, 0xC0BA, 0x00CC, 0xC0DC, 0xC0EF, 0x00FF,
+    0xC111, 0x0101, 0x0132, 0xC122, 0x0154, 0xC144, 0xC177, 0x0167,
+    0x0198, 0xC188, 0xC1BB, 0x01AB, 0xC1DD, 0x01CD, 0x01FE, 0xC1EE,
+    0xC221, 0x0231, 0x0202, 0xC212, 0x0264, 0xC274, 0xC247, 0x0257,
+    0x02A8, 0xC2B8, 0xC28B, 0x029B, 0xC2ED, 0x02FD, 0x02CE, 0xC2DE,
+    0x0330, 0xC320, 0xC313, 0x0303, 0xC375, 0x0365, 0x0356, 0xC346,
+    0xC3B9, 0x03A9, 0x039A, 0xC38A, 0x03FC, 0xC3EC, 0xC3DF, 0x03CF,
+    0xC441, 0x0451, 0x0462, 0xC472, 0x0404, 0xC414, 0xC427, 0x0437,
+    0x04C8, 0xC4D8, 0xC4EB, 0x04FB, 0xC48D, 0x049D, 0x04AE, 0xC4BE,
+    0x0550, 0xC540, 0xC573, 0x0563, 0xC515, 0x0505, 0x0536, 0xC526,
+    0xC5D9, 0x05C9, 0x05FA, 0xC5EA, 0x059C, 0xC58C, 0xC5BF, 0x05AF,
+    0x0660, 0xC670, 0xC643, 0x0653, 0xC625, 0x0635, 0x0606, 0xC616,
+    0xC6E9, 0x06F9, 0x06CA, 0xC6DA, 0x06AC, 0xC6BC, 0xC68F, 0x069F,
+    0xC771, 0x0761, 0x0752, 0xC742, 0x0734, 0xC724, 0xC717, 0x0707,
+    0x07F8, 0xC7E8, 0xC7DB, 0x07CB, 0xC7BD, 0x07AD, 0x079E, 0xC78E,
+    0xC881, 0x0891, 0x08A2, 0xC8B2, 0x08C4, 0xC8D4, 0xC8E7, 0x08F7,
+    0x0808, 0xC818, 0xC82B, 0x083B, 0xC84D, 0x085D, 0x086E, 0xC87E,
+    0x0990, 0xC980, 0xC9B3, 0x09A3, 0xC9D5, 0x09C5, 0x09F6, 0xC9E6,
+    0xC919, 0x0909, 0x093A, 0xC92A, 0x095C, 0xC94C, 0xC97F, 0x096F,
+    0x0AA0, 0xCAB0, 0xCA83, 0x0A93, 0xCAE5, 0x0AF5, 0x0AC6, 0xCAD6,
+    0xCA29, 0x0A39, 0x0A0A, 0xCA1A, 0x0A6C, 0xCA7C, 0xCA4F, 0x0A5F,
+    0xCBB1, 0x0BA1, 0x0B92, 0xCB82, 0x0BF4, 0xCBE4, 0xCBD7, 0x0BC7,
+    0x0B38, 0xCB28, 0xCB1B, 0x0B0B, 0xCB7D, 0x0B6D, 0x0B5E, 0xCB4E,
+    0x0CC0, 0xCCD0, 0xCCE3, 0x0CF3, 0xCC85, 0x0C95, 0x0CA6, 0xCCB6,
+    0xCC49, 0x0C59, 0x0C6A, 0xCC7A, 0x0C0C, 0xCC1C, 0xCC2F, 0x0C3F,
+    0xCDD1, 0x0DC1, 0x0DF2, 0xCDE2, 0x0D94, 0xCD84, 0xCDB7, 0x0DA7,
+    0x0D58, 0xCD48, 0xCD7B, 0x0D6B, 0xCD1D, 0x0D0D, 0x0D3E, 0xCD2E,
+    0xCEE1, 0x0EF1, 0x0EC2, 0xCED2, 0x0EA4, 0xCEB4, 0xCE87, 0x0E97,
+    0x0E68, 0xCE78, 0xCE4B, 0x0E5B, 0xCE2D, 0x0E3D, 0x0E0E, 0xCE1E,
+    0x0FF0, 0xCFE0, 0xCFD3, 0x0FC3, 0xCFB5, 0x0FA5, 0x0F96, 0xCF86,
+    0xCF79, 0x0F69, 0x0F5A, 0xCF4A, 0x0F3C, 0xCF2C, 0xCF1F, 0x0F0F
+  },
+  {
+    0x0000, 0xCCC1, 0xD981, 0x1540, 0xF301, 0x3FC0, 0x2A80, 0xE641,
+    0xA601, 0x6AC0, 0x7F80, 0xB341, 0x5500, 0x99C1, 0x8C81, 0x4040,
+    0x0C01, 0xC0C0, 0xD580, 0x1941, 0xFF00, 0x33C1, 0x2681, 0xEA40,
+    0xAA00, 0x66C1, 0x7381, 0xBF40, 0x5901, 0x95C0, 0x8080, 0x4C41,
+    0x1802, 0xD4C3, 0xC183, 0x0D42, 0xEB03, 0x27C2, 0x3282, 0xFE43,
+    0xBE03, 0x72C2, 0x6782, 0xAB43, 0x4D02, 0x81C3, 0x9483, 0x5842,
+    0x1403, 0xD8C2, 0xCD82, 0x0143, 0xE702, 0x2BC3, 0x3E83, 0xF242,
+    0xB202, 0x7EC3, 0x6B83, 0xA742, 0x4103, 0x8DC2, 0x9882, 0x5443,
+    0x3004, 0xFCC5, 0xE985, 0x2544, 0xC305, 0x0FC4, 0x1A84, 0xD645,
+    0x9605, 0x5AC4, 0x4F84, 0x8345, 0x6504, 0xA9C5, 0xBC85, 0x7044,
+    0x3C05, 0xF0C4, 0xE584, 0x2945, 0xCF04, 0x03C5, 0x1685, 0xDA44,
+    0x9A04, 0x56C5, 0x4385, 0x8F44, 0x6905, 0xA5C4, 0xB084, 0x7C45,
+    0x2806, 0xE4C7, 0xF187, 0x3D46, 0xDB07, 0x17C6, 0x0286, 0xCE47,
+    0x8E07, 0x42C6, 0x5786, 0x9B47, 0x7D06, 0xB1C7, 0xA487, 0x6846,
+    0x2407, 0xE8C6, 0xFD86, 0x3147, 0xD706, 0x1BC7, 0x0E87, 0xC246,
+    0x8206, 0x4EC7, 0x5B87, 0x9746, 0x7107, 0xBDC6, 0xA886, 0x6447,
+    0x6008, 0xACC9, 0xB989, 0x7548, 0x9309, 0x5FC8, 0x4A88, 0x8649,
+    0xC609, 0x0AC8, 0x1F88, 0xD349, 0x3508, 0xF9C9, 0xEC89, 0x2048,
+    0x6C09, 0xA0C8, 0xB588, 0x7949, 0x9F08, 0x53C9, 0x4689, 0x8A48,
+    0xCA08, 0x06C9, 0x1389, 0xDF48, 0x3909, 0xF5C8, 0xE088, 0x2C49,
+    0x780A, 0xB4CB, 0xA18B, 0x6D4A, 0x8B0B, 0x47CA, 0x528A, 0x9E4B,
+    0xDE0B, 0x12CA, 0x078A, 0xCB4B, 0x2D0A, 0xE1CB, 0xF48B, 0x384A,
+    0x740B, 0xB8CA, 0xAD8A, 0x614B, 0x870A, 0x4BCB, 0x5E8B, 0x924A,
+    0xD20A, 0x1ECB, 0x0B8B, 0xC74A, 0x210B, 0xEDCA, 0xF88A, 0x344B,
+    0x500C, 0x9CCD, 0x898D, 0x454C, 0xA30D, 0x6FCC, 0x7A8C, 0xB64D,
+    0xF60D, 0x3ACC, 0x2F8C, 0xE34D, 0x050C, 0xC9CD, 0xDC8D, 0x104C,
+    0x5C0D, 0x90CC, 0x858C, 0x494D, 0xAF0C, 0x63CD, 0x768D, 0xBA4C,
+    0xFA0C, 0x36CD, 0x238D, 0xEF4C, 0x090D, 0xC5CC, 0xD08C, 0x1C4D,
+    0x480E, 0x84CF, 0x918F, 0x5D4E, 0xBB0F, 0x77CE, 0x628E, 0xAE4F,
+    0xEE0F, 0x22CE, 0x378E, 0xFB4F, 0x1D0E, 0xD1CF, 0xC48F, 0x084E,
+    0x440F, 0x88CE, 0x9D8E, 0x514F, 0xB70E, 0x7BCF, 0x6E8F, 0xA24E,
+    0xE20E, 0x2ECF, 0x3B8F, 0xF74E, 0x110F, 0xDDCE, 0xC88E, 0x044F
+  },
+#endif
+#if CRCSW_SLICE_BY >= 16
+  {
+    0x0000, 0x900D, 0x6019, 0xF014, 0xC032, 0x503F, 0xA02B, 0x3026,
+    0xC067, 0x506A, 0xA07E, 0x3073, 0x0055, 0x9058, 0x604C, 0xF041,
+    0xC0CD, 0x50C0, 0xA0D4, 0x30D9, 0x00FF, 0x90F2, 0x60E6, 0xF0EB,
+    0x00AA, 0x90A7, 0x60B3, 0xF0BE, 0xC098, 0x5095, 0xA081, 0x308C,
+    0xC199, 0x5194, 0xA180, 0x318D, 0x01AB, 0x91A6, 0x61B2, 0xF1BF,
+    0x01FE, 0x91F3, 0x61E7, 0xF1EA, 0xC1CC, 0x51C1, 0xA1D5, 0x31D8,
+    0x0154, 0x9159, 0x614D, 0xF140, 0xC166, 0x516B, 0xA17F, 0x3172,
+    0xC133, 0x513E, 0xA12A, 0x3127, 0x0101, 0x910C, 0x6118, 0xF115,
+    0xC331, 0x533C, 0xA328, 0x3325, 0x0303, 0x930E, 0x631A, 0xF317,
+    0x0356, 0x935B, 0x634F, 0xF342, 0xC364, 0x5369, 0xA37D, 0x3370,
+    0x03FC, 0x93F1, 0x63E5, 0xF3E8, 0xC3CE, 0x53C3, 0xA3D7, 0x33DA,
+    0xC39B, 0x5396, 0xA382, 0x338F, 0x03A9, 0x93A4, 0x63B0, 0xF3BD,
+    0x02A8, 0x92A5, 0x62B1, 0xF2BC, 0xC29A, 0x5297, 0xA283, 0x328E,
+    0xC2CF, 0x52C2, 0xA2D6, 0x32DB, 0x02FD, 0x92F0, 0x62E4, 0xF2E9,
+    0xC265, 0x5268, 0xA27C, 0x3271, 0x0257, 0x925A, 0x624E, 0xF243,
+    0x0202, 0x920F, 0x621B, 0xF216, 0xC230, 0x523D, 0xA229, 0x3224,
+    0xC661, 0x566C, 0xA678, 0x3675, 0x0653, 0x965E, 0x664A, 0xF647,
+    0x0606, 0x960B, 0x661F, 0xF612, 0xC634, 0x5639, 0xA62D, 0x3620,
+    0x06AC, 0x96A1, 0x66B5, 0xF6B8, 0xC69E, 0x5693, 0xA687, 0x368A,
+    0xC6CB, 0x56C6, 0xA6D2, 0x36DF, 0x06F9, 0x96F4, 0x66E0, 0xF6ED,
+    0x07F8, 0x97F5, 0x67E1, 0xF7EC, 0xC7CA, 0x57C7, 0xA7D3, 0x37DE,
+    0xC79F, 0x5792, 0xA786, 0x378B, 0x07AD, 0x97A0, 0x67B4, 0xF7B9,
+    0xC735, 0x5738, 0xA72C, 0x3721, 0x0707, 0x970A, 0x671E, 0xF713,
+    0x0752, 0x975F, 0x674B, 0xF746, 0xC760, 0x576D, 0xA779, 0x3774,
+    0x0550, 0x955D, 0x6549, 0xF544, 0xC562, 0x556F, 0xA57B, 0x3576,
+    0xC537, 0x553A, 0xA52E, 0x3523, 0x0505, 0x9508, 0x651C, 0xF511,
+    0xC59D, 0x5590, 0xA584, 0x3589, 0x05AF, 0x95A2, 0x65B6, 0xF5BB,
+    0x05FA, 0x95F7, 0x65E3, 0xF5EE, 0xC5C8, 0x55C5, 0xA5D1, 0x35DC,
+    0xC4C9, 0x54C4, 0xA4D0, 0x34DD, 0x04FB, 0x94F6, 0x64E2, 0xF4EF,
+    0x04AE, 0x94A3, 0x64B7, 0xF4BA, 0xC49C, 0x5491, 0xA485, 0x3488,
+    0x0404, 0x9409, 0x641D, 0xF410, 0xC436, 0x543B, 0xA42F, 0x3422,
+    0xC463, 0x546E, 0xA47A, 0x3477, 0x0451, 0x945C, 0x6448, 0xF445
+  },
+  {
+    0x0000, 0xC551, 0xCAA1, 0x0FF0, 0xD541, 0x1010, 0x1FE0, 0xDAB1,
+    0xEA81, 0x2FD0, 0x2020, 0xE571, 0x3FC0, 0xFA91, 0xF561, 0x3030,
+    0x9501, 0x5050, 0x5FA0, 0x9AF1, 0x4040, 0x8511, 0x8AE1, 0x4FB0,
+    0x7F80, 0xBAD1, 0xB521, 0x7070, 0xAAC1, 0x6F90, 0x6060, 0xA531,
+    0x6A01, 0xAF50, 0xA0A0, 0x65F1, 0xBF40, 0x7A11, 0x75E1, 0xB0B0,
+    0x8080, 0x45D1, 0x4A21, 0x8F70, 0x55C1, 0x9090, 0x9F60, 0x5A31,
+    0xFF00, 0x3A51, 0x35A1, 0xF0F0, 0x2A41, 0xEF10, 0xE0E0, 0x25B1,
+    0x1581, 0xD0D0, 0xDF20, 0x1A71, 0xC0C0, 0x0591, 0x0A61, 0xCF30,
+    0xD402, 0x1153, 0x1EA3, 0xDBF2, 0x0143, 0xC412, 0xCBE2, 0x0EB3,
+    0x3E83, 0xFBD2, 0xF422, 0x3173, 0xEBC2, 0x2E93, 0x2163, 0xE432,
+    0x4103, 0x8452, 0x8BA2, 0x4EF3, 0x9442, 0x5113, 0x5EE3, 0x9BB2,
+    0xAB82, 0x6ED3, 0x6123, 0xA472, 0x7EC3, 0xBB92, 0xB462, 0x7133,
+    0xBE03, 0x7B52, 0x74A2, 0xB1F3, 0x6B42, 0xAE13, 0xA1E3, 0x64B2,
+    0x5482, 0x91D3, 0x9E23, 0x5B72, 0x81C3, 0x4492, 0x4B62, 0x8E33,
+    0x2B02, 0xEE53, 0xE1A3, 0x24F2, 0xFE43, 0x3B12, 0x34E2, 0xF1B3,
+    0xC183, 0x04D2, 0x0B22, 0xCE73, 0x14C2, 0xD193, 0xDE63, 0x1B32,
+    0xE807, 0x2D56, 0x22A6, 0xE7F7, 0x3D46, 0xF817, 0xF7E7, 0x32B6,
+    0x0286, 0xC7D7, 0xC827, 0x0D76, 0xD7C7, 0x1296, 0x1D66, 0xD837,
+    0x7D06, 0xB857, 0xB7A7, 0x72F6, 0xA847, 0x6D16, 0x62E6, 0xA7B7,
+    0x9787, 0x52D6, 0x5D26, 0x9877, 0x42C6, 0x8797, 0x8867, 0x4D36,
+    0x8206, 0x4757, 0x48A7, 0x8DF6, 0x5747, 0x9216, 0x9DE6, 0x58B7,
+    0x6887, 0xADD6, 0xA226, 0x6777, 0xBDC6, 0x7897, 0x7767, 0xB236,
+    0x1707, 0xD256, 0xDDA6, 0x18F7, 0xC246, 0x0717, 0x08E7, 0xCDB6,
+    0xFD86, 0x38D7, 0x3727, 0xF276, 0x28C7, 0xED96, 0xE266, 0x2737,
+    0x3C05, 0xF954, 0xF6A4, 0x33F5, 0xE944, 0x2C15, 0x23E5, 0xE6B4,
+    0xD684, 0x13D5, 0x1C25, 0xD974, 0x03C5, 0xC694, 0xC964, 0x0C35,
+    0xA904, 0x6C55, 0x63A5, 0xA6F4, 0x7C45, 0xB914, 0xB6E4, 0x73B5,
+    0x4385, 0x86D4, 0x8924, 0x4C75, 0x96C4, 0x5395, 0x5C65, 0x9934,
+    0x5604, 0x9355, 0x9CA5, 0x59F4, 0x8345, 0x4614, 0x49E4, 0x8CB5,
+    0xBC85, 0x79D4, 0x7624, 0xB375, 0x69C4, 0xAC95, 0xA365, 0x6634,
+    0xC305, 0x0654, 0x09A4, 0xCCF5, 0x1644, 0xD315, 0xDCE5, 0x19B4,
+    0x2984, 0xECD5, 0xE325, 0x2674, 0xFCC5, 0x3994, 0x3664, 0xF335
+  },
+  {
+    0x0000, 0xFC04, 0xB80B, 0x440F, 0x3015, 0xCC11, 0x881E, 0x741A,
+    0x602A, 0x9C2E, 0xD821, 0x2425, 0x503F, 0xAC3B, 0xE834, 0x1430,
+    0xC054, 0x3C50, 0x785F, 0x845B, 0xF041, 0x0C45, 0x484A, 0xB44E,
+    0xA07E, 0x5C7A, 0x1875, 0xE471, 0x906B, 0x6C6F, 0x2860, 0xD464,
+    0xC0AB, 0x3CAF, 0x78A0, 0x84A4, 0xF0BE, 0x0CBA, 0x48B5, 0xB4B1,
+    0xA081, 0x5C85, 0x188A, 0xE48E, 0x9094, 0x6C90, 0x289F, 0xD49B,
+    0x00FF, 0xFCFB, 0xB8F4, 0x44F0, 0x30EA, 0xCCEE, 0x88E1, 0x74E5,
+    0x60D5, 0x9CD1, 0xD8DE, 0x24DA, 0x50C0, 0xACC4, 0xE8CB, 0x14CF,
+    0xC155, 0x3D51, 0x795E, 0x855A, 0xF140, 0x0D44, 0x494B, 0xB54F,
+    0xA17F, 0x5D7B, 0x1974, 0xE570, 0x916A, 0x6D6E, 0x2961, 0xD565,
+    0x0101, 0xFD05, 0xB90A, 0x450E, 0x3114, 0xCD10, 0x891F, 0x751B,
+    0x612B, 0x9D2F, 0xD920, 0x2524, 0x513E, 0xAD3A, 0xE935, 0x1531,
+    0x01FE, 0xFDFA, 0xB9F5, 0x45F1, 0x31EB, 0xCDEF, 0x89E0, 0x75E4,
+    0x61D4, 0x9DD0, 0xD9DF, 0x25DB, 0x51C1, 0xADC5, 0xE9CA, 0x15CE,
+    0xC1AA, 0x3DAE, 0x79A1, 0x85A5, 0xF1BF, 0x0DBB, 0x49B4, 0xB5B0,
+    0xA180, 0x5D84, 0x198B, 0xE58F, 0x9195, 0x6D91, 0x299E, 0xD59A,
+    0xC2A9, 0x3EAD, 0x7AA2, 0x86A6, 0xF2BC, 0x0EB8, 0x4AB7, 0xB6B3,
+    0xA283, 0x5E87, 0x1A88, 0xE68C, 0x9296, 0x6E92, 0x2A9D, 0xD699,
+    0x02FD, 0xFEF9, 0xBAF6, 0x46F2, 0x32E8, 0xCEEC, 0x8AE3, 0x76E7,
+    0x62D7, 0x9ED3, 0xDADC, 0x26D8, 0x52C2, 0xAEC6, 0xEAC9, 0x16CD,
+    0x0202, 0xFE06, 0xBA09, 0x460D, 0x3217, 0xCE13, 0x8A1C, 0x7618,
+    0x6228, 0x9E2C, 0xDA23, 0x2627, 0x523D, 0xAE39, 0xEA36, 0x1632,
+    0xC256, 0x3E52, 0x7A5D, 0x8659, 0xF243, 0x0E47, 0x4A48, 0xB64C,
+    0xA27C, 0x5E78, 0x1A77, 0xE673, 0x9269, 0x6E6D, 0x2A62, 0xD666,
+    0x03FC, 0xFFF8, 0xBBF7, 0x47F3, 0x33E9, 0xCFED, 0x8BE2, 0x77E6,
+    0x63D6, 0x9FD2, 0xDBDD, 0x27D9, 0x53C3, 0xAFC7, 0xEBC8, 0x17CC,
+    0xC3A8, 0x3FAC, 0x7BA3, 0x87A7, 0xF3BD, 0x0FB9, 0x4BB6, 0xB7B2,
+    0xA382, 0x5F86, 0x1B89, 0xE78D, 0x9397, 0x6F93, 0x2B9C, 0xD798,
+    0xC357, 0x3F53, 0x7B5C, 0x8758, 0xF342, 0x0F46, 0x4B49, 0xB74D,
+    0xA37D, 0x5F79, 0x1B76, 0xE772, 0x9368, 0x6F6C, 0x2B63, 0xD767,
+    0x0303, 0xFF07, 0xBB08, 0x470C, 0x3316, 0xCF12, 0x8B1D, 0x7719,
+    0x6329, 0x9F2D, 0xDB22, 0x2726, 0x533C, 0xAF38, 0xEB37, 0x1733
+  },
+  {
+    0x0000, 0xC3FD, 0xC7F9, 0x0404, 0xCFF1, 0x0C0C, 0x0808, 0xCBF5,
+    0xDFE1, 0x1C1C, 0x1818, 0xDBE5, 0x1010, 0xD3ED, 0xD7E9, 0x1414,
+    0xFFC1, 0x3C3C, 0x3838, 0xFBC5, 0x3030, 0xF3CD, 0xF7C9, 0x3434,
+    0x2020, 0xE3DD, 0xE7D9, 0x2424, 0xEFD1, 0x2C2C, 0x2828, 0xEBD5,
+    0xBF81, 0x7C7C, 0x7878, 0xBB85, 0x7070, 0xB38D, 0xB789, 0x7474,
+    0x6060, 0xA39D, 0xA799, 0x6464, 0xAF91, 0x6C6C, 0x6868, 0xAB95,
+    0x4040, 0x83BD, 0x87B9, 0x4444, 0x8FB1, 0x4C4C, 0x4848, 0x8BB5,
+    0x9FA1, 0x5C5C, 0x5858, 0x9BA5, 0x5050, 0x93AD, 0x97A9, 0x5454,
+    0x3F01, 0xFCFC, 0xF8F8, 0x3B05, 0xF0F0, 0x330D, 0x3709, 0xF4F4,
+    0xE0E0, 0x231D, 0x2719, 0xE4E4, 0x2F11, 0xECEC, 0xE8E8, 0x2B15,
+    0xC0C0, 0x033D, 0x0739, 0xC4C4, 0x0F31, 0xCCCC, 0xC8C8, 0x0B35,
+    0x1F21, 0xDCDC, 0xD8D8, 0x1B25, 0xD0D0, 0x132D, 0x1729, 0xD4D4,
+    0x8080, 0x437D, 0x4779, 0x8484, 0x4F71, 0x8C8C, 0x8888, 0x4B75,
+    0x5F61, 0x9C9C, 0x9898, 0x5B65, 0x9090, 0x536D, 0x5769, 0x9494,
+    0x7F41, 0xBCBC, 0xB8B8, 0x7B45, 0xB0B0, 0x734D, 0x7749, 0xB4B4,
+    0xA0A0, 0x635D, 0x6759, 0xA4A4, 0x6F51, 0xACAC, 0xA8A8, 0x6B55,
+    0x7E02, 0xBDFF, 0xB9FB, 0x7A06, 0xB1F3, 0x720E, 0x760A, 0xB5F7,
+    0xA1E3, 0x621E, 0x661A, 0xA5E7, 0x6E12, 0xADEF, 0xA9EB, 0x6A16,
+    0x81C3, 0x423E, 0x463A, 0x85C7, 0x4E32, 0x8DCF, 0x89CB, 0x4A36,
+    0x5E22, 0x9DDF, 0x99DB, 0x5A26, 0x91D3, 0x522E, 0x562A, 0x95D7,
+    0xC183, 0x027E, 0x067A, 0xC587, 0x0E72, 0xCD8F, 0xC98B, 0x0A76,
+    0x1E62, 0xDD9F, 0xD99B, 0x1A66, 0xD193, 0x126E, 0x166A, 0xD597,
+    0x3E42, 0xFDBF, 0xF9BB, 0x3A46, 0xF1B3, 0x324E, 0x364A, 0xF5B7,
+    0xE1A3, 0x225E, 0x265A, 0xE5A7, 0x2E52, 0xEDAF, 0xE9AB, 0x2A56,
+    0x4103, 0x82FE, 0x86FA, 0x4507, 0x8EF2, 0x4D0F, 0x490B, 0x8AF6,
+    0x9EE2, 0x5D1F, 0x591B, 0x9AE6, 0x5113, 0x92EE, 0x96EA, 0x5517,
+    0xBEC2, 0x7D3F, 0x793B, 0xBAC6, 0x7133, 0xB2CE, 0xB6CA, 0x7537,
+    0x6123, 0xA2DE, 0xA6DA, 0x6527, 0xAED2, 0x6D2F, 0x692B, 0xAAD6,
+    0xFE82, 0x3D7F, 0x397B, 0xFA86, 0x3173, 0xF28E, 0xF68A, 0x3577,
+    0x2163, 0xE29E, 0xE69A, 0x2567, 0xEE92, 0x2D6F, 0x296B, 0xEA96,
+    0x0143, 0xC2BE, 0xC6BA, 0x0547, 0xCEB2, 0x0D4F, 0x094B, 0xCAB6,
+    0xDEA2, 0x1D5F, 0x195B, 0xDAA6, 0x1153, 0xD2AE, 0xD6AA, 0x1557
+  },
+  {
+    0x0000, 0x8102, 0x4207, 0xC305, 0x840E, 0x050C, 0xC609, 0x470B,
+    0x481F, 0xC91D, 0x0A18, 0x8B1A, 0xCC11, 0x4D13, 0x8E16, 0x0F14,
+    0x903E, 0x113C, 0xD239, 0x533B, 0x1430, 0x9532, 0x5637, 0xD735,
+    0xD821, 0x5923, 0x9A26, 0x1B24, 0x5C2F, 0xDD2D, 0x1E28, 0x9F2A,
+    0x607F, 0xE17D, 0x2278, 0xA37A, 0xE471, 0x6573, 0xA676, 0x2774,
+    0x2860, 0xA962, 0x6A67, 0xEB65, 0xAC6E, 0x2D6C, 0xEE69, 0x6F6B,
+    0xF041, 0x7143, 0xB246, 0x3344, 0x744F, 0xF54D, 0x3648, 0xB74A,
+    0xB85E, 0x395C, 0xFA59, 0x7B5B, 0x3C50, 0xBD52, 0x7E57, 0xFF55,
+    0xC0FE, 0x41FC, 0x82F9, 0x03FB, 0x44F0, 0xC5F2, 0x06F7, 0x87F5,
+    0x88E1, 0x09E3, 0xCAE6, 0x4BE4, 0x0CEF, 0x8DED, 0x4EE8, 0xCFEA,
+    0x50C0, 0xD1C2, 0x12C7, 0x93C5, 0xD4CE, 0x55CC, 0x96C9, 0x17CB,
+    0x18DF, 0x99DD, 0x5AD8, 0xDBDA, 0x9CD1, 0x1DD3, 0xDED6, 0x5FD4,
+    0xA081, 0x2183, 0xE286, 0x6384, 0x248F, 0xA58D, 0x6688, 0xE78A,
+    0xE89E, 0x699C, 0xAA99, 0x2B9B, 0x6C90, 0xED92, 0x2E97, 0xAF95,
+    0x30BF, 0xB1BD, 0x72B8, 0xF3BA, 0xB4B1, 0x35B3, 0xF6B6, 0x77B4,
+    0x78A0, 0xF9A2, 0x3AA7, 0xBBA5, 0xFCAE, 0x7DAC, 0xBEA9, 0x3FAB,
+    0xC1FF, 0x40FD, 0x83F8, 0x02FA, 0x45F1, 0xC4F3, 0x07F6, 0x86F4,
+    0x89E0, 0x08E2, 0xCBE7, 0x4AE5, 0x0DEE, 0x8CEC, 0x4FE9, 0xCEEB,
+    0x51C1, 0xD0C3, 0x13C6, 0x92C4, 0xD5CF, 0x54CD, 0x97C8, 0x16CA,
+    0x19DE, 0x98DC, 0x5BD9, 0xDADB, 0x9DD0, 0x1CD2, 0xDFD7, 0x5ED5,
+    0xA180, 0x2082, 0xE387, 0x6285, 0x258E, 0xA48C, 0x6789, 0xE68B,
+    0xE99F, 0x689D, 0xAB98, 0x2A9A, 0x6D91, 0xEC93, 0x2F96, 0xAE94,
+    0x31BE, 0xB0BC, 0x73B9, 0xF2BB, 0xB5B0, 0x34B2, 0xF7B7, 0x76B5,
+    0x79A1, 0xF8A3, 0x3BA6, 0xBAA4, 0xFDAF, 0x7CAD, 0xBFA8, 0x3EAA,
+    0x0101, 0x8003, 0x4306, 0xC204, 0x850F, 0x040D, 0xC708, 0x460A,
+    0x491E, 0xC81C, 0x0B19, 0x8A1B, 0xCD10, 0x4C12, 0x8F17, 0x0E15,
+    0x913F, 0x103D, 0xD338, 0x523A, 0x1531, 0x9433, 0x5736, 0xD634,
+    0xD920, 0x5822, 0x9B27, 0x1A25, 0x5D2E, 0xDC2C, 0x1F29, 0x9E2B,
+    0x617E, 0xE07C, 0x2379, 0xA27B, 0xE570, 0x6472, 0xA777, 0x2675,
+    0x2961, 0xA863, 0x6B66, 0xEA64, 0xAD6F, 0x2C6D, 0xEF68, 0x6E6A,
+    0xF140, 0x7042, 0xB347, 0x3245, 0x754E, 0xF44C, 0x3749, 0xB64B,
+    0xB95F, 0x385D, 0xFB58, 0x7A5A, 0x3D51, 0xBC53, 0x7F56, 0xFE54
+  },
+  {
+    0x0000, 0xC100, 0xC203, 0x0303, 0xC405, 0x0505, 0x0606, 0xC706,
+    0xC809, 0x0909, 0x0A0A, 0xCB0A, 0x0C0C, 0xCD0C, 0xCE0F, 0x0F0F,
+    0xD011, 0x1111, 0x1212, 0xD312, 0x1414, 0xD514, 0xD617, 0x1717,
+    0x1818, 0xD918, 0xDA1B, 0x1B1B, 0xDC1D, 0x1D1D, 0x1E1E, 0xDF1E,
+    0xE021, 0x2121, 0x2222, 0xE322, 0x2424, 0xE524, 0xE627, 0x2727,
+    0x2828, 0xE928, 0xEA2B, 0x2B2B, 0xEC2D, 0x2D2D, 0x2E2E, 0xEF2E,
+    0x3030, 0xF130, 0xF233, 0x3333, 0xF435, 0x3535, 0x3636, 0xF736,
+    0xF839, 0x3939, 0x3A3A, 0xFB3A, 0x3C3C, 0xFD3C, 0xFE3F, 0x3F3F,
+    0x8041, 0x4141, 0x4242, 0x8342, 0x4444, 0x8544, 0x8647, 0x4747,
+    0x4848, 0x8948, 0x8A4B, 0x4B4B, 0x8C4D, 0x4D4D, 0x4E4E, 0x8F4E,
+    0x5050, 0x9150, 0x9253, 0x5353, 0x9455, 0x5555, 0x5656, 0x9756,
+    0x9859, 0x5959, 0x5A5A, 0x9B5A, 0x5C5C, 0x9D5C, 0x9E5F, 0x5F5F,
+    0x6060, 0xA160, 0xA263, 0x6363, 0xA465, 0x6565, 0x6666, 0xA766,
+    0xA869, 0x6969, 0x6A6A, 0xAB6A, 0x6C6C, 0xAD6C, 0xAE6F, 0x6F6F,
+    0xB071, 0x7171, 0x7272, 0xB372, 0x7474, 0xB574, 0xB677, 0x7777,
+    0x7878, 0xB978, 0xBA7B, 0x7B7B, 0xBC7D, 0x7D7D, 0x7E7E, 0xBF7E,
+    0x4081, 0x8181, 0x8282, 0x4382, 0x8484, 0x4584, 0x4687, 0x8787,
+    0x8888, 0x4988, 0x4A8B, 0x8B8B, 0x4C8D, 0x8D8D, 0x8E8E, 0x4F8E,
+    0x9090, 0x5190, 0x5293, 0x9393, 0x5495, 0x9595, 0x9696, 0x5796,
+    0x5899, 0x9999, 0x9A9A, 0x5B9A, 0x9C9C, 0x5D9C, 0x5E9F, 0x9F9F,
+    0xA0A0, 0x61A0, 0x62A3, 0xA3A3, 0x64A5, 0xA5A5, 0xA6A6, 0x67A6,
+    0x68A9, 0xA9A9, 0xAAAA, 0x6BAA, 0xACAC, 0x6DAC, 0x6EAF, 0xAFAF,
+    0x70B1, 0xB1B1, 0xB2B2, 0x73B2, 0xB4B4, 0x75B4, 0x76B7, 0xB7B7,
+    0xB8B8, 0x79B8, 0x7ABB, 0xBBBB, 0x7CBD, 0xBDBD, 0xBEBE, 0x7FBE,
+    0xC0C0, 0x01C0, 0x02C3, 0xC3C3, 0x04C5, 0xC5C5, 0xC6C6, 0x07C6,
+    0x08C9, 0xC9C9, 0xCACA, 0x0BCA, 0xCCCC, 0x0DCC, 0x0ECF, 0xCFCF,
+    0x10D1, 0xD1D1, 0xD2D2, 0x13D2, 0xD4D4, 0x15D4, 0x16D7, 0xD7D7,
+    0xD8D8, 0x19D8, 0x1ADB, 0xDBDB, 0x1CDD, 0xDDDD, 0xDEDE, 0x1FDE,
+    0x20E1, 0xE1E1, 0xE2E2, 0x23E2, 0xE4E4, 0x25E4, 0x26E7, 0xE7E7,
+    0xE8E8, 0x29E8, 0x2AEB, 0xEBEB, 0x2CED, 0xEDED, 0xEEEE, 0x2FEE,
+    0xF0F0, 0x31F0, 0x32F3, 0xF3F3, 0x34F5, 0xF5F5, 0xF6F6, 0x37F6,
+    0x38F9, 0xF9F9, 0xFAFA, 0x3BFA, 0xFCFC, 0x3DFC, 0x3EFF, 0xFFFF
+  },
+  {
+    0x0000, 0x00C1, 0x0182, 0x0143, 0x0304, 0x03C5, 0x0286, 0x0247,
+    0x0608, 0x06C9, 0x078A, 0x074B, 0x050C, 0x05CD, 0x048E, 0x044F,
+    0x0C10, 0x0CD1, 0x0D92, 0x0D53, 0x0F14, 0x0FD5, 0x0E96, 0x0E57,
+    0x0A18, 0x0AD9, 0x0B9A, 0x0B5B, 0x091C, 0x09DD, 0x089E, 0x085F,
+    0x1820, 0x18E1, 0x19A2, 0x1963, 0x1B24, 0x1BE5, 0x1AA6, 0x1A67,
+    0x1E28, 0x1EE9, 0x1FAA, 0x1F6B, 0x1D2C, 0x1DED, 0x1CAE, 0x1C6F,
+    0x1430, 0x14F1, 0x15B2, 0x1573, 0x1734, 0x17F5, 0x16B6, 0x1677,
+    0x1238, 0x12F9, 0x13BA, 0x137B, 0x113C, 0x11FD, 0x10BE, 0x107F,
+    0x3040, 0x3081, 0x31C2, 0x3103, 0x3344, 0x3385, 0x32C6, 0x3207,
+    0x3648, 0x3689, 0x37CA, 0x370B, 0x354C, 0x358D, 0x34CE, 0x340F,
+    0x3C50, 0x3C91, 0x3DD2, 0x3D13, 0x3F54, 0x3F95, 0x3ED6, 0x3E17,
+    0x3A58, 0x3A99, 0x3BDA, 0x3B1B, 0x395C, 0x399D, 0x38DE, 0x381F,
+    0x2860, 0x28A1, 0x29E2, 0x2923, 0x2B64, 0x2BA5, 0x2AE6, 0x2A27,
+    0x2E68, 0x2EA9, 0x2FEA, 0x2F2B, 0x2D6C, 0x2DAD, 0x2CEE, 0x2C2F,
+    0x2470, 0x24B1, 0x25F2, 0x2533, 0x2774, 0x27B5, 0x26F6, 0x2637,
+    0x2278, 0x22B9, 0x23FA, 0x233B, 0x217C, 0x21BD, 0x20FE, 0x203F,
+    0x6080, 0x6041, 0x6102, 0x61C3, 0x6384, 0x6345, 0x6206, 0x62C7,
+    0x6688, 0x6649, 0x670A, 0x67CB, 0x658C, 0x654D, 0x640E, 0x64CF,
+    0x6C90, 0x6C51, 0x6D12, 0x6DD3, 0x6F94, 0x6F55, 0x6E16, 0x6ED7,
+    0x6A98, 0x6A59, 0x6B1A, 0x6BDB, 0x699C, 0x695D, 0x681E, 0x68DF,
+    0x78A0, 0x7861, 0x7922, 0x79E3, 0x7BA4, 0x7B65, 0x7A26, 0x7AE7,
+    0x7EA8, 0x7E69, 0x7F2A, 0x7FEB, 0x7DAC, 0x7D6D, 0x7C2E, 0x7CEF,
+    0x74B0, 0x7471, 0x7532, 0x75F3, 0x77B4, 0x7775, 0x7636, 0x76F7,
+    0x72B8, 0x7279, 0x733A, 0x73FB, 0x71BC, 0x717D, 0x703E, 0x70FF,
+    0x50C0, 0x5001, 0x5142, 0x5183, 0x53C4, 0x5305, 0x5246, 0x5287,
+    0x56C8, 0x5609, 0x574A, 0x578B, 0x55CC, 0x550D, 0x544E, 0x548F,
+    0x5CD0, 0x5C11, 0x5D52, 0x5D93, 0x5FD4, 0x5F15, 0x5E56, 0x5E97,
+    0x5AD8, 0x5A19, 0x5B5A, 0x5B9B, 0x59DC, 0x591D, 0x585E, 0x589F,
+    0x48E0, 0x4821, 0x4962, 0x49A3, 0x4BE4, 0x4B25, 0x4A66, 0x4AA7,
+    0x4EE8, 0x4E29, 0x4F6A, 0x4FAB, 0x4DEC, 0x4D2D, 0x4C6E, 0x4CAF,
+    0x44F0, 0x4431, 0x4572, 0x45B3, 0x47F4, 0x4735, 0x4676, 0x46B7,
+    0x42F8, 0x4239, 0x437A, 0x43BB, 0x41FC, 0x413D, 0x407E, 0x40BF
+  },
+  {
+    0x0000, 0x90C1, 0x6181, 0xF140, 0xC302, 0x53C3, 0xA283, 0x3242,
+    0xC607, 0x56C6, 0xA786, 0x3747, 0x0505, 0x95C4, 0x6484, 0xF445,
+    0xCC0D, 0x5CCC, 0xAD8C, 0x3D4D, 0x0F0F, 0x9FCE, 0x6E8E, 0xFE4F,
+    0x0A0A, 0x9ACB, 0x6B8B, 0xFB4A, 0xC908, 0x59C9, 0xA889, 0x3848,
+    0xD819, 0x48D8, 0xB998, 0x2959, 0x1B1B, 0x8BDA, 0x7A9A, 0xEA5B,
+    0x1E1E, 0x8EDF, 0x7F9F, 0xEF5E, 0xDD1C, 0x4DDD, 0xBC9D, 0x2C5C,
+    0x1414, 0x84D5, 0x7595, 0xE554, 0xD716, 0x47D7, 0xB697, 0x2656,
+    0xD213, 0x42D2, 0xB392, 0x2353, 0x1111, 0x81D0, 0x7090, 0xE051,
+    0xF031, 0x60F0, 0x91B0, 0x0171, 0x3333, 0xA3F2, 0x52B2, 0xC273,
+    0x3636, 0xA6F7, 0x57B7, 0xC776, 0xF534, 0x65F5, 0x94B5, 0x0474,
+    0x3C3C, 0xACFD, 0x5DBD, 0xCD7C, 0xFF3E, 0x6FFF, 0x9EBF, 0x0E7E,
+    0xFA3B, 0x6AFA, 0x9BBA, 0x0B7B, 0x3939, 0xA9F8, 0x58B8, 0xC879,
+    0x2828, 0xB8E9, 0x49A9, 0xD968, 0xEB2A, 0x7BEB, 0x8AAB, 0x1A6A,
+    0xEE2F, 0x7EEE, 0x8FAE, 0x1F6F, 0x2D2D, 0xBDEC, 0x4CAC, 0xDC6D,
+    0xE425, 0x74E4, 0x85A4, 0x1565, 0x2727, 0xB7E6, 0x46A6, 0xD667,
+    0x2222, 0xB2E3, 0x43A3, 0xD362, 0xE120, 0x71E1, 0x80A1, 0x1060,
+    0xA061, 0x30A0, 0xC1E0, 0x5121, 0x6363, 0xF3A2, 0x02E2, 0x9223,
+    0x6666, 0xF6A7, 0x07E7, 0x9726, 0xA564, 0x35A5, 0xC4E5, 0x5424,
+    0x6C6C, 0xFCAD, 0x0DED, 0x9D2C, 0xAF6E, 0x3FAF, 0xCEEF, 0x5E2E,
+    0xAA6B, 0x3AAA, 0xCBEA, 0x5B2B, 0x6969, 0xF9A8, 0x08E8, 0x9829,
+    0x7878, 0xE8B9, 0x19F9, 0x8938, 0xBB7A, 0x2BBB, 0xDAFB, 0x4A3A,
+    0xBE7F, 0x2EBE, 0xDFFE, 0x4F3F, 0x7D7D, 0xEDBC, 0x1CFC, 0x8C3D,
+    0xB475, 0x24B4, 0xD5F4, 0x4535, 0x7777, 0xE7B6, 0x16F6, 0x8637,
+    0x7272, 0xE2B3, 0x13F3, 0x8332, 0xB170, 0x21B1, 0xD0F1, 0x4030,
+    0x5050, 0xC091, 0x31D1, 0xA110, 0x9352, 0x0393, 0xF2D3, 0x6212,
+    0x9657, 0x0696, 0xF7D6, 0x6717, 0x5555, 0xC594, 0x34D4, 0xA415,
+    0x9C5D, 0x0C9C, 0xFDDC, 0x6D1D, 0x5F5F, 0xCF9E, 0x3EDE, 0xAE1F,
+    0x5A5A, 0xCA9B, 0x3BDB, 0xAB1A, 0x9958, 0x0999, 0xF8D9, 0x6818,
+    0x8849, 0x1888, 0xE9C8, 0x7909, 0x4B4B, 0xDB8A, 0x2ACA, 0xBA0B,
+    0x4E4E, 0xDE8F, 0x2FCF, 0xBF0E, 0x8D4C, 0x1D8D, 0xECCD, 0x7C0C,
+    0x4444, 0xD485, 0x25C5, 0xB504, 0x8746, 0x1787, 0xE6C7, 0x7606,
+    0x8243, 0x1282, 0xE3C2, 0x7303, 0x4141, 0xD180, 0x20C0, 0xB001
+  },
+#endif
+};
+#endif
+
+#endif /* CRCSW_TABLES_H */
+
+/** @} */
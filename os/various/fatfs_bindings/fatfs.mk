@@ -4,4 +4,5 @@ FATFSSRC = ${CHIBIOS_CONTRIB}/os/various/fatfs_bindings/fatfs_diskio.c \
            ${CHIBIOS}/ext/fatfs/src/ff.c \
            $(CHIBIOS)/ext/fatfs/src/ffunicode.c
 
-FATFSINC = ${CHIBIOS}/ext/fatfs/src
+FATFSINC = ${CHIBIOS}/ext/fatfs/src \
+           ${CHIBIOS_CONTRIB}/os/various/fatfs_bindings
@@ -9,6 +9,7 @@
 #include "ffconf.h"
 #include "diskio.h"
 #include "usbh/dev/msd.h"
+#include "fatfs_diskio.h"
 
 #if HAL_USE_MMC_SPI && HAL_USE_SDC
 #error "cannot specify both MMC_SPI and SDC drivers"
@@ -18,14 +19,11 @@
 extern MMCDriver MMCD1;
 #elif HAL_USE_SDC
 extern SDCDriver SDCD1;
-#elif HAL_USBH_USE_MSD
-
-#else
-#error "MMC_SPI, SDC or USBH_MSD driver must be specified"
 #endif
 
 /*-----------------------------------------------------------------------*/
-/* Correspondence between physical drive number and physical drive.      */
+/* Default correspondence between physical drive number and physical     */
+/* drive, other block devices are attached with fatfsRegisterDrive().    */
 #if HAL_USE_MMC_SPI
 #define MMC         0
 #endif
@@ -43,44 +41,78 @@ extern SDCDriver SDCD1;
 #endif
 
 /*-----------------------------------------------------------------------*/
-/* Inidialize a Drive                                                    */
+/* Drive registry                                                        */
 
-DSTATUS disk_initialize (
-    BYTE pdrv                /* Physical drive nmuber (0..) */
-)
-{
-  DSTATUS stat;
-
-  switch (pdrv) {
+static BaseBlockDevice *drives[FATFS_DISKIO_MAX_DRIVES] = {
 #if HAL_USE_MMC_SPI
-  case MMC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (mmcIsWriteProtected(&MMCD1))
-      stat |=  STA_PROTECT;
-    return stat;
+  [MMC] = (BaseBlockDevice *)&MMCD1,
 #elif HAL_USE_SDC
-  case SDC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (sdcIsWriteProtected(&SDCD1))
-      stat |=  STA_PROTECT;
-    return stat;
+  [SDC] = (BaseBlockDevice *)&SDCD1,
 #endif
-#if HAL_USBH_USE_MSD
-  case MSDLUN0:
-	stat = 0;
-	/* It is initialized externally, just reads the status.*/
-	if (blkGetDriverState(&MSBLKD[0]) != BLK_READY)
-	  stat |= STA_NOINIT;
-	return stat;
+#if HAL_USBH_USE_MSD && (MSDLUN0 < FATFS_DISKIO_MAX_DRIVES)
+  [MSDLUN0] = (BaseBlockDevice *)&MSBLKD[0],
 #endif
+};
+
+/**
+ * @brief   Attaches a block device to a physical drive number.
+ * @note    The drive must not be mounted while it is replaced.
+ *
+ * @param[in] pdrv      physical drive number
+ * @param[in] bbdp      pointer to the @p BaseBlockDevice object, @p NULL
+ *                      detaches the drive
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the drive has been attached.
+ * @retval HAL_FAILED   the drive number is out of range.
+ *
+ * @api
+ */
+bool fatfsRegisterDrive(uint8_t pdrv, BaseBlockDevice *bbdp) {
+
+  if (pdrv >= FATFS_DISKIO_MAX_DRIVES) {
+    return HAL_FAILED;
   }
-  return STA_NOINIT;
+  drives[pdrv] = bbdp;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Detaches the block device from a physical drive number.
+ *
+ * @param[in] pdrv      physical drive number
+ *
+ * @api
+ */
+void fatfsUnregisterDrive(uint8_t pdrv) {
+
+  (void)fatfsRegisterDrive(pdrv, NULL);
+}
+
+/**
+ * @brief   Returns the block device attached to a physical drive number.
+ *
+ * @param[in] pdrv      physical drive number
+ * @return              Pointer to the @p BaseBlockDevice object or @p NULL.
+ *
+ * @api
+ */
+BaseBlockDevice *fatfsGetDrive(uint8_t pdrv) {
+
+  if (pdrv >= FATFS_DISKIO_MAX_DRIVES) {
+    return NULL;
+  }
+  return drives[pdrv];
+}
+
+/*-----------------------------------------------------------------------*/
+/* Inidialize a Drive                                                    */
+
+DSTATUS disk_initialize (
+    BYTE pdrv                /* Physical drive nmuber (0..) */
+)
+{
+  /* Devices are initialized externally, just reads the status.*/
+  return disk_status(pdrv);
 }
 
 
@@ -92,38 +124,16 @@ DSTATUS disk_status (
     BYTE pdrv         /* Physical drive number (0..) */
 )
 {
-  DSTATUS stat;
+  BaseBlockDevice *bbdp = fatfsGetDrive(pdrv);
+  DSTATUS stat = 0;
 
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (mmcIsWriteProtected(&MMCD1))
-      stat |= STA_PROTECT;
-    return stat;
-#elif HAL_USE_SDC
-  case SDC:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      stat |= STA_NOINIT;
-    if (sdcIsWriteProtected(&SDCD1))
-      stat |= STA_PROTECT;
-    return stat;
-#endif
-#if HAL_USBH_USE_MSD
-  case MSDLUN0:
-    stat = 0;
-    /* It is initialized externally, just reads the status.*/
-    if (blkGetDriverState(&MSBLKD[0]) != BLK_READY)
-      stat |= STA_NOINIT;
-    return stat;
-#endif
-  }
-  return STA_NOINIT;
+  if (bbdp == NULL)
+    return STA_NOINIT;
+  if (blkGetDriverState(bbdp) != BLK_READY)
+    stat |= STA_NOINIT;
+  else if (blkIsWriteProtected(bbdp))
+    stat |= STA_PROTECT;
+  return stat;
 }
 
 
@@ -138,41 +148,16 @@ DRESULT disk_read (
     UINT count        /* Number of sectors to read (1..255) */
 )
 {
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-      return RES_NOTRDY;
-    if (mmcStartSequentialRead(&MMCD1, sector))
-      return RES_ERROR;
-    while (count > 0) {
-      if (mmcSequentialRead(&MMCD1, buff))
-        return RES_ERROR;
-      buff += MMCSD_BLOCK_SIZE;
-      count--;
-    }
-    if (mmcStopSequentialRead(&MMCD1))
-        return RES_ERROR;
-    return RES_OK;
-#elif HAL_USE_SDC
-  case SDC:
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      return RES_NOTRDY;
-    if (sdcRead(&SDCD1, sector, buff, count))
-      return RES_ERROR;
-    return RES_OK;
-#endif
-#if HAL_USBH_USE_MSD
-  case MSDLUN0:
-	/* It is initialized externally, just reads the status.*/
-	if (blkGetDriverState(&MSBLKD[0]) != BLK_READY)
-		return RES_NOTRDY;
-	if (usbhmsdLUNRead(&MSBLKD[0], sector, buff, count))
-		return RES_ERROR;
-	return RES_OK;
-#endif
-  }
-  return RES_PARERR;
+  BaseBlockDevice *bbdp = fatfsGetDrive(pdrv);
+
+  if (bbdp == NULL)
+    return RES_PARERR;
+  if (blkGetDriverState(bbdp) != BLK_READY)
+    return RES_NOTRDY;
+  /* Multi-sector requests are passed through as a single transfer.*/
+  if (blkRead(bbdp, sector, buff, count))
+    return RES_ERROR;
+  return RES_OK;
 }
 
 
@@ -187,43 +172,18 @@ DRESULT disk_write (
     UINT count        /* Number of sectors to write (1..255) */
 )
 {
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    if (blkGetDriverState(&MMCD1) != BLK_READY)
-        return RES_NOTRDY;
-    if (mmcIsWriteProtected(&MMCD1))
-        return RES_WRPRT;
-    if (mmcStartSequentialWrite(&MMCD1, sector))
-        return RES_ERROR;
-    while (count > 0) {
-        if (mmcSequentialWrite(&MMCD1, buff))
-            return RES_ERROR;
-        buff += MMCSD_BLOCK_SIZE;
-        count--;
-    }
-    if (mmcStopSequentialWrite(&MMCD1))
-        return RES_ERROR;
-    return RES_OK;
-#elif HAL_USE_SDC
-  case SDC:
-    if (blkGetDriverState(&SDCD1) != BLK_READY)
-      return RES_NOTRDY;
-    if (sdcWrite(&SDCD1, sector, buff, count))
-      return RES_ERROR;
-    return RES_OK;
-#endif
-#if HAL_USBH_USE_MSD
-  case MSDLUN0:
-	/* It is initialized externally, just reads the status.*/
-	if (blkGetDriverState(&MSBLKD[0]) != BLK_READY)
-		return RES_NOTRDY;
-	if (usbhmsdLUNWrite(&MSBLKD[0], sector, buff, count))
-		return RES_ERROR;
-	return RES_OK;
-#endif
-  }
-  return RES_PARERR;
+  BaseBlockDevice *bbdp = fatfsGetDrive(pdrv);
+
+  if (bbdp == NULL)
+    return RES_PARERR;
+  if (blkGetDriverState(bbdp) != BLK_READY)
+    return RES_NOTRDY;
+  if (blkIsWriteProtected(bbdp))
+    return RES_WRPRT;
+  /* Multi-sector requests are passed through as a single transfer.*/
+  if (blkWrite(bbdp, sector, buff, count))
+    return RES_ERROR;
+  return RES_OK;
 }
 
 
@@ -237,75 +197,56 @@ DRESULT disk_ioctl (
     void *buff        /* Buffer to send/receive control data */
 )
 {
-  switch (pdrv) {
-#if HAL_USE_MMC_SPI
-  case MMC:
-    switch (cmd) {
-    case CTRL_SYNC:
-        return RES_OK;
+  BaseBlockDevice *bbdp = fatfsGetDrive(pdrv);
+  BlockDeviceInfo bdi;
+
+  if (bbdp == NULL)
+    return RES_PARERR;
+
+  switch (cmd) {
+  case CTRL_SYNC:
+    if (blkSync(bbdp))
+      return RES_ERROR;
+    return RES_OK;
+  case GET_SECTOR_COUNT:
+    if (blkGetInfo(bbdp, &bdi))
+      return RES_NOTRDY;
+    *((DWORD *)buff) = bdi.blk_num;
+    return RES_OK;
 #if _MAX_SS > _MIN_SS
-    case GET_SECTOR_SIZE:
-        *((WORD *)buff) = MMCSD_BLOCK_SIZE;
-        return RES_OK;
-#endif
-#if _USE_TRIM
-    case CTRL_TRIM:
-        mmcErase(&MMCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
-        return RES_OK;
+  case GET_SECTOR_SIZE:
+    if (blkGetInfo(bbdp, &bdi))
+      return RES_NOTRDY;
+    *((WORD *)buff) = bdi.blk_size;
+    return RES_OK;
 #endif
-    default:
-        return RES_PARERR;
+  case GET_BLOCK_SIZE:
+#if HAL_USE_SDC
+    if (bbdp == (BaseBlockDevice *)&SDCD1) {
+      *((DWORD *)buff) = 256; /* 512b blocks in one erase block */
+      return RES_OK;
     }
-#elif HAL_USE_SDC
-  case SDC:
-    switch (cmd) {
-    case CTRL_SYNC:
-        return RES_OK;
-    case GET_SECTOR_COUNT:
-        *((DWORD *)buff) = mmcsdGetCardCapacity(&SDCD1);
-        return RES_OK;
-#if _MAX_SS > _MIN_SS
-    case GET_SECTOR_SIZE:
-        *((WORD *)buff) = MMCSD_BLOCK_SIZE;
-        return RES_OK;
 #endif
-    case GET_BLOCK_SIZE:
-        *((DWORD *)buff) = 256; /* 512b blocks in one erase block */
-        return RES_OK;
+    *((DWORD *)buff) = 1; /* unknown erase block size */
+    return RES_OK;
 #if _USE_TRIM
-    case CTRL_TRIM:
-        sdcErase(&SDCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
-        return RES_OK;
-#endif
-    default:
-        return RES_PARERR;
+  case CTRL_TRIM:
+#if HAL_USE_MMC_SPI
+    if (bbdp == (BaseBlockDevice *)&MMCD1) {
+      mmcErase(&MMCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
+      return RES_OK;
+    }
+#elif HAL_USE_SDC
+    if (bbdp == (BaseBlockDevice *)&SDCD1) {
+      sdcErase(&SDCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
+      return RES_OK;
     }
 #endif
-#if HAL_USBH_USE_MSD
-    case MSDLUN0:
-      switch (cmd) {
-      case CTRL_SYNC:
-          return RES_OK;
-      case GET_SECTOR_COUNT:
-          *((DWORD *)buff) = MSBLKD[0].info.blk_num;
-          return RES_OK;
-#if _MAX_SS > _MIN_SS
-      case GET_SECTOR_SIZE:
-          *((WORD *)buff) = MSBLKD[0].info.blk_size;
-          return RES_OK;
-#endif
-#if _USE_TRIM
-#error "unimplemented yet!"
-//    case CTRL_TRIM:
-//      ....
-//      return RES_OK;
-#endif
-      default:
-          return RES_PARERR;
-      }
+    return RES_PARERR;
 #endif
+  default:
+    return RES_PARERR;
   }
-  return RES_PARERR;
 }
 
 DWORD get_fattime(void) {
@@ -0,0 +1,37 @@
+/*-----------------------------------------------------------------------*/
+/* Drive registry for the FatFs disk I/O bindings                        */
+/*-----------------------------------------------------------------------*/
+/* Any BaseBlockDevice (MMC, SDC, USB host MSD LUN, RamDisk, BlockCache) */
+/* can be attached to a FatFs physical drive number.                     */
+/*-----------------------------------------------------------------------*/
+
+#ifndef FATFS_DISKIO_H
+#define FATFS_DISKIO_H
+
+#include "hal.h"
+#include "ffconf.h"
+
+/**
+ * @brief   Number of physical drives in the registry.
+ */
+#if !defined(FATFS_DISKIO_MAX_DRIVES)
+#if defined(FF_VOLUMES)
+#define FATFS_DISKIO_MAX_DRIVES     FF_VOLUMES
+#elif defined(_VOLUMES)
+#define FATFS_DISKIO_MAX_DRIVES     _VOLUMES
+#else
+#define FATFS_DISKIO_MAX_DRIVES     1
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  bool fatfsRegisterDrive(uint8_t pdrv, BaseBlockDevice *bbdp);
+  void fatfsUnregisterDrive(uint8_t pdrv);
+  BaseBlockDevice *fatfsGetDrive(uint8_t pdrv);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FATFS_DISKIO_H */
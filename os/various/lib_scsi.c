@@ -41,10 +41,23 @@
 /*===========================================================================*/
 
 typedef struct {
-  uint32_t first_lba;
-  uint16_t blk_cnt;
+  uint64_t first_lba;
+  uint32_t blk_cnt;
 } data_request_t;
 
+/**
+ * @brief   Data phase pipeline state.
+ */
+typedef struct {
+  const SCSITransport *tr;
+  BaseBlockDevice *blkdev;
+  size_t bs;
+  size_t chunk;
+  uint8_t *buf[2];
+  bool async;
+  uint32_t done;
+} data_pipe_t;
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -59,20 +72,35 @@ typedef struct {
 
 /**
  * @brief   Combines data request from byte array.
+ * @details Handles both 10 and 16 bytes CDBs, the CDB size is deduced
+ *          from the operation code group.
  *
  * @notapi
  */
 static data_request_t decode_data_request(const uint8_t *cmd) {
 
   data_request_t req;
-  uint32_t lba;
-  uint16_t blk;
 
-  memcpy(&lba, &cmd[2], sizeof(lba));
-  memcpy(&blk, &cmd[7], sizeof(blk));
+  if ((cmd[0] & 0xE0) == 0x80) {
+    uint64_t lba;
+    uint32_t blk;
+
+    memcpy(&lba, &cmd[2], sizeof(lba));
+    memcpy(&blk, &cmd[10], sizeof(blk));
 
-  req.first_lba = be32_to_cpu(lba);
-  req.blk_cnt = be16_to_cpu(blk);
+    req.first_lba = BE64_TO_CPU(lba);
+    req.blk_cnt = be32_to_cpu(blk);
+  }
+  else {
+    uint32_t lba;
+    uint16_t blk;
+
+    memcpy(&lba, &cmd[2], sizeof(lba));
+    memcpy(&blk, &cmd[7], sizeof(blk));
+
+    req.first_lba = be32_to_cpu(lba);
+    req.blk_cnt = be16_to_cpu(blk);
+  }
 
   return req;
 }
@@ -100,6 +128,38 @@ static void set_sense(SCSITarget *scsip, uint8_t key,
   sense->byte[13] = qual;
 }
 
+/**
+ * @brief   Reports a medium error.
+ * @details Fills sense data with MEDIUM ERROR key and the address of the
+ *          first block of the failed access in the information field.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[in] code    SCSI sense code
+ * @param[in] lba     address of the failed block
+ * @param[in] residue number of bytes not transferred
+ *
+ * @return            Always @p SCSI_FAILED.
+ *
+ * @notapi
+ */
+static bool set_medium_error(SCSITarget *scsip, uint8_t code,
+                             uint32_t lba, uint32_t residue) {
+
+  scsi_sense_response_t *sense = &scsip->sense;
+
+  set_sense(scsip, SCSI_SENSE_KEY_MEDIUM_ERROR, code,
+                   SCSI_ASENSEQ_NO_QUALIFIER);
+  sense->byte[0] |= 0x80;
+  sense->byte[3]  = lba >> 24;
+  sense->byte[4]  = lba >> 16;
+  sense->byte[5]  = lba >> 8;
+  sense->byte[6]  = lba & 0xFF;
+  scsip->residue = residue;
+  errprintf("SCSI medium error at LBA %U\r\n", lba);
+
+  return SCSI_FAILED;
+}
+
 /**
  * @brief   Sets all values in sense data to 'success' condition.
  *
@@ -311,6 +371,49 @@ static bool read_capacity10(SCSITarget *scsip, const uint8_t *cmd) {
                         sizeof(scsi_read_capacity10_response_t));
 }
 
+/**
+ * @brief   SCSI service action in (16) command handler.
+ * @details Only the read capacity (16) service action is supported.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[in] cmd     pointer to SCSI command data
+ *
+ * @return            The operation status.
+ *
+ * @notapi
+ */
+static bool service_action_in16(SCSITarget *scsip, const uint8_t *cmd) {
+
+  if ((cmd[1] & 0x1F) != SCSI_SA_READ_CAPACITY_16) {
+    return cmd_unhandled(scsip, cmd);
+  }
+  else {
+    scsi_read_capacity16_response_t ret;
+    BlockDeviceInfo bdi;
+    uint64_t last;
+    uint32_t tmp;
+    uint32_t len;
+
+    memcpy(&tmp, &cmd[10], sizeof(tmp));
+    len = be32_to_cpu(tmp);
+    if (len > sizeof(scsi_read_capacity16_response_t)) {
+      len = sizeof(scsi_read_capacity16_response_t);
+    }
+    if (0 == len) {
+      return SCSI_SUCCESS;
+    }
+
+    blkGetInfo(scsip->config->blkdev, &bdi);
+    memset(&ret, 0, sizeof(ret));
+    last = CPU_TO_BE64((uint64_t)bdi.blk_num - 1U);
+    memcpy(ret.last_block_addr, &last, sizeof(last));
+    tmp = cpu_to_be32(bdi.blk_size);
+    memcpy(ret.block_size, &tmp, sizeof(tmp));
+
+    return transmit_data(scsip, (uint8_t *)&ret, len);
+  }
+}
+
 /**
  * @brief   Checks data request for media overflow.
  *
@@ -328,7 +431,8 @@ static bool data_overflow(SCSITarget *scsip, const data_request_t *req) {
   BlockDeviceInfo bdi;
   blkGetInfo(scsip->config->blkdev, &bdi);
 
-  if (req->first_lba + req->blk_cnt > bdi.blk_num) {
+  if ((req->first_lba > bdi.blk_num) ||
+      (req->blk_cnt > bdi.blk_num - req->first_lba)) {
     set_sense(scsip, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
                      SCSI_ASENSE_LBA_OUT_OF_RANGE,
                      SCSI_ASENSEQ_NO_QUALIFIER);
@@ -339,6 +443,236 @@ static bool data_overflow(SCSITarget *scsip, const data_request_t *req) {
   }
 }
 
+/**
+ * @brief   Prepares data phase pipeline.
+ * @details The data buffer is split in two halves when it can hold at
+ *          least two blocks, the transport is used asynchronously only
+ *          in that case.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[out] pipe   pointer to @p data_pipe_t structure
+ *
+ * @notapi
+ */
+static void pipe_init(SCSITarget *scsip, data_pipe_t *pipe) {
+
+  const SCSITargetConfig *cfg = scsip->config;
+  BlockDeviceInfo bdi;
+
+  pipe->tr = cfg->transport;
+  pipe->blkdev = cfg->blkdev;
+  blkGetInfo(pipe->blkdev, &bdi);
+  pipe->bs = bdi.blk_size;
+  pipe->done = 0;
+
+  if (cfg->blkbuf_blocks >= 2) {
+    pipe->chunk = cfg->blkbuf_blocks / 2;
+    pipe->buf[0] = cfg->blkbuf;
+    pipe->buf[1] = cfg->blkbuf + pipe->chunk * pipe->bs;
+    pipe->async = (pipe->tr->start_transmit != NULL) &&
+                  (pipe->tr->start_receive != NULL) &&
+                  (pipe->tr->wait != NULL);
+  }
+  else {
+    pipe->chunk = 1;
+    pipe->buf[0] = cfg->blkbuf;
+    pipe->buf[1] = cfg->blkbuf;
+    pipe->async = false;
+  }
+}
+
+/**
+ * @brief   Starts a data phase transfer.
+ * @details Without asynchronous transport the transfer is performed here
+ *          and its result is returned by the following @p pipe_wait().
+ *
+ * @param[in] pipe    pointer to @p data_pipe_t structure
+ * @param[in] tx      @p true for device to host transfers
+ * @param[in] data    pointer to data buffer
+ * @param[in] len     number of bytes to be transferred
+ *
+ * @notapi
+ */
+static void pipe_start(data_pipe_t *pipe, bool tx, uint8_t *data, size_t len) {
+
+  const SCSITransport *tr = pipe->tr;
+
+  if (pipe->async) {
+    if (tx) {
+      tr->start_transmit(tr, data, len);
+    }
+    else {
+      tr->start_receive(tr, data, len);
+    }
+  }
+  else {
+    if (tx) {
+      pipe->done = tr->transmit(tr, data, len);
+    }
+    else {
+      pipe->done = tr->receive(tr, data, len);
+    }
+  }
+}
+
+/**
+ * @brief   Waits for the data phase transfer started last.
+ *
+ * @param[in] pipe    pointer to @p data_pipe_t structure
+ *
+ * @return            Number of transferred bytes.
+ *
+ * @notapi
+ */
+static uint32_t pipe_wait(data_pipe_t *pipe) {
+
+  if (pipe->async) {
+    return pipe->tr->wait(pipe->tr);
+  }
+  return pipe->done;
+}
+
+/**
+ * @brief   Returns the size of the next chunk in blocks.
+ *
+ * @notapi
+ */
+static size_t pipe_chunk(const data_pipe_t *pipe, size_t remaining) {
+
+  return (remaining < pipe->chunk) ? remaining : pipe->chunk;
+}
+
+/**
+ * @brief   Reads blocks from medium and transmits them to the host.
+ * @details Transmission of a chunk overlaps the read of the next one.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[in] req     pointer to @p data_request_t structure
+ *
+ * @return            The operation status.
+ *
+ * @notapi
+ */
+static bool data_read(SCSITarget *scsip, const data_request_t *req) {
+
+  data_pipe_t pipe;
+  uint32_t lba = (uint32_t)req->first_lba;
+  size_t remaining = req->blk_cnt;
+  size_t n, cur;
+  uint32_t got;
+  unsigned k = 0;
+
+  if (0 == remaining) {
+    return SCSI_SUCCESS;
+  }
+
+  pipe_init(scsip, &pipe);
+  n = pipe_chunk(&pipe, remaining);
+  if (HAL_SUCCESS != blkRead(pipe.blkdev, lba, pipe.buf[0], n)) {
+    return set_medium_error(scsip, SCSI_ASENSE_UNRECOVERED_READ_ERROR,
+                            lba, remaining * pipe.bs);
+  }
+
+  while (remaining > 0) {
+    bool err = HAL_SUCCESS;
+
+    cur = n;
+    pipe_start(&pipe, true, pipe.buf[k], cur * pipe.bs);
+    lba += cur;
+    remaining -= cur;
+    if (remaining > 0) {
+      n = pipe_chunk(&pipe, remaining);
+      err = blkRead(pipe.blkdev, lba, pipe.buf[k ^ 1], n);
+    }
+    got = pipe_wait(&pipe);
+    if (got != cur * pipe.bs) {
+      scsip->residue = (remaining + cur) * pipe.bs - got;
+      return SCSI_FAILED;
+    }
+    if (HAL_SUCCESS != err) {
+      /* Data already read is sent, the transfer stops at the bad chunk.*/
+      return set_medium_error(scsip, SCSI_ASENSE_UNRECOVERED_READ_ERROR,
+                              lba, remaining * pipe.bs);
+    }
+    k ^= 1;
+  }
+
+  return SCSI_SUCCESS;
+}
+
+/**
+ * @brief   Receives blocks from the host and writes them to medium.
+ * @details Reception of a chunk overlaps the write of the previous one.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[in] req     pointer to @p data_request_t structure
+ *
+ * @return            The operation status.
+ *
+ * @notapi
+ */
+static bool data_write(SCSITarget *scsip, const data_request_t *req) {
+
+  data_pipe_t pipe;
+  uint32_t lba = (uint32_t)req->first_lba;
+  size_t remaining = req->blk_cnt;
+  size_t n, cur;
+  uint32_t got;
+  unsigned k = 0;
+
+  if (0 == remaining) {
+    return SCSI_SUCCESS;
+  }
+
+  pipe_init(scsip, &pipe);
+  if (blkIsWriteProtected(pipe.blkdev)) {
+    set_sense(scsip, SCSI_SENSE_KEY_DATA_PROTECT,
+                     SCSI_ASENSE_WRITE_PROTECTED,
+                     SCSI_ASENSEQ_NO_QUALIFIER);
+    scsip->residue = remaining * pipe.bs;
+    return SCSI_FAILED;
+  }
+  n = pipe_chunk(&pipe, remaining);
+  pipe_start(&pipe, false, pipe.buf[0], n * pipe.bs);
+  got = pipe_wait(&pipe);
+  if (got != n * pipe.bs) {
+    scsip->residue = remaining * pipe.bs - got;
+    return SCSI_FAILED;
+  }
+
+  while (remaining > 0) {
+    bool err;
+
+    cur = n;
+    remaining -= cur;
+    n = pipe_chunk(&pipe, remaining);
+    if ((remaining > 0) && pipe.async) {
+      pipe_start(&pipe, false, pipe.buf[k ^ 1], n * pipe.bs);
+    }
+    err = blkWrite(pipe.blkdev, lba, pipe.buf[k], cur);
+    if ((remaining > 0) && (pipe.async || (HAL_SUCCESS == err))) {
+      if (!pipe.async) {
+        /* Buffer halves may alias, receive only after the write.*/
+        pipe_start(&pipe, false, pipe.buf[k ^ 1], n * pipe.bs);
+      }
+      /* A transfer in progress must complete even after a write error.*/
+      got = pipe_wait(&pipe);
+      if ((HAL_SUCCESS == err) && (got != n * pipe.bs)) {
+        scsip->residue = remaining * pipe.bs - got;
+        return SCSI_FAILED;
+      }
+    }
+    if (HAL_SUCCESS != err) {
+      return set_medium_error(scsip, SCSI_ASENSE_WRITE_ERROR,
+                              lba, (remaining + cur) * pipe.bs);
+    }
+    lba += cur;
+    k ^= 1;
+  }
+
+  return SCSI_SUCCESS;
+}
+
 /**
  * @brief   SCSI read/write (10) command handler.
  *
@@ -349,34 +683,125 @@ static bool data_overflow(SCSITarget *scsip, const data_request_t *req) {
  *
  * @notapi
  */
-static bool data_read_write10(SCSITarget *scsip, const uint8_t *cmd) {
+static bool data_read_write(SCSITarget *scsip, const uint8_t *cmd) {
 
   data_request_t req = decode_data_request(cmd);
 
   if (data_overflow(scsip, &req)) {
     return SCSI_FAILED;
   }
+  else if ((cmd[0] == SCSI_CMD_READ_10) || (cmd[0] == SCSI_CMD_READ_16)) {
+    return data_read(scsip, &req);
+  }
   else {
-    const SCSITransport *tr = scsip->config->transport;
-    BaseBlockDevice *blkdev = scsip->config->blkdev;
+    return data_write(scsip, &req);
+  }
+}
+
+/**
+ * @brief   SCSI write same (10) and (16) command handler.
+ * @details A single block is received and written to the whole range,
+ *          replicated over the data buffer so that the medium is accessed
+ *          with multi-block writes. A zero block count extends the range
+ *          to the end of the medium.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[in] cmd     pointer to SCSI command data
+ *
+ * @return            The operation status.
+ *
+ * @notapi
+ */
+static bool write_same(SCSITarget *scsip, const uint8_t *cmd) {
+
+  data_request_t req = decode_data_request(cmd);
+  data_pipe_t pipe;
+  size_t fill, n, i;
+  uint32_t lba;
+
+  /* PBDATA and LBDATA are not supported, UNMAP is a plain write here.*/
+  if ((cmd[1] & 0x06) != 0) {
+    set_sense(scsip, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                     SCSI_ASENSE_INVALID_FIELD_IN_CDB,
+                     SCSI_ASENSEQ_NO_QUALIFIER);
+    return SCSI_FAILED;
+  }
+
+  pipe_init(scsip, &pipe);
+  if (0 == req.blk_cnt) {
     BlockDeviceInfo bdi;
-    blkGetInfo(blkdev, &bdi);
-    size_t bs = bdi.blk_size;
-    uint8_t *buf = scsip->config->blkbuf;
-
-    size_t i = 0;
-    for (i=0; i<req.blk_cnt; i++) {
-      if (cmd[0] == SCSI_CMD_READ_10) {
-        // TODO: block error handling
-        blkRead(blkdev, req.first_lba + i, buf, 1);
-        tr->transmit(tr, buf, bs);
-      }
-      else {
-        // TODO: block error handling
-        tr->receive(tr, buf, bs);
-        blkWrite(blkdev, req.first_lba + i, buf, 1);
-      }
+
+    blkGetInfo(pipe.blkdev, &bdi);
+    if (req.first_lba >= bdi.blk_num) {
+      /* No block to extend the range from.*/
+      set_sense(scsip, SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+                       SCSI_ASENSE_LBA_OUT_OF_RANGE,
+                       SCSI_ASENSEQ_NO_QUALIFIER);
+      return SCSI_FAILED;
+    }
+    req.blk_cnt = bdi.blk_num - (uint32_t)req.first_lba;
+  }
+  if (data_overflow(scsip, &req)) {
+    return SCSI_FAILED;
+  }
+  if (blkIsWriteProtected(pipe.blkdev)) {
+    set_sense(scsip, SCSI_SENSE_KEY_DATA_PROTECT,
+                     SCSI_ASENSE_WRITE_PROTECTED,
+                     SCSI_ASENSEQ_NO_QUALIFIER);
+    scsip->residue = pipe.bs;
+    return SCSI_FAILED;
+  }
+
+  /* Synchronous reception, the buffer is going to be overwritten.*/
+  pipe.async = false;
+  pipe_start(&pipe, false, pipe.buf[0], pipe.bs);
+  if (pipe_wait(&pipe) != pipe.bs) {
+    scsip->residue = pipe.bs - pipe.done;
+    return SCSI_FAILED;
+  }
+
+  fill = scsip->config->blkbuf_blocks;
+  if (fill == 0) {
+    fill = 1;
+  }
+  if (fill > req.blk_cnt) {
+    fill = req.blk_cnt;
+  }
+  for (i = 1; i < fill; i++) {
+    memcpy(pipe.buf[0] + i * pipe.bs, pipe.buf[0], pipe.bs);
+  }
+
+  lba = (uint32_t)req.first_lba;
+  while (req.blk_cnt > 0) {
+    n = (req.blk_cnt < fill) ? req.blk_cnt : fill;
+    if (HAL_SUCCESS != blkWrite(pipe.blkdev, lba, pipe.buf[0], n)) {
+      return set_medium_error(scsip, SCSI_ASENSE_WRITE_ERROR, lba, 0);
     }
+    lba += n;
+    req.blk_cnt -= n;
+  }
+
+  return SCSI_SUCCESS;
+}
+
+/**
+ * @brief   SCSI synchronize cache (10) and (16) command handler.
+ * @details The whole device is synchronized regardless of the range.
+ *
+ * @param[in] scsip   pointer to @p SCSITarget structure
+ * @param[in] cmd     pointer to SCSI command data
+ *
+ * @return            The operation status.
+ *
+ * @notapi
+ */
+static bool synchronize_cache(SCSITarget *scsip, const uint8_t *cmd) {
+
+  data_request_t req = decode_data_request(cmd);
+
+  if (HAL_SUCCESS != blkSync(scsip->config->blkdev)) {
+    return set_medium_error(scsip, SCSI_ASENSE_WRITE_ERROR,
+                            (uint32_t)req.first_lba, 0);
   }
   return SCSI_SUCCESS;
 }
@@ -426,6 +851,9 @@ bool scsiExecCmd(SCSITarget *scsip, const uint8_t *cmd) {
 
   bool ret = SCSI_SUCCESS;
 
+  /* the residue only describes the command being executed */
+  scsip->residue = 0;
+
   switch (cmd[0]) {
   case SCSI_CMD_INQUIRY:
     dbgprintf("SCSI_CMD_INQUIRY\r\n");
@@ -442,14 +870,49 @@ bool scsiExecCmd(SCSITarget *scsip, const uint8_t *cmd) {
     ret = read_capacity10(scsip, cmd);
     break;
 
+  case SCSI_CMD_SERVICE_ACTION_IN_16:
+    dbgprintf("SCSI_CMD_SERVICE_ACTION_IN_16\r\n");
+    ret = service_action_in16(scsip, cmd);
+    break;
+
   case SCSI_CMD_READ_10:
     dbgprintf("SCSI_CMD_READ_10\r\n");
-    ret = data_read_write10(scsip, cmd);
+    ret = data_read_write(scsip, cmd);
     break;
 
   case SCSI_CMD_WRITE_10:
     dbgprintf("SCSI_CMD_WRITE_10\r\n");
-    ret = data_read_write10(scsip, cmd);
+    ret = data_read_write(scsip, cmd);
+    break;
+
+  case SCSI_CMD_READ_16:
+    dbgprintf("SCSI_CMD_READ_16\r\n");
+    ret = data_read_write(scsip, cmd);
+    break;
+
+  case SCSI_CMD_WRITE_16:
+    dbgprintf("SCSI_CMD_WRITE_16\r\n");
+    ret = data_read_write(scsip, cmd);
+    break;
+
+  case SCSI_CMD_WRITE_SAME_10:
+    dbgprintf("SCSI_CMD_WRITE_SAME_10\r\n");
+    ret = write_same(scsip, cmd);
+    break;
+
+  case SCSI_CMD_WRITE_SAME_16:
+    dbgprintf("SCSI_CMD_WRITE_SAME_16\r\n");
+    ret = write_same(scsip, cmd);
+    break;
+
+  case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+    dbgprintf("SCSI_CMD_SYNCHRONIZE_CACHE_10\r\n");
+    ret = synchronize_cache(scsip, cmd);
+    break;
+
+  case SCSI_CMD_SYNCHRONIZE_CACHE_16:
+    dbgprintf("SCSI_CMD_SYNCHRONIZE_CACHE_16\r\n");
+    ret = synchronize_cache(scsip, cmd);
     break;
 
   case SCSI_CMD_TEST_UNIT_READY:
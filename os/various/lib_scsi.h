@@ -41,6 +41,15 @@
 #define SCSI_CMD_READ_10                        0x28
 #define SCSI_CMD_WRITE_10                       0x2A
 #define SCSI_CMD_VERIFY_10                      0x2F
+#define SCSI_CMD_SYNCHRONIZE_CACHE_10           0x35
+#define SCSI_CMD_WRITE_SAME_10                  0x41
+#define SCSI_CMD_READ_16                        0x88
+#define SCSI_CMD_WRITE_16                       0x8A
+#define SCSI_CMD_SYNCHRONIZE_CACHE_16           0x91
+#define SCSI_CMD_WRITE_SAME_16                  0x93
+#define SCSI_CMD_SERVICE_ACTION_IN_16           0x9E
+
+#define SCSI_SA_READ_CAPACITY_16                0x10
 
 #define SCSI_SENSE_KEY_GOOD                     0x00
 #define SCSI_SENSE_KEY_RECOVERED_ERROR          0x01
@@ -59,6 +68,8 @@
 
 #define SCSI_ASENSE_NO_ADDITIONAL_INFORMATION   0x00
 #define SCSI_ASENSE_LOGICAL_UNIT_NOT_READY      0x04
+#define SCSI_ASENSE_WRITE_ERROR                 0x0C
+#define SCSI_ASENSE_UNRECOVERED_READ_ERROR      0x11
 #define SCSI_ASENSE_INVALID_FIELD_IN_CDB        0x24
 #define SCSI_ASENSE_NOT_READY_TO_READY_CHANGE   0x28
 #define SCSI_ASENSE_WRITE_PROTECTED             0x27
@@ -168,6 +179,16 @@ typedef struct PACKED_VAR {
   uint32_t block_size;
 } scsi_read_capacity10_response_t;
 
+/**
+ * @brief   Represents SCSI read capacity (16) response structure.
+ * @details See SCSI specification.
+ */
+typedef struct PACKED_VAR {
+  uint8_t last_block_addr[8];
+  uint8_t block_size[4];
+  uint8_t reserved[20];
+} scsi_read_capacity16_response_t;
+
 /**
  * @brief   Represents SCSI read format capacity response structure.
  * @details See SCSI specification.
@@ -198,6 +219,35 @@ typedef uint32_t (*scsi_transport_transmit_t)(const SCSITransport *transport,
 typedef uint32_t (*scsi_transport_receive_t)(const SCSITransport *transport,
                                              uint8_t *data, size_t len);
 
+/**
+ * @brief   Type of a SCSI transport asynchronous transmit start call.
+ *
+ * @param[in] transport pointer to the @p SCSITransport object
+ * @param[in] data      pointer to payload buffer
+ * @param[in] len       payload length
+ */
+typedef void (*scsi_transport_start_transmit_t)(const SCSITransport *transport,
+                                                const uint8_t *data, size_t len);
+
+/**
+ * @brief   Type of a SCSI transport asynchronous receive start call.
+ *
+ * @param[in] transport pointer to the @p SCSITransport object
+ * @param[out] data     pointer to receive buffer
+ * @param[in] len       number of bytes to be received
+ */
+typedef void (*scsi_transport_start_receive_t)(const SCSITransport *transport,
+                                               uint8_t *data, size_t len);
+
+/**
+ * @brief   Type of a SCSI transport asynchronous completion wait call.
+ * @details Waits for the transfer started by the last start call.
+ *
+ * @param[in] transport pointer to the @p SCSITransport object
+ * @return              Number of successfully transferred bytes.
+ */
+typedef uint32_t (*scsi_transport_wait_t)(const SCSITransport *transport);
+
 /**
  * @brief   SCSI transport structure.
  */
@@ -210,6 +260,20 @@ struct SCSITransport {
    * @brief   Receive call provided by lower level driver.
    */
   scsi_transport_receive_t      receive;
+  /**
+   * @brief   Asynchronous transmit start call, may be @p NULL.
+   * @details When the asynchronous calls are provided data phase transfers
+   *          are overlapped with block device accesses.
+   */
+  scsi_transport_start_transmit_t start_transmit;
+  /**
+   * @brief   Asynchronous receive start call, may be @p NULL.
+   */
+  scsi_transport_start_receive_t  start_receive;
+  /**
+   * @brief   Asynchronous transfer completion wait call, may be @p NULL.
+   */
+  scsi_transport_wait_t         wait;
   /**
    * @brief   Transport handler provided by lower level driver.
    */
@@ -229,9 +293,16 @@ typedef struct {
    */
   BaseBlockDevice               *blkdev;
   /**
-   * @brief   Pointer to data buffer for single block.
+   * @brief   Pointer to data buffer.
    */
   uint8_t                       *blkbuf;
+  /**
+   * @brief   Size of the data buffer in blocks, at least 1.
+   * @details With 2 or more blocks multi-block transfers are performed in
+   *          chunks of half the buffer, one half being transferred over the
+   *          transport while the other one is accessed on the medium.
+   */
+  size_t                        blkbuf_blocks;
   /**
    * @brief   Pointer to SCSI inquiry response object.
    */
@@ -0,0 +1,340 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "osal.h"
+#include "multibuf.h"
+
+/**
+ * @file    multibuf.c
+ * @brief   N-buffer handler source.
+ *
+ * @addtogroup MultiBuf
+ * @{
+ */
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a buffer to the free pool.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @param[in] index     Buffer index.
+ */
+static void pool_put(multibuf_t *handler, uint8_t index) {
+
+  handler->pool[handler->pcount++] = index;
+}
+
+/**
+ * @brief   Removes the oldest buffer from the ready queue.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Buffer index.
+ */
+static uint8_t queue_get(multibuf_t *handler) {
+  uint8_t index;
+
+  index = handler->queue[handler->qhead];
+  if (++handler->qhead >= handler->n) {
+    handler->qhead = 0U;
+  }
+  handler->qcount--;
+  return index;
+}
+
+/**
+ * @brief   Appends a buffer to the ready queue.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @param[in] index     Buffer index.
+ */
+static void queue_put(multibuf_t *handler, uint8_t index) {
+  unsigned tail;
+
+  tail = (unsigned)handler->qhead + (unsigned)handler->qcount;
+  if (tail >= handler->n) {
+    tail -= handler->n;
+  }
+  handler->queue[tail] = index;
+  handler->qcount++;
+}
+
+#if (TRIBUF_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Aligns the ready semaphore to the ready queue state.
+ * @details The semaphore acts as a binary flag, it is signaled when at
+ *          least one buffer is ready and reset when the queue is empty.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ *
+ * @iclass
+ */
+static void update_ready(multibuf_t *handler) {
+
+  if (handler->qcount > 0U) {
+    if (chSemGetCounterI(&handler->ready) == 0) {
+      chSemSignalI(&handler->ready);
+    }
+  }
+  else if (chSemGetCounterI(&handler->ready) > 0) {
+    /* No waiters can be queued on a positive counter.*/
+    chSemResetI(&handler->ready, 0);
+  }
+}
+#endif
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the N-buffer handler object.
+ * @details The first buffer becomes the front buffer, the second one the
+ *          back buffer, the remaining ones are free.
+ * @note    With three buffers in @p MULTIBUF_LATEST mode the behavior is
+ *          the same as the triple buffer.
+ *
+ * @param[out] handler  Pointer to the multibuf handler object.
+ * @param[in] buffers   Array of @p n buffer pointers, must stay valid for
+ *                      the whole handler lifetime.
+ * @param[in] n         Number of buffers, from 3 to
+ *                      @p MULTIBUF_MAX_BUFFERS.
+ * @param[in] mode      Consumption policy.
+ *
+ * @init
+ */
+void multibufObjectInit(multibuf_t *handler, void * const *buffers,
+                        size_t n, multibuf_mode_t mode) {
+  uint8_t i;
+
+  osalDbgCheck((handler != NULL) && (buffers != NULL) &&
+               (n >= 3U) && (n <= MULTIBUF_MAX_BUFFERS));
+
+  handler->buffers = buffers;
+  handler->n = (uint8_t)n;
+  handler->mode = (uint8_t)mode;
+  handler->front = 0U;
+  handler->back = 1U;
+  handler->qhead = 0U;
+  handler->qcount = 0U;
+  handler->pcount = 0U;
+  for (i = (uint8_t)(n - 1U); i >= 2U; i--) {
+    pool_put(handler, i);
+  }
+  handler->dropped = 0U;
+#if (TRIBUF_USE_WAIT == TRUE)
+  chSemObjectInit(&handler->ready, (cnt_t)0);
+#endif
+}
+
+/**
+ * @brief   Gets the current front buffer.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Pointer to the current front buffer.
+ *
+ * @api
+ */
+void *multibufGetFront(multibuf_t *handler) {
+
+  void *front;
+
+  osalSysLock();
+  front = multibufGetFrontI(handler);
+  osalSysUnlock();
+  return front;
+}
+
+/**
+ * @brief   Swaps the current front buffer.
+ * @details The front buffer is released to the free pool and replaced by
+ *          the newest ready buffer in @p MULTIBUF_LATEST mode, older ready
+ *          buffers being released too, or by the oldest ready buffer in
+ *          @p MULTIBUF_FIFO mode. Nothing is done if no buffer is ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  The swap result.
+ * @retval true         A new front buffer is available.
+ * @retval false        No buffer was ready, the front buffer is unchanged.
+ *
+ * @iclass
+ */
+bool multibufSwapFrontI(multibuf_t *handler) {
+
+  osalDbgCheckClassI();
+
+  if (handler->qcount == 0U) {
+    return false;
+  }
+
+  pool_put(handler, handler->front);
+  if (handler->mode == (uint8_t)MULTIBUF_LATEST) {
+    while (handler->qcount > 1U) {
+      pool_put(handler, queue_get(handler));
+      handler->dropped++;
+    }
+  }
+  handler->front = queue_get(handler);
+#if (TRIBUF_USE_WAIT == TRUE)
+  update_ready(handler);
+#endif
+  return true;
+}
+
+/**
+ * @brief   Swaps the current front buffer.
+ * @details The front buffer is released to the free pool and replaced by
+ *          the newest ready buffer in @p MULTIBUF_LATEST mode, older ready
+ *          buffers being released too, or by the oldest ready buffer in
+ *          @p MULTIBUF_FIFO mode. Nothing is done if no buffer is ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  The swap result.
+ * @retval true         A new front buffer is available.
+ * @retval false        No buffer was ready, the front buffer is unchanged.
+ *
+ * @api
+ */
+bool multibufSwapFront(multibuf_t *handler) {
+
+  bool swapped;
+
+  osalSysLock();
+  swapped = multibufSwapFrontI(handler);
+  osalSysUnlock();
+  return swapped;
+}
+
+/**
+ * @brief   Gets the current back buffer.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Pointer to the current back buffer.
+ *
+ * @api
+ */
+void *multibufGetBack(multibuf_t *handler) {
+
+  void *back;
+
+  osalSysLock();
+  back = multibufGetBackI(handler);
+  osalSysUnlock();
+  return back;
+}
+
+/**
+ * @brief   Swaps the current back buffer.
+ * @details The back buffer is appended to the ready queue and replaced by
+ *          a free buffer. When no free buffer is left, in
+ *          @p MULTIBUF_LATEST mode the oldest ready buffer is recycled,
+ *          in @p MULTIBUF_FIFO mode the back buffer is not queued and is
+ *          kept by the producer. Both cases count as a dropped frame.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  The swap result.
+ * @retval true         No frame was dropped.
+ * @retval false        A frame was dropped.
+ *
+ * @iclass
+ */
+bool multibufSwapBackI(multibuf_t *handler) {
+
+  bool ok = true;
+
+  osalDbgCheckClassI();
+
+  if (handler->pcount == 0U) {
+    handler->dropped++;
+    ok = false;
+    if (handler->mode == (uint8_t)MULTIBUF_FIFO) {
+      return false;
+    }
+    pool_put(handler, queue_get(handler));
+  }
+  queue_put(handler, handler->back);
+  handler->back = handler->pool[--handler->pcount];
+#if (TRIBUF_USE_WAIT == TRUE)
+  update_ready(handler);
+#endif
+  return ok;
+}
+
+/**
+ * @brief   Swaps the current back buffer.
+ * @details The back buffer is appended to the ready queue and replaced by
+ *          a free buffer. When no free buffer is left, in
+ *          @p MULTIBUF_LATEST mode the oldest ready buffer is recycled,
+ *          in @p MULTIBUF_FIFO mode the back buffer is not queued and is
+ *          kept by the producer. Both cases count as a dropped frame.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  The swap result.
+ * @retval true         No frame was dropped.
+ * @retval false        A frame was dropped.
+ *
+ * @api
+ */
+bool multibufSwapBack(multibuf_t *handler) {
+
+  bool ok;
+
+  osalSysLock();
+  ok = multibufSwapBackI(handler);
+#if (TRIBUF_USE_WAIT == TRUE)
+  osalOsRescheduleS();
+#endif
+  osalSysUnlock();
+  return ok;
+}
+
+/**
+ * @brief   Gets the number of dropped frames.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Number of dropped frames since initialization.
+ *
+ * @api
+ */
+uint32_t multibufGetDropped(multibuf_t *handler) {
+
+  uint32_t dropped;
+
+  osalSysLock();
+  dropped = multibufGetDroppedI(handler);
+  osalSysUnlock();
+  return dropped;
+}
+
+/** @} */
@@ -0,0 +1,289 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    multibuf.h
+ * @brief   N-buffer handler header.
+ * @details Generalization of the triple buffer to an arbitrary number of
+ *          buffers, with either "latest wins" or bounded FIFO consumption.
+ *          Configuration is shared with the triple buffer, see
+ *          @p TRIBUF_USE_WAIT.
+ *
+ * @addtogroup MultiBuf
+ * @{
+ */
+
+#ifndef MULTIBUF_H_
+#define MULTIBUF_H_
+
+#include "tribuf.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    N-buffer configuration options
+ * @{
+ */
+
+/**
+ * @brief   Maximum number of buffers handled by a single object.
+ */
+#if !defined(MULTIBUF_MAX_BUFFERS) || defined(__DOXYGEN__)
+#define MULTIBUF_MAX_BUFFERS  8
+#endif
+
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (MULTIBUF_MAX_BUFFERS < 3) || (MULTIBUF_MAX_BUFFERS > 255)
+#error "MULTIBUF_MAX_BUFFERS must be within 3 and 255"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Consumption policy of the ready buffers.
+ */
+typedef enum {
+  MULTIBUF_LATEST = 0,        /**< Newest buffer wins, older are recycled.*/
+  MULTIBUF_FIFO = 1           /**< Buffers consumed in order, newest are
+                                   dropped when no free buffer is left.*/
+} multibuf_mode_t;
+
+/**
+ * @brief   N-buffer handler object.
+ * @details Buffers are referenced by index. Besides the front and back
+ *          buffers, owned by consumer and producer, each buffer is either
+ *          in the ready queue or in the free pool.
+ */
+typedef struct {
+  void * const *buffers;      /**< @brief Buffer pointers array.*/
+  uint8_t n;                  /**< @brief Number of buffers.*/
+  uint8_t mode;               /**< @brief Consumption policy.*/
+  uint8_t front;              /**< @brief Front buffer index.*/
+  uint8_t back;               /**< @brief Back buffer index.*/
+  uint8_t queue[MULTIBUF_MAX_BUFFERS]; /**< @brief Ready buffers ring.*/
+  uint8_t qhead;              /**< @brief Oldest ready buffer position.*/
+  uint8_t qcount;             /**< @brief Number of ready buffers.*/
+  uint8_t pool[MULTIBUF_MAX_BUFFERS]; /**< @brief Free buffers stack.*/
+  uint8_t pcount;             /**< @brief Number of free buffers.*/
+  uint32_t dropped;           /**< @brief Frames dropped or overwritten.*/
+#if (TRIBUF_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+  semaphore_t ready;          /**< @brief A new front buffer is ready.*/
+#endif
+} multibuf_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks if a new front buffer is ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Availability of a new front buffer.
+ *
+ * @iclass
+ */
+static inline
+bool multibufIsReadyI(multibuf_t *handler)
+{
+  osalDbgCheckClassI();
+
+  return (0U != handler->qcount);
+}
+
+/**
+ * @brief   Gets the number of ready buffers.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Number of buffers waiting to become front buffer.
+ *
+ * @iclass
+ */
+static inline
+size_t multibufGetReadyCountI(multibuf_t *handler)
+{
+  osalDbgCheckClassI();
+
+  return (size_t)handler->qcount;
+}
+
+/**
+ * @brief   Gets the number of dropped frames.
+ * @details In @p MULTIBUF_LATEST mode this counts ready buffers recycled
+ *          or skipped without becoming front buffer, in @p MULTIBUF_FIFO
+ *          mode it counts back buffer swaps refused because the queue was
+ *          full.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Number of dropped frames since initialization.
+ *
+ * @iclass
+ */
+static inline
+uint32_t multibufGetDroppedI(multibuf_t *handler)
+{
+  osalDbgCheckClassI();
+
+  return handler->dropped;
+}
+
+#if (TRIBUF_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+
+/**
+ * @brief   Waits until a new front buffer is ready, with timeout.
+ *
+ * @post  The ready signal is consumed, it is raised again by the front
+ *        buffer swap if more buffers are still ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @param[in] timeout   Timeout of the wait operation.
+ * @return  Timeout error code, as from @p chSemWaitTimeoutS.
+ *
+ * @see chSemWaitTimeoutS
+ * @sclass
+ */
+static inline
+msg_t multibufWaitReadyTimeoutS(multibuf_t *handler, systime_t timeout)
+{
+  osalDbgCheckClassS();
+
+  return chSemWaitTimeoutS(&handler->ready, timeout);
+}
+
+/**
+ * @brief   Waits until a new front buffer is ready, with timeout.
+ *
+ * @post  The ready signal is consumed, it is raised again by the front
+ *        buffer swap if more buffers are still ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @param[in] timeout   Timeout of the wait operation.
+ * @return  Timeout error code, as from @p chSemWaitTimeout.
+ *
+ * @see chSemWaitTimeout
+ * @api
+ */
+static inline
+msg_t multibufWaitReadyTimeout(multibuf_t *handler, systime_t timeout)
+{
+  return chSemWaitTimeout(&handler->ready, timeout);
+}
+
+/**
+ * @brief   Waits until a new front buffer is ready.
+ *
+ * @post  The ready signal is consumed, it is raised again by the front
+ *        buffer swap if more buffers are still ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ *
+ * @see chSemWaitS
+ * @sclass
+ */
+static inline
+void multibufWaitReadyS(multibuf_t *handler)
+{
+  osalDbgCheckClassS();
+
+  chSemWaitS(&handler->ready);
+}
+
+/**
+ * @brief   Waits until a new front buffer is ready.
+ *
+ * @post  The ready signal is consumed, it is raised again by the front
+ *        buffer swap if more buffers are still ready.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ *
+ * @see chSemWait
+ * @api
+ */
+static inline
+void multibufWaitReady(multibuf_t *handler)
+{
+  chSemWait(&handler->ready);
+}
+
+#endif  /* (TRIBUF_USE_WAIT == TRUE) || defined(__DOXYGEN__) */
+
+/**
+ * @brief   Gets the current front buffer.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Pointer to the current front buffer.
+ *
+ * @iclass
+ */
+static inline
+void *multibufGetFrontI(multibuf_t *handler) {
+
+  osalDbgCheckClassI();
+
+  return handler->buffers[handler->front];
+}
+
+/**
+ * @brief   Gets the current back buffer.
+ *
+ * @param[in] handler   Pointer to the multibuf handler object.
+ * @return  Pointer to the current back buffer.
+ *
+ * @iclass
+ */
+static inline
+void *multibufGetBackI(multibuf_t *handler) {
+
+  osalDbgCheckClassI();
+
+  return handler->buffers[handler->back];
+}
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void multibufObjectInit(multibuf_t *handler, void * const *buffers,
+                          size_t n, multibuf_mode_t mode);
+  void *multibufGetFront(multibuf_t *handler);
+  bool multibufSwapFrontI(multibuf_t *handler);
+  bool multibufSwapFront(multibuf_t *handler);
+  void *multibufGetBack(multibuf_t *handler);
+  bool multibufSwapBackI(multibuf_t *handler);
+  bool multibufSwapBack(multibuf_t *handler);
+  uint32_t multibufGetDropped(multibuf_t *handler);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* MULTIBUF_H_ */
+/** @} */
@@ -111,6 +111,40 @@ static bool write(void *instance, uint32_t startblk,
   }
 }
 
+static bool readv(void *instance, uint32_t startblk,
+                  const blkiov_t *iov, uint32_t iovcnt) {
+
+  RamDisk *rd = instance;
+  const uint32_t bs = rd->blk_size;
+
+  if (overflow(rd, startblk, ioblockvGetBlocks(iov, iovcnt))) {
+    return HAL_FAILED;
+  }
+  while (iovcnt-- > 0U) {
+    memcpy(iov->buffer, &rd->storage[startblk * bs], iov->n * bs);
+    startblk += iov->n;
+    iov++;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool writev(void *instance, uint32_t startblk,
+                   const blkiov_t *iov, uint32_t iovcnt) {
+
+  RamDisk *rd = instance;
+  const uint32_t bs = rd->blk_size;
+
+  if (overflow(rd, startblk, ioblockvGetBlocks(iov, iovcnt))) {
+    return HAL_FAILED;
+  }
+  while (iovcnt-- > 0U) {
+    memcpy(&rd->storage[startblk * bs], iov->buffer, iov->n * bs);
+    startblk += iov->n;
+    iov++;
+  }
+  return HAL_SUCCESS;
+}
+
 static bool sync(void *instance) {
 
   RamDisk *rd = instance;
@@ -138,7 +172,7 @@ static bool get_info(void *instance, BlockDeviceInfo *bdip) {
 /**
  *
  */
-static const struct BaseBlockDeviceVMT vmt = {
+static const struct BaseVectoredBlockDeviceVMT vmt = {
     is_inserted,
     is_protected,
     connect,
@@ -146,8 +180,184 @@ static const struct BaseBlockDeviceVMT vmt = {
     read,
     write,
     sync,
-    get_info
+    get_info,
+    readv,
+    writev
+};
+
+#if RAMDISK_USE_SPARSE == TRUE
+/*
+ * Sparse storage. Free pool slots are chained through their first word,
+ * slot numbers are stored plus one so that zero means "no slot".
+ */
+static uint8_t *slot_data(const RamDisk *rd, uint32_t slot) {
+  return &rd->sparse->pool[(slot - 1U) * rd->blk_size];
+}
+
+static uint32_t slot_alloc(RamDisk *rd) {
+  uint32_t slot = rd->free_slot;
+
+  if (slot != 0U) {
+    memcpy(&rd->free_slot, slot_data(rd, slot), sizeof(uint32_t));
+    rd->used++;
+  }
+  return slot;
+}
+
+static void slot_free(RamDisk *rd, uint32_t entry) {
+  uint32_t slot = entry & RAMDISK_SPARSE_SLOT_MASK;
+
+  if (slot != 0U) {
+    memcpy(slot_data(rd, slot), &rd->free_slot, sizeof(uint32_t));
+    rd->free_slot = slot;
+    rd->used--;
+  }
+}
+
+static bool is_zero(const uint8_t *buffer, uint32_t n) {
+  return (buffer[0] == 0U) && (memcmp(buffer, buffer + 1, n - 1U) == 0);
+}
+
+static bool sparse_read(void *instance, uint32_t startblk,
+                        uint8_t *buffer, uint32_t n) {
+
+  RamDisk *rd = instance;
+  const uint32_t bs = rd->blk_size;
+
+  if (overflow(rd, startblk, n)) {
+    return HAL_FAILED;
+  }
+  while (n-- > 0U) {
+    uint32_t slot = rd->sparse->index[startblk++] & RAMDISK_SPARSE_SLOT_MASK;
+    if (slot == 0U) {
+      memset(buffer, 0, bs);
+    }
+    else {
+      memcpy(buffer, slot_data(rd, slot), bs);
+    }
+    buffer += bs;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool sparse_write_block(RamDisk *rd, uint32_t lba,
+                               const uint8_t *buffer) {
+
+  uint32_t *entryp = &rd->sparse->index[lba];
+  uint32_t entry = *entryp;
+  uint32_t slot;
+  const bool zero = is_zero(buffer, rd->blk_size);
+
+  if (zero && ((entry & RAMDISK_SPARSE_SLOT_MASK) == 0U)) {
+    return HAL_SUCCESS;
+  }
+
+  if (rd->snapshot && ((entry & RAMDISK_SPARSE_MODIFIED) == 0U)) {
+    /* First write after the snapshot, the old slot is left untouched and
+       logged so that it can be restored.*/
+    if (rd->undo_cnt >= rd->sparse->undo_num) {
+      return HAL_FAILED;
+    }
+    slot = 0U;
+    if (!zero) {
+      slot = slot_alloc(rd);
+      if (slot == 0U) {
+        return HAL_FAILED;
+      }
+      memcpy(slot_data(rd, slot), buffer, rd->blk_size);
+    }
+    rd->sparse->undo[rd->undo_cnt].lba = lba;
+    rd->sparse->undo[rd->undo_cnt].entry = entry;
+    rd->undo_cnt++;
+    *entryp = slot | RAMDISK_SPARSE_MODIFIED;
+    return HAL_SUCCESS;
+  }
+
+  if (zero) {
+    slot_free(rd, entry);
+    *entryp = entry & RAMDISK_SPARSE_MODIFIED;
+    return HAL_SUCCESS;
+  }
+
+  slot = entry & RAMDISK_SPARSE_SLOT_MASK;
+  if (slot == 0U) {
+    slot = slot_alloc(rd);
+    if (slot == 0U) {
+      return HAL_FAILED;
+    }
+    *entryp = slot | (entry & RAMDISK_SPARSE_MODIFIED);
+  }
+  memcpy(slot_data(rd, slot), buffer, rd->blk_size);
+  return HAL_SUCCESS;
+}
+
+static bool sparse_write(void *instance, uint32_t startblk,
+                         const uint8_t *buffer, uint32_t n) {
+
+  RamDisk *rd = instance;
+
+  if (overflow(rd, startblk, n)) {
+    return HAL_FAILED;
+  }
+  while (n-- > 0U) {
+    if (sparse_write_block(rd, startblk++, buffer)) {
+      return HAL_FAILED;
+    }
+    buffer += rd->blk_size;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool sparse_readv(void *instance, uint32_t startblk,
+                         const blkiov_t *iov, uint32_t iovcnt) {
+
+  RamDisk *rd = instance;
+
+  if (overflow(rd, startblk, ioblockvGetBlocks(iov, iovcnt))) {
+    return HAL_FAILED;
+  }
+  while (iovcnt-- > 0U) {
+    (void)sparse_read(rd, startblk, iov->buffer, iov->n);
+    startblk += iov->n;
+    iov++;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool sparse_writev(void *instance, uint32_t startblk,
+                          const blkiov_t *iov, uint32_t iovcnt) {
+
+  RamDisk *rd = instance;
+
+  if (overflow(rd, startblk, ioblockvGetBlocks(iov, iovcnt))) {
+    return HAL_FAILED;
+  }
+  while (iovcnt-- > 0U) {
+    if (sparse_write(rd, startblk, iov->buffer, iov->n)) {
+      return HAL_FAILED;
+    }
+    startblk += iov->n;
+    iov++;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ *
+ */
+static const struct BaseVectoredBlockDeviceVMT sparse_vmt = {
+    is_inserted,
+    is_protected,
+    connect,
+    disconnect,
+    sparse_read,
+    sparse_write,
+    sync,
+    get_info,
+    sparse_readv,
+    sparse_writev
 };
+#endif /* RAMDISK_USE_SPARSE == TRUE */
 
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
@@ -166,6 +376,10 @@ static const struct BaseBlockDeviceVMT vmt = {
  */
 void ramdiskObjectInit(RamDisk *rdp) {
 
+  ioblockvRegisterVMT(&vmt);
+#if RAMDISK_USE_SPARSE == TRUE
+  ioblockvRegisterVMT(&sparse_vmt);
+#endif
   rdp->vmt = &vmt;
   rdp->state = BLK_STOP;
 }
@@ -193,6 +407,10 @@ void ramdiskStart(RamDisk *rdp, uint8_t *storage, uint32_t blksize,
   rdp->blk_size = blksize;
   rdp->readonly = readonly;
   rdp->storage  = storage;
+#if RAMDISK_USE_SPARSE == TRUE
+  rdp->vmt      = &vmt;
+  rdp->sparse   = NULL;
+#endif
   rdp->state    = BLK_READY;
   osalSysUnlock();
 }
@@ -216,4 +434,135 @@ void ramdiskStop(RamDisk *rdp) {
   osalSysUnlock();
 }
 
+#if (RAMDISK_USE_SPARSE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts RAM disk in sparse mode.
+ * @details Blocks that only contain zeros are not stored, the disk starts
+ *          zero filled and the pool only needs to hold the blocks actually
+ *          written with data. A write fails if the pool is exhausted.
+ *
+ * @param[in] rdp       pointer to @p RamDisk object
+ * @param[in] config    pointer to the @p RamDiskSparseConfig object
+ * @param[in] blksize   size of blocks in bytes
+ * @param[in] blknum    total number of blocks in device
+ * @param[in] readonly  read only flag
+ *
+ * @api
+ */
+void ramdiskStartSparse(RamDisk *rdp, const RamDiskSparseConfig *config,
+                        uint32_t blksize, uint32_t blknum, bool readonly) {
+  uint32_t i, next;
+
+  osalDbgCheck((rdp != NULL) && (config != NULL) &&
+               (config->index != NULL) && (blksize >= sizeof(uint32_t)) &&
+               (config->pool_blocks < RAMDISK_SPARSE_SLOT_MASK));
+
+  memset(config->index, 0, blknum * sizeof(uint32_t));
+  /* Chaining all the pool slots in the free list.*/
+  for (i = 0U; i < config->pool_blocks; i++) {
+    next = (i + 2U <= config->pool_blocks) ? (i + 2U) : 0U;
+    memcpy(&config->pool[i * blksize], &next, sizeof(uint32_t));
+  }
+
+  osalSysLock();
+  osalDbgAssert((rdp->state == BLK_STOP) || (rdp->state == BLK_READY),
+                "invalid state");
+  rdp->vmt       = &sparse_vmt;
+  rdp->blk_num   = blknum;
+  rdp->blk_size  = blksize;
+  rdp->readonly  = readonly;
+  rdp->storage   = config->pool;
+  rdp->sparse    = config;
+  rdp->free_slot = (config->pool_blocks > 0U) ? 1U : 0U;
+  rdp->used      = 0U;
+  rdp->undo_cnt  = 0U;
+  rdp->snapshot  = false;
+  rdp->state     = BLK_READY;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns the number of pool blocks in use.
+ *
+ * @param[in] rdp       pointer to @p RamDisk object
+ * @return              Number of stored blocks, including the blocks kept
+ *                      for a pending snapshot.
+ *
+ * @api
+ */
+uint32_t ramdiskGetUsedBlocks(RamDisk *rdp) {
+
+  osalDbgCheck((rdp != NULL) && (rdp->sparse != NULL));
+
+  return rdp->used;
+}
+
+/**
+ * @brief   Takes a snapshot of the sparse RAM disk.
+ * @details Blocks written after the snapshot get a fresh pool slot on their
+ *          first modification, the previous content stays in the pool until
+ *          the snapshot is committed or rolled back. A pending snapshot is
+ *          committed first.
+ * @note    Must not be called while the disk is being accessed.
+ *
+ * @param[in] rdp       pointer to @p RamDisk object
+ *
+ * @api
+ */
+void ramdiskSnapshot(RamDisk *rdp) {
+
+  osalDbgCheck((rdp != NULL) && (rdp->sparse != NULL) &&
+               (rdp->sparse->undo != NULL));
+
+  ramdiskCommit(rdp);
+  rdp->snapshot = true;
+}
+
+/**
+ * @brief   Restores the content saved by the last snapshot.
+ * @details The snapshot stays active, the disk can be rolled back again.
+ * @note    Must not be called while the disk is being accessed.
+ *
+ * @param[in] rdp       pointer to @p RamDisk object
+ *
+ * @api
+ */
+void ramdiskRollback(RamDisk *rdp) {
+  const RamDiskSparseConfig *config;
+
+  osalDbgCheck((rdp != NULL) && (rdp->sparse != NULL));
+
+  config = rdp->sparse;
+  while (rdp->undo_cnt > 0U) {
+    const ramdisk_undo_t *undop = &config->undo[--rdp->undo_cnt];
+    slot_free(rdp, config->index[undop->lba]);
+    config->index[undop->lba] = undop->entry;
+  }
+}
+
+/**
+ * @brief   Makes the modifications done after the last snapshot permanent.
+ * @details The blocks saved by the snapshot are returned to the pool and the
+ *          snapshot is terminated.
+ * @note    Must not be called while the disk is being accessed.
+ *
+ * @param[in] rdp       pointer to @p RamDisk object
+ *
+ * @api
+ */
+void ramdiskCommit(RamDisk *rdp) {
+  const RamDiskSparseConfig *config;
+
+  osalDbgCheck((rdp != NULL) && (rdp->sparse != NULL));
+
+  config = rdp->sparse;
+  while (rdp->undo_cnt > 0U) {
+    const ramdisk_undo_t *undop = &config->undo[--rdp->undo_cnt];
+    slot_free(rdp, undop->entry);
+    config->index[undop->lba] &= RAMDISK_SPARSE_SLOT_MASK;
+  }
+  rdp->snapshot = false;
+}
+#endif /* RAMDISK_USE_SPARSE == TRUE */
+
 /** @} */
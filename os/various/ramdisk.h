@@ -29,10 +29,29 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Sparse index entry flag, the block was written after the last
+ *          snapshot.
+ */
+#define RAMDISK_SPARSE_MODIFIED     0x80000000U
+
+/**
+ * @brief   Sparse index entry mask, slot number plus one, zero for a block
+ *          that is not stored and reads as zeros.
+ */
+#define RAMDISK_SPARSE_SLOT_MASK    0x7FFFFFFFU
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Enables the sparse storage mode with snapshots.
+ */
+#if !defined(RAMDISK_USE_SPARSE) || defined(__DOXYGEN__)
+#define RAMDISK_USE_SPARSE          FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -43,6 +62,61 @@
 
 typedef struct RamDisk RamDisk;
 
+#if (RAMDISK_USE_SPARSE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Snapshot undo log entry.
+ */
+typedef struct {
+  /**
+   * @brief   Block address.
+   */
+  uint32_t      lba;
+  /**
+   * @brief   Index entry of the block at snapshot time.
+   */
+  uint32_t      entry;
+} ramdisk_undo_t;
+
+/**
+ * @brief   Sparse RAM disk configuration structure.
+ * @details Only blocks holding non-zero data take space in the pool, blocks
+ *          are located through a per block index.
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the block index, @p blknum entries.
+   */
+  uint32_t          *index;
+  /**
+   * @brief   Pointer to the data pool, @p pool_blocks blocks.
+   */
+  uint8_t           *pool;
+  /**
+   * @brief   Number of blocks in the data pool.
+   */
+  uint32_t          pool_blocks;
+  /**
+   * @brief   Pointer to the snapshot undo log, can be @p NULL if snapshots
+   *          are not used.
+   */
+  ramdisk_undo_t    *undo;
+  /**
+   * @brief   Number of entries in the undo log, it limits the number of
+   *          distinct blocks that can be modified after a snapshot.
+   */
+  uint32_t          undo_num;
+} RamDiskSparseConfig;
+
+#define _ramdisk_sparse_data                                                \
+  const RamDiskSparseConfig *sparse;                                        \
+  uint32_t      free_slot;                                                  \
+  uint32_t      used;                                                       \
+  uint32_t      undo_cnt;                                                   \
+  bool          snapshot;
+#else
+#define _ramdisk_sparse_data
+#endif
+
 /**
  *
  */
@@ -51,14 +125,15 @@ typedef struct RamDisk RamDisk;
   uint8_t       *storage;                                                   \
   uint32_t      blk_size;                                                   \
   uint32_t      blk_num;                                                    \
-  bool          readonly;
+  bool          readonly;                                                   \
+  _ramdisk_sparse_data
 
 /**
  *
  */
 struct RamDisk {
   /** @brief Virtual Methods Table.*/
-  const struct BaseBlockDeviceVMT *vmt;
+  const struct BaseVectoredBlockDeviceVMT *vmt;
   _ramdisk_device_data
 };
 
@@ -77,6 +152,14 @@ extern "C" {
   void ramdiskStart(RamDisk *rdp, uint8_t *storage, uint32_t blksize,
                     uint32_t blknum, bool readonly);
   void ramdiskStop(RamDisk *rdp);
+#if RAMDISK_USE_SPARSE == TRUE
+  void ramdiskStartSparse(RamDisk *rdp, const RamDiskSparseConfig *config,
+                          uint32_t blksize, uint32_t blknum, bool readonly);
+  uint32_t ramdiskGetUsedBlocks(RamDisk *rdp);
+  void ramdiskSnapshot(RamDisk *rdp);
+  void ramdiskRollback(RamDisk *rdp);
+  void ramdiskCommit(RamDisk *rdp);
+#endif
 #ifdef __cplusplus
 }
 #endif
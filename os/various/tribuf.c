@@ -41,6 +41,66 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (TRIBUF_USE_LOCKFREE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Atomically exchanges the orphan word.
+ * @note    ARMv6-M has no exclusive access instructions, a short critical
+ *          zone is used there instead.
+ *
+ * @param[in] handler   Pointer to the tribuf handler object.
+ * @param[in] orphan    New orphan word value.
+ * @return  Previous orphan word value.
+ */
+static uint32_t tribuf_lf_exchange(tribuf_t *handler, uint32_t orphan) {
+
+#if defined(__ARM_ARCH_6M__)
+  syssts_t sts;
+  uint32_t old;
+
+  sts = osalSysGetStatusAndLockX();
+  old = handler->orphan;
+  handler->orphan = orphan;
+  osalSysRestoreStatusX(sts);
+  return old;
+#else
+  return __atomic_exchange_n(&handler->orphan, orphan, __ATOMIC_ACQ_REL);
+#endif
+}
+
+/**
+ * @brief   Lock-free front buffer swap.
+ * @details The front buffer is exchanged with the orphan one only if the
+ *          latter holds data newer than the current front buffer.
+ *
+ * @param[in] handler   Pointer to the tribuf handler object.
+ */
+static void tribuf_lf_swap_front(tribuf_t *handler) {
+
+  if (0U != (__atomic_load_n(&handler->orphan, __ATOMIC_ACQUIRE) &
+             TRIBUF_LF_FRESH)) {
+    uint32_t old;
+
+    old = tribuf_lf_exchange(handler, handler->front);
+    handler->front = (uint8_t)(old & TRIBUF_LF_INDEX_MASK);
+  }
+}
+
+/**
+ * @brief   Lock-free back buffer swap.
+ * @details The back buffer is published as the fresh orphan buffer, a
+ *          previously published buffer not yet consumed is recycled.
+ *
+ * @param[in] handler   Pointer to the tribuf handler object.
+ */
+static void tribuf_lf_swap_back(tribuf_t *handler) {
+
+  uint32_t old;
+
+  old = tribuf_lf_exchange(handler, handler->back | TRIBUF_LF_FRESH);
+  handler->back = (uint8_t)(old & TRIBUF_LF_INDEX_MASK);
+}
+#endif /* TRIBUF_USE_LOCKFREE == TRUE */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -61,6 +121,14 @@
  */
 void tribufObjectInit(tribuf_t *handler, void *front, void *back, void *orphan) {
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  handler->buffers[0] = front;
+  handler->buffers[1] = back;
+  handler->buffers[2] = orphan;
+  handler->front = 0U;
+  handler->back = 1U;
+  handler->orphan = 2U;
+#else
   handler->front = front;
   handler->back = back;
   handler->orphan = orphan;
@@ -69,6 +137,7 @@ void tribufObjectInit(tribuf_t *handler, void *front, void *back, void *orphan)
 #else
   handler->ready = false;
 #endif
+#endif
 }
 
 /**
@@ -81,12 +150,16 @@ void tribufObjectInit(tribuf_t *handler, void *front, void *back, void *orphan)
  */
 void *tribufGetFront(tribuf_t *handler) {
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  return handler->buffers[handler->front];
+#else
   void *front;
 
   osalSysLock();
   front = tribufGetFrontI(handler);
   osalSysUnlock();
   return front;
+#endif
 }
 
 /**
@@ -106,13 +179,20 @@ void *tribufGetFront(tribuf_t *handler) {
  */
 void tribufSwapFrontI(tribuf_t *handler) {
 
-  void *front;
-
   osalDbgCheckClassI();
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  tribuf_lf_swap_front(handler);
+#else
+  void *front;
+
   front = handler->orphan;
   handler->orphan = handler->front;
   handler->front = front;
+#if (TRIBUF_USE_WAIT == FALSE)
+  handler->ready = false;
+#endif
+#endif
 }
 
 /**
@@ -132,9 +212,13 @@ void tribufSwapFrontI(tribuf_t *handler) {
  */
 void tribufSwapFront(tribuf_t *handler) {
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  tribuf_lf_swap_front(handler);
+#else
   osalSysLock();
   tribufSwapFrontI(handler);
   osalSysUnlock();
+#endif
 }
 
 /**
@@ -147,12 +231,16 @@ void tribufSwapFront(tribuf_t *handler) {
  */
 void *tribufGetBack(tribuf_t *handler) {
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  return handler->buffers[handler->back];
+#else
   void *back;
 
   osalSysLock();
   back = tribufGetBackI(handler);
   osalSysUnlock();
   return back;
+#endif
 }
 
 /**
@@ -171,10 +259,13 @@ void *tribufGetBack(tribuf_t *handler) {
  */
 void tribufSwapBackI(tribuf_t *handler) {
 
-  void *back;
-
   osalDbgCheckClassI();
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  tribuf_lf_swap_back(handler);
+#else
+  void *back;
+
   back = handler->orphan;
   handler->orphan = handler->back;
   handler->back = back;
@@ -185,6 +276,7 @@ void tribufSwapBackI(tribuf_t *handler) {
 #else
   handler->ready = true;
 #endif
+#endif
 }
 
 /**
@@ -203,12 +295,16 @@ void tribufSwapBackI(tribuf_t *handler) {
  */
 void tribufSwapBack(tribuf_t *handler) {
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  tribuf_lf_swap_back(handler);
+#else
   osalSysLock();
   tribufSwapBackI(handler);
 #if (TRIBUF_USE_WAIT == TRUE)
   osalOsRescheduleS();
 #endif
   osalSysUnlock();
+#endif
 }
 
 /** @} */
@@ -45,12 +45,35 @@
 #define TRIBUF_USE_WAIT       TRUE
 #endif
 
+/**
+ * @brief   Triple buffers are lock-free.
+ * @details Buffers are exchanged through a single atomic index word, so
+ *          that an ISR producer and a thread consumer never need to enter
+ *          a critical section.
+ * @note    Requires @p TRIBUF_USE_WAIT set to @p FALSE.
+ */
+#if !defined(TRIBUF_USE_LOCKFREE) || defined(__DOXYGEN__)
+#define TRIBUF_USE_LOCKFREE   FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (TRIBUF_USE_LOCKFREE == TRUE) && (TRIBUF_USE_WAIT == TRUE)
+#error "TRIBUF_USE_LOCKFREE requires TRIBUF_USE_WAIT == FALSE"
+#endif
+
+/**
+ * @name    Lock-free orphan word fields
+ * @{
+ */
+#define TRIBUF_LF_INDEX_MASK  0x03U   /**< @brief Orphan buffer index.*/
+#define TRIBUF_LF_FRESH       0x04U   /**< @brief Orphan holds new data.*/
+/** @} */
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -59,6 +82,12 @@
  * @brief   Triple buffer handler object.
  */
 typedef struct {
+#if (TRIBUF_USE_LOCKFREE == TRUE) || defined(__DOXYGEN__)
+  void *buffers[3];           /**< @brief Buffer pointers.*/
+  uint8_t front;              /**< @brief Front buffer index.*/
+  uint8_t back;               /**< @brief Back buffer index.*/
+  volatile uint32_t orphan;   /**< @brief Orphan buffer index, fresh flag.*/
+#else
   void *front;                /**< @brief Current front buffer pointer.*/
   void *back;                 /**< @brief Current back buffer pointer.*/
   void *orphan;               /**< @brief Current orphan buffer pointer.*/
@@ -67,6 +96,7 @@ typedef struct {
 #else
   bool ready;                 /**< @brief A new front buffer is ready.*/
 #endif
+#endif
 } tribuf_t;
 
 /*===========================================================================*/
@@ -86,7 +116,10 @@ bool tribufIsReadyI(tribuf_t *handler)
 {
   osalDbgCheckClassI();
 
-#if (TRIBUF_USE_WAIT == TRUE)
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  return (0U != (__atomic_load_n(&handler->orphan, __ATOMIC_ACQUIRE) &
+                 TRIBUF_LF_FRESH));
+#elif (TRIBUF_USE_WAIT == TRUE)
   return (0 != chSemGetCounterI(&handler->ready));
 #else
   return handler->ready;
@@ -184,7 +217,11 @@ void *tribufGetFrontI(tribuf_t *handler) {
 
   osalDbgCheckClassI();
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  return handler->buffers[handler->front];
+#else
   return handler->front;
+#endif
 }
 
 /**
@@ -200,7 +237,11 @@ void *tribufGetBackI(tribuf_t *handler) {
 
   osalDbgCheckClassI();
 
+#if (TRIBUF_USE_LOCKFREE == TRUE)
+  return handler->buffers[handler->back];
+#else
   return handler->back;
+#endif
 }
 
 /*===========================================================================*/
@@ -17,6 +17,11 @@
 #include "ch.h"
 #include "hal.h"
 
+#if CRCSW_USE_CRC1 == TRUE && CRCSW_PROGRAMMABLE == TRUE
+/* Generated with: tools/crcsw_tables.py -p crc8 -n crc8_smbus */
+#include "crc8_smbus_table.h"
+#endif
+
 
 /*
  * Data used for CRC calculation.
@@ -175,6 +180,8 @@ static THD_FUNCTION(crc_thread_1, p) {
     /* CRC16 Calculation */
     testCrc(&crc16_config, 0xc36a);
     testCrc(&crc8_config, 0x06);
+    /* CRC8 Calculation with generated table lookup */
+    testCrc(&crc8_smbus_config, 0x06);
 #endif
 /* Test CRCSW with table lookups.  */
 #if CRCSW_CRC32_TABLE == TRUE
@@ -177,12 +177,16 @@
 #define HAL_USBH_PORT_RESET_TIMEOUT                   500
 #define HAL_USBH_DEVICE_ADDRESS_STABILIZATION         20
 #define HAL_USBH_CONTROL_REQUEST_DEFAULT_TIMEOUT	    OSAL_MS2I(1000)
+#define HAL_USBH_USE_THREAD                           FALSE
 
 /* MSD */
 #define HAL_USBH_USE_MSD                              TRUE
 
 #define HAL_USBHMSD_MAX_LUNS                          1
 #define HAL_USBHMSD_MAX_INSTANCES                     1
+#define HAL_USBHMSD_MAX_TRANSFER_BLOCKS               0
+#define HAL_USBHMSD_MAX_RETRIES                       3
+#define HAL_USBHMSD_RETRY_DELAY_MS                    50
 
 /* FTDI */
 #define HAL_USBH_USE_FTDI                             TRUE
@@ -217,11 +221,15 @@
 #define HAL_USBHUVC_MAX_MAILBOX_SZ                    70
 #define HAL_USBHUVC_WORK_RAM_SIZE                     20000
 #define HAL_USBHUVC_STATUS_PACKETS_COUNT              10
+#define HAL_USBHUVC_USE_FRAME_ASSEMBLER               FALSE
+#define HAL_USBHUVC_USE_STATS                         FALSE
 
 /* HID */
 #define HAL_USBH_USE_HID                              TRUE
 #define HAL_USBHHID_MAX_INSTANCES                     2
 #define HAL_USBHHID_USE_INTERRUPT_OUT                 FALSE
+#define HAL_USBHHID_USE_REPORT_PARSER                 FALSE
+#define HAL_USBHHID_USE_REPORT_QUEUE                  FALSE
 
 /* HUB */
 #define HAL_USBH_USE_HUB                              TRUE
@@ -850,7 +850,10 @@ check_eof:
                 }
 free_data:
                 usbhuvcFreeDataMessage(uvcdp, data);
-            } else {
+            }
+            usbhuvcUnlock(uvcdp);
+
+            while (usbhuvcFetchStatus(uvcdp, &msg, TIME_IMMEDIATE) == MSG_OK) {
                 usbhuvc_message_status_t *const status = (usbhuvc_message_status_t *)msg;
                 const uint8_t *const stat = status->data;
                 switch (stat[0] & 0x0f) {
@@ -870,7 +873,6 @@ free_data:
                 }
                 usbhuvcFreeStatusMessage(uvcdp, status);
             }
-            usbhuvcUnlock(uvcdp);
         }
 
     }
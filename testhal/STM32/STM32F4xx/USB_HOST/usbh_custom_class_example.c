@@ -71,8 +71,13 @@ static const usbh_classdriver_vmt_t class_driver_vmt = {
 	_unload
 };
 
+static const usbh_device_id_t id_table[] = {
+	USBH_ID_VID_PID(0xABCD, 0x0123),
+	USBH_ID_END
+};
+
 const usbh_classdriverinfo_t usbhCustomClassDriverInfo = {
-	"CUSTOM", &class_driver_vmt
+	"CUSTOM", &class_driver_vmt, id_table
 };
 
 static usbh_baseclassdriver_t *_load(usbh_device_t *dev, const uint8_t *descriptor, uint16_t rem) {
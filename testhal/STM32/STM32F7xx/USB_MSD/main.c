@@ -50,7 +50,7 @@ static THD_FUNCTION(Thread1, arg) {
 
 RamDisk ramdisk;
 __attribute__((section("DATA_RAM"))) static uint8_t ramdisk_storage[RAMDISK_BLOCK_SIZE * RAMDISK_BLOCK_CNT];
-static uint8_t blkbuf[RAMDISK_BLOCK_SIZE];
+static uint8_t blkbuf[RAMDISK_BLOCK_SIZE * USB_MSD_BLKBUF_BLOCKS];
 
 BaseSequentialStream *GlobalDebugChannel;
 
@@ -0,0 +1,300 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Randomized check of the bit map module against a bit-by-bit reference
+ * model, and of the two levels map against the flat one. Run with
+ * "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal.h"
+#include "bitmap.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_WORDS            67U
+#define TEST_BITS             (TEST_WORDS * sizeof(bitmap_word_t) * 8U)
+#define TEST_ROUNDS           300U
+#define BENCH_WORDS           2048U
+#define BENCH_LOOPS           200U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static bitmap_word_t words[TEST_WORDS];
+static bitmap_t map = {words, TEST_WORDS};
+static uint8_t ref[TEST_BITS];
+static bitmap_word_t leaf[TEST_WORDS];
+static bitmap_word_t nonempty[BITMAP2L_SUMMARY_LEN(TEST_WORDS)];
+static bitmap_word_t notfull[BITMAP2L_SUMMARY_LEN(TEST_WORDS)];
+static bitmap2l_t map2l;
+static bitmap_word_t bench_words[BENCH_WORDS];
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static size_t ref_find(uint8_t val, size_t from) {
+  size_t i;
+
+  for (i = from; i < TEST_BITS; i++) {
+    if (ref[i] == val)
+      return i;
+  }
+  return BITMAP_NOT_FOUND;
+}
+
+static size_t ref_zero_run(size_t from, size_t len) {
+  size_t i, run = 0;
+
+  for (i = from; i < TEST_BITS; i++) {
+    run = ref[i] ? 0 : run + 1;
+    if (run == len)
+      return i + 1 - len;
+  }
+  return BITMAP_NOT_FOUND;
+}
+
+static size_t ref_popcount(void) {
+  size_t i, n = 0;
+
+  for (i = 0; i < TEST_BITS; i++)
+    n += ref[i];
+  return n;
+}
+
+static bool same(void) {
+  size_t i;
+
+  for (i = 0; i < TEST_BITS; i++) {
+    if ((bitmapGet(&map, i) != 0) != (ref[i] != 0))
+      return false;
+  }
+  return true;
+}
+
+/*
+ * Random mix of single bit and range updates, applied to both.
+ */
+static void scramble(unsigned ops) {
+  unsigned k;
+
+  for (k = 0; k < ops; k++) {
+    size_t start = (size_t)rand() % TEST_BITS;
+    size_t len = (size_t)rand() % (TEST_BITS - start + 1) % 300U;
+
+    switch (rand() % 5) {
+    case 0:
+      bitmapSetRange(&map, start, len);
+      memset(&ref[start], 1, len);
+      break;
+    case 1:
+      bitmapClearRange(&map, start, len);
+      memset(&ref[start], 0, len);
+      break;
+    case 2:
+      bitmapSet(&map, start);
+      ref[start] = 1;
+      break;
+    case 3:
+      bitmapClear(&map, start);
+      ref[start] = 0;
+      break;
+    default:
+      bitmapInvert(&map, start);
+      ref[start] ^= 1;
+      break;
+    }
+  }
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+static void test_flat(void) {
+  unsigned round, k;
+
+  printf("bitmap_t against the reference model\n");
+  check(bitmapGetBitsCount(&map) == TEST_BITS);
+  for (round = 0; round < TEST_ROUNDS; round++) {
+    uint8_t val = (uint8_t)(round & 1U);
+
+    bitmapObjectInit(&map, val);
+    memset(ref, val, sizeof(ref));
+    scramble(1U + (unsigned)rand() % 60U);
+    check(same());
+    check(bitmapPopcount(&map) == ref_popcount());
+    for (k = 0; k < 40U; k++) {
+      /* starting points past the end are valid and find nothing */
+      size_t from = (size_t)rand() % (TEST_BITS + 40U);
+      size_t len = 1U + (size_t)rand() % 100U;
+
+      check(bitmapFindFirstSet(&map, from) == ref_find(1, from));
+      check(bitmapFindFirstClear(&map, from) == ref_find(0, from));
+      if (from < TEST_BITS)
+        check(bitmapFindNextZeroRun(&map, from, len) ==
+              ref_zero_run(from, len));
+    }
+    if (failures > 10U)
+      return;
+  }
+}
+
+static void test_edges(void) {
+  size_t i;
+
+  printf("word boundaries\n");
+  bitmapObjectInit(&map, 0);
+  bitmapSetRange(&map, 31, 34);
+  for (i = 0; i < 100; i++)
+    check((bitmapGet(&map, i) != 0) == ((i >= 31) && (i < 65)));
+  check(bitmapPopcount(&map) == 34);
+  check(bitmapFindFirstSet(&map, 0) == 31);
+  check(bitmapFindFirstClear(&map, 31) == 65);
+  check(bitmapFindNextZeroRun(&map, 0, 32) == 65);
+
+  bitmapObjectInit(&map, 0);
+  bitmapSet(&map, TEST_BITS - 1U);
+  check(bitmapFindFirstSet(&map, 0) == TEST_BITS - 1U);
+  check(bitmapFindFirstSet(&map, TEST_BITS) == BITMAP_NOT_FOUND);
+  check(bitmapFindNextZeroRun(&map, 0, TEST_BITS) == BITMAP_NOT_FOUND);
+  check(bitmapFindNextZeroRun(&map, 0, TEST_BITS - 1U) == 0);
+  bitmapSetRange(&map, 0, TEST_BITS);
+  check(bitmapPopcount(&map) == TEST_BITS);
+  check(bitmapFindFirstClear(&map, 0) == BITMAP_NOT_FOUND);
+}
+
+/*
+ * The two levels map must answer as the flat one holding the same bits,
+ * at every fill density and for leaf lengths not multiple of a word.
+ */
+static void test_2l(void) {
+  unsigned round, k;
+
+  printf("bitmap2l_t against bitmap_t\n");
+  for (round = 0; round < TEST_ROUNDS; round++) {
+    unsigned val = round & 1U;
+    unsigned density = (unsigned)rand() % 101U;
+    size_t len = TEST_WORDS - round % 3U;
+    size_t n;
+
+    map.len = len;
+    bitmapObjectInit(&map, val);
+    bitmap2lObjectInit(&map2l, leaf, len, nonempty, notfull, val);
+    n = bitmapGetBitsCount(&map);
+    for (k = 0; k < 2000U; k++) {
+      size_t bit = (size_t)rand() % n;
+      size_t from = (size_t)rand() % (n + 5U);
+
+      if ((unsigned)rand() % 100U < density) {
+        bitmapSet(&map, bit);
+        bitmap2lSet(&map2l, bit);
+      }
+      else {
+        bitmapClear(&map, bit);
+        bitmap2lClear(&map2l, bit);
+      }
+      check(bitmap2lGet(&map2l, bit) == bitmapGet(&map, bit));
+      check(bitmap2lFindFirstSet(&map2l, from) ==
+            bitmapFindFirstSet(&map, from));
+      check(bitmap2lFindFirstClear(&map2l, from) ==
+            bitmapFindFirstClear(&map, from));
+      check(bitmap2lAnySet(&map2l) == (bitmapPopcount(&map) != 0U));
+      check(bitmap2lAnyClear(&map2l) == (bitmapPopcount(&map) != n));
+      if (failures > 10U)
+        return;
+    }
+  }
+  map.len = TEST_WORDS;
+}
+
+/*
+ * Informational, last set bit of a large map.
+ */
+static void bench(void) {
+  bitmap_t big = {bench_words, BENCH_WORDS};
+  volatile size_t sink = 0;
+  clock_t t;
+  double word, bit;
+  size_t n = bitmapGetBitsCount(&big);
+  unsigned i;
+  size_t j;
+
+  bitmapObjectInit(&big, 0);
+  bitmapSet(&big, n - 1U);
+  t = clock();
+  for (i = 0; i < BENCH_LOOPS; i++)
+    sink += bitmapFindFirstSet(&big, 0);
+  word = (double)(clock() - t) / CLOCKS_PER_SEC;
+  t = clock();
+  for (i = 0; i < BENCH_LOOPS; i++) {
+    for (j = 0; (j < n) && (bitmapGet(&big, j) == 0); j++)
+      ;
+    sink += j;
+  }
+  bit = (double)(clock() - t) / CLOCKS_PER_SEC;
+  printf("find first set in %u bits: word %.1f us, bit-by-bit %.1f us\n",
+         (unsigned)n, word * 1e6 / BENCH_LOOPS, bit * 1e6 / BENCH_LOOPS);
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+  test_flat();
+  test_edges();
+  test_2l();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  bench();
+  printf("all tests passed\n");
+  return 0;
+}
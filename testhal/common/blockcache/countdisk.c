@@ -0,0 +1,131 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Counting block device.
+ */
+
+#include "hal.h"
+#include "countdisk.h"
+
+static bool cd_is_inserted(void *instance) {
+  CountDisk *cdp = instance;
+
+  return blkIsInserted(cdp->target);
+}
+
+static bool cd_is_protected(void *instance) {
+  CountDisk *cdp = instance;
+
+  return blkIsWriteProtected(cdp->target);
+}
+
+static bool cd_connect(void *instance) {
+  CountDisk *cdp = instance;
+
+  return blkConnect(cdp->target);
+}
+
+static bool cd_disconnect(void *instance) {
+  CountDisk *cdp = instance;
+
+  return blkDisconnect(cdp->target);
+}
+
+static bool cd_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n) {
+  CountDisk *cdp = instance;
+
+  cdp->reads++;
+  cdp->blocks_read += n;
+  return blkRead(cdp->target, startblk, buffer, n);
+}
+
+static bool cd_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n) {
+  CountDisk *cdp = instance;
+
+  cdp->writes++;
+  if (cdp->fail_writes)
+    return HAL_FAILED;
+  cdp->blocks_written += n;
+  return blkWrite(cdp->target, startblk, buffer, n);
+}
+
+static bool cd_sync(void *instance) {
+  CountDisk *cdp = instance;
+
+  cdp->syncs++;
+  return blkSync(cdp->target);
+}
+
+static bool cd_get_info(void *instance, BlockDeviceInfo *bdip) {
+  CountDisk *cdp = instance;
+
+  return blkGetInfo(cdp->target, bdip);
+}
+
+static bool cd_readv(void *instance, uint32_t startblk,
+                     const blkiov_t *iov, uint32_t iovcnt) {
+  CountDisk *cdp = instance;
+
+  cdp->reads++;
+  cdp->blocks_read += ioblockvGetBlocks(iov, iovcnt);
+  return ioblockvRead(cdp->target, startblk, iov, iovcnt);
+}
+
+static bool cd_writev(void *instance, uint32_t startblk,
+                      const blkiov_t *iov, uint32_t iovcnt) {
+  CountDisk *cdp = instance;
+
+  cdp->writes++;
+  if (cdp->fail_writes)
+    return HAL_FAILED;
+  cdp->blocks_written += ioblockvGetBlocks(iov, iovcnt);
+  return ioblockvWrite(cdp->target, startblk, iov, iovcnt);
+}
+
+static const struct BaseVectoredBlockDeviceVMT vmt = {
+  cd_is_inserted,
+  cd_is_protected,
+  cd_connect,
+  cd_disconnect,
+  cd_read,
+  cd_write,
+  cd_sync,
+  cd_get_info,
+  cd_readv,
+  cd_writev
+};
+
+void countdiskObjectInit(CountDisk *cdp, BaseBlockDevice *target) {
+
+  ioblockvRegisterVMT(&vmt);
+  cdp->vmt = &vmt;
+  cdp->state = BLK_READY;
+  cdp->target = target;
+  cdp->fail_writes = false;
+  countdiskClearStats(cdp);
+}
+
+void countdiskClearStats(CountDisk *cdp) {
+
+  cdp->reads = 0;
+  cdp->writes = 0;
+  cdp->syncs = 0;
+  cdp->blocks_read = 0;
+  cdp->blocks_written = 0;
+}
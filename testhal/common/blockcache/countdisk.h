@@ -0,0 +1,49 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Counting block device, forwards every call to a target device, counts
+ * them and fails the writes on demand. It implements the vectored
+ * interface so that each vectored write of the cache is seen as one call.
+ */
+
+#ifndef COUNTDISK_H
+#define COUNTDISK_H
+
+typedef struct {
+  const struct BaseVectoredBlockDeviceVMT *vmt;
+  _base_vectored_block_device_data
+  BaseBlockDevice       *target;
+  bool                  fail_writes;
+  /* calls, vectored ones included */
+  unsigned              reads;
+  unsigned              writes;
+  unsigned              syncs;
+  /* blocks transferred */
+  unsigned              blocks_read;
+  unsigned              blocks_written;
+} CountDisk;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void countdiskObjectInit(CountDisk *cdp, BaseBlockDevice *target);
+  void countdiskClearStats(CountDisk *cdp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COUNTDISK_H */
@@ -0,0 +1,371 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the block cache, the cached device is a RAM disk wrapped
+ * by a block device counting the calls. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "ramdisk.h"
+#include "blockcache.h"
+#include "countdisk.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_BLOCK_SIZE       512U
+#define TEST_BLOCKS           8192U
+#define TEST_LINES            16U
+#define TEST_MAX_LINE_BLOCKS  8U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t disk[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t model[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t buffer[TEST_LINES * TEST_MAX_LINE_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t data[32 * TEST_BLOCK_SIZE];
+static blockcache_line_t lines[TEST_LINES];
+static RamDisk ramdisk;
+static CountDisk countdisk;
+static BlockCache cache;
+static BlockCacheConfig config;
+static BaseBlockDevice *const dev = (BaseBlockDevice *)&cache;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void randomize(uint8_t *p, size_t n) {
+
+  while (n-- > 0)
+    *p++ = (uint8_t)rand();
+}
+
+static void start(uint32_t lines_num, uint32_t line_blocks,
+                  uint32_t readahead) {
+
+  config.blkdev = (BaseBlockDevice *)&countdisk;
+  config.lines = lines;
+  config.buffer = buffer;
+  config.lines_num = lines_num;
+  config.line_blocks = line_blocks;
+  config.readahead = readahead;
+  randomize(disk, sizeof(disk));
+  memcpy(model, disk, sizeof(disk));
+  blockcacheObjectInit(&cache);
+  blockcacheStart(&cache, &config);
+  countdiskClearStats(&countdisk);
+}
+
+/*
+ * Writes through the cache and to the model.
+ */
+static bool write_blocks(uint32_t lba, uint32_t n) {
+
+  randomize(data, n * TEST_BLOCK_SIZE);
+  memcpy(model + lba * TEST_BLOCK_SIZE, data, n * TEST_BLOCK_SIZE);
+  return blkWrite(dev, lba, data, n);
+}
+
+/*
+ * Reads through the cache and compares with the model.
+ */
+static bool read_check(uint32_t lba, uint32_t n) {
+
+  if (blkRead(dev, lba, data, n) != HAL_SUCCESS)
+    return false;
+  return memcmp(data, model + lba * TEST_BLOCK_SIZE, n * TEST_BLOCK_SIZE) == 0;
+}
+
+static bool disk_matches(void) {
+
+  return memcmp(disk, model, sizeof(disk)) == 0;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Device calls of hits, misses, whole line writes and write back.
+ */
+static void test_counts(void) {
+
+  printf("call counts\n");
+  start(4, 4, 0);
+
+  /* read miss loads the line, then hits */
+  check(read_check(5, 1));
+  check((countdisk.reads == 1) && (countdisk.blocks_read == 4));
+  check(read_check(4, 4));
+  check(write_blocks(7, 1) == HAL_SUCCESS);
+  check((countdisk.reads == 1) && (countdisk.writes == 0));
+
+  /* a whole line overwritten is not read */
+  check(write_blocks(8, 4) == HAL_SUCCESS);
+  check(countdisk.reads == 1);
+
+  /* a partial line is read, modified and written back later */
+  check(write_blocks(13, 1) == HAL_SUCCESS);
+  check((countdisk.reads == 2) && (countdisk.writes == 0));
+
+  /* two or more whole uncached lines are written through at once */
+  check(write_blocks(16, 8) == HAL_SUCCESS);
+  check((countdisk.writes == 1) && (countdisk.blocks_written == 8));
+  check(read_check(16, 8));
+  check(countdisk.reads == 3);
+
+  /* blocks 7-11 in one write, block 13 in another */
+  countdiskClearStats(&countdisk);
+  check(blkSync(dev) == HAL_SUCCESS);
+  check((countdisk.writes == 2) && (countdisk.blocks_written == 6));
+  check(countdisk.syncs == 1);
+  check(disk_matches());
+
+  /* nothing left to write */
+  check(blkSync(dev) == HAL_SUCCESS);
+  check(countdisk.writes == 2);
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+}
+
+/*
+ * The least recently used line is evicted, written back when dirty.
+ */
+static void test_lru(void) {
+  uint32_t i;
+
+  printf("LRU eviction\n");
+  start(4, 4, 0);
+
+  for (i = 0; i < 4; i++)
+    check(read_check(i * 4, 1));
+  check(countdisk.reads == 4);
+  /* line 0 is used again, line 1 becomes the oldest */
+  check(read_check(0, 1));
+  check(read_check(16, 1));
+  check(countdisk.reads == 5);
+  check(read_check(0, 1));
+  check(countdisk.reads == 5);
+  check(read_check(4, 1));
+  check(countdisk.reads == 6);
+
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+
+  /* the oldest line is dirty and written back on eviction */
+  start(4, 4, 0);
+  check(write_blocks(9, 2) == HAL_SUCCESS);
+  check(read_check(0, 1));
+  check(read_check(4, 1));
+  check(read_check(12, 1));
+  check((countdisk.reads == 4) && (countdisk.writes == 0));
+  check(read_check(20, 1));
+  check((countdisk.writes == 1) && (countdisk.blocks_written == 2));
+  check(disk_matches());
+  check(read_check(8, 4));
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+}
+
+/*
+ * Dirty blocks spanning several lines are written in address order with
+ * one vectored write, up to BLOCKCACHE_FLUSH_IOV_SIZE elements.
+ */
+static void test_flush(void) {
+  uint32_t lba;
+
+  printf("coalesced flush\n");
+  start(4, 4, 0);
+  /* blocks 2 to 13, line by line in reverse order */
+  for (lba = 13; lba >= 2; lba--)
+    check(write_blocks(lba, 1) == HAL_SUCCESS);
+  countdiskClearStats(&countdisk);
+  check(blockcacheFlush(&cache) == HAL_SUCCESS);
+  check((countdisk.writes == 1) && (countdisk.blocks_written == 12));
+  check(disk_matches());
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+
+  /* single block lines, the vector holds 8 of them */
+  start(TEST_LINES, 1, 0);
+  for (lba = 100; lba < 110; lba++)
+    check(write_blocks(lba, 1) == HAL_SUCCESS);
+  check(write_blocks(120, 1) == HAL_SUCCESS);
+  countdiskClearStats(&countdisk);
+  check(blockcacheFlush(&cache) == HAL_SUCCESS);
+  check((countdisk.writes == 3) && (countdisk.blocks_written == 11));
+  check(disk_matches());
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+}
+
+/*
+ * A sequential miss prefetches the following lines.
+ */
+static void test_readahead(void) {
+
+  printf("read-ahead\n");
+  start(4, 4, 2);
+  check(read_check(0, 4));
+  check(countdisk.reads == 1);
+  check(read_check(4, 4));
+  check(countdisk.reads == 4);
+  check(read_check(8, 8));
+  check(countdisk.reads == 4);
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+}
+
+/*
+ * A failed write back leaves the cache ready with its dirty blocks, they
+ * are written by the next stop or start.
+ */
+static void test_stop_start(void) {
+
+  printf("stop/start with dirty data\n");
+  start(4, 4, 0);
+  check(write_blocks(3, 3) == HAL_SUCCESS);
+  countdisk.fail_writes = true;
+  check(blockcacheStop(&cache) == HAL_FAILED);
+  check(cache.state == BLK_READY);
+  check(!disk_matches());
+  check(read_check(3, 3));
+
+  countdisk.fail_writes = false;
+  blockcacheStart(&cache, &config);
+  check(cache.state == BLK_READY);
+  check(disk_matches());
+
+  check(write_blocks(40, 1) == HAL_SUCCESS);
+  countdisk.fail_writes = true;
+  check(blockcacheStop(&cache) == HAL_FAILED);
+  countdisk.fail_writes = false;
+  check(blockcacheStop(&cache) == HAL_SUCCESS);
+  check(cache.state == BLK_STOP);
+  check(disk_matches());
+}
+
+/*
+ * FatFs like workload: clusters of 4 blocks appended to files, each with
+ * an update of the two FAT copies, a directory update and a sync per
+ * file, then the files and the FAT read back block by block.
+ */
+static void workload(BaseBlockDevice *bdp) {
+  uint8_t sec[TEST_BLOCK_SIZE];
+  uint32_t f, c, s;
+
+  for (f = 0; f < 20; f++) {
+    for (c = 0; c < 40; c++) {
+      uint32_t cl = f * 40 + c;
+      uint32_t fat = 32 + cl / 128;
+
+      randomize(data, 4 * TEST_BLOCK_SIZE);
+      memcpy(model + (128 + cl * 4) * TEST_BLOCK_SIZE, data,
+             4 * TEST_BLOCK_SIZE);
+      check(blkWrite(bdp, 128 + cl * 4, data, 4) == HAL_SUCCESS);
+      for (s = fat; s <= fat + 32; s += 32) {
+        check(blkRead(bdp, s, sec, 1) == HAL_SUCCESS);
+        memcpy(&sec[(cl % 128) * 4], &cl, 4);
+        memcpy(model + s * TEST_BLOCK_SIZE, sec, TEST_BLOCK_SIZE);
+        check(blkWrite(bdp, s, sec, 1) == HAL_SUCCESS);
+      }
+    }
+    check(blkRead(bdp, 96, sec, 1) == HAL_SUCCESS);
+    sec[f * 16] = (uint8_t)f;
+    memcpy(model + 96 * TEST_BLOCK_SIZE, sec, TEST_BLOCK_SIZE);
+    check(blkWrite(bdp, 96, sec, 1) == HAL_SUCCESS);
+    check(blkSync(bdp) == HAL_SUCCESS);
+  }
+  for (s = 128; s < 128 + 5 * 160; s++) {
+    check(blkRead(bdp, s, sec, 1) == HAL_SUCCESS);
+    check(memcmp(sec, model + s * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE) == 0);
+  }
+  for (s = 32; s < 40; s++) {
+    check(blkRead(bdp, s, sec, 1) == HAL_SUCCESS);
+    check(memcmp(sec, model + s * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE) == 0);
+  }
+}
+
+static void test_workload(void) {
+  static const uint32_t line_blocks[] = {1, 8};
+  unsigned direct_writes, i;
+
+  printf("FatFs like workload, device calls:\n");
+  start(TEST_LINES, 1, 0);
+  workload((BaseBlockDevice *)&countdisk);
+  check(disk_matches());
+  direct_writes = countdisk.writes;
+  printf("  uncached          reads %5u writes %5u\n",
+         countdisk.reads, countdisk.writes);
+
+  for (i = 0; i < sizeof(line_blocks) / sizeof(line_blocks[0]); i++) {
+    start(TEST_LINES, line_blocks[i], 2);
+    workload(dev);
+    check(blockcacheStop(&cache) == HAL_SUCCESS);
+    check(disk_matches());
+    check(countdisk.writes < direct_writes);
+    printf("  %u blocks lines    reads %5u writes %5u\n",
+           (unsigned)line_blocks[i], countdisk.reads, countdisk.writes);
+  }
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+  ramdiskObjectInit(&ramdisk);
+  ramdiskStart(&ramdisk, disk, TEST_BLOCK_SIZE, TEST_BLOCKS, false);
+  countdiskObjectInit(&countdisk, (BaseBlockDevice *)&ramdisk);
+
+  test_counts();
+  test_lru();
+  test_flush();
+  test_readahead();
+  test_stop_start();
+  test_workload();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
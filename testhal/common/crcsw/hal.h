@@ -0,0 +1,62 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of hal.h, only what the software CRC driver needs.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#endif
+#ifndef FALSE
+#define FALSE                           0
+#endif
+
+/*
+ * Driver configuration, CRCSW_SLICE_BY comes from the Makefile.
+ */
+#define HAL_USE_CRC                     TRUE
+#define CRCSW_USE_CRC1                  TRUE
+#define CRCSW_CRC32_TABLE               TRUE
+#define CRCSW_CRC16_TABLE               TRUE
+#define CRCSW_PROGRAMMABLE              TRUE
+#define CRC_USE_DMA                     FALSE
+#define CRC_USE_MUTUAL_EXCLUSION        FALSE
+
+#define osalDbgAssert(c, remark)        assert(c)
+#define osalDbgCheck(c)                 assert(c)
+
+typedef enum {
+  CRC_UNINIT,
+  CRC_STOP,
+  CRC_READY,
+  CRC_ACTIVE,
+  CRC_COMPLETE
+} crcstate_t;
+
+#include "crcsw.h"
+
+void crcObjectInit(CRCDriver *crcp);
+
+#endif /* HAL_H */
@@ -0,0 +1,218 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Randomized check of the software CRC driver table engines against a
+ * bit-at-a-time reference model, for the built-in tables and for tables
+ * generated by tools/crcsw_tables.py. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal.h"
+
+/* Generated by the Makefile with tools/crcsw_tables.py.*/
+#include "crc8_table.h"
+#include "crc8_maxim_table.h"
+#include "crc8_autosar_table.h"
+#include "crc12_umts_table.h"
+#include "crc16_arc_table.h"
+#include "crc16_ccitt_false_table.h"
+#include "crc16_kermit_table.h"
+#include "crc16_xmodem_table.h"
+#include "crc16_modbus_table.h"
+#include "crc16_usb_table.h"
+#include "crc16_x25_table.h"
+#include "crc24_openpgp_table.h"
+#include "crc32_table.h"
+#include "crc32_4_table.h"
+#include "crc32_bzip2_table.h"
+#include "crc32_mpeg2_table.h"
+#include "crc32c_table.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_ROUNDS           2000U
+#define TEST_MAX_SIZE         600U
+#define TEST_MAX_OFFSET       16U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+typedef struct {
+  const char            *name;
+  const CRCConfig       *config;
+  uint32_t              check;
+} test_crc_t;
+
+/* Check values are the CRC of "123456789".*/
+static const test_crc_t crcs[] = {
+  {"built-in crc32",    &crcsw_crc32_config,    0xCBF43926U},
+  {"built-in crc16",    &crcsw_crc16_config,    0xBB3DU},
+  {"crc8",              &crc8_config,           0xF4U},
+  {"crc8_maxim",        &crc8_maxim_config,     0xA1U},
+  {"crc8_autosar",      &crc8_autosar_config,   0xDFU},
+  {"crc12_umts",        &crc12_umts_config,     0xDAFU},
+  {"crc16_arc",         &crc16_arc_config,      0xBB3DU},
+  {"crc16_ccitt_false", &crc16_ccitt_false_config, 0x29B1U},
+  {"crc16_kermit",      &crc16_kermit_config,   0x2189U},
+  {"crc16_xmodem",      &crc16_xmodem_config,   0x31C3U},
+  {"crc16_modbus",      &crc16_modbus_config,   0x4B37U},
+  {"crc16_usb",         &crc16_usb_config,      0xB4C8U},
+  {"crc16_x25",         &crc16_x25_config,      0x906EU},
+  {"crc24_openpgp",     &crc24_openpgp_config,  0x21CF02U},
+  {"crc32",             &crc32_config,          0xCBF43926U},
+  {"crc32, 4 slices",   &crc32_4_config,        0xCBF43926U},
+  {"crc32_bzip2",       &crc32_bzip2_config,    0xFC891918U},
+  {"crc32_mpeg2",       &crc32_mpeg2_config,    0x0376E6E7U},
+  {"crc32c",            &crc32c_config,         0xE3069283U}
+};
+
+static uint8_t data[TEST_MAX_SIZE + TEST_MAX_OFFSET];
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static uint32_t ref_reflect(uint32_t v, unsigned width) {
+  uint32_t r = 0;
+  unsigned i;
+
+  for (i = 0; i < width; i++) {
+    if (v & (1UL << i))
+      r |= 1UL << (width - 1 - i);
+  }
+  return r;
+}
+
+/*
+ * Reference model, one bit at a time on a 64 bits remainder.
+ */
+static uint32_t ref_crc(const CRCConfig *cfg, const uint8_t *p, size_t n) {
+  unsigned width = cfg->poly_size;
+  uint64_t mask = (1ULL << width) - 1U;
+  uint64_t crc = cfg->initial_val & mask;
+  size_t i;
+  int bit;
+
+  for (i = 0; i < n; i++) {
+    uint8_t d = cfg->reflect_data ? (uint8_t)ref_reflect(p[i], 8) : p[i];
+
+    for (bit = 7; bit >= 0; bit--) {
+      uint64_t top = (crc >> (width - 1)) & 1U;
+
+      crc = (crc << 1) & mask;
+      if (top ^ ((d >> bit) & 1U))
+        crc ^= cfg->poly;
+    }
+  }
+  if (cfg->reflect_remainder)
+    crc = ref_reflect((uint32_t)crc, width);
+  return (uint32_t)((crc ^ cfg->final_val) & mask);
+}
+
+/*
+ * Calculation split in up to three driver calls.
+ */
+static uint32_t drv_crc(const CRCConfig *cfg, const uint8_t *p, size_t n) {
+  size_t a = n ? (size_t)rand() % (n + 1) : 0;
+  size_t b = (n - a) ? (size_t)rand() % (n - a + 1) : 0;
+
+  CRCD1.config = cfg;
+  crc_lld_start(&CRCD1);
+  (void)crc_lld_calc(&CRCD1, a, p);
+  (void)crc_lld_calc(&CRCD1, b, p + a);
+  return crc_lld_calc(&CRCD1, n - a - b, p + a + b);
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+static void test_crc(const test_crc_t *tp) {
+  CRCConfig bitwise = *tp->config;
+  unsigned i;
+
+  printf("%s, %u slices\n", tp->name, (unsigned)tp->config->table_slices);
+  bitwise.table = NULL;
+  bitwise.table_slices = 0;
+  check(drv_crc(tp->config, (const uint8_t *)"123456789", 9) == tp->check);
+  check(drv_crc(&bitwise, (const uint8_t *)"123456789", 9) == tp->check);
+  for (i = 0; i < TEST_ROUNDS; i++) {
+    size_t n = (size_t)rand() % (TEST_MAX_SIZE + 1);
+    const uint8_t *p = data + rand() % TEST_MAX_OFFSET;
+    uint32_t expected = ref_crc(tp->config, p, n);
+
+    check(drv_crc(tp->config, p, n) == expected);
+    if (i % 16U == 0U)
+      check(drv_crc(&bitwise, p, n) == expected);
+    if (failures > 10U)
+      return;
+  }
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+void crcObjectInit(CRCDriver *crcp) {
+
+  crcp->config = &crcsw_crc32_config;
+}
+
+int main(void) {
+  unsigned i;
+
+  printf("CRCSW_SLICE_BY %d\n", CRCSW_SLICE_BY);
+  srand(1);
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)rand();
+
+  for (i = 0; i < sizeof(crcs) / sizeof(crcs[0]); i++)
+    test_crc(&crcs[i]);
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
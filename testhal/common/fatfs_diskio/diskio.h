@@ -0,0 +1,57 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of the FatFs diskio.h, only the interface of the
+ * bindings.
+ */
+
+#ifndef DISKIO_H
+#define DISKIO_H
+
+typedef unsigned char   BYTE;
+typedef unsigned short  WORD;
+typedef unsigned int    UINT;
+typedef unsigned int    DWORD;
+
+typedef BYTE DSTATUS;
+
+typedef enum {
+  RES_OK = 0,
+  RES_ERROR,
+  RES_WRPRT,
+  RES_NOTRDY,
+  RES_PARERR
+} DRESULT;
+
+#define STA_NOINIT              0x01
+#define STA_NODISK              0x02
+#define STA_PROTECT             0x04
+
+#define CTRL_SYNC               0
+#define GET_SECTOR_COUNT        1
+#define GET_SECTOR_SIZE         2
+#define GET_BLOCK_SIZE          3
+#define CTRL_TRIM               4
+
+DSTATUS disk_initialize(BYTE pdrv);
+DSTATUS disk_status(BYTE pdrv);
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count);
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count);
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff);
+DWORD get_fattime(void);
+
+#endif /* DISKIO_H */
@@ -0,0 +1,30 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of ffconf.h, four volumes and variable sector
+ * size.
+ */
+
+#ifndef FFCONF_H
+#define FFCONF_H
+
+#define FF_VOLUMES              4
+#define _MAX_SS                 4096
+#define _MIN_SS                 512
+#define _USE_TRIM               0
+
+#endif /* FFCONF_H */
@@ -0,0 +1,195 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the FatFs disk I/O bindings, RAM disks are registered as
+ * physical drives. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "ffconf.h"
+#include "diskio.h"
+#include "ramdisk.h"
+#include "fatfs_diskio.h"
+#include "countdisk.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t storage0[64 * 512];
+static uint8_t storage1[16 * 512];
+static uint8_t storage2[32 * 1024];
+static uint8_t data[8 * 1024];
+static RamDisk ramdisk[3];
+static CountDisk countdisk;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Drive 0 is a RAM disk behind a counting device, drive 1 a write
+ * protected RAM disk, drive 2 a RAM disk with 1024 bytes sectors, drive 3
+ * is not registered.
+ */
+static void test_register(void) {
+
+  printf("registry\n");
+  check(disk_status(0) == STA_NOINIT);
+  check(fatfsRegisterDrive(0, (BaseBlockDevice *)&countdisk) == HAL_SUCCESS);
+  check(fatfsRegisterDrive(1, (BaseBlockDevice *)&ramdisk[1]) == HAL_SUCCESS);
+  check(fatfsRegisterDrive(2, (BaseBlockDevice *)&ramdisk[2]) == HAL_SUCCESS);
+  check(fatfsRegisterDrive(FF_VOLUMES, (BaseBlockDevice *)&ramdisk[2]) ==
+        HAL_FAILED);
+  check(fatfsGetDrive(2) == (BaseBlockDevice *)&ramdisk[2]);
+  check(fatfsGetDrive(3) == NULL);
+  check(fatfsGetDrive(FF_VOLUMES) == NULL);
+
+  check(disk_initialize(0) == 0);
+  check(disk_status(0) == 0);
+  check(disk_status(1) == STA_PROTECT);
+  check(disk_status(2) == 0);
+}
+
+/*
+ * Multi-sector requests reach the device as one call.
+ */
+static void test_transfers(void) {
+  unsigned i;
+
+  printf("transfers\n");
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)rand();
+
+  countdiskClearStats(&countdisk);
+  check(disk_write(0, data, 3, 16) == RES_OK);
+  check((countdisk.writes == 1) && (countdisk.blocks_written == 16));
+  check(memcmp(storage0 + 3 * 512, data, 16 * 512) == 0);
+  memset(data, 0, sizeof(data));
+  check(disk_read(0, data, 3, 16) == RES_OK);
+  check((countdisk.reads == 1) && (countdisk.blocks_read == 16));
+  check(memcmp(storage0 + 3 * 512, data, 16 * 512) == 0);
+
+  /* drives are independent */
+  check(disk_write(2, data, 0, 8) == RES_OK);
+  check(memcmp(storage2, data, 8 * 1024) == 0);
+  check(countdisk.writes == 1);
+  check(disk_write(1, data, 0, 1) == RES_WRPRT);
+  check(disk_read(1, data, 0, 1) == RES_OK);
+
+  /* past the end of the medium */
+  check(disk_read(0, data, 60, 8) == RES_ERROR);
+}
+
+static void test_ioctl(void) {
+  DWORD count;
+  WORD size;
+
+  printf("ioctl\n");
+  countdiskClearStats(&countdisk);
+  check(disk_ioctl(0, CTRL_SYNC, NULL) == RES_OK);
+  check(countdisk.syncs == 1);
+  check((disk_ioctl(0, GET_SECTOR_COUNT, &count) == RES_OK) && (count == 64));
+  check((disk_ioctl(1, GET_SECTOR_COUNT, &count) == RES_OK) && (count == 16));
+  check((disk_ioctl(2, GET_SECTOR_COUNT, &count) == RES_OK) && (count == 32));
+  check((disk_ioctl(0, GET_SECTOR_SIZE, &size) == RES_OK) && (size == 512));
+  check((disk_ioctl(2, GET_SECTOR_SIZE, &size) == RES_OK) && (size == 1024));
+  check((disk_ioctl(2, GET_BLOCK_SIZE, &count) == RES_OK) && (count == 1));
+  check(disk_ioctl(2, 0xFF, &count) == RES_PARERR);
+}
+
+/*
+ * Unregistered and out of range drives, stopped devices.
+ */
+static void test_unregistered(void) {
+  DWORD count = 0;
+  BYTE pdrv;
+
+  printf("unregistered drives\n");
+  for (pdrv = 3; pdrv <= FF_VOLUMES; pdrv++) {
+    check(disk_initialize(pdrv) == STA_NOINIT);
+    check(disk_status(pdrv) == STA_NOINIT);
+    check(disk_read(pdrv, data, 0, 1) == RES_PARERR);
+    check(disk_write(pdrv, data, 0, 1) == RES_PARERR);
+    check(disk_ioctl(pdrv, CTRL_SYNC, NULL) == RES_PARERR);
+    check(disk_ioctl(pdrv, GET_SECTOR_COUNT, &count) == RES_PARERR);
+    check(count == 0);
+  }
+
+  ramdiskStop(&ramdisk[2]);
+  check(disk_status(2) == STA_NOINIT);
+  check(disk_read(2, data, 0, 1) == RES_NOTRDY);
+  check(disk_write(2, data, 0, 1) == RES_NOTRDY);
+  check(disk_ioctl(2, GET_SECTOR_COUNT, &count) == RES_NOTRDY);
+
+  fatfsUnregisterDrive(0);
+  check(fatfsGetDrive(0) == NULL);
+  check(disk_status(0) == STA_NOINIT);
+  check(disk_read(0, data, 0, 1) == RES_PARERR);
+  check(disk_status(1) == STA_PROTECT);
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+  ramdiskObjectInit(&ramdisk[0]);
+  ramdiskStart(&ramdisk[0], storage0, 512, 64, false);
+  ramdiskObjectInit(&ramdisk[1]);
+  ramdiskStart(&ramdisk[1], storage1, 512, 16, true);
+  ramdiskObjectInit(&ramdisk[2]);
+  ramdiskStart(&ramdisk[2], storage2, 1024, 32, false);
+  countdiskObjectInit(&countdisk, (BaseBlockDevice *)&ramdisk[0]);
+
+  test_register();
+  test_transfers();
+  test_ioctl();
+  test_unregistered();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
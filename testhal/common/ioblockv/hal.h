@@ -0,0 +1,107 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of hal.h, only what the vectored block I/O and the
+ * RAM disk need.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#endif
+#ifndef FALSE
+#define FALSE                           0
+#endif
+
+#define HAL_SUCCESS                     false
+#define HAL_FAILED                      true
+
+#define PACKED_VAR                      __attribute__((packed))
+
+#define osalDbgCheck(c)                 assert(c)
+#define osalDbgAssert(c, remark)        assert(c)
+#define osalSysLock()
+#define osalSysUnlock()
+
+/*
+ * BaseBlockDevice, as in the ChibiOS hal_ioblock.h.
+ */
+typedef enum {
+  BLK_UNINIT = 0,
+  BLK_STOP = 1,
+  BLK_ACTIVE = 2,
+  BLK_CONNECTING = 3,
+  BLK_DISCONNECTING = 4,
+  BLK_READY = 5,
+  BLK_READING = 6,
+  BLK_WRITING = 7,
+  BLK_SYNCING = 8
+} blkstate_t;
+
+typedef struct {
+  uint32_t      blk_size;
+  uint32_t      blk_num;
+} BlockDeviceInfo;
+
+#define _base_block_device_methods                                          \
+  bool (*is_inserted)(void *instance);                                      \
+  bool (*is_protected)(void *instance);                                     \
+  bool (*connect)(void *instance);                                          \
+  bool (*disconnect)(void *instance);                                       \
+  bool (*read)(void *instance, uint32_t startblk,                           \
+               uint8_t *buffer, uint32_t n);                                \
+  bool (*write)(void *instance, uint32_t startblk,                          \
+                const uint8_t *buffer, uint32_t n);                         \
+  bool (*sync)(void *instance);                                             \
+  bool (*get_info)(void *instance, BlockDeviceInfo *bdip);
+
+#define _base_block_device_data                                             \
+  blkstate_t    state;
+
+struct BaseBlockDeviceVMT {
+  _base_block_device_methods
+};
+
+typedef struct {
+  const struct BaseBlockDeviceVMT *vmt;
+  _base_block_device_data
+} BaseBlockDevice;
+
+#define blkGetDriverState(ip)           ((ip)->state)
+#define blkIsTransferring(ip)           false
+#define blkIsInserted(ip)               ((ip)->vmt->is_inserted(ip))
+#define blkIsWriteProtected(ip)         ((ip)->vmt->is_protected(ip))
+#define blkConnect(ip)                  ((ip)->vmt->connect(ip))
+#define blkDisconnect(ip)               ((ip)->vmt->disconnect(ip))
+#define blkRead(ip, startblk, buf, n)                                       \
+  ((ip)->vmt->read(ip, startblk, buf, n))
+#define blkWrite(ip, startblk, buf, n)                                      \
+  ((ip)->vmt->write(ip, startblk, buf, n))
+#define blkSync(ip)                     ((ip)->vmt->sync(ip))
+#define blkGetInfo(ip, bdip)            ((ip)->vmt->get_info(ip, bdip))
+
+#include "hal_ioblockv.h"
+
+#endif /* HAL_H */
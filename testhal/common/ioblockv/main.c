@@ -0,0 +1,355 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the vectored block I/O, the native RAM disk readv and
+ * writev against contiguous transfers and the per element fallback of
+ * the devices whose VMT is not registered. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "ramdisk.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_BLOCK_SIZE       512U
+#define TEST_BLOCKS           256U
+#define TEST_IOV_MAX          6U
+#define TEST_ITERATIONS       4000U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ * Memory disk counting the calls of each method, it is built either with
+ * a plain VMT or with a vectored one.
+ */
+typedef struct {
+  const struct BaseVectoredBlockDeviceVMT *vmt;
+  _base_block_device_data
+  uint8_t       storage[TEST_BLOCKS * TEST_BLOCK_SIZE];
+  unsigned      reads;
+  unsigned      writes;
+  unsigned      readvs;
+  unsigned      writevs;
+  uint32_t      fail_lba;
+} MemDisk;
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t model[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t flat[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint32_t sparse_index[TEST_BLOCKS];
+static uint8_t pool[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static const RamDiskSparseConfig config = {
+  sparse_index, pool, TEST_BLOCKS, NULL, 0
+};
+static uint8_t buf[2 * TEST_IOV_MAX * 8 * TEST_BLOCK_SIZE];
+static uint8_t data[TEST_IOV_MAX * 8 * TEST_BLOCK_SIZE];
+static RamDisk ramdisk;
+static MemDisk memdisk;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static bool md_covers(const MemDisk *mdp, uint32_t startblk, uint32_t n) {
+  return (mdp->fail_lba >= startblk) && (mdp->fail_lba < startblk + n);
+}
+
+static bool md_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n) {
+  MemDisk *mdp = instance;
+
+  mdp->reads++;
+  if ((startblk + n > TEST_BLOCKS) || md_covers(mdp, startblk, n))
+    return HAL_FAILED;
+  memcpy(buffer, &mdp->storage[startblk * TEST_BLOCK_SIZE],
+         n * TEST_BLOCK_SIZE);
+  return HAL_SUCCESS;
+}
+
+static bool md_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n) {
+  MemDisk *mdp = instance;
+
+  mdp->writes++;
+  if ((startblk + n > TEST_BLOCKS) || md_covers(mdp, startblk, n))
+    return HAL_FAILED;
+  memcpy(&mdp->storage[startblk * TEST_BLOCK_SIZE], buffer,
+         n * TEST_BLOCK_SIZE);
+  return HAL_SUCCESS;
+}
+
+static bool md_readv(void *instance, uint32_t startblk,
+                     const blkiov_t *iov, uint32_t iovcnt) {
+  MemDisk *mdp = instance;
+
+  mdp->readvs++;
+  (void)startblk;
+  (void)iov;
+  (void)iovcnt;
+  return HAL_SUCCESS;
+}
+
+static bool md_writev(void *instance, uint32_t startblk,
+                      const blkiov_t *iov, uint32_t iovcnt) {
+  MemDisk *mdp = instance;
+
+  mdp->writevs++;
+  (void)startblk;
+  (void)iov;
+  (void)iovcnt;
+  return HAL_SUCCESS;
+}
+
+static const struct BaseVectoredBlockDeviceVMT md_plain_vmt = {
+  NULL, NULL, NULL, NULL, md_read, md_write, NULL, NULL, NULL, NULL
+};
+
+static const struct BaseVectoredBlockDeviceVMT md_vectored_vmt = {
+  NULL, NULL, NULL, NULL, md_read, md_write, NULL, NULL, md_readv, md_writev
+};
+
+static void memdisk_init(const struct BaseVectoredBlockDeviceVMT *vmtp) {
+
+  memset(&memdisk, 0, sizeof(memdisk));
+  memdisk.vmt = vmtp;
+  memdisk.state = BLK_READY;
+  memdisk.fail_lba = TEST_BLOCKS;
+}
+
+static void fill(uint8_t *p, size_t size) {
+
+  while (size-- > 0U)
+    *p++ = (uint8_t)rand();
+}
+
+/*
+ * Builds a random I/O vector over separate places of buf, zero sized
+ * elements included, and returns the number of elements.
+ */
+static uint32_t random_iov(blkiov_t *iov) {
+  uint32_t i, iovcnt = 1 + rand() % TEST_IOV_MAX;
+
+  for (i = 0; i < iovcnt; i++) {
+    iov[i].n = rand() % 6;
+    iov[i].buffer = buf + (2 * i + rand() % 2) * 8 * TEST_BLOCK_SIZE;
+  }
+  return iovcnt;
+}
+
+/*
+ * Gathers the vector buffers into a contiguous one.
+ */
+static void gather(uint8_t *p, const blkiov_t *iov, uint32_t iovcnt) {
+
+  while (iovcnt-- > 0U) {
+    memcpy(p, iov->buffer, iov->n * TEST_BLOCK_SIZE);
+    p += iov->n * TEST_BLOCK_SIZE;
+    iov++;
+  }
+}
+
+/*
+ * Random vectored writes checked by contiguous reads and contiguous
+ * writes checked by vectored reads, against a model of the medium.
+ */
+static void random_vectored(BaseBlockDevice *bbdp) {
+  blkiov_t iov[TEST_IOV_MAX];
+  unsigned i;
+
+  memset(model, 0, sizeof(model));
+  for (i = 0; i < TEST_BLOCKS; i += 8)
+    check(blkWrite(bbdp, i, model, 8) == HAL_SUCCESS);
+
+  for (i = 0; i < TEST_ITERATIONS; i++) {
+    uint32_t iovcnt = random_iov(iov);
+    uint32_t n = ioblockvGetBlocks(iov, iovcnt);
+    uint32_t lba = rand() % (TEST_BLOCKS - n + 1);
+
+    if (rand() & 1) {
+      fill(buf, sizeof(buf));
+      check(ioblockvWrite(bbdp, lba, iov, iovcnt) == HAL_SUCCESS);
+      gather(model + lba * TEST_BLOCK_SIZE, iov, iovcnt);
+      check((n == 0) ||
+            (blkRead(bbdp, lba, data, n) == HAL_SUCCESS));
+      check(memcmp(data, model + lba * TEST_BLOCK_SIZE,
+                   n * TEST_BLOCK_SIZE) == 0);
+    }
+    else {
+      fill(data, n * TEST_BLOCK_SIZE);
+      check((n == 0) ||
+            (blkWrite(bbdp, lba, data, n) == HAL_SUCCESS));
+      memcpy(model + lba * TEST_BLOCK_SIZE, data, n * TEST_BLOCK_SIZE);
+      fill(buf, sizeof(buf));
+      check(ioblockvRead(bbdp, lba, iov, iovcnt) == HAL_SUCCESS);
+      gather(data, iov, iovcnt);
+      check(memcmp(data, model + lba * TEST_BLOCK_SIZE,
+                   n * TEST_BLOCK_SIZE) == 0);
+    }
+  }
+
+  /* a transfer crossing the end of the medium fails */
+  iov[0].buffer = buf;
+  iov[0].n = 4;
+  iov[1].buffer = buf + 8 * TEST_BLOCK_SIZE;
+  iov[1].n = 4;
+  check(ioblockvRead(bbdp, TEST_BLOCKS - 6, iov, 2) == HAL_FAILED);
+  check(ioblockvWrite(bbdp, TEST_BLOCKS - 6, iov, 2) == HAL_FAILED);
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * The RAM disk is served by its native readv and writev, on flat and
+ * sparse storage.
+ */
+static void test_ramdisk(void) {
+  BaseBlockDevice *dev = (BaseBlockDevice *)&ramdisk;
+
+  printf("RAM disk, flat storage\n");
+  ramdiskObjectInit(&ramdisk);
+  check(ioblockvIsVectored(dev));
+  ramdiskStart(&ramdisk, flat, TEST_BLOCK_SIZE, TEST_BLOCKS, false);
+  random_vectored(dev);
+  check(memcmp(flat, model, sizeof(flat)) == 0);
+  ramdiskStop(&ramdisk);
+
+  printf("RAM disk, sparse storage\n");
+  ramdiskStartSparse(&ramdisk, &config, TEST_BLOCK_SIZE, TEST_BLOCKS, false);
+  check(ioblockvIsVectored(dev));
+  random_vectored(dev);
+  ramdiskStop(&ramdisk);
+}
+
+/*
+ * A device whose VMT is not registered gets one read or write for each
+ * non empty element, even if its VMT has the vectored methods.
+ */
+static void test_fallback(void) {
+  BaseBlockDevice *dev = (BaseBlockDevice *)&memdisk;
+  blkiov_t iov[4] = {
+    {buf, 2}, {buf + 8 * TEST_BLOCK_SIZE, 0},
+    {buf + 16 * TEST_BLOCK_SIZE, 3}, {buf + 24 * TEST_BLOCK_SIZE, 1}
+  };
+
+  printf("plain device\n");
+  memdisk_init(&md_plain_vmt);
+  check(!ioblockvIsVectored(dev));
+  random_vectored(dev);
+  check(memcmp(memdisk.storage, model, sizeof(model)) == 0);
+
+  printf("unregistered vectored device\n");
+  memdisk_init(&md_vectored_vmt);
+  check(!ioblockvIsVectored(dev));
+  random_vectored(dev);
+  check(memcmp(memdisk.storage, model, sizeof(model)) == 0);
+  check((memdisk.readvs == 0) && (memdisk.writevs == 0));
+
+  /* one call per non empty element, the start block follows the vector */
+  memdisk.reads = 0;
+  memdisk.writes = 0;
+  fill(buf, sizeof(buf));
+  check(ioblockvWrite(dev, 10, iov, 4) == HAL_SUCCESS);
+  check(memdisk.writes == 3);
+  check(memcmp(&memdisk.storage[10 * TEST_BLOCK_SIZE], buf,
+               2 * TEST_BLOCK_SIZE) == 0);
+  check(memcmp(&memdisk.storage[12 * TEST_BLOCK_SIZE],
+               buf + 16 * TEST_BLOCK_SIZE, 3 * TEST_BLOCK_SIZE) == 0);
+  check(memcmp(&memdisk.storage[15 * TEST_BLOCK_SIZE],
+               buf + 24 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE) == 0);
+  check(ioblockvRead(dev, 10, iov, 4) == HAL_SUCCESS);
+  check(memdisk.reads == 3);
+  check(ioblockvRead(dev, 10, iov, 0) == HAL_SUCCESS);
+  check(ioblockvWrite(dev, 10, NULL, 0) == HAL_SUCCESS);
+  check((memdisk.reads == 3) && (memdisk.writes == 3));
+
+  /* a failing element stops the transfer */
+  memdisk.fail_lba = 13;
+  check(ioblockvWrite(dev, 10, iov, 4) == HAL_FAILED);
+  check(memdisk.writes == 5);
+  check(ioblockvRead(dev, 10, iov, 4) == HAL_FAILED);
+  check(memdisk.reads == 5);
+}
+
+/*
+ * Once registered, the same VMT is served by readv and writev only.
+ */
+static void test_register(void) {
+  BaseBlockDevice *dev = (BaseBlockDevice *)&memdisk;
+  blkiov_t iov[2] = {{buf, 2}, {buf + 8 * TEST_BLOCK_SIZE, 3}};
+
+  printf("registered vectored device\n");
+  memdisk_init(&md_vectored_vmt);
+  ioblockvRegisterVMT(&md_vectored_vmt);
+  ioblockvRegisterVMT(&md_vectored_vmt);
+  check(ioblockvIsVectored(dev));
+  check(ioblockvRead(dev, 0, iov, 2) == HAL_SUCCESS);
+  check(ioblockvWrite(dev, 0, iov, 2) == HAL_SUCCESS);
+  check((memdisk.readvs == 1) && (memdisk.writevs == 1));
+  check((memdisk.reads == 0) && (memdisk.writes == 0));
+
+  /* the plain VMT is still not vectored */
+  memdisk_init(&md_plain_vmt);
+  check(!ioblockvIsVectored(dev));
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+
+  test_ramdisk();
+  test_fallback();
+  test_register();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
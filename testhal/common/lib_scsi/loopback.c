@@ -0,0 +1,104 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Loopback SCSI transport.
+ */
+
+#include "hal.h"
+#include "loopback.h"
+
+static size_t move(loopback_t *lbp, bool tx, uint8_t *buf, size_t len) {
+
+  /* the host does not take more than announced, as a USB host would */
+  if (len > lbp->limit - lbp->pos)
+    len = lbp->limit - lbp->pos;
+  if (tx)
+    memcpy(lbp->host + lbp->pos, buf, len);
+  else
+    memcpy(buf, lbp->host + lbp->pos, len);
+  lbp->pos += len;
+  lbp->transfers++;
+  return len;
+}
+
+static uint32_t lb_transmit(const SCSITransport *tp, const uint8_t *data,
+                            size_t len) {
+
+  return (uint32_t)move(tp->handler, true, (uint8_t *)data, len);
+}
+
+static uint32_t lb_receive(const SCSITransport *tp, uint8_t *data,
+                           size_t len) {
+
+  return (uint32_t)move(tp->handler, false, data, len);
+}
+
+static void lb_start(loopback_t *lbp, bool tx, uint8_t *buf, size_t len) {
+
+  /* one transfer at a time, as on a single endpoint */
+  if (lbp->busy)
+    lbp->overlaps++;
+  lbp->busy = true;
+  lbp->tx = tx;
+  lbp->buf = buf;
+  lbp->len = len;
+}
+
+static void lb_start_transmit(const SCSITransport *tp, const uint8_t *data,
+                              size_t len) {
+
+  lb_start(tp->handler, true, (uint8_t *)data, len);
+}
+
+static void lb_start_receive(const SCSITransport *tp, uint8_t *data,
+                             size_t len) {
+
+  lb_start(tp->handler, false, data, len);
+}
+
+static uint32_t lb_wait(const SCSITransport *tp) {
+  loopback_t *lbp = tp->handler;
+
+  if (!lbp->busy)
+    return 0;
+  lbp->busy = false;
+  return (uint32_t)move(lbp, lbp->tx, lbp->buf, lbp->len);
+}
+
+void loopbackObjectInit(loopback_t *lbp, SCSITransport *tp, bool async) {
+
+  memset(lbp, 0, sizeof(*lbp));
+  memset(tp, 0, sizeof(*tp));
+  tp->handler = lbp;
+  tp->transmit = lb_transmit;
+  tp->receive = lb_receive;
+  if (async) {
+    tp->start_transmit = lb_start_transmit;
+    tp->start_receive = lb_start_receive;
+    tp->wait = lb_wait;
+  }
+}
+
+void loopbackReset(loopback_t *lbp, uint8_t *host, size_t limit) {
+
+  lbp->host = host;
+  lbp->pos = 0;
+  lbp->limit = limit;
+  lbp->busy = false;
+  lbp->transfers = 0;
+  lbp->overlaps = 0;
+}
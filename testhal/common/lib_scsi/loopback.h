@@ -0,0 +1,52 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Loopback SCSI transport, the host side of the data phase is a plain
+ * buffer.
+ */
+
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include "lib_scsi.h"
+
+/*
+ * Host side of the transport. Asynchronous transfers are only carried out
+ * when waited for, so that a buffer reused before the wait is detected.
+ */
+typedef struct {
+  uint8_t       *host;
+  size_t        pos;
+  size_t        limit;
+  bool          busy;
+  bool          tx;
+  uint8_t       *buf;
+  size_t        len;
+  unsigned      transfers;
+  unsigned      overlaps;
+} loopback_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void loopbackObjectInit(loopback_t *lbp, SCSITransport *tp, bool async);
+  void loopbackReset(loopback_t *lbp, uint8_t *host, size_t limit);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOOPBACK_H */
@@ -0,0 +1,250 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of lib_scsi, the SCSI target runs on a RAM disk and talks to
+ * a loopback transport. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "lib_scsi.h"
+#include "ramdisk.h"
+#include "loopback.h"
+#include "testdisk.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_BLOCK_SIZE       512U
+#define TEST_BLOCKS           1024U
+#define TEST_CMD_BLOCKS       128U
+#define TEST_MAX_BLKBUF       64U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t disk[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t host[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t blkbuf[TEST_MAX_BLKBUF * TEST_BLOCK_SIZE];
+static RamDisk ramdisk;
+static TestDisk testdisk;
+static loopback_t loopback;
+static SCSITransport transport;
+static SCSITargetConfig config;
+static SCSITarget target;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void randomize(uint8_t *p, size_t n) {
+
+  while (n-- > 0)
+    *p++ = (uint8_t)rand();
+}
+
+static void cdb10(uint8_t *cmd, uint8_t op, uint32_t lba, uint16_t n) {
+
+  memset(cmd, 0, 16);
+  cmd[0] = op;
+  cmd[2] = (uint8_t)(lba >> 24);
+  cmd[3] = (uint8_t)(lba >> 16);
+  cmd[4] = (uint8_t)(lba >> 8);
+  cmd[5] = (uint8_t)lba;
+  cmd[7] = (uint8_t)(n >> 8);
+  cmd[8] = (uint8_t)n;
+}
+
+/*
+ * Executes a command, the host side of the data phase is @p data,
+ * @p len bytes long.
+ */
+static bool exec(const uint8_t *cmd, uint8_t *data, size_t len) {
+
+  loopbackReset(&loopback, data, len);
+  return scsiExecCmd(&target, cmd);
+}
+
+static void start(size_t blkbuf_blocks, bool async) {
+
+  loopbackObjectInit(&loopback, &transport, async);
+  testdiskObjectInit(&testdisk, (BaseBlockDevice *)&ramdisk);
+  testdisk.link_busy = &loopback.busy;
+  memset(&config, 0, sizeof(config));
+  config.transport = &transport;
+  config.blkdev = (BaseBlockDevice *)&testdisk;
+  config.blkbuf = blkbuf;
+  config.blkbuf_blocks = blkbuf_blocks;
+  scsiObjectInit(&target);
+  scsiStart(&target, &config);
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Multi-block READ(10)/WRITE(10) for a given buffer size and transport.
+ */
+static void test_pipeline(size_t blkbuf_blocks, bool async) {
+  size_t chunk = blkbuf_blocks >= 2 ? blkbuf_blocks / 2 : 1;
+  unsigned per_cmd = (TEST_CMD_BLOCKS + chunk - 1) / chunk;
+  unsigned cmds = TEST_BLOCKS / TEST_CMD_BLOCKS;
+  bool pipelined = async && (blkbuf_blocks >= 2);
+  uint8_t cmd[16];
+  uint32_t lba;
+
+  printf("%2u blocks buffer, %s transport\n", (unsigned)blkbuf_blocks,
+         async ? "async" : "sync ");
+  start(blkbuf_blocks, async);
+
+  randomize(disk, sizeof(disk));
+  memset(host, 0, sizeof(host));
+  for (lba = 0; lba < TEST_BLOCKS; lba += TEST_CMD_BLOCKS) {
+    cdb10(cmd, SCSI_CMD_READ_10, lba, TEST_CMD_BLOCKS);
+    check(exec(cmd, host + lba * TEST_BLOCK_SIZE,
+               TEST_CMD_BLOCKS * TEST_BLOCK_SIZE) == SCSI_SUCCESS);
+  }
+  check(memcmp(host, disk, sizeof(disk)) == 0);
+  check(testdisk.reads == cmds * per_cmd);
+  /* every medium read but the first of a command overlaps a transfer */
+  check(testdisk.overlapped == (pipelined ? cmds * (per_cmd - 1) : 0));
+  check(loopback.overlaps == 0);
+
+  testdiskClearStats(&testdisk);
+  randomize(host, sizeof(host));
+  for (lba = 0; lba < TEST_BLOCKS; lba += TEST_CMD_BLOCKS) {
+    cdb10(cmd, SCSI_CMD_WRITE_10, lba, TEST_CMD_BLOCKS);
+    check(exec(cmd, host + lba * TEST_BLOCK_SIZE,
+               TEST_CMD_BLOCKS * TEST_BLOCK_SIZE) == SCSI_SUCCESS);
+  }
+  check(memcmp(host, disk, sizeof(disk)) == 0);
+  check(testdisk.writes == cmds * per_cmd);
+  /* every medium write but the last of a command overlaps a transfer */
+  check(testdisk.overlapped == (pipelined ? cmds * (per_cmd - 1) : 0));
+  check(loopback.overlaps == 0);
+
+  /* lengths that are not a multiple of the chunk */
+  memset(host, 0, sizeof(host));
+  cdb10(cmd, SCSI_CMD_READ_10, 3, 37);
+  check(exec(cmd, host, 37 * TEST_BLOCK_SIZE) == SCSI_SUCCESS);
+  check(memcmp(host, disk + 3 * TEST_BLOCK_SIZE, 37 * TEST_BLOCK_SIZE) == 0);
+  randomize(host, 5 * TEST_BLOCK_SIZE);
+  cdb10(cmd, SCSI_CMD_WRITE_10, TEST_BLOCKS - 5, 5);
+  check(exec(cmd, host, 5 * TEST_BLOCK_SIZE) == SCSI_SUCCESS);
+  check(memcmp(host, disk + (TEST_BLOCKS - 5) * TEST_BLOCK_SIZE,
+               5 * TEST_BLOCK_SIZE) == 0);
+  check(loopback.pos == 5 * TEST_BLOCK_SIZE);
+}
+
+/*
+ * Medium errors, the residue and the sense data describe the failed
+ * command only.
+ */
+static void test_errors(size_t blkbuf_blocks, bool async) {
+  const scsi_sense_response_t *sense = &target.sense;
+  size_t chunk = blkbuf_blocks >= 2 ? blkbuf_blocks / 2 : 1;
+  /* the failing access is the chunk holding block 40 */
+  uint32_t bad = 32 + ((40 - 32) / chunk) * chunk;
+  uint8_t cmd[16];
+
+  printf("%2u blocks buffer, %s transport, medium errors\n",
+         (unsigned)blkbuf_blocks, async ? "async" : "sync ");
+  start(blkbuf_blocks, async);
+  testdisk.bad_lba = 40;
+
+  testdisk.fail_reads = true;
+  cdb10(cmd, SCSI_CMD_READ_10, 32, 16);
+  check(exec(cmd, host, 16 * TEST_BLOCK_SIZE) == SCSI_FAILED);
+  check(loopback.pos == (bad - 32) * TEST_BLOCK_SIZE);
+  check(scsiResidue(&target) == (48 - bad) * TEST_BLOCK_SIZE);
+  check(sense->byte[2] == SCSI_SENSE_KEY_MEDIUM_ERROR);
+  check(sense->byte[12] == SCSI_ASENSE_UNRECOVERED_READ_ERROR);
+  check(sense->byte[6] == bad);
+  memset(cmd, 0, sizeof(cmd));
+  cmd[0] = SCSI_CMD_TEST_UNIT_READY;
+  check(exec(cmd, NULL, 0) == SCSI_SUCCESS);
+  check(scsiResidue(&target) == 0);
+  testdisk.fail_reads = false;
+
+  testdisk.fail_writes = true;
+  cdb10(cmd, SCSI_CMD_WRITE_10, 32, 16);
+  check(exec(cmd, host, 16 * TEST_BLOCK_SIZE) == SCSI_FAILED);
+  /* the residue counts the blocks not written */
+  check(scsiResidue(&target) == (48 - bad) * TEST_BLOCK_SIZE);
+  check(sense->byte[2] == SCSI_SENSE_KEY_MEDIUM_ERROR);
+  check(sense->byte[12] == SCSI_ASENSE_WRITE_ERROR);
+  check(sense->byte[6] == bad);
+  /* FORMAT UNIT is not supported, a failure without data phase */
+  memset(cmd, 0, sizeof(cmd));
+  cmd[0] = 0x04;
+  check(exec(cmd, NULL, 0) == SCSI_FAILED);
+  check(scsiResidue(&target) == 0);
+  check(sense->byte[2] == SCSI_SENSE_KEY_ILLEGAL_REQUEST);
+  testdisk.fail_writes = false;
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+  static const size_t sizes[] = {1, 2, 3, 16, TEST_MAX_BLKBUF};
+  unsigned i;
+
+  srand(1);
+  ramdiskObjectInit(&ramdisk);
+  ramdiskStart(&ramdisk, disk, TEST_BLOCK_SIZE, TEST_BLOCKS, false);
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    test_pipeline(sizes[i], false);
+    test_pipeline(sizes[i], true);
+    test_errors(sizes[i], false);
+    test_errors(sizes[i], true);
+  }
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Instrumented block device.
+ */
+
+#include "hal.h"
+#include "testdisk.h"
+
+static bool td_is_inserted(void *instance) {
+  TestDisk *tdp = instance;
+
+  return blkIsInserted(tdp->target);
+}
+
+static bool td_is_protected(void *instance) {
+  TestDisk *tdp = instance;
+
+  return blkIsWriteProtected(tdp->target);
+}
+
+static bool td_connect(void *instance) {
+  TestDisk *tdp = instance;
+
+  return blkConnect(tdp->target);
+}
+
+static bool td_disconnect(void *instance) {
+  TestDisk *tdp = instance;
+
+  return blkDisconnect(tdp->target);
+}
+
+static void td_access(TestDisk *tdp) {
+
+  if ((tdp->link_busy != NULL) && *tdp->link_busy)
+    tdp->overlapped++;
+}
+
+static bool td_covers_bad(TestDisk *tdp, uint32_t startblk, uint32_t n) {
+
+  return (tdp->bad_lba >= startblk) && (tdp->bad_lba - startblk < n);
+}
+
+static bool td_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n) {
+  TestDisk *tdp = instance;
+
+  tdp->reads++;
+  td_access(tdp);
+  if (tdp->fail_reads && td_covers_bad(tdp, startblk, n))
+    return HAL_FAILED;
+  return blkRead(tdp->target, startblk, buffer, n);
+}
+
+static bool td_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n) {
+  TestDisk *tdp = instance;
+
+  tdp->writes++;
+  td_access(tdp);
+  if (tdp->fail_writes && td_covers_bad(tdp, startblk, n))
+    return HAL_FAILED;
+  return blkWrite(tdp->target, startblk, buffer, n);
+}
+
+static bool td_sync(void *instance) {
+  TestDisk *tdp = instance;
+
+  tdp->syncs++;
+  return blkSync(tdp->target);
+}
+
+static bool td_get_info(void *instance, BlockDeviceInfo *bdip) {
+  TestDisk *tdp = instance;
+
+  return blkGetInfo(tdp->target, bdip);
+}
+
+static const struct BaseBlockDeviceVMT vmt = {
+  td_is_inserted,
+  td_is_protected,
+  td_connect,
+  td_disconnect,
+  td_read,
+  td_write,
+  td_sync,
+  td_get_info
+};
+
+void testdiskObjectInit(TestDisk *tdp, BaseBlockDevice *target) {
+
+  tdp->vmt = &vmt;
+  tdp->state = BLK_READY;
+  tdp->target = target;
+  tdp->link_busy = NULL;
+  tdp->fail_reads = false;
+  tdp->fail_writes = false;
+  tdp->bad_lba = 0;
+  testdiskClearStats(tdp);
+}
+
+void testdiskClearStats(TestDisk *tdp) {
+
+  tdp->reads = 0;
+  tdp->writes = 0;
+  tdp->syncs = 0;
+  tdp->overlapped = 0;
+}
@@ -0,0 +1,51 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Instrumented block device, forwards every call to a target device,
+ * counts them and fails the accesses to a given block on demand.
+ */
+
+#ifndef TESTDISK_H
+#define TESTDISK_H
+
+typedef struct {
+  const struct BaseBlockDeviceVMT *vmt;
+  _base_block_device_data
+  BaseBlockDevice       *target;
+  /* when not NULL, medium accesses done while it is true are counted as
+     overlapped with the link */
+  const bool            *link_busy;
+  /* when set, reads or writes covering bad_lba fail */
+  bool                  fail_reads;
+  bool                  fail_writes;
+  uint32_t              bad_lba;
+  unsigned              reads;
+  unsigned              writes;
+  unsigned              syncs;
+  unsigned              overlapped;
+} TestDisk;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void testdiskObjectInit(TestDisk *tdp, BaseBlockDevice *target);
+  void testdiskClearStats(TestDisk *tdp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTDISK_H */
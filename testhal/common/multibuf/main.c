@@ -0,0 +1,255 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Stress test of the N-buffer, a producer thread standing for an ISR
+ * publishes numbered frames while the consumer checks them, for every
+ * buffer count and both consumption policies. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "osal.h"
+#include "multibuf.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_FRAMES           200000U
+#define FRAME_WORDS           32U
+
+/* One in YIELD_RATE fills or checks gives the CPU away half way, so that
+   the two sides also interleave on a single core host.*/
+#define YIELD_RATE            8U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+typedef struct {
+  uint32_t      seq[FRAME_WORDS];
+} frame_t;
+
+pthread_mutex_t osal_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static frame_t frames[MULTIBUF_MAX_BUFFERS];
+static void *buffers[MULTIBUF_MAX_BUFFERS];
+static multibuf_t mb;
+static volatile bool producer_done;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void maybe_yield(unsigned *seed) {
+
+  *seed = *seed * 1103515245U + 12345U;
+  if ((*seed >> 16) % YIELD_RATE == 0U)
+    sched_yield();
+}
+
+static void fill(frame_t *fp, uint32_t seq, unsigned *seed) {
+  unsigned k;
+
+  for (k = 0; k < FRAME_WORDS; k++) {
+    fp->seq[k] = seq;
+    if ((seed != NULL) && (k == FRAME_WORDS / 2U))
+      maybe_yield(seed);
+  }
+}
+
+static uint32_t front_seq(void) {
+
+  return ((frame_t *)multibufGetFront(&mb))->seq[0];
+}
+
+static void publish(uint32_t seq) {
+
+  fill(multibufGetBack(&mb), seq, NULL);
+  (void)multibufSwapBack(&mb);
+}
+
+static void init(size_t n, multibuf_mode_t mode) {
+  size_t i;
+
+  memset(frames, 0, sizeof(frames));
+  for (i = 0; i < n; i++)
+    buffers[i] = &frames[i];
+  multibufObjectInit(&mb, buffers, n, mode);
+}
+
+static void *producer(void *arg) {
+  unsigned seed = 1;
+  uint32_t seq;
+
+  (void)arg;
+  for (seq = 1; seq <= TEST_FRAMES; seq++) {
+    fill(multibufGetBack(&mb), seq, &seed);
+    (void)multibufSwapBack(&mb);
+  }
+  __atomic_store_n(&producer_done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+static void test_latest(void) {
+
+  printf("latest wins sequence\n");
+  init(5, MULTIBUF_LATEST);
+  check(!multibufSwapFront(&mb));
+  publish(1);
+  publish(2);
+  publish(3);
+  check(multibufSwapFront(&mb));
+  check(front_seq() == 3);
+  check(multibufGetDropped(&mb) == 2);
+  /* three ready frames fit in five buffers, a fourth recycles the oldest */
+  publish(4);
+  publish(5);
+  publish(6);
+  check(multibufGetDropped(&mb) == 2);
+  fill(multibufGetBack(&mb), 7, NULL);
+  check(!multibufSwapBack(&mb));
+  check(multibufGetDropped(&mb) == 3);
+  check(multibufSwapFront(&mb));
+  check(front_seq() == 7);
+  check(multibufGetDropped(&mb) == 5);
+  check(!multibufSwapFront(&mb));
+}
+
+static void test_fifo(void) {
+
+  printf("FIFO sequence\n");
+  init(5, MULTIBUF_FIFO);
+  publish(1);
+  publish(2);
+  publish(3);
+  check(multibufSwapFront(&mb));
+  check(front_seq() == 1);
+  check(multibufSwapFront(&mb));
+  check(front_seq() == 2);
+  /* with the queue full the back buffer is kept by the producer */
+  publish(4);
+  publish(5);
+  fill(multibufGetBack(&mb), 6, NULL);
+  check(!multibufSwapBack(&mb));
+  check(multibufGetDropped(&mb) == 1);
+  check(((frame_t *)multibufGetBack(&mb))->seq[0] == 6);
+  check(multibufSwapFront(&mb) && (front_seq() == 3));
+  check(multibufSwapBack(&mb));
+  check(multibufSwapFront(&mb) && (front_seq() == 4));
+  check(multibufSwapFront(&mb) && (front_seq() == 5));
+  check(multibufSwapFront(&mb) && (front_seq() == 6));
+  check(!multibufSwapFront(&mb));
+}
+
+static void test_stress(size_t n, multibuf_mode_t mode) {
+  pthread_t thread;
+  uint32_t last = 0;
+  unsigned long received = 0;
+  unsigned torn = 0, order = 0;
+  unsigned seed = 7;
+
+  init(n, mode);
+  producer_done = false;
+  pthread_create(&thread, NULL, producer, NULL);
+  for (;;) {
+    bool done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+
+    if (multibufSwapFront(&mb)) {
+      const frame_t *fp = multibufGetFront(&mb);
+      unsigned k;
+
+      for (k = 1; k < FRAME_WORDS; k++) {
+        if (k == FRAME_WORDS / 2U)
+          maybe_yield(&seed);
+        if (fp->seq[k] != fp->seq[0]) {
+          torn++;
+          break;
+        }
+      }
+      if (fp->seq[0] <= last)
+        order++;
+      last = fp->seq[0];
+      received++;
+    }
+    else if (done) {
+      break;
+    }
+    else {
+      sched_yield();
+    }
+  }
+  pthread_join(thread, NULL);
+  printf("%u buffers %s: %lu received, %u dropped, last %u\n",
+         (unsigned)n, mode == MULTIBUF_FIFO ? "FIFO  " : "latest",
+         received, (unsigned)multibufGetDropped(&mb), last);
+  check(torn == 0);
+  check(order == 0);
+  /* every frame is either received or accounted as dropped */
+  check(received + multibufGetDropped(&mb) == TEST_FRAMES);
+  if (mode == MULTIBUF_LATEST)
+    check(last == TEST_FRAMES);
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+  size_t n;
+
+  test_latest();
+  test_fifo();
+  for (n = 3; n <= MULTIBUF_MAX_BUFFERS; n++) {
+    test_stress(n, MULTIBUF_LATEST);
+    test_stress(n, MULTIBUF_FIFO);
+  }
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
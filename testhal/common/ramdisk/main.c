@@ -0,0 +1,306 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the RAM disk sparse storage and snapshots, checked against
+ * a flat model of the medium. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "ramdisk.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_BLOCK_SIZE       512U
+#define TEST_BLOCKS           2048U
+#define TEST_POOL_BLOCKS      256U
+#define TEST_UNDO_NUM         64U
+#define TEST_ITERATIONS       20000U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t model[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t saved[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint32_t sparse_index[TEST_BLOCKS];
+static uint8_t pool[TEST_POOL_BLOCKS * TEST_BLOCK_SIZE];
+static ramdisk_undo_t undo[TEST_UNDO_NUM];
+static const RamDiskSparseConfig config = {
+  sparse_index, pool, TEST_POOL_BLOCKS, undo, TEST_UNDO_NUM
+};
+static uint8_t data[8 * TEST_BLOCK_SIZE];
+static RamDisk ramdisk;
+static BaseBlockDevice *const dev = (BaseBlockDevice *)&ramdisk;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+/*
+ * Fills n blocks, about one in eight with data and the others with zeros.
+ */
+static void fill(uint8_t *p, uint32_t n) {
+  uint32_t i;
+
+  memset(p, 0, n * TEST_BLOCK_SIZE);
+  for (i = 0; i < n; i++) {
+    if ((rand() & 7) == 0) {
+      /* sometimes only the last byte is set */
+      if (rand() & 1)
+        memset(p + i * TEST_BLOCK_SIZE, rand() | 1, TEST_BLOCK_SIZE);
+      else
+        p[(i + 1) * TEST_BLOCK_SIZE - 1] = 1;
+    }
+  }
+}
+
+static bool is_zero(const uint8_t *p) {
+  uint32_t i;
+
+  for (i = 0; i < TEST_BLOCK_SIZE; i++) {
+    if (p[i] != 0)
+      return false;
+  }
+  return true;
+}
+
+static uint32_t model_used(void) {
+  uint32_t lba, n = 0;
+
+  for (lba = 0; lba < TEST_BLOCKS; lba++)
+    n += is_zero(model + lba * TEST_BLOCK_SIZE) ? 0 : 1;
+  return n;
+}
+
+/*
+ * Writes to the disk and, if accepted, to the model.
+ */
+static bool write_blocks(uint32_t lba, uint32_t n) {
+
+  if (blkWrite(dev, lba, data, n) != HAL_SUCCESS)
+    return HAL_FAILED;
+  memcpy(model + lba * TEST_BLOCK_SIZE, data, n * TEST_BLOCK_SIZE);
+  return HAL_SUCCESS;
+}
+
+static bool disk_matches(const uint8_t *ref) {
+  uint32_t lba;
+
+  for (lba = 0; lba < TEST_BLOCKS; lba += 8) {
+    if ((blkRead(dev, lba, data, 8) != HAL_SUCCESS) ||
+        (memcmp(data, ref + lba * TEST_BLOCK_SIZE, 8 * TEST_BLOCK_SIZE) != 0))
+      return false;
+  }
+  return true;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Random reads and writes, a write failing on pool exhaustion is only
+ * allowed when the pool is full.
+ */
+static void test_random(void) {
+  unsigned i, rejected = 0;
+
+  printf("random workload\n");
+  memset(model, 0, sizeof(model));
+  ramdiskStartSparse(&ramdisk, &config, TEST_BLOCK_SIZE, TEST_BLOCKS, false);
+  check(ramdiskGetUsedBlocks(&ramdisk) == 0);
+  check(disk_matches(model));
+
+  for (i = 0; i < TEST_ITERATIONS; i++) {
+    uint32_t n = 1 + rand() % 8;
+    uint32_t lba = rand() % (TEST_BLOCKS - n + 1);
+
+    if (rand() % 3) {
+      fill(data, n);
+      /* a failed write may have stored some of the blocks */
+      if (write_blocks(lba, n) != HAL_SUCCESS) {
+        check(ramdiskGetUsedBlocks(&ramdisk) == TEST_POOL_BLOCKS);
+        check(blkRead(dev, lba, data, n) == HAL_SUCCESS);
+        memcpy(model + lba * TEST_BLOCK_SIZE, data, n * TEST_BLOCK_SIZE);
+        rejected++;
+      }
+    }
+    else {
+      check(blkRead(dev, lba, data, n) == HAL_SUCCESS);
+      check(memcmp(data, model + lba * TEST_BLOCK_SIZE,
+                   n * TEST_BLOCK_SIZE) == 0);
+    }
+    /* zeros give the pool back */
+    if ((i % 1000) == 999) {
+      memset(data, 0, sizeof(data));
+      for (lba = 0; lba < TEST_BLOCKS / 2; lba += 8)
+        check(write_blocks(lba, 8) == HAL_SUCCESS);
+    }
+  }
+  check(rejected > 0);
+  check(disk_matches(model));
+  check(ramdiskGetUsedBlocks(&ramdisk) == model_used());
+  check(blkRead(dev, TEST_BLOCKS - 1, data, 2) == HAL_FAILED);
+  check(blkWrite(dev, TEST_BLOCKS, data, 1) == HAL_FAILED);
+  printf("  %u writes rejected on a full pool\n", rejected);
+}
+
+/*
+ * Vectored transfers against the plain ones.
+ */
+static void test_vectored(void) {
+  static uint8_t buf[8 * TEST_BLOCK_SIZE];
+  blkiov_t iov[3] = {
+    {buf, 1}, {buf + 3 * TEST_BLOCK_SIZE, 4}, {buf + TEST_BLOCK_SIZE, 2}
+  };
+
+  printf("vectored transfers\n");
+  check(ioblockvIsVectored(dev));
+  fill(buf, 8);
+  memset(buf + TEST_BLOCK_SIZE, 0x5A, TEST_BLOCK_SIZE);
+  check(ioblockvWrite(dev, 100, iov, 3) == HAL_SUCCESS);
+  memcpy(model + 100 * TEST_BLOCK_SIZE, buf, TEST_BLOCK_SIZE);
+  memcpy(model + 101 * TEST_BLOCK_SIZE, buf + 3 * TEST_BLOCK_SIZE,
+         4 * TEST_BLOCK_SIZE);
+  memcpy(model + 105 * TEST_BLOCK_SIZE, buf + TEST_BLOCK_SIZE,
+         2 * TEST_BLOCK_SIZE);
+  check(disk_matches(model));
+  memset(buf, 0xEE, sizeof(buf));
+  check(ioblockvRead(dev, 100, iov, 3) == HAL_SUCCESS);
+  check(memcmp(buf, model + 100 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE) == 0);
+  check(memcmp(buf + 3 * TEST_BLOCK_SIZE, model + 101 * TEST_BLOCK_SIZE,
+               4 * TEST_BLOCK_SIZE) == 0);
+  check(ioblockvRead(dev, TEST_BLOCKS - 6, iov, 3) == HAL_FAILED);
+  check(ramdiskGetUsedBlocks(&ramdisk) == model_used());
+}
+
+/*
+ * Rollbacks restore the snapshot content and pool usage, a commit keeps
+ * the modifications. Writes beyond the undo log capacity fail.
+ */
+static void test_snapshot(void) {
+  uint32_t used;
+  unsigned r, i, rejected = 0;
+
+  printf("snapshots\n");
+  /* make room in the pool */
+  memset(data, 0, sizeof(data));
+  for (i = 0; i < TEST_BLOCKS; i += 8)
+    check(write_blocks(i, 8) == HAL_SUCCESS);
+  for (i = 0; i < TEST_POOL_BLOCKS / 2; i++) {
+    fill(data, 1);
+    data[0] = 1;
+    check(write_blocks(rand() % TEST_BLOCKS, 1) == HAL_SUCCESS);
+  }
+  used = ramdiskGetUsedBlocks(&ramdisk);
+  memcpy(saved, model, sizeof(model));
+
+  ramdiskSnapshot(&ramdisk);
+  for (r = 0; r < 3; r++) {
+    for (i = 0; i < 2 * TEST_UNDO_NUM; i++) {
+      uint32_t lba = rand() % TEST_BLOCKS;
+
+      fill(data, 1);
+      data[0] = (uint8_t)(rand() & 1);
+      if (write_blocks(lba, 1) != HAL_SUCCESS)
+        rejected++;
+      /* written again, no new log entry */
+      if (write_blocks(lba, 1) != HAL_SUCCESS)
+        rejected++;
+    }
+    /* the blocks saved by the snapshot are still in the pool */
+    check(ramdiskGetUsedBlocks(&ramdisk) >= model_used());
+    ramdiskRollback(&ramdisk);
+    check(ramdiskGetUsedBlocks(&ramdisk) == used);
+    check(disk_matches(saved));
+    memcpy(model, saved, sizeof(model));
+  }
+  check(rejected > 0);
+
+  for (i = 0; i < TEST_UNDO_NUM; i++) {
+    fill(data, 1);
+    check(write_blocks(i * 7, 1) == HAL_SUCCESS);
+  }
+  ramdiskCommit(&ramdisk);
+  check(disk_matches(model));
+  check(ramdiskGetUsedBlocks(&ramdisk) == model_used());
+
+  /* the blocks committed are saved again by the next snapshot */
+  memcpy(saved, model, sizeof(model));
+  ramdiskSnapshot(&ramdisk);
+  for (i = 0; i < TEST_UNDO_NUM; i++) {
+    memset(data, 0x33, TEST_BLOCK_SIZE);
+    check(write_blocks(i * 7, 1) == HAL_SUCCESS);
+  }
+  ramdiskRollback(&ramdisk);
+  check(disk_matches(saved));
+  memcpy(model, saved, sizeof(model));
+  ramdiskCommit(&ramdisk);
+  /* no snapshot, nothing to roll back */
+  fill(data, 1);
+  data[0] = 1;
+  check(write_blocks(3, 1) == HAL_SUCCESS);
+  ramdiskRollback(&ramdisk);
+  check(disk_matches(model));
+  check(ramdiskGetUsedBlocks(&ramdisk) == model_used());
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+  ramdiskObjectInit(&ramdisk);
+
+  test_random();
+  test_vectored();
+  test_snapshot();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
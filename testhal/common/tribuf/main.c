@@ -0,0 +1,225 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Stress test of the triple buffer, a producer thread standing for an ISR
+ * publishes numbered frames as fast as it can while the consumer checks
+ * them. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "osal.h"
+#include "tribuf.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_FRAMES           1000000U
+#define FRAME_WORDS           64U
+
+/* One in YIELD_RATE fills or checks gives the CPU away half way, so that
+   the two sides also interleave on a single core host.*/
+#define YIELD_RATE            8U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+typedef struct {
+  uint32_t      seq[FRAME_WORDS];
+} frame_t;
+
+pthread_mutex_t osal_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static frame_t frames[3];
+static tribuf_t tb;
+static volatile bool producer_done;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+/*
+ * The "I" class functions run under the system lock, as from an ISR.
+ */
+static bool swap_front(void) {
+  bool ready;
+
+#if TRIBUF_USE_LOCKFREE == TRUE
+  ready = tribufIsReadyI(&tb);
+  if (ready)
+    tribufSwapFront(&tb);
+#else
+  osalSysLock();
+  ready = tribufIsReadyI(&tb);
+  if (ready)
+    tribufSwapFrontI(&tb);
+  osalSysUnlock();
+#endif
+  return ready;
+}
+
+static void maybe_yield(unsigned *seed) {
+
+  *seed = *seed * 1103515245U + 12345U;
+  if ((*seed >> 16) % YIELD_RATE == 0U)
+    sched_yield();
+}
+
+static void fill(frame_t *fp, uint32_t seq, unsigned *seed) {
+  unsigned k;
+
+  for (k = 0; k < FRAME_WORDS; k++) {
+    fp->seq[k] = seq;
+    if (k == FRAME_WORDS / 2U)
+      maybe_yield(seed);
+  }
+}
+
+static void *producer(void *arg) {
+  unsigned seed = 1;
+  uint32_t seq;
+
+  (void)arg;
+  for (seq = 1; seq <= TEST_FRAMES; seq++) {
+    fill(tribufGetBack(&tb), seq, &seed);
+    tribufSwapBack(&tb);
+  }
+  __atomic_store_n(&producer_done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+static void test_sequence(void) {
+  unsigned seed = 0;
+  frame_t *fp;
+
+  printf("single thread sequence\n");
+  tribufObjectInit(&tb, &frames[0], &frames[1], &frames[2]);
+  check(!swap_front());
+  fill(tribufGetBack(&tb), 1, &seed);
+  tribufSwapBack(&tb);
+  /* an unread frame is replaced by a newer one */
+  fill(tribufGetBack(&tb), 2, &seed);
+  tribufSwapBack(&tb);
+  check(swap_front());
+  fp = tribufGetFront(&tb);
+  check(fp->seq[0] == 2);
+  check(!swap_front());
+  check(tribufGetFront(&tb) == fp);
+  /* the three buffers are always distinct */
+  check(tribufGetBack(&tb) != fp);
+  fill(tribufGetBack(&tb), 3, &seed);
+  tribufSwapBack(&tb);
+  check(tribufGetBack(&tb) != tribufGetFront(&tb));
+  check(swap_front());
+  check(((frame_t *)tribufGetFront(&tb))->seq[0] == 3);
+}
+
+static void test_stress(void) {
+  pthread_t thread;
+  uint32_t last = 0;
+  unsigned long received = 0;
+  unsigned torn = 0, stale = 0;
+  unsigned seed = 7;
+
+  printf("producer thread, %u frames\n", TEST_FRAMES);
+  memset(frames, 0, sizeof(frames));
+  tribufObjectInit(&tb, &frames[0], &frames[1], &frames[2]);
+  producer_done = false;
+  pthread_create(&thread, NULL, producer, NULL);
+  for (;;) {
+    bool done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+
+    if (swap_front()) {
+      const frame_t *fp = tribufGetFront(&tb);
+      unsigned k;
+
+      /* the front buffer is never written while it is held */
+      for (k = 1; k < FRAME_WORDS; k++) {
+        if (k == FRAME_WORDS / 2U)
+          maybe_yield(&seed);
+        if (fp->seq[k] != fp->seq[0]) {
+          torn++;
+          break;
+        }
+      }
+      if (fp->seq[0] <= last)
+        stale++;
+      last = fp->seq[0];
+      received++;
+    }
+    else if (done) {
+      break;
+    }
+    else {
+      sched_yield();
+    }
+  }
+  pthread_join(thread, NULL);
+  printf("  %lu frames received, last %u\n", received, last);
+  check(torn == 0);
+  check(stale == 0);
+  /* the last published frame is always delivered */
+  check(last == TEST_FRAMES);
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  printf("TRIBUF_USE_LOCKFREE %s\n",
+         TRIBUF_USE_LOCKFREE == TRUE ? "TRUE" : "FALSE");
+  test_sequence();
+  test_stress();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
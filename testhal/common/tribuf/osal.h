@@ -0,0 +1,48 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of osal.h, the system lock is a pthread mutex
+ * standing for the interrupt mask. TRIBUF_USE_LOCKFREE comes from the
+ * Makefile.
+ */
+
+#ifndef OSAL_H
+#define OSAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#endif
+#ifndef FALSE
+#define FALSE                           0
+#endif
+
+#define TRIBUF_USE_WAIT                 FALSE
+
+extern pthread_mutex_t osal_lock;
+
+#define osalDbgCheck(c)                 assert(c)
+#define osalDbgCheckClassI()
+#define osalSysLock()                   pthread_mutex_lock(&osal_lock)
+#define osalSysUnlock()                 pthread_mutex_unlock(&osal_lock)
+
+#endif /* OSAL_H */
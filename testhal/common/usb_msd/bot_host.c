@@ -0,0 +1,278 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Bulk-Only Transport host model and emulated device controller.
+ */
+
+#include "hal.h"
+#include "bot_host.h"
+
+#define PACKET_SIZE                     64U
+
+typedef enum {
+  PHASE_CBW,
+  PHASE_DATA,
+  PHASE_CSW
+} bot_phase_t;
+
+USBDriver USBD1;
+
+static USBInEndpointState in_state;
+static USBOutEndpointState out_state;
+static const USBEndpointConfig ep1config = {&in_state, &out_state};
+
+static bot_command_t *script;
+static size_t script_len;
+static size_t current;
+static bot_phase_t phase;
+
+/* asynchronous transfer armed and not yet waited for */
+static struct {
+  bool          in;
+  uint8_t       *buf;
+  size_t        n;
+} pending;
+bool bot_transfer_pending;
+
+/*
+ * Moves up to n bytes of the data phase, returns the bytes moved.
+ */
+static size_t data_move(bot_command_t *bcp, uint8_t *buf, size_t n,
+                        bool in) {
+  size_t left = bcp->data_len - bcp->moved;
+
+  if (bcp->in != in) {
+    /* the host is not moving data in this direction */
+    bcp->errors++;
+    return 0;
+  }
+  if (n > left) {
+    /* device sending more than announced, a phase error for the host */
+    if (in)
+      bcp->errors++;
+    n = left;
+  }
+  if (in)
+    memcpy(bcp->data + bcp->moved, buf, n);
+  else
+    memcpy(buf, bcp->data + bcp->moved, n);
+  bcp->moved += n;
+  if ((bcp->reset_at != 0) && (bcp->moved >= bcp->reset_at)) {
+    USBD1.state = USB_READY;
+    bcp->reset = true;
+  }
+  return n;
+}
+
+/*
+ * The device wrote to the IN pipe.
+ */
+static void device_transmit(const uint8_t *buf, size_t n) {
+  bot_command_t *bcp = &script[current];
+
+  if (phase == PHASE_DATA) {
+    if (!bcp->in) {
+      /* the host would still be sending data, take it as a CSW anyway
+         so that the script goes on */
+      bcp->errors++;
+      phase = PHASE_CSW;
+    }
+    else {
+      data_move(bcp, (uint8_t *)buf, n, true);
+      /* a short packet or the announced length ends the data phase */
+      if ((bcp->moved == bcp->data_len) || ((n % PACKET_SIZE) != 0))
+        phase = PHASE_CSW;
+      return;
+    }
+  }
+  if (phase == PHASE_CSW) {
+    const msd_csw_t *csw = (const msd_csw_t *)buf;
+
+    if ((n != sizeof(msd_csw_t)) || (csw->signature != 0x53425355U) ||
+        (csw->tag != (uint32_t)current + 1U)) {
+      bcp->errors++;
+    }
+    else {
+      bcp->csw_received = true;
+      bcp->csw_status = csw->status;
+      bcp->csw_residue = csw->data_residue;
+    }
+    current++;
+    phase = PHASE_CBW;
+    return;
+  }
+  bcp->errors++;
+}
+
+/*
+ * The device read from the OUT pipe, returns the bytes received.
+ */
+static size_t device_receive(uint8_t *buf, size_t n) {
+  bot_command_t *bcp;
+  msd_cbw_t cbw;
+
+  if (current >= script_len)
+    return 0;
+  bcp = &script[current];
+
+  if (phase == PHASE_CBW) {
+    memset(&cbw, 0, sizeof(cbw));
+    cbw.signature = 0x43425355U;
+    cbw.tag = (uint32_t)current + 1U;
+    cbw.data_len = bcp->data_len;
+    cbw.flags = bcp->in ? 0x80U : 0x00U;
+    cbw.cmd_len = bcp->cmd_len;
+    memcpy(cbw.cmd_data, bcp->cmd, sizeof(cbw.cmd_data));
+    bcp->moved = 0;
+    bcp->stalls = 0;
+    bcp->errors = 0;
+    bcp->reset = false;
+    bcp->csw_received = false;
+    phase = bcp->data_len != 0 ? PHASE_DATA : PHASE_CSW;
+    if (n < sizeof(cbw))
+      bcp->errors++;
+    n = n < sizeof(cbw) ? n : sizeof(cbw);
+    memcpy(buf, &cbw, n);
+    return n;
+  }
+  if (phase == PHASE_DATA) {
+    n = data_move(bcp, buf, n, false);
+    if (bcp->moved == bcp->data_len)
+      phase = PHASE_CSW;
+    return n;
+  }
+  bcp->errors++;
+  return 0;
+}
+
+/*
+ * A stall ends the data phase of its direction, the host clears it and
+ * fetches the CSW.
+ */
+static void device_stall(bool in) {
+  bot_command_t *bcp = &script[current];
+
+  if (bcp->reset)
+    return;
+  if ((phase != PHASE_DATA) || (bcp->in != in)) {
+    bcp->errors++;
+    return;
+  }
+  bcp->stalls++;
+  phase = PHASE_CSW;
+}
+
+bool botHostDone(void) {
+
+  return current >= script_len;
+}
+
+/*
+ * Completes the pending asynchronous transfer.
+ */
+msg_t osalThreadSuspendS(thread_reference_t *trp) {
+  msg_t msg;
+
+  (void)trp;
+  assert(bot_transfer_pending);
+  bot_transfer_pending = false;
+  if (USBD1.state != USB_ACTIVE)
+    msg = MSG_RESET;
+  else if (pending.in) {
+    device_transmit(pending.buf, pending.n);
+    msg = MSG_OK;
+  }
+  else {
+    msg = (msg_t)device_receive(pending.buf, pending.n);
+    USBD1.epc[USB_MSD_DATA_EP]->out_state->rxcnt = (size_t)msg;
+  }
+  USBD1.transmitting = 0;
+  USBD1.receiving = 0;
+  return msg;
+}
+
+msg_t usbTransmit(USBDriver *usbp, usbep_t ep,
+                  const uint8_t *buf, size_t n) {
+
+  assert((usbp == &USBD1) && (ep == USB_MSD_DATA_EP));
+  if (usbp->state != USB_ACTIVE)
+    return MSG_RESET;
+  device_transmit(buf, n);
+  return MSG_OK;
+}
+
+msg_t usbReceive(USBDriver *usbp, usbep_t ep, uint8_t *buf, size_t n) {
+
+  assert((usbp == &USBD1) && (ep == USB_MSD_DATA_EP));
+  if (usbp->state != USB_ACTIVE) {
+    /* the host recovers and goes on with the next command */
+    if ((current < script_len) && script[current].reset) {
+      usbp->state = USB_ACTIVE;
+      current++;
+      phase = PHASE_CBW;
+    }
+    return MSG_RESET;
+  }
+  return (msg_t)device_receive(buf, n);
+}
+
+void usbStartTransmitI(USBDriver *usbp, usbep_t ep,
+                       const uint8_t *buf, size_t n) {
+
+  assert((usbp == &USBD1) && (ep == USB_MSD_DATA_EP));
+  assert(!bot_transfer_pending);
+  usbp->transmitting |= 1U << ep;
+  pending.in = true;
+  pending.buf = (uint8_t *)buf;
+  pending.n = n;
+  bot_transfer_pending = true;
+}
+
+void usbStartReceiveI(USBDriver *usbp, usbep_t ep, uint8_t *buf, size_t n) {
+
+  assert((usbp == &USBD1) && (ep == USB_MSD_DATA_EP));
+  assert(!bot_transfer_pending);
+  usbp->receiving |= 1U << ep;
+  pending.in = false;
+  pending.buf = buf;
+  pending.n = n;
+  bot_transfer_pending = true;
+}
+
+void usbStallTransmitI(USBDriver *usbp, usbep_t ep) {
+
+  assert((usbp == &USBD1) && (ep == USB_MSD_DATA_EP));
+  device_stall(true);
+}
+
+void usbStallReceiveI(USBDriver *usbp, usbep_t ep) {
+
+  assert((usbp == &USBD1) && (ep == USB_MSD_DATA_EP));
+  device_stall(false);
+}
+
+void botHostStart(bot_command_t *cmds, size_t n) {
+
+  memset(&USBD1, 0, sizeof(USBD1));
+  USBD1.state = USB_ACTIVE;
+  USBD1.epc[USB_MSD_DATA_EP] = &ep1config;
+  script = cmds;
+  script_len = n;
+  current = 0;
+  phase = PHASE_CBW;
+  bot_transfer_pending = false;
+}
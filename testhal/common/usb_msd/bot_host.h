@@ -0,0 +1,61 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Bulk-Only Transport host model, it plays a script of commands to the
+ * emulated device controller and checks the phases the device goes
+ * through.
+ */
+
+#ifndef BOT_HOST_H
+#define BOT_HOST_H
+
+/*
+ * A scripted command, the fields after data are filled by the host.
+ */
+typedef struct {
+  uint8_t       cmd[16];
+  uint8_t       cmd_len;
+  bool          in;
+  uint32_t      data_len;
+  uint8_t       *data;
+  /* when not zero, the bus is reset once this many bytes are moved */
+  uint32_t      reset_at;
+  /* bytes of the data phase actually moved */
+  uint32_t      moved;
+  /* stalls of the data pipe of the command direction */
+  unsigned      stalls;
+  /* protocol violations: data moved outside of the data phase, more data
+     than announced, stall of the wrong pipe or without data phase */
+  unsigned      errors;
+  bool          reset;
+  bool          csw_received;
+  uint8_t       csw_status;
+  uint32_t      csw_residue;
+} bot_command_t;
+
+extern USBDriver USBD1;
+extern bool bot_transfer_pending;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void botHostStart(bot_command_t *cmds, size_t n);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOT_HOST_H */
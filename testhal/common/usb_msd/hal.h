@@ -0,0 +1,224 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of hal.h, only what lib_scsi, the RAM disk and
+ * the USB mass storage driver need. The USB driver is the emulated
+ * device controller of bot_host.c.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#endif
+#ifndef FALSE
+#define FALSE                           0
+#endif
+
+#define HAL_SUCCESS                     false
+#define HAL_FAILED                      true
+
+#define HAL_USE_USB                     TRUE
+#define HAL_USE_USB_MSD                 TRUE
+#define USB_USE_WAIT                    TRUE
+
+#define PACKED_VAR                      __attribute__((packed))
+
+#define osalDbgCheck(c)                 assert(c)
+#define osalDbgAssert(c, remark)        assert(c)
+#define osalSysLock()
+#define osalSysUnlock()
+#define osalSysLockFromISR()
+#define osalSysUnlockFromISR()
+#define osalThreadSleepMilliseconds(ms)
+
+/*
+ * Kernel, the worker thread runs on the caller of msdStart() until the
+ * host has no more commands.
+ */
+typedef int32_t msg_t;
+typedef struct thread *thread_reference_t;
+
+#define MSG_OK                          (msg_t)0
+#define MSG_RESET                       (msg_t)-2
+
+#define CH_KERNEL_MAJOR                 7
+#define CH_KERNEL_MINOR                 0
+#define NORMALPRIO                      128
+
+#define THD_WORKING_AREA(s, n)          uint8_t s[n]
+#define THD_FUNCTION(tname, arg)        void tname(void *arg)
+#define chRegSetThreadName(name)
+#define chThdCreateStatic(wa, size, prio, func, arg)                        \
+  ((func)(arg), (thread_reference_t)NULL)
+#define chThdShouldTerminateX()         botHostDone()
+#define chThdExit(msg)
+#define chThdTerminate(tp)
+#define chThdWait(tp)
+#define chSysLockFromISR()
+#define chSysUnlockFromISR()
+
+/*
+ * BaseBlockDevice, as in the ChibiOS hal_ioblock.h.
+ */
+typedef enum {
+  BLK_UNINIT = 0,
+  BLK_STOP = 1,
+  BLK_ACTIVE = 2,
+  BLK_CONNECTING = 3,
+  BLK_DISCONNECTING = 4,
+  BLK_READY = 5,
+  BLK_READING = 6,
+  BLK_WRITING = 7,
+  BLK_SYNCING = 8
+} blkstate_t;
+
+typedef struct {
+  uint32_t      blk_size;
+  uint32_t      blk_num;
+} BlockDeviceInfo;
+
+#define _base_block_device_methods                                          \
+  bool (*is_inserted)(void *instance);                                      \
+  bool (*is_protected)(void *instance);                                     \
+  bool (*connect)(void *instance);                                          \
+  bool (*disconnect)(void *instance);                                       \
+  bool (*read)(void *instance, uint32_t startblk,                           \
+               uint8_t *buffer, uint32_t n);                                \
+  bool (*write)(void *instance, uint32_t startblk,                          \
+                const uint8_t *buffer, uint32_t n);                         \
+  bool (*sync)(void *instance);                                             \
+  bool (*get_info)(void *instance, BlockDeviceInfo *bdip);
+
+#define _base_block_device_data                                             \
+  blkstate_t    state;
+
+struct BaseBlockDeviceVMT {
+  _base_block_device_methods
+};
+
+typedef struct {
+  const struct BaseBlockDeviceVMT *vmt;
+  _base_block_device_data
+} BaseBlockDevice;
+
+#define blkGetDriverState(ip)           ((ip)->state)
+#define blkIsTransferring(ip)           false
+#define blkIsInserted(ip)               ((ip)->vmt->is_inserted(ip))
+#define blkIsWriteProtected(ip)         ((ip)->vmt->is_protected(ip))
+#define blkConnect(ip)                  ((ip)->vmt->connect(ip))
+#define blkDisconnect(ip)               ((ip)->vmt->disconnect(ip))
+#define blkRead(ip, startblk, buf, n)                                       \
+  ((ip)->vmt->read(ip, startblk, buf, n))
+#define blkWrite(ip, startblk, buf, n)                                      \
+  ((ip)->vmt->write(ip, startblk, buf, n))
+#define blkSync(ip)                     ((ip)->vmt->sync(ip))
+#define blkGetInfo(ip, bdip)            ((ip)->vmt->get_info(ip, bdip))
+
+#include "hal_ioblockv.h"
+
+/*
+ * USB device driver, only the endpoint 1 pair used by the mass storage
+ * driver. Synchronous transfers complete at once, asynchronous ones when
+ * waited for.
+ */
+typedef uint8_t usbep_t;
+
+typedef enum {
+  USB_UNINIT = 0,
+  USB_STOP = 1,
+  USB_READY = 2,
+  USB_SELECTED = 3,
+  USB_ACTIVE = 4
+} usbstate_t;
+
+typedef struct {
+  thread_reference_t    thread;
+} USBInEndpointState;
+
+typedef struct {
+  size_t                rxcnt;
+  thread_reference_t    thread;
+} USBOutEndpointState;
+
+typedef struct {
+  USBInEndpointState    *in_state;
+  USBOutEndpointState   *out_state;
+} USBEndpointConfig;
+
+typedef struct {
+  uint32_t              DIEPCTL;
+  uint32_t              DOEPCTL;
+} stm32_otg_ep_t;
+
+typedef struct {
+  stm32_otg_ep_t        ie[2];
+  stm32_otg_ep_t        oe[2];
+} stm32_otg_t;
+
+typedef struct USBDriver {
+  usbstate_t            state;
+  const USBEndpointConfig *epc[2];
+  uint16_t              transmitting;
+  uint16_t              receiving;
+  uint8_t               setup[8];
+  stm32_otg_t           *otg;
+} USBDriver;
+
+#define DIEPCTL_SNAK                    (1U << 27)
+#define DOEPCTL_SNAK                    (1U << 27)
+
+#define USB_RTYPE_DIR_MASK              0x80U
+#define USB_RTYPE_DIR_HOST2DEV          0x00U
+#define USB_RTYPE_DIR_DEV2HOST          0x80U
+#define USB_RTYPE_TYPE_MASK             0x60U
+#define USB_RTYPE_TYPE_CLASS            0x20U
+#define USB_RTYPE_RECIPIENT_MASK        0x1FU
+#define USB_RTYPE_RECIPIENT_INTERFACE   0x01U
+
+#define usbGetDriverStateI(usbp)        ((usbp)->state)
+#define usbGetTransmitStatusI(usbp, ep) (((usbp)->transmitting >> (ep)) & 1U)
+#define usbGetReceiveStatusI(usbp, ep)  (((usbp)->receiving >> (ep)) & 1U)
+#define usbSetupTransfer(usbp, buf, n, endcb)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  bool botHostDone(void);
+  msg_t osalThreadSuspendS(thread_reference_t *trp);
+  msg_t usbTransmit(USBDriver *usbp, usbep_t ep,
+                    const uint8_t *buf, size_t n);
+  msg_t usbReceive(USBDriver *usbp, usbep_t ep, uint8_t *buf, size_t n);
+  void usbStartTransmitI(USBDriver *usbp, usbep_t ep,
+                         const uint8_t *buf, size_t n);
+  void usbStartReceiveI(USBDriver *usbp, usbep_t ep, uint8_t *buf, size_t n);
+  void usbStallTransmitI(USBDriver *usbp, usbep_t ep);
+  void usbStallReceiveI(USBDriver *usbp, usbep_t ep);
+#ifdef __cplusplus
+}
+#endif
+
+#include "hal_usb_msd.h"
+
+#endif /* HAL_H */
@@ -0,0 +1,490 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the USB mass storage driver worker, lib_scsi runs on a
+ * RAM disk failing the accesses to a given block and talks to a
+ * Bulk-Only Transport host model. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "ramdisk.h"
+#include "testdisk.h"
+#include "bot_host.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_BLOCK_SIZE       512U
+#define TEST_BLOCKS           256U
+#define TEST_BAD_LBA          40U
+
+#define CSW_PASSED            0x00U
+#define CSW_FAILED            0x01U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static uint8_t disk[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t host[TEST_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t blkbuf[USB_MSD_BLKBUF_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t sense[2][18];
+static RamDisk ramdisk;
+static TestDisk testdisk;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void randomize(uint8_t *p, size_t n) {
+
+  while (n-- > 0)
+    *p++ = (uint8_t)rand();
+}
+
+static void cmd6(bot_command_t *bcp, uint8_t op, uint8_t len,
+                 uint8_t *data) {
+
+  memset(bcp, 0, sizeof(*bcp));
+  bcp->cmd[0] = op;
+  bcp->cmd[4] = len;
+  bcp->cmd_len = 6;
+  bcp->in = true;
+  bcp->data_len = data != NULL ? len : 0;
+  bcp->data = data;
+}
+
+static void cmd10(bot_command_t *bcp, uint8_t op, uint32_t lba, uint16_t n,
+                  uint8_t *data) {
+
+  memset(bcp, 0, sizeof(*bcp));
+  bcp->cmd[0] = op;
+  bcp->cmd[2] = (uint8_t)(lba >> 24);
+  bcp->cmd[3] = (uint8_t)(lba >> 16);
+  bcp->cmd[4] = (uint8_t)(lba >> 8);
+  bcp->cmd[5] = (uint8_t)lba;
+  bcp->cmd[7] = (uint8_t)(n >> 8);
+  bcp->cmd[8] = (uint8_t)n;
+  bcp->cmd_len = 10;
+  bcp->in = op != SCSI_CMD_WRITE_10;
+  bcp->data_len = n * TEST_BLOCK_SIZE;
+  bcp->data = data;
+}
+
+static void cmd16(bot_command_t *bcp, uint8_t op, uint64_t lba, uint32_t n,
+                  uint8_t *data) {
+  unsigned i;
+
+  memset(bcp, 0, sizeof(*bcp));
+  bcp->cmd[0] = op;
+  for (i = 0; i < 8; i++)
+    bcp->cmd[2 + i] = (uint8_t)(lba >> (56 - 8 * i));
+  for (i = 0; i < 4; i++)
+    bcp->cmd[10 + i] = (uint8_t)(n >> (24 - 8 * i));
+  bcp->cmd_len = 16;
+  bcp->in = op == SCSI_CMD_READ_16;
+  bcp->data_len = data != NULL ? n * TEST_BLOCK_SIZE : 0;
+  bcp->data = data;
+}
+
+static void run(bot_command_t *cmds, size_t n) {
+
+  botHostStart(cmds, n);
+  msdStart(&USBMSD1, &USBD1, (BaseBlockDevice *)&testdisk, blkbuf,
+           NULL, NULL);
+  msdStop(&USBMSD1);
+}
+
+/*
+ * Checks the status and the residue of a CSW, the residue must account
+ * for the bytes not moved and the pipe must be stalled only when a
+ * failed command leaves its data phase short.
+ */
+static void check_csw(const bot_command_t *bcp, uint8_t status,
+                      uint32_t residue) {
+
+  check(bcp->errors == 0);
+  check(bcp->csw_received);
+  check(bcp->csw_status == status);
+  check(bcp->csw_residue == residue);
+  check(bcp->csw_residue == bcp->data_len - bcp->moved);
+  check(bcp->stalls == ((status == CSW_FAILED) && (residue != 0) ? 1 : 0));
+}
+
+static void check_sense(const uint8_t *sp, uint8_t key, uint8_t asc,
+                        bool valid, uint32_t info) {
+
+  check((sp[2] & 0x0FU) == key);
+  check(sp[12] == asc);
+  check(((sp[0] & 0x80U) != 0) == valid);
+  if (valid) {
+    check((((uint32_t)sp[3] << 24) | ((uint32_t)sp[4] << 16) |
+           ((uint32_t)sp[5] << 8) | sp[6]) == info);
+  }
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Medium error on READ, the blocks before the bad one are delivered. The
+ * commands after it must not inherit its residue nor its stall.
+ */
+static void test_read_error(void) {
+  bot_command_t cmds[7];
+
+  printf("read error\n");
+  randomize(disk, sizeof(disk));
+  memset(host, 0, sizeof(host));
+  testdisk.fail_reads = true;
+  testdisk.bad_lba = TEST_BAD_LBA;
+
+  cmd10(&cmds[0], SCSI_CMD_READ_10, 32, 16, host);
+  cmd6(&cmds[1], SCSI_CMD_REQUEST_SENSE, sizeof(sense[0]), sense[0]);
+  cmd6(&cmds[2], SCSI_CMD_TEST_UNIT_READY, 0, NULL);
+  cmd10(&cmds[3], SCSI_CMD_READ_10, 32, 16, host);
+  /* FORMAT UNIT is not supported */
+  cmd6(&cmds[4], 0x04, 0, NULL);
+  cmd6(&cmds[5], SCSI_CMD_REQUEST_SENSE, sizeof(sense[1]), sense[1]);
+  cmd10(&cmds[6], SCSI_CMD_READ_10, 0, 32, host + 64 * TEST_BLOCK_SIZE);
+  run(cmds, 7);
+
+  check_csw(&cmds[0], CSW_FAILED, 8 * TEST_BLOCK_SIZE);
+  check(memcmp(host, disk + 32 * TEST_BLOCK_SIZE, 8 * TEST_BLOCK_SIZE) == 0);
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check_sense(sense[0], SCSI_SENSE_KEY_MEDIUM_ERROR,
+              SCSI_ASENSE_UNRECOVERED_READ_ERROR, true, TEST_BAD_LBA);
+  check_csw(&cmds[2], CSW_PASSED, 0);
+  check_csw(&cmds[3], CSW_FAILED, 8 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[4], CSW_FAILED, 0);
+  check_csw(&cmds[5], CSW_PASSED, 0);
+  check_sense(sense[1], SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+              SCSI_ASENSE_INVALID_COMMAND, false, 0);
+  check_csw(&cmds[6], CSW_PASSED, 0);
+  check(memcmp(host + 64 * TEST_BLOCK_SIZE, disk,
+               32 * TEST_BLOCK_SIZE) == 0);
+
+  testdisk.fail_reads = false;
+}
+
+/*
+ * Medium error on WRITE, the blocks before the bad one are on the medium.
+ */
+static void test_write_error(void) {
+  bot_command_t cmds[3];
+
+  printf("write error\n");
+  memset(disk, 0, sizeof(disk));
+  randomize(host, sizeof(host));
+  testdisk.fail_writes = true;
+  testdisk.bad_lba = TEST_BAD_LBA;
+
+  cmd10(&cmds[0], SCSI_CMD_WRITE_10, 32, 16, host);
+  cmd6(&cmds[1], SCSI_CMD_REQUEST_SENSE, sizeof(sense[0]), sense[0]);
+  cmd6(&cmds[2], SCSI_CMD_TEST_UNIT_READY, 0, NULL);
+  run(cmds, 3);
+
+  /* the data received past the bad block depends on the pipelining */
+  check(cmds[0].moved > 8 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[0], CSW_FAILED, cmds[0].data_len - cmds[0].moved);
+  check(memcmp(host, disk + 32 * TEST_BLOCK_SIZE, 8 * TEST_BLOCK_SIZE) == 0);
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check_sense(sense[0], SCSI_SENSE_KEY_MEDIUM_ERROR,
+              SCSI_ASENSE_WRITE_ERROR, true, TEST_BAD_LBA);
+  check_csw(&cmds[2], CSW_PASSED, 0);
+
+  testdisk.fail_writes = false;
+}
+
+/*
+ * Commands rejected before their data phase, the whole length is residue
+ * and the pipe of the announced direction is stalled.
+ */
+static void test_rejected(void) {
+  bot_command_t cmds[5];
+
+  printf("rejected commands\n");
+  cmd10(&cmds[0], SCSI_CMD_WRITE_10, TEST_BLOCKS - 8, 16, host);
+  cmd6(&cmds[1], SCSI_CMD_REQUEST_SENSE, sizeof(sense[0]), sense[0]);
+  cmd10(&cmds[2], SCSI_CMD_READ_10, TEST_BLOCKS - 8, 16, host);
+  /* unsupported command announcing an IN data phase */
+  cmd6(&cmds[3], 0x04, 36, host);
+  cmd6(&cmds[4], SCSI_CMD_INQUIRY, 36, host);
+  run(cmds, 5);
+
+  check_csw(&cmds[0], CSW_FAILED, 16 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check_sense(sense[0], SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+              SCSI_ASENSE_LBA_OUT_OF_RANGE, false, 0);
+  check_csw(&cmds[2], CSW_FAILED, 16 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[3], CSW_FAILED, 36);
+  check_csw(&cmds[4], CSW_PASSED, 0);
+}
+
+/*
+ * Multi-block transfers, with two or more blocks of buffer the medium
+ * accesses overlap the bulk transfers.
+ */
+static void test_pipeline(void) {
+  const unsigned chunk = USB_MSD_BLKBUF_BLOCKS >= 2 ?
+                         USB_MSD_BLKBUF_BLOCKS / 2 : 1;
+  const unsigned per_cmd = (128 + chunk - 1) / chunk;
+  bot_command_t cmds[TEST_BLOCKS / 128];
+  unsigned i;
+
+  printf("pipeline\n");
+  randomize(disk, sizeof(disk));
+  memset(host, 0, sizeof(host));
+  testdiskClearStats(&testdisk);
+  for (i = 0; i < TEST_BLOCKS / 128; i++)
+    cmd10(&cmds[i], SCSI_CMD_READ_10, i * 128, 128,
+          host + i * 128 * TEST_BLOCK_SIZE);
+  run(cmds, TEST_BLOCKS / 128);
+  for (i = 0; i < TEST_BLOCKS / 128; i++)
+    check_csw(&cmds[i], CSW_PASSED, 0);
+  check(memcmp(host, disk, sizeof(disk)) == 0);
+  check(testdisk.reads == i * per_cmd);
+  /* every medium read but the first of a command overlaps a transfer */
+  check(testdisk.overlapped ==
+        (USB_MSD_BLKBUF_BLOCKS >= 2 ? i * (per_cmd - 1) : 0));
+
+  randomize(host, sizeof(host));
+  testdiskClearStats(&testdisk);
+  for (i = 0; i < TEST_BLOCKS / 128; i++)
+    cmd10(&cmds[i], SCSI_CMD_WRITE_10, i * 128, 128,
+          host + i * 128 * TEST_BLOCK_SIZE);
+  run(cmds, TEST_BLOCKS / 128);
+  for (i = 0; i < TEST_BLOCKS / 128; i++)
+    check_csw(&cmds[i], CSW_PASSED, 0);
+  check(memcmp(host, disk, sizeof(disk)) == 0);
+  check(testdisk.writes == i * per_cmd);
+  /* every medium write but the last of a command overlaps a transfer */
+  check(testdisk.overlapped ==
+        (USB_MSD_BLKBUF_BLOCKS >= 2 ? i * (per_cmd - 1) : 0));
+}
+
+/*
+ * Bus reset in the middle of the data phase, the command is abandoned
+ * without CSW and the next one is served.
+ */
+static void test_bus_reset(void) {
+  bot_command_t cmds[4];
+
+  printf("bus reset\n");
+  randomize(disk, sizeof(disk));
+  memset(host, 0, sizeof(host));
+  cmd10(&cmds[0], SCSI_CMD_READ_10, 0, 64, host);
+  cmds[0].reset_at = 10 * TEST_BLOCK_SIZE;
+  cmd10(&cmds[1], SCSI_CMD_READ_10, 64, 16, host + 64 * TEST_BLOCK_SIZE);
+  cmd10(&cmds[2], SCSI_CMD_WRITE_10, 128, 64, host);
+  cmds[2].reset_at = 10 * TEST_BLOCK_SIZE;
+  cmd6(&cmds[3], SCSI_CMD_TEST_UNIT_READY, 0, NULL);
+  run(cmds, 4);
+
+  check(cmds[0].reset && !cmds[0].csw_received && (cmds[0].errors == 0));
+  check(cmds[0].moved < cmds[0].data_len);
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check(memcmp(host + 64 * TEST_BLOCK_SIZE, disk + 64 * TEST_BLOCK_SIZE,
+               16 * TEST_BLOCK_SIZE) == 0);
+  check(cmds[2].reset && !cmds[2].csw_received && (cmds[2].errors == 0));
+  check_csw(&cmds[3], CSW_PASSED, 0);
+}
+
+/*
+ * READ(16)/WRITE(16), LBAs past the medium and past 32 bits are rejected
+ * and never wrap around.
+ */
+static void test_rw16(void) {
+  bot_command_t cmds[8];
+
+  printf("READ(16)/WRITE(16)\n");
+  randomize(disk, sizeof(disk));
+  randomize(host, sizeof(host));
+  cmd16(&cmds[0], SCSI_CMD_READ_16, 5, 100, host);
+  cmd16(&cmds[1], SCSI_CMD_WRITE_16, 150, 99, host + 100 * TEST_BLOCK_SIZE);
+  cmd16(&cmds[2], SCSI_CMD_READ_16, 0x100000000ULL, 1, host);
+  cmd6(&cmds[3], SCSI_CMD_REQUEST_SENSE, sizeof(sense[0]), sense[0]);
+  cmd16(&cmds[4], SCSI_CMD_READ_16, 0xFFFFFFFFFFFFFFFFULL, 2, host);
+  cmd16(&cmds[5], SCSI_CMD_READ_16, TEST_BLOCKS - 1, 2, host);
+  cmd10(&cmds[6], SCSI_CMD_READ_10, 0xFFFFFFFFU, 2, host);
+  cmd16(&cmds[7], SCSI_CMD_WRITE_16, 0x100000000ULL + 10, 1, host);
+  run(cmds, 8);
+
+  check_csw(&cmds[0], CSW_PASSED, 0);
+  check(memcmp(host, disk + 5 * TEST_BLOCK_SIZE, 100 * TEST_BLOCK_SIZE) == 0);
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check(memcmp(host + 100 * TEST_BLOCK_SIZE, disk + 150 * TEST_BLOCK_SIZE,
+               99 * TEST_BLOCK_SIZE) == 0);
+  check_csw(&cmds[2], CSW_FAILED, TEST_BLOCK_SIZE);
+  check_sense(sense[0], SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+              SCSI_ASENSE_LBA_OUT_OF_RANGE, false, 0);
+  check_csw(&cmds[4], CSW_FAILED, 2 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[5], CSW_FAILED, 2 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[6], CSW_FAILED, 2 * TEST_BLOCK_SIZE);
+  check_csw(&cmds[7], CSW_FAILED, TEST_BLOCK_SIZE);
+  check(memcmp(host, disk + 10 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE) != 0);
+}
+
+/*
+ * READ CAPACITY(16), the response is cut to the allocation length.
+ */
+static void test_read_capacity16(void) {
+  bot_command_t cmds[3];
+  uint8_t resp[32];
+
+  printf("READ CAPACITY(16)\n");
+  memset(resp, 0, sizeof(resp));
+  cmd16(&cmds[0], SCSI_CMD_SERVICE_ACTION_IN_16, 0, 0, NULL);
+  cmds[0].cmd[1] = 0x10;
+  cmds[0].cmd[13] = 32;
+  cmds[0].data_len = 32;
+  cmds[0].data = resp;
+  cmds[0].in = true;
+  cmds[1] = cmds[0];
+  cmds[1].cmd[13] = 12;
+  cmds[1].data_len = 12;
+  cmds[1].data = host;
+  /* unsupported service action */
+  cmd16(&cmds[2], SCSI_CMD_SERVICE_ACTION_IN_16, 0, 0, NULL);
+  cmds[2].cmd[1] = 0x11;
+  run(cmds, 3);
+
+  check_csw(&cmds[0], CSW_PASSED, 0);
+  check(cmds[0].moved == 32);
+  check((resp[6] == ((TEST_BLOCKS - 1) >> 8)) &&
+        (resp[7] == ((TEST_BLOCKS - 1) & 0xFF)));
+  check((resp[10] == (TEST_BLOCK_SIZE >> 8)) && (resp[11] == 0));
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check(memcmp(host, resp, 12) == 0);
+  check_csw(&cmds[2], CSW_FAILED, 0);
+}
+
+/*
+ * SYNCHRONIZE CACHE and WRITE SAME, PBDATA and LBDATA are rejected, a
+ * zero count extends to the end of the medium.
+ */
+static void test_sync_write_same(void) {
+  const unsigned fill = USB_MSD_BLKBUF_BLOCKS < 17 ? USB_MSD_BLKBUF_BLOCKS
+                                                   : 17;
+  bot_command_t cmds[9];
+  unsigned i;
+
+  printf("SYNCHRONIZE CACHE/WRITE SAME\n");
+  randomize(disk, sizeof(disk));
+  memset(host, 0, TEST_BLOCK_SIZE);
+  memset(host + TEST_BLOCK_SIZE, 0xA5, TEST_BLOCK_SIZE);
+  testdiskClearStats(&testdisk);
+
+  cmd10(&cmds[0], SCSI_CMD_SYNCHRONIZE_CACHE_10, 0, 0, NULL);
+  cmds[0].data_len = 0;
+  cmd16(&cmds[1], SCSI_CMD_SYNCHRONIZE_CACHE_16, 0, 0, NULL);
+  cmd10(&cmds[2], SCSI_CMD_WRITE_SAME_10, 10, 17, host);
+  cmds[2].data_len = TEST_BLOCK_SIZE;
+  cmds[2].in = false;
+  cmd16(&cmds[3], SCSI_CMD_WRITE_SAME_16, TEST_BLOCKS - 6, 0,
+        host + TEST_BLOCK_SIZE);
+  cmds[3].data_len = TEST_BLOCK_SIZE;
+  /* LBDATA, PBDATA */
+  cmds[4] = cmds[3];
+  cmds[4].cmd[1] = 0x02;
+  cmds[5] = cmds[3];
+  cmds[5].cmd[1] = 0x04;
+  cmd6(&cmds[6], SCSI_CMD_REQUEST_SENSE, sizeof(sense[0]), sense[0]);
+  cmds[7] = cmds[3];
+  cmds[7].cmd[9] = TEST_BLOCKS - 2;
+  cmds[7].cmd[13] = 5;
+  /* zero count starting past the medium */
+  cmds[8] = cmds[3];
+  cmds[8].cmd[8] = TEST_BLOCKS >> 8;
+  cmds[8].cmd[9] = TEST_BLOCKS & 0xFF;
+  run(cmds, 9);
+
+  check_csw(&cmds[0], CSW_PASSED, 0);
+  check_csw(&cmds[1], CSW_PASSED, 0);
+  check(testdisk.syncs == 2);
+  check_csw(&cmds[2], CSW_PASSED, 0);
+  for (i = 10 * TEST_BLOCK_SIZE; i < 27 * TEST_BLOCK_SIZE; i++)
+    check(disk[i] == 0);
+  check(memcmp(disk + 27 * TEST_BLOCK_SIZE, host, TEST_BLOCK_SIZE) != 0);
+  check_csw(&cmds[3], CSW_PASSED, 0);
+  for (i = (TEST_BLOCKS - 6) * TEST_BLOCK_SIZE; i < sizeof(disk); i++)
+    check(disk[i] == 0xA5);
+  /* the medium is written with multi-block writes */
+  check(testdisk.writes == (17 + fill - 1) / fill + (6 + fill - 1) / fill);
+  check_csw(&cmds[4], CSW_FAILED, TEST_BLOCK_SIZE);
+  check_csw(&cmds[5], CSW_FAILED, TEST_BLOCK_SIZE);
+  check_sense(sense[0], SCSI_SENSE_KEY_ILLEGAL_REQUEST,
+              SCSI_ASENSE_INVALID_FIELD_IN_CDB, false, 0);
+  check_csw(&cmds[7], CSW_FAILED, TEST_BLOCK_SIZE);
+  check_csw(&cmds[8], CSW_FAILED, TEST_BLOCK_SIZE);
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+  ramdiskObjectInit(&ramdisk);
+  ramdiskStart(&ramdisk, disk, TEST_BLOCK_SIZE, TEST_BLOCKS, false);
+  testdiskObjectInit(&testdisk, (BaseBlockDevice *)&ramdisk);
+  testdisk.link_busy = &bot_transfer_pending;
+  msdObjectInit(&USBMSD1);
+
+  printf("%u blocks buffer\n", (unsigned)USB_MSD_BLKBUF_BLOCKS);
+  test_read_error();
+  test_write_error();
+  test_rejected();
+  test_pipeline();
+  test_bus_reset();
+  test_rw16();
+  test_read_capacity16();
+  test_sync_write_same();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,364 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host emulation of the STM32 OTG root port and of a device answering the
+ * enumeration control requests. The port "interrupts" run in the caller
+ * thread with the system lock held and signal the root hub event as the
+ * LLD interrupt handler does. Also implements the OSAL of osal.h on
+ * pthreads.
+ */
+
+#include <time.h>
+#include <unistd.h>
+
+#include "hal.h"
+#include "usbh/internal.h"
+#include "dev_emulator.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define PORT_RESET_TIME       10U
+
+struct osal_waiter {
+  pthread_cond_t  cond;
+  bool            done;
+  msg_t           msg;
+};
+
+struct osal_thread {
+  pthread_t       thread;
+};
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+pthread_mutex_t osal_lock = PTHREAD_MUTEX_INITIALIZER;
+dev_emulator_t emu;
+
+/*
+ * Vendor specific device with a single interface and no endpoints.
+ */
+static const uint8_t default_device[18] = {
+  18, USBH_DT_DEVICE, 0x00, 0x02, 0xFF, 0x00, 0x00, 64,
+  0x83, 0x04, 0x40, 0x57, 0x00, 0x01, 0, 0, 0, 1
+};
+static const uint8_t default_config[18] = {
+  9, USBH_DT_CONFIG, 18, 0, 1, 1, 0, 0x80, 50,
+  9, USBH_DT_INTERFACE, 0, 0, 0, 0xFF, 0x00, 0x00, 0
+};
+static const uint8_t languages[4] = {4, USBH_DT_STRING, 0x09, 0x04};
+
+static struct osal_thread threads[1];
+static unsigned thread_count;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void timespec_add(struct timespec *ts, uint32_t msec) {
+
+  ts->tv_sec += msec / 1000U;
+  ts->tv_nsec += (long)(msec % 1000U) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L) {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+
+static void *thread_entry(void *arg) {
+  void **wsp = arg;
+
+  ((void (*)(void *))wsp[0])(wsp[1]);
+  return NULL;
+}
+
+/*
+ * Root port interrupt, signals the root hub event on new change bits.
+ */
+static void port_isr(uint16_t set, uint16_t clear, uint16_t change) {
+  usbh_port_t *port = &USBHD1.rootport;
+  uint16_t c_status;
+
+  osalSysLock();
+  c_status = port->lld_c_status;
+  port->lld_status = (port->lld_status | set) & ~clear;
+  port->lld_c_status |= change;
+  if (port->lld_c_status & ~c_status)
+    _usbh_signal_eventI(&USBHD1, USBH_EVENT_ROOTHUB);
+  osalSysUnlock();
+}
+
+/*
+ ******************************************************************************
+ * OSAL
+ ******************************************************************************
+ */
+
+systime_t osalOsGetSystemTimeX(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (systime_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+void osalThreadSleepMilliseconds(uint32_t msec) {
+
+  usleep(msec * 1000U);
+}
+
+void osalThreadResumeI(thread_reference_t *trp, msg_t msg) {
+
+  if (*trp != NULL) {
+    (*trp)->msg = msg;
+    (*trp)->done = true;
+    pthread_cond_signal(&(*trp)->cond);
+    *trp = NULL;
+  }
+}
+
+msg_t osalThreadSuspendTimeoutS(thread_reference_t *trp,
+                                sysinterval_t timeout) {
+  struct osal_waiter w = {PTHREAD_COND_INITIALIZER, false, MSG_OK};
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  timespec_add(&ts, timeout);
+  *trp = &w;
+  while (!w.done) {
+    if (timeout == TIME_INFINITE) {
+      pthread_cond_wait(&w.cond, &osal_lock);
+    }
+    else if ((pthread_cond_timedwait(&w.cond, &osal_lock, &ts) != 0) &&
+             !w.done) {
+      *trp = NULL;
+      return MSG_TIMEOUT;
+    }
+  }
+  return w.msg;
+}
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio,
+                            void (*pf)(void *), void *arg) {
+  void **p = wsp;
+  thread_t *tp = &threads[thread_count++];
+
+  (void)size;
+  (void)prio;
+  p[0] = (void *)pf;
+  p[1] = arg;
+  pthread_create(&tp->thread, NULL, thread_entry, wsp);
+  pthread_detach(tp->thread);
+  return tp;
+}
+
+/*
+ ******************************************************************************
+ * LOW LEVEL DRIVER
+ ******************************************************************************
+ */
+
+void usbh_lld_init(void) {
+}
+
+void usbh_lld_start(USBHDriver *usbh) {
+
+  usbh->rootport.lld_status = USBH_PORTSTATUS_POWER;
+  usbh->rootport.lld_c_status = 0;
+}
+
+void usbh_lld_ep_object_init(usbh_ep_t *ep) {
+
+  (void)ep;
+}
+
+void usbh_lld_ep_open(usbh_ep_t *ep) {
+
+  ep->status = USBH_EPSTATUS_OPEN;
+}
+
+void usbh_lld_ep_close(usbh_ep_t *ep) {
+
+  ep->status = USBH_EPSTATUS_CLOSED;
+}
+
+bool usbh_lld_ep_reset(usbh_ep_t *ep) {
+
+  (void)ep;
+  return true;
+}
+
+/*
+ * Control transfers are served at once by the emulated device.
+ */
+void usbh_lld_urb_submit(usbh_urb_t *urb) {
+  const usbh_control_request_t *req = urb->setup_buff;
+  usbh_urbstatus_t status = USBH_URBSTATUS_OK;
+  const uint8_t *data = NULL;
+  uint32_t n = 0;
+
+  osalDbgAssert(urb->ep->type == USBH_EPTYPE_CTRL, "control only");
+  switch (req->bRequest) {
+  case USBH_REQ_GET_DESCRIPTOR:
+    switch (req->wValue >> 8) {
+    case USBH_DT_DEVICE:
+      data = emu.device;
+      n = data[0];
+      break;
+    case USBH_DT_CONFIG:
+      data = emu.config;
+      n = data[2] | (data[3] << 8);
+      break;
+    case USBH_DT_STRING:
+      if ((req->wValue & 0xFF) == 0) {
+        data = languages;
+        n = sizeof(languages);
+        break;
+      }
+      /* falls through */
+    default:
+      status = USBH_URBSTATUS_STALL;
+    }
+    break;
+  case USBH_REQ_SET_ADDRESS:
+    emu.set_address++;
+    break;
+  case USBH_REQ_SET_CONFIGURATION:
+    emu.set_configuration++;
+    break;
+  default:
+    status = USBH_URBSTATUS_STALL;
+  }
+
+  if (n > urb->requestedLength)
+    n = urb->requestedLength;
+  if (data != NULL)
+    memcpy(urb->buff, data, n);
+  urb->actualLength = n;
+  _usbh_urb_completeI(urb, status);
+}
+
+bool usbh_lld_urb_abort(usbh_urb_t *urb, usbh_urbstatus_t status) {
+
+  _usbh_urb_completeI(urb, status);
+  return true;
+}
+
+usbh_urbstatus_t usbh_lld_root_hub_request(USBHDriver *usbh,
+                                           uint8_t bmRequestType,
+                                           uint8_t bRequest,
+                                           uint16_t wvalue,
+                                           uint16_t windex,
+                                           uint16_t wlength,
+                                           uint8_t *buf) {
+  usbh_port_t *port = &usbh->rootport;
+  uint32_t status;
+
+  (void)windex;
+  (void)wlength;
+  switch ((bmRequestType << 8) | bRequest) {
+  case GetPortStatus:
+    osalSysLock();
+    status = port->lld_status | ((uint32_t)port->lld_c_status << 16);
+    osalSysUnlock();
+    memcpy(buf, &status, 4);
+    break;
+  case ClearPortFeature:
+    osalSysLock();
+    port->lld_c_status &= ~(1U << (wvalue - 16U));
+    osalSysUnlock();
+    break;
+  case SetPortFeature:
+    if (wvalue == USBH_PORT_FEAT_RESET) {
+      usleep(PORT_RESET_TIME * 1000U);
+      port_isr(USBH_PORTSTATUS_ENABLE, 0,
+               USBH_PORTSTATUS_C_ENABLE | USBH_PORTSTATUS_C_RESET);
+    }
+    break;
+  case GetHubStatus:
+    memset(buf, 0, 4);
+    break;
+  default:
+    break;
+  }
+  return USBH_URBSTATUS_OK;
+}
+
+uint8_t usbh_lld_roothub_get_statuschange_bitmap(USBHDriver *usbh) {
+  uint8_t bitmap;
+
+  osalSysLock();
+  emu.passes++;
+  bitmap = (usbh->rootport.lld_c_status != 0) ? (1U << 1) : 0U;
+  osalSysUnlock();
+  return bitmap;
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+/*
+ * Emulator reset, the default device has one vendor specific interface.
+ */
+void emuInit(void) {
+
+  memset(&emu, 0, sizeof(emu));
+  emu.device = default_device;
+  emu.config = default_config;
+}
+
+void emuAttach(void) {
+
+  port_isr(USBH_PORTSTATUS_CONNECTION, 0, USBH_PORTSTATUS_C_CONNECTION);
+}
+
+void emuDetach(void) {
+
+  port_isr(0, USBH_PORTSTATUS_CONNECTION | USBH_PORTSTATUS_ENABLE,
+           USBH_PORTSTATUS_C_CONNECTION | USBH_PORTSTATUS_C_ENABLE);
+}
+
+usbh_devstatus_t emuGetDeviceStatus(void) {
+  usbh_devstatus_t status;
+
+  osalSysLock();
+  status = USBHD1.rootport.device.status;
+  osalSysUnlock();
+  return status;
+}
+
+unsigned emuGetPasses(void) {
+  unsigned passes;
+
+  osalSysLock();
+  passes = emu.passes;
+  osalSysUnlock();
+  return passes;
+}
@@ -0,0 +1,65 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef DEV_EMULATOR_H
+#define DEV_EMULATOR_H
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+/*
+ * Root port, device and host controller emulator.
+ */
+typedef struct {
+  /* configuration */
+  const uint8_t *device;        /* device descriptor */
+  const uint8_t *config;        /* configuration descriptor and its tail */
+  /* statistics */
+  unsigned      passes;         /* root hub status change checks */
+  unsigned      set_address;
+  unsigned      set_configuration;
+} dev_emulator_t;
+
+/*
+ ******************************************************************************
+ * EXTERNS
+ ******************************************************************************
+ */
+
+extern dev_emulator_t emu;
+
+/*
+ ******************************************************************************
+ * PROTOTYPES
+ ******************************************************************************
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void emuInit(void);
+  void emuAttach(void);
+  void emuDetach(void);
+  usbh_devstatus_t emuGetDeviceStatus(void);
+  unsigned emuGetPasses(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEV_EMULATOR_H */
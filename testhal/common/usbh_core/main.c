@@ -0,0 +1,176 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the USB host core enumeration, polled by the application
+ * or run by the internal host thread woken by the root port events. The
+ * device and root port are emulated by dev_emulator.c. Run with
+ * "make check".
+ */
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "dev_emulator.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_CYCLES           5U
+
+/*
+ * Without the application loop the enumeration must not wait for the
+ * thread poll interval.
+ */
+#define TEST_EVENT_DEADLINE   500U
+#define TEST_POLL_DEADLINE    3000U
+#define TEST_APP_PERIOD       10U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+USBHDriver USBHD1;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+/*
+ * Waits for a device status and returns the time taken, in polling mode
+ * the application loop calls usbhMainLoop() meanwhile. Returns
+ * TIME_INFINITE on timeout.
+ */
+static sysinterval_t wait_status(usbh_devstatus_t status,
+                                 sysinterval_t deadline) {
+  systime_t start = osalOsGetSystemTimeX();
+  sysinterval_t elapsed;
+
+  while (emuGetDeviceStatus() != status) {
+    elapsed = osalOsGetSystemTimeX() - start;
+    if (elapsed > deadline)
+      return TIME_INFINITE;
+#if HAL_USBH_USE_THREAD == FALSE
+    usbhMainLoop(&USBHD1);
+#endif
+    osalThreadSleepMilliseconds(TEST_APP_PERIOD);
+  }
+  return osalOsGetSystemTimeX() - start;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Attach and detach cycles, each one enumerates and configures the device.
+ */
+static void test_enumeration(void) {
+#if HAL_USBH_USE_THREAD == TRUE
+  const sysinterval_t deadline = TEST_EVENT_DEADLINE;
+#else
+  const sysinterval_t deadline = TEST_POLL_DEADLINE;
+#endif
+  sysinterval_t t, total = 0, max = 0;
+  unsigned i;
+
+  printf("enumeration\n");
+  for (i = 0; i < TEST_CYCLES; i++) {
+    emuAttach();
+    t = wait_status(USBH_DEVSTATUS_CONFIGURED, deadline);
+    check(t != TIME_INFINITE);
+    if (t == TIME_INFINITE)
+      return;
+    total += t;
+    max = (t > max) ? t : max;
+
+    emuDetach();
+    check(wait_status(USBH_DEVSTATUS_DISCONNECTED, deadline) != TIME_INFINITE);
+  }
+  check(emu.set_address == TEST_CYCLES);
+  check(emu.set_configuration == TEST_CYCLES);
+  printf("  average %u ms, max %u ms\n",
+         (unsigned)(total / TEST_CYCLES), (unsigned)max);
+}
+
+/*
+ * Without events the host is only run by usbhMainLoop() and, in thread
+ * mode, by the poll interval safety net.
+ */
+static void test_idle(void) {
+  unsigned passes;
+
+  printf("idle host\n");
+  osalThreadSleepMilliseconds(50);
+  passes = emuGetPasses();
+  osalThreadSleepMilliseconds(200);
+  check(emuGetPasses() == passes);
+
+  /* each call is one pass, done by the caller or by the woken thread */
+  usbhMainLoop(&USBHD1);
+  osalThreadSleepMilliseconds(50);
+  check(emuGetPasses() == passes + 1);
+
+#if HAL_USBH_USE_THREAD == TRUE
+  passes = emuGetPasses();
+  osalThreadSleepMilliseconds(HAL_USBH_THREAD_POLL_INTERVAL + 100);
+  check(emuGetPasses() == passes + 1);
+#endif
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  printf("HAL_USBH_USE_THREAD %s\n", HAL_USBH_USE_THREAD ? "TRUE" : "FALSE");
+  emuInit();
+  usbhInit();
+  usbhObjectInit(&USBHD1);
+  usbhStart(&USBHD1);
+
+  test_enumeration();
+  test_idle();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,79 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of osal.h. Threads are pthreads and the system
+ * lock is a mutex standing for the interrupt mask, systime_t counts
+ * milliseconds.
+ */
+
+#ifndef OSAL_H
+#define OSAL_H
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+typedef int32_t                 msg_t;
+typedef uint32_t                systime_t;
+typedef uint32_t                sysinterval_t;
+typedef int                     tprio_t;
+typedef struct osal_waiter      *thread_reference_t;
+typedef struct osal_thread      thread_t;
+
+#define MSG_OK                  ((msg_t)0)
+#define MSG_TIMEOUT             ((msg_t)-1)
+#define MSG_RESET               ((msg_t)-2)
+
+#define TIME_INFINITE           ((sysinterval_t)-1)
+#define NORMALPRIO              128
+
+#define OSAL_MS2I(msec)         ((sysinterval_t)(msec))
+
+/*
+ * The working area only holds the pthread trampoline arguments.
+ */
+#define THD_WORKING_AREA(s, n)  void *s[2]
+
+extern pthread_mutex_t osal_lock;
+
+#define osalDbgCheck(c)         assert(c)
+#define osalDbgAssert(c, r)     assert(c)
+#define osalDbgCheckClassI()    (void)0
+#define osalDbgCheckClassS()    (void)0
+#define osalSysLock()           pthread_mutex_lock(&osal_lock)
+#define osalSysUnlock()         pthread_mutex_unlock(&osal_lock)
+#define osalOsRescheduleS()     (void)0
+#define osalThreadSuspendS(trp) osalThreadSuspendTimeoutS(trp, TIME_INFINITE)
+#define chRegSetThreadName(p)   (void)0
+#define chHeapAlloc(h, size)    calloc(1, size)
+#define chHeapFree(p)           free(p)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  systime_t osalOsGetSystemTimeX(void);
+  void osalThreadSleepMilliseconds(uint32_t msec);
+  void osalThreadResumeI(thread_reference_t *trp, msg_t msg);
+  msg_t osalThreadSuspendTimeoutS(thread_reference_t *trp,
+                                  sysinterval_t timeout);
+  thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio,
+                              void (*pf)(void *), void *arg);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_H */
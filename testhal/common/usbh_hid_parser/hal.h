@@ -0,0 +1,66 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of hal.h, only what the USB host HID driver
+ * needs. HAL_USBHHID_USE_REPORT_QUEUE comes from the Makefile.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#endif
+#ifndef FALSE
+#define FALSE                           0
+#endif
+
+#define HAL_SUCCESS                     false
+#define HAL_FAILED                      true
+
+#define PACKED_VAR                      __attribute__((packed))
+
+/*
+ * Input queue return codes, as in hal_queues.h.
+ */
+#define Q_OK                            MSG_OK
+#define Q_TIMEOUT                       MSG_TIMEOUT
+#define Q_RESET                         MSG_RESET
+
+/*
+ * Driver configuration.
+ */
+#define HAL_USE_USBH                    TRUE
+#define HAL_USBH_USE_HID                TRUE
+#define HAL_USBHHID_MAX_INSTANCES       1
+#define HAL_USBHHID_USE_REPORT_PARSER   TRUE
+#define HAL_USBH_CONTROL_REQUEST_DEFAULT_TIMEOUT OSAL_MS2I(1000)
+#define USBH_DEBUG_ENABLE               FALSE
+#define USBHHID_DEBUG_ENABLE_TRACE      FALSE
+#define USBHHID_DEBUG_ENABLE_INFO       FALSE
+#define USBHHID_DEBUG_ENABLE_WARNINGS   FALSE
+#define USBHHID_DEBUG_ENABLE_ERRORS     FALSE
+
+#include "osal.h"
+#include "hal_usbh.h"
+
+#endif /* HAL_H */
@@ -0,0 +1,227 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host emulation of the USB host core calls made by the HID driver and of
+ * the device. The report descriptor is served on GET_DESCRIPTOR, the
+ * interrupt IN URB waits on its endpoint until the test completes it with
+ * emuComplete(), as the LLD interrupt handler does.
+ */
+
+#include "hal.h"
+#include "usbh/internal.h"
+#include "hid_emulator.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define HID_REQ_SET_PROTOCOL    0x0B
+#define HID_DT_REPORT           0x22
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+hid_emulator_t emu;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void complete(usbh_urb_t *urb, usbh_urbstatus_t status) {
+
+  urb->status = status;
+  if (urb->callback != NULL)
+    urb->callback(urb);
+}
+
+/*
+ ******************************************************************************
+ * OSAL
+ ******************************************************************************
+ */
+
+systime_t osalOsGetSystemTimeX(void) {
+
+  return emu.now;
+}
+
+/*
+ ******************************************************************************
+ * USB HOST CORE
+ ******************************************************************************
+ */
+
+bool _usbh_match_descriptor(const uint8_t *descriptor, uint16_t rem,
+                            int16_t type, int16_t _class, int16_t subclass,
+                            int16_t protocol) {
+  const usbh_interface_descriptor_t *const desc =
+      (const usbh_interface_descriptor_t *)descriptor;
+
+  /* the HID driver only matches interfaces */
+  if ((rem < USBH_DT_INTERFACE_SIZE) ||
+      (descriptor[1] != USBH_DT_INTERFACE) ||
+      (type != USBH_DT_INTERFACE))
+    return HAL_FAILED;
+  if (((_class >= 0) && (desc->bInterfaceClass != _class)) ||
+      ((subclass >= 0) && (desc->bInterfaceSubClass != subclass)) ||
+      ((protocol >= 0) && (desc->bInterfaceProtocol != protocol)))
+    return HAL_FAILED;
+  return HAL_SUCCESS;
+}
+
+usbh_urbstatus_t usbhControlRequest(usbh_device_t *dev, uint8_t bmRequestType,
+                                    uint8_t bRequest, uint16_t wValue,
+                                    uint16_t wIndex, uint16_t wLength,
+                                    uint8_t *buff) {
+
+  (void)dev;
+  (void)wIndex;
+  if (bRequest == HID_REQ_SET_PROTOCOL)
+    emu.protocol = (uint8_t)wValue;
+  if ((bmRequestType & 0x80) != 0)
+    memset(buff, 0, wLength);
+  return USBH_URBSTATUS_OK;
+}
+
+usbh_urbstatus_t usbhControlRequestExtended(usbh_device_t *dev,
+                                            const usbh_control_request_t *req,
+                                            uint8_t *buff,
+                                            uint32_t *actual_len,
+                                            systime_t timeout) {
+  uint16_t len = req->wLength;
+
+  (void)dev;
+  (void)timeout;
+  if ((req->bRequest != USBH_REQ_GET_DESCRIPTOR) ||
+      (req->wValue != (HID_DT_REPORT << 8)))
+    return USBH_URBSTATUS_STALL;
+  if (len > emu.report_desc_len)
+    len = emu.report_desc_len;
+  memcpy(buff, emu.report_desc, len);
+  *actual_len = len;
+  return USBH_URBSTATUS_OK;
+}
+
+void usbhEPObjectInit(usbh_ep_t *ep, usbh_device_t *dev,
+                      const usbh_endpoint_descriptor_t *desc) {
+
+  memset(ep, 0, sizeof(*ep));
+  ep->device = dev;
+  ep->wMaxPacketSize = desc->wMaxPacketSize;
+  ep->address = desc->bEndpointAddress & 0x0F;
+  ep->type = (usbh_eptype_t)(desc->bmAttributes & 0x03);
+  ep->in = (desc->bEndpointAddress & 0x80) ? TRUE : FALSE;
+  ep->bInterval = desc->bInterval;
+  ep->status = USBH_EPSTATUS_CLOSED;
+}
+
+void usbhURBObjectInit(usbh_urb_t *urb, usbh_ep_t *ep,
+                       usbh_completion_cb callback, void *user, void *buff,
+                       uint32_t len) {
+
+  memset(urb, 0, sizeof(*urb));
+  urb->ep = ep;
+  urb->callback = callback;
+  urb->userData = user;
+  urb->buff = buff;
+  urb->requestedLength = len;
+  urb->status = USBH_URBSTATUS_INITIALIZED;
+}
+
+void usbhURBObjectResetI(usbh_urb_t *urb) {
+
+  assert(urb->status != USBH_URBSTATUS_PENDING);
+  urb->actualLength = 0;
+  urb->status = USBH_URBSTATUS_INITIALIZED;
+}
+
+void usbhURBSubmitI(usbh_urb_t *urb) {
+
+  assert(urb->status == USBH_URBSTATUS_INITIALIZED);
+  if (urb->ep->status != USBH_EPSTATUS_OPEN) {
+    complete(urb, USBH_URBSTATUS_DISCONNECTED);
+    return;
+  }
+  assert(emu.pending == NULL);
+  urb->status = USBH_URBSTATUS_PENDING;
+  emu.pending = urb;
+  emu.submits++;
+}
+
+/*
+ ******************************************************************************
+ * LOW LEVEL DRIVER
+ ******************************************************************************
+ */
+
+void usbh_lld_ep_open(usbh_ep_t *ep) {
+
+  ep->status = USBH_EPSTATUS_OPEN;
+}
+
+/*
+ * Closing an endpoint aborts its pending URB, as the STM32 LLD does.
+ */
+void usbh_lld_ep_close(usbh_ep_t *ep) {
+  usbh_urb_t *const urb = emu.pending;
+
+  ep->status = USBH_EPSTATUS_CLOSED;
+  if ((urb != NULL) && (urb->ep == ep)) {
+    emu.pending = NULL;
+    complete(urb, USBH_URBSTATUS_DISCONNECTED);
+  }
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+void emuInit(const uint8_t *report_desc, uint16_t len) {
+
+  memset(&emu, 0, sizeof(emu));
+  emu.report_desc = report_desc;
+  emu.report_desc_len = len;
+}
+
+/*
+ * Completes the pending interrupt IN URB with a report of len bytes
+ * written where the URB points. Returns false if no URB is pending, the
+ * device NAKs.
+ */
+bool emuComplete(const uint8_t *data, uint32_t len, usbh_urbstatus_t status) {
+  usbh_urb_t *const urb = emu.pending;
+
+  if (urb == NULL)
+    return false;
+  assert(len <= urb->requestedLength);
+  emu.pending = NULL;
+  memcpy(urb->buff, data, len);
+  urb->actualLength = len;
+  complete(urb, status);
+  return true;
+}
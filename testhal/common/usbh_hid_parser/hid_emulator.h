@@ -0,0 +1,65 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef HID_EMULATOR_H
+#define HID_EMULATOR_H
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+/*
+ * USB host core and HID device emulator.
+ */
+typedef struct {
+  /* configuration */
+  const uint8_t *report_desc;   /* report descriptor */
+  uint16_t      report_desc_len;
+  /* state */
+  systime_t     now;            /* system time */
+  uint8_t       protocol;       /* last SET_PROTOCOL */
+  usbh_urb_t    *pending;       /* URB waiting on the interrupt IN endpoint */
+  /* statistics */
+  unsigned      submits;
+} hid_emulator_t;
+
+/*
+ ******************************************************************************
+ * EXTERNS
+ ******************************************************************************
+ */
+
+extern hid_emulator_t emu;
+
+/*
+ ******************************************************************************
+ * PROTOTYPES
+ ******************************************************************************
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void emuInit(const uint8_t *report_desc, uint16_t len);
+  bool emuComplete(const uint8_t *data, uint32_t len,
+                   usbh_urbstatus_t status);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HID_EMULATOR_H */
@@ -0,0 +1,540 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the USB host HID report descriptor parser and field
+ * extractors: boot keyboard and mouse, a gaming mouse with report IDs and
+ * signed 12-bit axes, a gamepad and a device whose last field ends at the
+ * last report byte. Reports and descriptors are placed right before an
+ * inaccessible page, so that reading past them faults. The device is
+ * emulated by hid_emulator.c. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "hal.h"
+#include "hid_emulator.h"
+
+/* The driver is built here to reach its load and init functions.*/
+#include "hal_usbh_hid.c"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_MAX_FIELDS       64U
+#define TEST_CROSS_REPORTS    2000U
+#define TEST_FUZZ_RUNS        100000U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+/*
+ * HID 1.11 Appendix B.1, boot keyboard.
+ */
+static const uint8_t keyboard[] = {
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+  0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01,
+  0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01, 0x05, 0x08, 0x19, 0x01,
+  0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+  0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65,
+  0x81, 0x00, 0xC0
+};
+
+/*
+ * HID 1.11 Appendix B.2, boot mouse with a wheel.
+ */
+static const uint8_t mouse[] = {
+  0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x05, 0x09,
+  0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01, 0x95, 0x03, 0x75, 0x01,
+  0x81, 0x02, 0x95, 0x01, 0x75, 0x05, 0x81, 0x01, 0x05, 0x01, 0x09, 0x30,
+  0x09, 0x31, 0x09, 0x38, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x03,
+  0x81, 0x06, 0xC0, 0xC0
+};
+
+/*
+ * Gaming mouse: report 2 with 16 buttons, 12-bit X/Y in -2047..2047, wheel
+ * and AC pan; report 3 with two consumer control usages.
+ */
+static const uint8_t gaming_mouse[] = {
+  0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x02, 0x09, 0x01, 0xA1, 0x00,
+  0x05, 0x09, 0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25, 0x01, 0x95, 0x10,
+  0x75, 0x01, 0x81, 0x02, 0x05, 0x01, 0x16, 0x01, 0xF8, 0x26, 0xFF, 0x07,
+  0x75, 0x0C, 0x95, 0x02, 0x09, 0x30, 0x09, 0x31, 0x81, 0x06, 0x15, 0x81,
+  0x25, 0x7F, 0x75, 0x08, 0x95, 0x01, 0x09, 0x38, 0x81, 0x06, 0x05, 0x0C,
+  0x0A, 0x38, 0x02, 0x95, 0x01, 0x81, 0x06, 0xC0, 0xC0,
+  0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x03, 0x75, 0x10, 0x95, 0x02,
+  0x15, 0x01, 0x26, 0xFF, 0x02, 0x19, 0x01, 0x2A, 0xFF, 0x02, 0x81, 0x00,
+  0xC0
+};
+
+/*
+ * Gamepad: report 1 with four 16-bit axes (Logical Maximum 0xFFFF in four
+ * bytes), a hat switch with null state inside Push/Pop, 12 buttons, an
+ * empty padding item, two vendor bytes and a padding byte; an output
+ * report, with the same ID since Report ID is a global item.
+ */
+static const uint8_t gamepad[] = {
+  0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x01, 0xA1, 0x00,
+  0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x15, 0x00, 0x27, 0xFF,
+  0xFF, 0x00, 0x00, 0x75, 0x10, 0x95, 0x04, 0x81, 0x02, 0xC0,
+  0xA4, 0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46, 0x3B, 0x01,
+  0x65, 0x14, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42, 0xB4,
+  0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01,
+  0x95, 0x0C, 0x81, 0x02, 0x75, 0x08, 0x95, 0x00, 0x81, 0x03,
+  0x06, 0x00, 0xFF, 0x09, 0x20, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08,
+  0x95, 0x02, 0x81, 0x02, 0x75, 0x08, 0x95, 0x01, 0x81, 0x03,
+  0x05, 0x01, 0x09, 0x05, 0x75, 0x08, 0x95, 0x04, 0x91, 0x02, 0xC0
+};
+
+/*
+ * Vendor device: report 5 with ten bytes, a 4-bit padding and a signed
+ * 4-bit field in the high nibble of the last byte of the 12 bytes report.
+ */
+static const uint8_t last_byte[] = {
+  0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x05, 0x19, 0x01, 0x29,
+  0x0A, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x0A, 0x81, 0x02,
+  0x75, 0x04, 0x95, 0x01, 0x81, 0x03, 0x09, 0x10, 0x15, 0xF8, 0x25, 0x07,
+  0x81, 0x02, 0xC0
+};
+
+/*
+ * Gaming mouse interface: interface, HID and interrupt IN endpoint
+ * descriptors.
+ */
+static const uint8_t interface[] = {
+  9, USBH_DT_INTERFACE, 0, 0, 1, 0x03, 0x01, 0x02, 0,
+  9, 0x21, 0x11, 0x01, 0, 1, 0x22, sizeof(gaming_mouse), 0,
+  7, USBH_DT_ENDPOINT, 0x81, 0x03, 8, 0, 1,
+  /* the descriptor iterators read the length byte past the last one */
+  0
+};
+
+static usbh_device_t device;
+static usbhhid_field_t fields[TEST_MAX_FIELDS];
+static uint8_t *guard;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+/*
+ * Maps two pages, the second inaccessible.
+ */
+static void guard_init(void) {
+  const long page = sysconf(_SC_PAGESIZE);
+  uint8_t *const p = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  assert((p != MAP_FAILED) && (mprotect(p + page, page, PROT_NONE) == 0));
+  guard = p + page;
+}
+
+/*
+ * Copy of len bytes ending at the inaccessible page.
+ */
+static uint8_t *at_guard(const void *src, size_t len) {
+  uint8_t *const p = guard - len;
+
+  memcpy(p, src, len);
+  return p;
+}
+
+static uint16_t parse(const uint8_t *desc, uint16_t len) {
+  uint16_t n = TEST_MAX_FIELDS;
+
+  check(usbhhidParseReportDescriptor(at_guard(desc, len), len,
+                                     fields, &n) == HAL_SUCCESS);
+  return n;
+}
+
+static const usbhhid_field_t *find(uint16_t n, usbhhid_reporttype_t type,
+                                   uint16_t page, uint16_t usage,
+                                   uint16_t *index) {
+  static USBHHIDDriver hid;
+
+  memcpy(hid.fields, fields, n * sizeof(fields[0]));
+  hid.nfields = (uint8_t)n;
+  const usbhhid_field_t *const f = usbhhidFindField(&hid, type, page, usage,
+                                                    index);
+  return (f != NULL) ? &fields[f - hid.fields] : NULL;
+}
+
+/*
+ * Bit by bit reference of the extractors.
+ */
+static uint32_t ref_raw(const uint8_t *report, uint32_t bit, uint32_t size) {
+  uint32_t v = 0;
+  uint32_t i;
+
+  for (i = 0; i < size; i++)
+    v |= (uint32_t)((report[(bit + i) >> 3] >> ((bit + i) & 7)) & 1) << i;
+  return v;
+}
+
+static int32_t ref_value(const usbhhid_field_t *f, uint32_t raw) {
+
+  if ((f->logical_min < 0) && (f->bit_size < 32) &&
+      ((raw >> (f->bit_size - 1)) & 1))
+    raw |= ~0U << f->bit_size;
+  return (int32_t)raw;
+}
+
+/*
+ * Random reports of exactly report_len bytes decoded by the extractors
+ * and by the reference.
+ */
+static void crosscheck(uint16_t n) {
+  uint8_t buf[300];
+  unsigned r, i;
+  uint16_t k, e;
+
+  for (r = 0; r < TEST_CROSS_REPORTS; r++) {
+    for (i = 0; i < sizeof(buf); i++)
+      buf[i] = (uint8_t)rand();
+    for (k = 0; k < n; k++) {
+      const usbhhid_field_t *const f = &fields[k];
+      const uint8_t *const report = at_guard(buf, f->report_len);
+
+      for (e = 0; e < f->count; e++) {
+        const uint32_t raw = ref_raw(report, f->bit_offset + e * f->bit_size,
+                                     f->bit_size);
+        if ((usbhhidFieldGetRaw(f, report, e) != raw) ||
+            (usbhhidFieldGetValue(f, report, e) != ref_value(f, raw))) {
+          printf("  field %u element %u mismatch\n", k, e);
+          failures++;
+          return;
+        }
+      }
+    }
+  }
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+static void test_keyboard(void) {
+  const uint8_t rep[8] = {0x02, 0, 0x04, 0x05, 0, 0, 0, 0};
+  const usbhhid_field_t *f;
+  uint16_t n, idx;
+
+  printf("boot keyboard\n");
+  n = parse(keyboard, sizeof(keyboard));
+  check(n == 3);
+
+  /* left shift, the second modifier bit */
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x07, 0xE1, &idx);
+  check((f != NULL) && (f->bit_offset == 0) && (f->count == 8) &&
+        (idx == 1));
+  check((f != NULL) && (usbhhidFieldGetRaw(f, rep, idx) == 1));
+
+  /* key array, the reserved byte is skipped */
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x07, 0x04, &idx);
+  check((f != NULL) && (f->bit_offset == 16) && (f->count == 6) &&
+        !(f->flags & USBHHID_FIELD_FLAG_VARIABLE) && (idx == 0));
+  check((f != NULL) && (usbhhidFieldGetRaw(f, rep, 0) == 0x04) &&
+        (usbhhidFieldGetRaw(f, rep, 1) == 0x05));
+
+  /* caps lock LED */
+  f = find(n, USBHHID_REPORTTYPE_OUTPUT, 0x08, 0x02, &idx);
+  check((f != NULL) && (f->bit_offset == 0) && (idx == 1));
+  crosscheck(n);
+}
+
+static void test_mouse(void) {
+  const uint8_t rep[8] = {0x05, 0xFE, 0x03, 0x81};
+  const usbhhid_field_t *f;
+  uint16_t n, idx;
+
+  printf("boot mouse\n");
+  n = parse(mouse, sizeof(mouse));
+  check(n == 3);
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x09, 0x03, &idx);
+  check((f != NULL) && (usbhhidFieldGetRaw(f, rep, idx) == 1));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x30, &idx);
+  check((f != NULL) && (usbhhidFieldGetValue(f, rep, idx) == -2));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x31, &idx);
+  check((f != NULL) && (usbhhidFieldGetValue(f, rep, idx) == 3));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x38, &idx);
+  check((f != NULL) && (usbhhidFieldGetValue(f, rep, idx) == -127));
+  crosscheck(n);
+}
+
+/*
+ * Report IDs and signed 12-bit fields straddling bytes.
+ */
+static void test_gaming_mouse(void) {
+  /* buttons 1 and 16, X -5, Y 1000, wheel -1, pan 2 */
+  const uint8_t rep[8] = {0x02, 0x01, 0x80, 0xFB, 0x8F, 0x3E, 0xFF, 0x02};
+  /* X -2047, Y 2047 */
+  const uint8_t ext[8] = {0x02, 0x00, 0x00, 0x01, 0xF8, 0x7F, 0x00, 0x00};
+  /* X -2048, out of the logical range, still sign extended */
+  const uint8_t neg[8] = {0x02, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00};
+  const usbhhid_field_t *f;
+  uint16_t n, idx;
+
+  printf("gaming mouse\n");
+  n = parse(gaming_mouse, sizeof(gaming_mouse));
+  check(n == 5);
+
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x30, &idx);
+  check((f != NULL) && (f->report_id == 2) && (f->bit_offset == 24) &&
+        (f->bit_size == 12) && (f->logical_min == -2047) &&
+        (f->logical_max == 2047));
+  check((f != NULL) && (usbhhidFieldGetValue(f, rep, idx) == -5));
+  check((f != NULL) && (usbhhidFieldGetValue(f, ext, idx) == -2047));
+  check((f != NULL) && (usbhhidFieldGetValue(f, neg, idx) == -2048));
+  check((f != NULL) && (usbhhidFieldGetRaw(f, neg, idx) == 0x800));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x31, &idx);
+  /* same field as X, the second element */
+  check((f != NULL) && (f->bit_offset == 24) && (idx == 1));
+  check((f != NULL) && (usbhhidFieldGetValue(f, rep, idx) == 1000));
+  check((f != NULL) && (usbhhidFieldGetValue(f, ext, idx) == 2047));
+
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x09, 0x10, &idx);
+  check((f != NULL) && (usbhhidFieldGetRaw(f, rep, idx) == 1));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x38, &idx);
+  check((f != NULL) && (usbhhidFieldGetValue(f, rep, idx) == -1));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x0C, 0x238, &idx);
+  check((f != NULL) && (f->report_len == 8) &&
+        (usbhhidFieldGetValue(f, rep, idx) == 2));
+
+  /* consumer control report */
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x0C, 0xE9, &idx);
+  check((f != NULL) && (f->report_id == 3) && (f->bit_offset == 8) &&
+        (f->count == 2) && (f->bit_size == 16) && (f->logical_max == 0x2FF));
+  crosscheck(n);
+}
+
+static void test_gamepad(void) {
+  const usbhhid_field_t *f;
+  uint16_t n, idx;
+
+  printf("gamepad\n");
+  n = parse(gamepad, sizeof(gamepad));
+
+  /* unsigned 16-bit, not sign extended */
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x35, &idx);
+  check((f != NULL) && (f->bit_offset == 56) && (idx == 0) &&
+        (f->logical_max == 65535) && (f->sign == 0));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x01, 0x39, &idx);
+  check((f != NULL) && (f->bit_offset == 72) && (f->bit_size == 4) &&
+        (f->flags & USBHHID_FIELD_FLAG_NULLSTATE));
+  /* Pop restored the report size and count */
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0x09, 0x0C, &idx);
+  check((f != NULL) && (f->bit_offset == 76) && (idx == 11));
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0xFF00, 0x20, &idx);
+  check((f != NULL) && (f->bit_offset == 88) && (f->count == 2) &&
+        (f->report_len == 14));
+  f = find(n, USBHHID_REPORTTYPE_OUTPUT, 0x01, 0x05, &idx);
+  check((f != NULL) && (f->report_id == 1) && (f->bit_offset == 8) &&
+        (f->count == 4) && (f->report_len == 8));
+  crosscheck(n);
+}
+
+/*
+ * The window of the fields near the end of the report is clamped inside
+ * it: the report ends at the inaccessible page.
+ */
+static void test_last_byte(void) {
+  const uint8_t values[] = {-8, 7, -1, 0, 3};
+  uint8_t rep[12];
+  const usbhhid_field_t *f;
+  uint16_t n, idx;
+  unsigned i;
+
+  printf("field ending at the last report byte\n");
+  n = parse(last_byte, sizeof(last_byte));
+  check(n == 2);
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0xFF00, 0x10, &idx);
+  check((f != NULL) && (f->report_id == 5) && (f->bit_offset == 92) &&
+        (f->bit_size == 4) && (f->report_len == sizeof(rep)));
+  for (i = 0; (f != NULL) && (i < sizeof(values)); i++) {
+    memset(rep, 0x0F, sizeof(rep));
+    rep[0] = 5;
+    rep[11] = (uint8_t)(values[i] << 4) | 0x0F;
+    check(usbhhidFieldGetValue(f, at_guard(rep, sizeof(rep)), idx) ==
+          (int8_t)values[i]);
+  }
+  f = find(n, USBHHID_REPORTTYPE_INPUT, 0xFF00, 0x0A, &idx);
+  check((f != NULL) && (idx == 9));
+  for (i = 0; i < sizeof(rep); i++)
+    rep[i] = (uint8_t)i;
+  check((f != NULL) &&
+        (usbhhidFieldGetRaw(f, at_guard(rep, sizeof(rep)), idx) == 10));
+  crosscheck(n);
+}
+
+/*
+ * Random and truncated descriptors are rejected or give fields inside
+ * their report, and nothing is read past them.
+ */
+static void test_malformed(void) {
+  static const struct {
+    const uint8_t *desc;
+    uint16_t len;
+  } descs[] = {
+    {keyboard, sizeof(keyboard)},
+    {mouse, sizeof(mouse)},
+    {gaming_mouse, sizeof(gaming_mouse)},
+    {gamepad, sizeof(gamepad)},
+    {last_byte, sizeof(last_byte)}
+  };
+  uint8_t desc[128];
+  unsigned r, i, k;
+  uint16_t n, len;
+  bool ok = true;
+
+  printf("malformed descriptors\n");
+  for (r = 0; r < TEST_FUZZ_RUNS; r++) {
+    len = (uint16_t)(rand() % sizeof(desc));
+    for (i = 0; i < len; i++)
+      desc[i] = (uint8_t)rand();
+    n = TEST_MAX_FIELDS;
+    usbhhidParseReportDescriptor(at_guard(desc, len), len, fields, &n);
+    for (k = 0; k < n; k++) {
+      const usbhhid_field_t *const f = &fields[k];
+
+      if ((f->bit_size < 1) || (f->bit_size > 32) ||
+          (f->report_len < USBHHID_FIELD_WINDOW) ||
+          ((uint32_t)f->bit_offset + (uint32_t)f->count * f->bit_size >
+           f->report_len * 8U))
+        ok = false;
+    }
+  }
+  check(ok);
+
+  for (k = 0; k < sizeof(descs) / sizeof(descs[0]); k++) {
+    for (len = 0; len < descs[k].len; len++) {
+      n = TEST_MAX_FIELDS;
+      usbhhidParseReportDescriptor(at_guard(descs[k].desc, len), len,
+                                   fields, &n);
+    }
+  }
+
+  /* the table is too small, the fields returned are valid */
+  n = 4;
+  check((usbhhidParseReportDescriptor(gamepad, sizeof(gamepad), fields,
+                                      &n) == HAL_FAILED) && (n == 4));
+  check((fields[0].usage_min == 0x30) && (fields[0].count == 3) &&
+        (fields[3].usage_max == 0x0C));
+}
+
+static void cb_report(USBHHIDDriver *hidp, uint16_t len) {
+
+  (void)hidp;
+  (void)len;
+}
+
+/*
+ * The driver fetches and compiles the report descriptor of a report ID
+ * device at load, its reports are decoded as received.
+ */
+static void test_driver(void) {
+  static uint8_t report[8];
+  static const USBHHIDConfig config = {
+    cb_report, report, sizeof(report), USBHHID_PROTOCOL_REPORT
+  };
+  const uint8_t rep2[8] = {0x02, 0x01, 0x80, 0xFB, 0x8F, 0x3E, 0xFF, 0x02};
+  const uint8_t rep3[5] = {0x03, 0xE9, 0x00, 0xEA, 0x00};
+  USBHHIDDriver *const hidp = &USBHHIDD[0];
+  const usbhhid_field_t *x, *y, *cc;
+  uint16_t xi, yi;
+
+  printf("driver\n");
+  emuInit(gaming_mouse, sizeof(gaming_mouse));
+  _hid_init();
+  check(_hid_load(&device, interface, sizeof(interface) - 1) ==
+        (usbh_baseclassdriver_t *)hidp);
+  /* the core records the device after load */
+  hidp->dev = &device;
+  check(hidp->nfields == 5);
+  check(usbhhidGetType(hidp) == USBHHID_DEVTYPE_BOOT_MOUSE);
+
+  x = usbhhidFindField(hidp, USBHHID_REPORTTYPE_INPUT, 0x01, 0x30, &xi);
+  y = usbhhidFindField(hidp, USBHHID_REPORTTYPE_INPUT, 0x01, 0x31, &yi);
+  cc = usbhhidFindField(hidp, USBHHID_REPORTTYPE_INPUT, 0x0C, 0xE9, NULL);
+  check((x != NULL) && (y != NULL) && (cc != NULL));
+  if ((x == NULL) || (y == NULL) || (cc == NULL))
+    return;
+
+  usbhhidStart(hidp, &config);
+  check(usbhhidGetState(hidp) == USBHHID_STATE_READY);
+  check(emu.protocol == USBHHID_PROTOCOL_REPORT);
+
+  check(emuComplete(rep2, sizeof(rep2), USBH_URBSTATUS_OK));
+  check((report[0] == x->report_id) &&
+        (usbhhidFieldGetValue(x, report, xi) == -5) &&
+        (usbhhidFieldGetValue(y, report, yi) == 1000));
+  check(emuComplete(rep3, sizeof(rep3), USBH_URBSTATUS_OK));
+  check((report[0] == cc->report_id) &&
+        (usbhhidFieldGetRaw(cc, report, 0) == 0xE9) &&
+        (usbhhidFieldGetRaw(cc, report, 1) == 0xEA));
+
+  usbhhidStop(hidp);
+  check((usbhhidGetState(hidp) == USBHHID_STATE_ACTIVE) &&
+        (emu.pending == NULL));
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  srand(1);
+  guard_init();
+
+  test_keyboard();
+  test_mouse();
+  test_gaming_mouse();
+  test_gamepad();
+  test_last_byte();
+  test_malformed();
+  test_driver();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of osal.h and of the kernel objects used by the
+ * HID driver. There is a single thread, the interrupt IN completions are
+ * run by the test; systime_t is driven by the emulator. A thread queue
+ * only records its wake-ups, a read on an empty report queue times out.
+ */
+
+#ifndef OSAL_H
+#define OSAL_H
+
+#include <stdlib.h>
+#include <assert.h>
+
+typedef int32_t                 msg_t;
+typedef uint32_t                systime_t;
+typedef uint32_t                sysinterval_t;
+typedef struct osal_waiter      *thread_reference_t;
+
+#define MSG_OK                  ((msg_t)0)
+#define MSG_TIMEOUT             ((msg_t)-1)
+#define MSG_RESET               ((msg_t)-2)
+
+#define TIME_IMMEDIATE          ((sysinterval_t)0)
+#define OSAL_MS2I(msec)         ((sysinterval_t)(msec))
+
+#define osalDbgCheck(c)         assert(c)
+#define osalDbgAssert(c, r)     assert(c)
+#define osalDbgCheckClassI()    (void)0
+#define osalDbgCheckClassS()    (void)0
+#define osalSysLock()           (void)0
+#define osalSysUnlock()         (void)0
+#define osalOsRescheduleS()     (void)0
+
+/*
+ * Semaphore, never waiting.
+ */
+typedef struct {
+  int           cnt;
+} semaphore_t;
+
+static inline void chSemObjectInit(semaphore_t *sp, int n) {
+  sp->cnt = n;
+}
+
+static inline void chSemWait(semaphore_t *sp) {
+  assert(sp->cnt > 0);
+  sp->cnt--;
+}
+
+static inline void chSemSignal(semaphore_t *sp) {
+  sp->cnt++;
+}
+
+/*
+ * Threads queue, nobody ever waits.
+ */
+typedef struct {
+  unsigned      wakeups;
+  msg_t         msg;
+} threads_queue_t;
+
+static inline void chThdQueueObjectInit(threads_queue_t *tqp) {
+  tqp->wakeups = 0;
+  tqp->msg = MSG_OK;
+}
+
+static inline msg_t chThdEnqueueTimeoutS(threads_queue_t *tqp,
+                                         sysinterval_t timeout) {
+  (void)tqp;
+  assert(timeout == TIME_IMMEDIATE);
+  return MSG_TIMEOUT;
+}
+
+static inline void chThdDequeueNextI(threads_queue_t *tqp, msg_t msg) {
+  tqp->wakeups++;
+  tqp->msg = msg;
+}
+
+static inline void chThdDequeueAllI(threads_queue_t *tqp, msg_t msg) {
+  tqp->wakeups++;
+  tqp->msg = msg;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  systime_t osalOsGetSystemTimeX(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_H */
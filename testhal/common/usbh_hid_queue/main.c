@@ -0,0 +1,411 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the USB host HID report queue: overwrite and block
+ * policies, polling held while the queue is full, ownership of the slot
+ * the interrupt IN URB writes to and replay of 1 to 8 kHz report streams
+ * read by a consumer that stalls. The device is emulated by
+ * ../usbh_hid_parser/hid_emulator.c, one system tick is one microsecond.
+ * Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "hid_emulator.h"
+
+/* The driver is built here to reach its load and init functions.*/
+#include "hal_usbh_hid.c"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_LEN              HAL_USBHHID_REPORT_QUEUE_LEN
+#define TEST_REPORT_LEN       8U
+#define TEST_REPLAY_TICKS     2000000U
+#define TEST_STALL_PERIOD     20000U
+#define TEST_STALL_MAX        6000U
+#define TEST_READ_TICKS       20U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+/*
+ * Vendor device, one 8 bytes input report without ID.
+ */
+static const uint8_t report_desc[] = {
+  0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x09, 0x02, 0x15, 0x00, 0x26,
+  0xFF, 0x00, 0x75, 0x08, 0x95, 0x08, 0x81, 0x02, 0xC0
+};
+
+static const uint8_t interface[] = {
+  9, USBH_DT_INTERFACE, 0, 0, 1, 0x03, 0x00, 0x00, 0,
+  9, 0x21, 0x11, 0x01, 0, 1, 0x22, sizeof(report_desc), 0,
+  7, USBH_DT_ENDPOINT, 0x81, 0x03, TEST_REPORT_LEN, 0, 1,
+  /* the descriptor iterators read the length byte past the last one */
+  0
+};
+
+static uint8_t ring[TEST_LEN][TEST_REPORT_LEN];
+static USBHHIDConfig config;
+static USBHHIDDriver *const hidp = &USBHHIDD[0];
+static usbh_device_t device;
+static unsigned notifications;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static void cb_report(USBHHIDDriver *hidp, uint16_t len) {
+
+  (void)hidp;
+  (void)len;
+  notifications++;
+}
+
+static void start(usbhhid_queue_policy_t policy) {
+
+  emuInit(report_desc, sizeof(report_desc));
+  _hid_init();
+  assert(_hid_load(&device, interface, sizeof(interface) - 1) ==
+         (usbh_baseclassdriver_t *)hidp);
+  hidp->dev = &device;
+  config.cb_report = cb_report;
+  config.report_buffer = ring;
+  config.report_len = TEST_REPORT_LEN;
+  config.protocol = USBHHID_PROTOCOL_REPORT;
+  config.queue_policy = policy;
+  notifications = 0;
+  usbhhidStart(hidp, &config);
+}
+
+static void fill(uint8_t *report, uint32_t seq) {
+  unsigned i;
+
+  memcpy(report, &seq, sizeof(seq));
+  for (i = sizeof(seq); i < TEST_REPORT_LEN; i++)
+    report[i] = (uint8_t)(seq * 7 + i);
+}
+
+/*
+ * Sequence number of a report, 0 if its payload is corrupted.
+ */
+static uint32_t sequence(const uint8_t *report) {
+  uint32_t seq;
+  unsigned i;
+
+  memcpy(&seq, report, sizeof(seq));
+  for (i = sizeof(seq); i < TEST_REPORT_LEN; i++) {
+    if (report[i] != (uint8_t)(seq * 7 + i))
+      return 0;
+  }
+  return seq;
+}
+
+/*
+ * True if the pending URB writes to a free slot of the ring, never to a
+ * queued report.
+ */
+static bool urb_slot_free(void) {
+  const uint8_t *const buff = (const uint8_t *)hidp->in_urb.buff;
+  unsigned i, k;
+
+  if ((buff < ring[0]) || (buff > ring[TEST_LEN - 1]) ||
+      ((buff - ring[0]) % TEST_REPORT_LEN != 0))
+    return false;
+  for (i = 0, k = hidp->q_rd; i < hidp->q_counter; i++, k = (k + 1) % TEST_LEN) {
+    if (buff == ring[k])
+      return false;
+  }
+  return true;
+}
+
+/*
+ * The device sends report seq. The whole URB buffer is scribbled over
+ * first, as a transfer in progress would.
+ */
+static bool deliver(uint32_t seq) {
+  uint8_t report[TEST_REPORT_LEN];
+
+  if (emu.pending == NULL)
+    return false;
+  memset(emu.pending->buff, 0xEE, emu.pending->requestedLength);
+  fill(report, seq);
+  return emuComplete(report, sizeof(report), USBH_URBSTATUS_OK);
+}
+
+static uint32_t read_seq(usbhhid_report_info_t *info) {
+  uint8_t buf[TEST_REPORT_LEN];
+
+  if (usbhhidReadReport(hidp, buf, sizeof(buf), info,
+                        TIME_IMMEDIATE) != Q_OK)
+    return 0;
+  return sequence(buf);
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * A full queue drops its oldest report: LEN - 1 are kept, the last slot
+ * belongs to the URB, which keeps polling.
+ */
+static void test_overwrite(void) {
+  usbhhid_report_info_t info;
+  bool free_slot = true;
+  uint32_t seq;
+
+  printf("overwrite policy\n");
+  start(USBHHID_QUEUE_OVERWRITE);
+  check(read_seq(NULL) == 0);
+  for (seq = 1; seq <= 3 * TEST_LEN; seq++) {
+    emu.now = seq * 100;
+    check(deliver(seq));
+    free_slot &= urb_slot_free();
+  }
+  check(free_slot);
+  check(notifications == 3 * TEST_LEN);
+  check(hidp->q_waiting.wakeups == 3 * TEST_LEN);
+  check((hidp->q_counter == TEST_LEN - 1) && !hidp->q_held);
+  check(usbhhidGetDroppedReports(hidp) == 2 * TEST_LEN + 1);
+
+  /* the newest LEN - 1 reports, in order and intact */
+  for (seq = 2 * TEST_LEN + 2; seq <= 3 * TEST_LEN; seq++) {
+    check((read_seq(&info) == seq) && (info.timestamp == seq * 100) &&
+          (info.len == TEST_REPORT_LEN));
+  }
+  check(read_seq(NULL) == 0);
+  check(emu.pending == &hidp->in_urb);
+  usbhhidStop(hidp);
+}
+
+/*
+ * A full queue holds the URB: the device is not polled until a report is
+ * read, the read resubmits the URB on the slot it freed.
+ */
+static void test_block(void) {
+  usbhhid_report_info_t info;
+  bool free_slot = true;
+  uint32_t seq;
+
+  printf("block policy\n");
+  start(USBHHID_QUEUE_BLOCK);
+  for (seq = 1; seq <= TEST_LEN; seq++) {
+    check(!hidp->q_held && deliver(seq));
+    if (emu.pending != NULL)
+      free_slot &= urb_slot_free();
+  }
+  check(free_slot);
+  check(hidp->q_held && (hidp->q_counter == TEST_LEN) &&
+        (emu.pending == NULL));
+  /* the device NAKs */
+  check(!deliver(100));
+
+  /* the first read frees slot 0 and resubmits on it */
+  check(read_seq(&info) == 1);
+  check(!hidp->q_held && (emu.pending == &hidp->in_urb) &&
+        (hidp->in_urb.buff == ring[0]) && urb_slot_free());
+  check(deliver(TEST_LEN + 1));
+  check(hidp->q_held && (emu.pending == NULL));
+
+  for (seq = 2; seq <= TEST_LEN + 1; seq++)
+    check(read_seq(NULL) == seq);
+  check(usbhhidGetDroppedReports(hidp) == 0);
+  check(!hidp->q_held && (emu.pending != NULL) && urb_slot_free());
+  check(read_seq(NULL) == 0);
+
+  /* stopped while held: the queue is reset on restart */
+  for (seq = 1; seq <= TEST_LEN; seq++)
+    check(deliver(seq));
+  usbhhidStop(hidp);
+  check(emu.pending == NULL);
+  usbhhidStart(hidp, &config);
+  check(!hidp->q_held && (hidp->q_counter == 0) && (emu.pending != NULL));
+  usbhhidStop(hidp);
+}
+
+/*
+ * Short reads, short reports, timeouts, failed transfers and stop.
+ */
+static void test_reads(void) {
+  const uint8_t short_report[3] = {1, 2, 3};
+  usbhhid_report_info_t info;
+  uint8_t buf[TEST_REPORT_LEN];
+
+  printf("reads\n");
+  start(USBHHID_QUEUE_OVERWRITE);
+  check(usbhhidReadReport(hidp, buf, sizeof(buf), NULL,
+                          TIME_IMMEDIATE) == Q_TIMEOUT);
+
+  /* failed or empty polls queue nothing */
+  check(emuComplete(NULL, 0, USBH_URBSTATUS_TIMEOUT));
+  check(emuComplete(NULL, 0, USBH_URBSTATUS_STALL));
+  check((hidp->q_counter == 0) && (emu.pending != NULL) &&
+        (notifications == 0));
+
+  check(emuComplete(short_report, sizeof(short_report), USBH_URBSTATUS_OK));
+  check(deliver(42));
+  memset(buf, 0, sizeof(buf));
+  check((usbhhidReadReport(hidp, buf, sizeof(buf), &info,
+                           TIME_IMMEDIATE) == Q_OK) &&
+        (info.len == sizeof(short_report)) &&
+        (memcmp(buf, short_report, sizeof(short_report)) == 0) &&
+        (buf[3] == 0));
+  /* truncated to the buffer, the length is the report one */
+  memset(buf, 0, sizeof(buf));
+  check((usbhhidReadReport(hidp, buf, 2, &info, TIME_IMMEDIATE) == Q_OK) &&
+        (info.len == TEST_REPORT_LEN) && (buf[0] == 42) && (buf[2] == 0));
+
+  /* the aborted URB and the stop wake the readers, queued reports can
+     still be read */
+  check(deliver(43));
+  hidp->q_waiting.wakeups = 0;
+  usbhhidStop(hidp);
+  check((hidp->q_waiting.wakeups == 2) && (hidp->q_waiting.msg == Q_RESET));
+  check(usbhhidReadReport(hidp, buf, sizeof(buf), NULL,
+                          TIME_IMMEDIATE) == Q_OK);
+  check(usbhhidReadReport(hidp, buf, sizeof(buf), NULL,
+                          TIME_IMMEDIATE) == Q_RESET);
+}
+
+/*
+ * Reports every period ticks for TEST_REPLAY_TICKS. The device polled
+ * when a report is ready, a report not polled before the next one is lost
+ * in the device. The consumer reads one report each TEST_READ_TICKS and
+ * stalls up to TEST_STALL_MAX ticks each TEST_STALL_PERIOD.
+ */
+static void replay(unsigned rate, usbhhid_queue_policy_t policy) {
+  const uint32_t period = 1000000U / rate;
+  uint32_t produced = 0, consumed = 0, device_lost = 0, last = 0;
+  uint32_t busy_until = 0, ready = 0, max_latency = 0;
+  uint64_t latencies = 0;
+  usbhhid_report_info_t info;
+  bool ordered = true, stamped = true;
+  systime_t now;
+
+  start(policy);
+  srand(1234);
+  for (now = 0; now < TEST_REPLAY_TICKS; now++) {
+    emu.now = now;
+    if (now % period == 0) {
+      if (ready != 0)
+        device_lost++;
+      ready = ++produced;
+    }
+    if ((ready != 0) && deliver(ready))
+      ready = 0;
+
+    if (now % TEST_STALL_PERIOD == TEST_STALL_PERIOD / 2) {
+      const uint32_t stall = now + (uint32_t)rand() % TEST_STALL_MAX;
+      if (stall > busy_until)
+        busy_until = stall;
+    }
+    if (now < busy_until)
+      continue;
+    const uint32_t seq = read_seq(&info);
+    if (seq == 0)
+      continue;
+    /* reports are timestamped when the URB completes */
+    if ((policy == USBHHID_QUEUE_OVERWRITE) ?
+        (info.timestamp != (seq - 1) * period) :
+        (info.timestamp < (seq - 1) * period))
+      stamped = false;
+    if (seq <= last)
+      ordered = false;
+    last = seq;
+    consumed++;
+    latencies += now - (seq - 1) * period;
+    if (now - (seq - 1) * period > max_latency)
+      max_latency = now - (seq - 1) * period;
+    busy_until = now + TEST_READ_TICKS;
+  }
+
+  const uint32_t dropped = usbhhidGetDroppedReports(hidp);
+  printf("  %u Hz %-9s produced %5u read %5u dropped %5u device %5u "
+         "latency avg %4u max %5u us\n", rate,
+         (policy == USBHHID_QUEUE_BLOCK) ? "block" : "overwrite",
+         produced, consumed, dropped, device_lost,
+         (unsigned)(latencies / consumed), max_latency);
+  check(ordered && stamped);
+  check(produced == consumed + dropped + device_lost + hidp->q_counter +
+                    (ready != 0));
+  if (policy == USBHHID_QUEUE_BLOCK) {
+    check((dropped == 0) && (max_latency < TEST_LEN * period +
+                             TEST_STALL_MAX + TEST_READ_TICKS));
+  }
+  else {
+    check(device_lost == 0);
+  }
+  /* LEN - 1 slots cover the stalls at 1 kHz */
+  if (rate == 1000)
+    check((dropped == 0) && (device_lost == 0));
+  usbhhidStop(hidp);
+}
+
+static void test_replay(void) {
+  static const unsigned rates[] = {1000, 2000, 4000, 8000};
+  unsigned i;
+
+  printf("replay\n");
+  for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    replay(rates[i], USBHHID_QUEUE_OVERWRITE);
+    replay(rates[i], USBHHID_QUEUE_BLOCK);
+  }
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+
+  test_overwrite();
+  test_block();
+  test_reads();
+  test_replay();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
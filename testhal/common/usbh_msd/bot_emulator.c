@@ -0,0 +1,597 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Bulk-Only Transport mass storage device, attached to an emulated host
+ * controller that replaces the USB host core URB layer. The device answers
+ * the commands issued by the MSD driver at connection and READ/WRITE, and
+ * can end the data phase of a READ/WRITE early with a short packet or a
+ * STALL, as allowed by the BOT specification.
+ */
+
+#include <stdlib.h>
+
+#include "hal.h"
+#include "usbh/internal.h"
+#include "bot_emulator.h"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define CBW_SIGNATURE         0x43425355U
+#define CSW_SIGNATURE         0x53425355U
+#define CBW_SIZE              31U
+#define CSW_SIZE              13U
+
+#define CSW_STATUS_PASSED     0U
+#define CSW_STATUS_FAILED     1U
+#define CSW_STATUS_PHASE      2U
+
+#define SENSE_ILLEGAL_REQUEST 5U
+
+typedef enum {
+  DEV_CBW,
+  DEV_DATA_IN,
+  DEV_DATA_OUT,
+  DEV_CSW
+} dev_phase_t;
+
+/*
+ * Emulated device and bus state.
+ */
+typedef struct {
+  usbh_ep_t     *epin;
+  usbh_ep_t     *epout;
+  usbh_urb_t    *qin;         /* URBs queued on the IN pipe */
+  usbh_urb_t    *qout;        /* URBs queued on the OUT pipe */
+  bool          in_halted;
+  bool          out_halted;
+  dev_phase_t   phase;
+  uint32_t      tag;
+  uint32_t      xfer;         /* dCBWDataTransferLength */
+  uint32_t      pos;          /* bytes moved in the data phase */
+  uint32_t      stop;         /* bytes after which the data phase ends */
+  bool          stall;        /* the early end is a STALL, not a short packet */
+  uint8_t       *data;
+  uint8_t       status;
+  bool          bad_tag;
+  uint8_t       sense_key;
+  uint8_t       resp[64];
+} emu_device_t;
+
+/*
+ ******************************************************************************
+ * EXTERNS
+ ******************************************************************************
+ */
+
+bot_emulator_t emu;
+uint8_t emu_disk[EMU_BLOCKS * EMU_BLOCK_SIZE];
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static emu_device_t dev;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static uint32_t get_be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void put_be32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static usbh_urb_t **queue_of(const usbh_urb_t *urb) {
+  return (urb->ep == dev.epin) ? &dev.qin : &dev.qout;
+}
+
+static void queue_add(usbh_urb_t *urb) {
+  usbh_urb_t **q = queue_of(urb);
+
+  urb->qnext = NULL;
+  while (*q != NULL)
+    q = &(*q)->qnext;
+  *q = urb;
+}
+
+static void queue_del(usbh_urb_t *urb) {
+  usbh_urb_t **q = queue_of(urb);
+
+  while ((*q != NULL) && (*q != urb))
+    q = &(*q)->qnext;
+  if (*q != NULL)
+    *q = urb->qnext;
+}
+
+static usbh_urb_t *queue_pop(usbh_urb_t **q) {
+  usbh_urb_t *urb = *q;
+
+  *q = urb->qnext;
+  return urb;
+}
+
+/*
+ * Same as _usbh_urb_completeI(), a STALL halts the host endpoint as the
+ * low level driver does.
+ */
+static void urb_complete(usbh_urb_t *urb, usbh_urbstatus_t status) {
+
+  if (status == USBH_URBSTATUS_STALL) {
+    urb->ep->status = USBH_EPSTATUS_HALTED;
+    emu.stalls++;
+  }
+  urb->status = status;
+  osalThreadResumeI(&urb->waitingThread,
+                    (status == USBH_URBSTATUS_OK) ? MSG_OK : MSG_RESET);
+  osalThreadResumeI(&urb->abortingThread, MSG_RESET);
+  if (urb->callback != NULL)
+    urb->callback(urb);
+}
+
+/*
+ * READ/WRITE(10/16), moves the data straight from/to the disk.
+ */
+static void dev_read_write(const uint8_t *cdb, bool cdb16) {
+  uint32_t lba, n;
+
+  if (cdb16) {
+    assert(get_be32(&cdb[2]) == 0);
+    lba = get_be32(&cdb[6]);
+    n = get_be32(&cdb[10]);
+  }
+  else {
+    lba = get_be32(&cdb[2]);
+    n = ((uint32_t)cdb[7] << 8) | cdb[8];
+  }
+  assert(dev.xfer == n * EMU_BLOCK_SIZE);
+  assert((emu.max_transfer == 0) || (n <= emu.max_transfer));
+  if ((lba >= EMU_BLOCKS) || (n > EMU_BLOCKS - lba)) {
+    dev.status = CSW_STATUS_FAILED;
+    dev.sense_key = SENSE_ILLEGAL_REQUEST;
+    dev.stop = 0;
+    dev.stall = true;
+    return;
+  }
+  dev.data = &emu_disk[lba * EMU_BLOCK_SIZE];
+  dev.stop = dev.xfer;
+
+  if ((emu.fail == EMU_FAIL_NONE) || (emu.fail_count == 0) ||
+      (emu.fail_lba < lba) || (emu.fail_lba >= lba + n))
+    return;
+
+  if (emu.fail_count > 0)
+    emu.fail_count--;
+  switch (emu.fail) {
+  case EMU_FAIL_STATUS:
+    dev.status = CSW_STATUS_FAILED;
+    dev.sense_key = emu.fail_key;
+    break;
+  case EMU_FAIL_SHORT:
+  case EMU_FAIL_STALL:
+    /* data up to the failing block, a short packet is only possible IN */
+    dev.status = CSW_STATUS_FAILED;
+    dev.sense_key = emu.fail_key;
+    dev.stop = (emu.fail_lba - lba) * EMU_BLOCK_SIZE;
+    dev.stall = (emu.fail == EMU_FAIL_STALL) || ((cdb[0] & 2U) != 0U);
+    break;
+  case EMU_FAIL_PHASE:
+    dev.status = CSW_STATUS_PHASE;
+    break;
+  case EMU_FAIL_TAG:
+    dev.bad_tag = true;
+    break;
+  default:
+    break;
+  }
+}
+
+static void dev_cbw(const uint8_t *cbw) {
+  const uint8_t *cdb = &cbw[15];
+  uint32_t signature, len = 0;
+
+  memcpy(&signature, &cbw[0], 4);
+  memcpy(&dev.tag, &cbw[4], 4);
+  memcpy(&dev.xfer, &cbw[8], 4);
+  assert(signature == CBW_SIGNATURE);
+  emu.commands++;
+
+  dev.pos = 0;
+  dev.stop = 0;
+  dev.stall = false;
+  dev.data = dev.resp;
+  dev.status = CSW_STATUS_PASSED;
+  dev.bad_tag = false;
+  memset(dev.resp, 0, sizeof(dev.resp));
+
+  switch (cdb[0]) {
+  case 0x00:    /* TEST UNIT READY */
+    break;
+  case 0x03:    /* REQUEST SENSE */
+    dev.resp[0] = 0x70;
+    dev.resp[2] = dev.sense_key;
+    dev.resp[7] = 10;
+    dev.sense_key = 0;
+    len = 18;
+    break;
+  case 0x12:    /* INQUIRY */
+    if ((cdb[1] & 1U) == 0U) {
+      dev.resp[2] = 6;
+      len = 36;
+    }
+    else if (cdb[2] == 0x00) {
+      dev.resp[3] = (emu.max_transfer != 0) ? 2 : 1;
+      dev.resp[5] = 0xB0;
+      len = 64;
+    }
+    else if ((cdb[2] == 0xB0) && (emu.max_transfer != 0)) {
+      dev.resp[1] = 0xB0;
+      dev.resp[3] = 0x3C;
+      put_be32(&dev.resp[8], emu.max_transfer);
+      len = 64;
+    }
+    else {
+      dev.status = CSW_STATUS_FAILED;
+      dev.sense_key = SENSE_ILLEGAL_REQUEST;
+    }
+    break;
+  case 0x25:    /* READ CAPACITY(10) */
+    put_be32(&dev.resp[0], EMU_BLOCKS - 1);
+    put_be32(&dev.resp[4], EMU_BLOCK_SIZE);
+    len = 8;
+    break;
+  case 0x35:    /* SYNCHRONIZE CACHE(10) */
+    break;
+  case 0x28:    /* READ(10) */
+  case 0x2A:    /* WRITE(10) */
+    dev_read_write(cdb, false);
+    break;
+  case 0x88:    /* READ(16) */
+  case 0x8A:    /* WRITE(16) */
+    dev_read_write(cdb, true);
+    break;
+  default:
+    dev.status = CSW_STATUS_FAILED;
+    dev.sense_key = SENSE_ILLEGAL_REQUEST;
+    break;
+  }
+
+  if (dev.data == dev.resp) {
+    /* shorter responses end with a short packet */
+    dev.stop = (len < dev.xfer) ? len : dev.xfer;
+  }
+  if (dev.xfer == 0)
+    dev.phase = DEV_CSW;
+  else
+    dev.phase = ((cbw[12] & 0x80U) != 0U) ? DEV_DATA_IN : DEV_DATA_OUT;
+}
+
+/*
+ * Moves the data of one URB, the device ends the data phase either when
+ * all the expected bytes are moved or at dev.stop.
+ */
+static void dev_data(usbh_urb_t *urb, bool in) {
+  uint32_t n = dev.stop - dev.pos;
+
+  if (n > urb->requestedLength)
+    n = urb->requestedLength;
+  if (in)
+    memcpy(urb->buff, dev.data + dev.pos, n);
+  else
+    memcpy(dev.data + dev.pos, urb->buff, n);
+  dev.pos += n;
+  urb->actualLength = n;
+
+  if (dev.pos == dev.xfer) {
+    dev.phase = DEV_CSW;
+  }
+  else if (n < urb->requestedLength) {
+    dev.phase = DEV_CSW;
+    if (dev.stall) {
+      if (in)
+        dev.in_halted = true;
+      else
+        dev.out_halted = true;
+      urb_complete(urb, USBH_URBSTATUS_STALL);
+      return;
+    }
+    assert(in);
+  }
+  urb_complete(urb, USBH_URBSTATUS_OK);
+}
+
+static void dev_csw(usbh_urb_t *urb) {
+  uint8_t csw[CSW_SIZE];
+  uint32_t v, n;
+
+  v = CSW_SIGNATURE;
+  memcpy(&csw[0], &v, 4);
+  v = dev.bad_tag ? ~dev.tag : dev.tag;
+  memcpy(&csw[4], &v, 4);
+  v = dev.xfer - dev.pos;
+  memcpy(&csw[8], &v, 4);
+  csw[12] = dev.status;
+
+  n = (urb->requestedLength < CSW_SIZE) ? urb->requestedLength : CSW_SIZE;
+  memcpy(urb->buff, csw, n);
+  urb->actualLength = n;
+  dev.phase = DEV_CBW;
+  urb_complete(urb, USBH_URBSTATUS_OK);
+}
+
+/*
+ * Completes one queued URB, returns false if nothing can progress.
+ */
+static bool bus_step(void) {
+  usbh_urb_t *urb;
+
+  /* a halted pipe answers every token with a STALL */
+  if (dev.out_halted && (dev.qout != NULL)) {
+    urb = queue_pop(&dev.qout);
+    urb->actualLength = 0;
+    urb_complete(urb, USBH_URBSTATUS_STALL);
+    return true;
+  }
+  if (dev.in_halted && (dev.qin != NULL)) {
+    urb = queue_pop(&dev.qin);
+    urb->actualLength = 0;
+    urb_complete(urb, USBH_URBSTATUS_STALL);
+    return true;
+  }
+
+  switch (dev.phase) {
+  case DEV_CBW:
+    if (dev.qout != NULL) {
+      urb = queue_pop(&dev.qout);
+      assert(urb->requestedLength == CBW_SIZE);
+      dev_cbw(urb->buff);
+      urb->actualLength = CBW_SIZE;
+      urb_complete(urb, USBH_URBSTATUS_OK);
+      return true;
+    }
+    break;
+  case DEV_DATA_OUT:
+    if (dev.qout != NULL) {
+      dev_data(queue_pop(&dev.qout), false);
+      return true;
+    }
+    break;
+  case DEV_DATA_IN:
+    if (dev.qin != NULL) {
+      dev_data(queue_pop(&dev.qin), true);
+      return true;
+    }
+    break;
+  case DEV_CSW:
+    if (dev.qin != NULL) {
+      dev_csw(queue_pop(&dev.qin));
+      return true;
+    }
+    break;
+  }
+  return false;
+}
+
+/*
+ ******************************************************************************
+ * HOST CONTROLLER AND OS EMULATION
+ ******************************************************************************
+ */
+
+static msg_t resume_msg;
+
+void osalThreadSleepMilliseconds(uint32_t msec) {
+  (void)msec;
+}
+
+void osalThreadResumeI(thread_reference_t *trp, msg_t msg) {
+  if (*trp != NULL) {
+    *trp = NULL;
+    resume_msg = msg;
+  }
+}
+
+/*
+ * The bus runs while the thread waits, the timeout expires as soon as
+ * nothing can progress.
+ */
+msg_t osalThreadSuspendTimeoutS(thread_reference_t *trp, sysinterval_t timeout) {
+  (void)timeout;
+
+  *trp = (thread_reference_t)trp;
+  while (*trp != NULL) {
+    if (!bus_step()) {
+      *trp = NULL;
+      emu.timeouts++;
+      return MSG_TIMEOUT;
+    }
+  }
+  return resume_msg;
+}
+
+void usbhURBObjectInit(usbh_urb_t *urb, usbh_ep_t *ep, usbh_completion_cb callback,
+    void *user, void *buff, uint32_t len) {
+
+  memset(urb, 0, sizeof(*urb));
+  urb->ep = ep;
+  urb->callback = callback;
+  urb->userData = user;
+  urb->buff = buff;
+  urb->requestedLength = len;
+  urb->status = USBH_URBSTATUS_INITIALIZED;
+}
+
+void usbhURBSubmitI(usbh_urb_t *urb) {
+
+  assert(urb->status == USBH_URBSTATUS_INITIALIZED);
+  if (urb->ep->status == USBH_EPSTATUS_HALTED) {
+    urb_complete(urb, USBH_URBSTATUS_STALL);
+    return;
+  }
+  urb->status = USBH_URBSTATUS_PENDING;
+  queue_add(urb);
+}
+
+bool usbhURBCancelI(usbh_urb_t *urb) {
+
+  if (urb->status == USBH_URBSTATUS_PENDING) {
+    queue_del(urb);
+    urb_complete(urb, USBH_URBSTATUS_CANCELLED);
+  }
+  return true;
+}
+
+void usbhURBCancelAndWaitS(usbh_urb_t *urb) {
+  (void)usbhURBCancelI(urb);
+}
+
+usbh_urbstatus_t usbhBulkTransfer(usbh_ep_t *ep, void *data, uint32_t len,
+    uint32_t *actual_len, systime_t timeout) {
+  usbh_urb_t urb;
+
+  usbhURBObjectInit(&urb, ep, NULL, NULL, data, len);
+  usbhURBSubmitI(&urb);
+  if (usbhURBIsBusy(&urb) &&
+      (osalThreadSuspendTimeoutS(&urb.waitingThread, timeout) == MSG_TIMEOUT)) {
+    queue_del(&urb);
+    urb.status = USBH_URBSTATUS_TIMEOUT;
+  }
+  if (actual_len != NULL)
+    *actual_len = urb.actualLength;
+  return urb.status;
+}
+
+/*
+ * Only the Bulk-Only Mass Storage Reset is expected on the control pipe.
+ */
+usbh_urbstatus_t usbhControlRequest(usbh_device_t *dev_p, uint8_t bmRequestType,
+    uint8_t bRequest, uint16_t wValue, uint16_t wIndex, uint16_t wLength,
+    uint8_t *buff) {
+
+  (void)dev_p;
+  (void)bmRequestType;
+  (void)wValue;
+  (void)wIndex;
+  (void)wLength;
+  (void)buff;
+  assert(bRequest == 0xFF);
+  emu.bot_resets++;
+  dev.phase = DEV_CBW;
+  return USBH_URBSTATUS_OK;
+}
+
+/*
+ * CLEAR_FEATURE(ENDPOINT_HALT).
+ */
+bool usbhEPReset(usbh_ep_t *ep) {
+
+  if (ep == dev.epin) {
+    dev.in_halted = false;
+    emu.in_clears++;
+  }
+  else {
+    dev.out_halted = false;
+    emu.out_clears++;
+  }
+  ep->status = USBH_EPSTATUS_OPEN;
+  return HAL_SUCCESS;
+}
+
+void usbhEPObjectInit(usbh_ep_t *ep, usbh_device_t *dev_p,
+    const usbh_endpoint_descriptor_t *desc) {
+  (void)ep;
+  (void)dev_p;
+  (void)desc;
+}
+
+/*
+ * Not reached, the test does not load the class driver.
+ */
+bool _usbh_match_descriptor(const uint8_t *descriptor, uint16_t rem,
+    int16_t type, int16_t _class, int16_t subclass, int16_t protocol) {
+  (void)descriptor;
+  (void)rem;
+  (void)type;
+  (void)_class;
+  (void)subclass;
+  (void)protocol;
+  abort();
+}
+
+void ep_iter_init(generic_iterator_t *iep, const if_iterator_t *iif) {
+  (void)iep;
+  (void)iif;
+  abort();
+}
+
+void ep_iter_next(generic_iterator_t *iep) {
+  (void)iep;
+  abort();
+}
+
+void usbh_lld_ep_open(usbh_ep_t *ep) {
+  (void)ep;
+}
+
+void usbh_lld_ep_close(usbh_ep_t *ep) {
+  (void)ep;
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+void emuInit(usbh_ep_t *epin, usbh_ep_t *epout) {
+
+  memset(&dev, 0, sizeof(dev));
+  dev.epin = epin;
+  dev.epout = epout;
+  dev.phase = DEV_CBW;
+  epin->type = USBH_EPTYPE_BULK;
+  epin->status = USBH_EPSTATUS_OPEN;
+  epout->type = USBH_EPTYPE_BULK;
+  epout->status = USBH_EPSTATUS_OPEN;
+  memset(&emu, 0, sizeof(emu));
+}
+
+void emuClearStats(void) {
+
+  emu.commands = 0;
+  emu.bot_resets = 0;
+  emu.in_clears = 0;
+  emu.out_clears = 0;
+  emu.stalls = 0;
+  emu.timeouts = 0;
+}
@@ -0,0 +1,84 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef BOT_EMULATOR_H
+#define BOT_EMULATOR_H
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define EMU_BLOCK_SIZE        512U
+#define EMU_BLOCKS            1024U
+
+/*
+ * Failure injected in the READ/WRITE commands touching emu.fail_lba.
+ */
+typedef enum {
+  EMU_FAIL_NONE,
+  EMU_FAIL_STATUS,      /* data phase completed, CSW status failed      */
+  EMU_FAIL_SHORT,       /* IN data phase ended by a short packet        */
+  EMU_FAIL_STALL,       /* data phase ended by halting the pipe         */
+  EMU_FAIL_PHASE,       /* CSW status phase error                       */
+  EMU_FAIL_TAG          /* CSW with a wrong tag                         */
+} emu_fail_t;
+
+/*
+ * Bulk-Only device and host controller emulator.
+ */
+typedef struct {
+  /* configuration */
+  uint32_t    max_transfer;   /* VPD block limits, zero if not reported */
+  emu_fail_t  fail;
+  uint32_t    fail_lba;
+  int         fail_count;     /* failures left, negative for persistent */
+  uint8_t     fail_key;       /* sense key of the failure */
+  /* statistics */
+  unsigned    commands;
+  unsigned    bot_resets;
+  unsigned    in_clears;
+  unsigned    out_clears;
+  unsigned    stalls;
+  unsigned    timeouts;
+} bot_emulator_t;
+
+/*
+ ******************************************************************************
+ * EXTERNS
+ ******************************************************************************
+ */
+
+extern bot_emulator_t emu;
+extern uint8_t emu_disk[EMU_BLOCKS * EMU_BLOCK_SIZE];
+
+/*
+ ******************************************************************************
+ * PROTOTYPES
+ ******************************************************************************
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void emuInit(usbh_ep_t *epin, usbh_ep_t *epout);
+  void emuClearStats(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOT_EMULATOR_H */
@@ -0,0 +1,38 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of the USB host low level driver header.
+ */
+
+#ifndef HAL_USBH_LLD_H
+#define HAL_USBH_LLD_H
+
+#define USBH_LLD_DEFINE_BUFFER(var)             var
+#define USBH_LLD_DECLARE_STRUCT_MEMBER(member)  member
+
+#define _usbh_urb_ll_data                                                   \
+  struct usbh_urb *qnext;
+
+#define _usbh_ep_ll_data
+#define _usbh_device_ll_data
+#define _usbh_port_ll_data
+#define _usbhdriver_ll_data
+
+void usbh_lld_ep_open(usbh_ep_t *ep);
+void usbh_lld_ep_close(usbh_ep_t *ep);
+
+#endif /* HAL_USBH_LLD_H */
@@ -0,0 +1,256 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Regression test of the USB host MSD Bulk-Only transport, the driver
+ * talks to the device emulated by bot_emulator.c. Run with "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal.h"
+#include "bot_emulator.h"
+
+/* The driver is built here to reach its instances and class init.*/
+#include "hal_usbh_msd.c"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_BLOCKS           256U
+#define TEST_MAX_TRANSFER     64U
+
+#define SENSE_MEDIUM_ERROR    3U
+#define SENSE_ILLEGAL_REQUEST 5U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+static USBHMassStorageLUNDriver *const lunp = &MSBLKD[0];
+static uint8_t pattern[TEST_BLOCKS * EMU_BLOCK_SIZE];
+static uint8_t buf[TEST_BLOCKS * EMU_BLOCK_SIZE];
+static usbhmsd_lun_errors_t errors;
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+/*
+ * Three uneven vector elements, so that the chained commands of
+ * TEST_MAX_TRANSFER blocks have more than one data URB.
+ */
+static void make_iov(blkiov_t *iov, uint8_t *data) {
+
+  iov[0].buffer = data;
+  iov[0].n = 10;
+  iov[1].buffer = data + 10 * EMU_BLOCK_SIZE;
+  iov[1].n = 100;
+  iov[2].buffer = data + 110 * EMU_BLOCK_SIZE;
+  iov[2].n = TEST_BLOCKS - 110;
+}
+
+static bool read_all(void) {
+  blkiov_t iov[3];
+
+  memset(buf, 0, sizeof(buf));
+  make_iov(iov, buf);
+  return usbhmsdLUNReadV(lunp, 0, iov, 3);
+}
+
+static bool write_all(void) {
+  blkiov_t iov[3];
+
+  make_iov(iov, pattern);
+  return usbhmsdLUNWriteV(lunp, 0, iov, 3);
+}
+
+static void begin(const char *name, emu_fail_t fail, uint32_t lba,
+                  int count, uint8_t key) {
+
+  printf("%s\n", name);
+  memcpy(emu_disk, pattern, sizeof(pattern));
+  usbhmsdLUNClearErrors(lunp);
+  emuClearStats();
+  emu.fail = fail;
+  emu.fail_lba = lba;
+  emu.fail_count = count;
+  emu.fail_key = key;
+}
+
+static void end(void) {
+
+  usbhmsdLUNGetErrors(lunp, &errors);
+  emu.fail = EMU_FAIL_NONE;
+  /* no command may be left waiting for a CSW that was never sent */
+  check(emu.timeouts == 0);
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+static void test_clean(void) {
+
+  begin("read and write without errors", EMU_FAIL_NONE, 0, 0, 0);
+  memset(emu_disk, 0, sizeof(pattern));
+  check(write_all() == HAL_SUCCESS);
+  check(memcmp(emu_disk, pattern, sizeof(pattern)) == 0);
+  check(read_all() == HAL_SUCCESS);
+  check(memcmp(buf, pattern, sizeof(pattern)) == 0);
+  check(emu.commands == 2 * TEST_BLOCKS / TEST_MAX_TRANSFER);
+  end();
+  check((errors.retries == 0) && (emu.bot_resets == 0) && (emu.stalls == 0));
+}
+
+static void test_csw_failed(void) {
+
+  begin("CSW failed after the whole data phase", EMU_FAIL_STATUS, 100, 1,
+        SENSE_MEDIUM_ERROR);
+  check(read_all() == HAL_SUCCESS);
+  check(memcmp(buf, pattern, sizeof(pattern)) == 0);
+  end();
+  check((errors.failed_commands == 1) && (errors.retries == 1));
+  check((errors.transport_errors == 0) && (emu.bot_resets == 0));
+  check(errors.sense_key == SENSE_MEDIUM_ERROR);
+}
+
+static void test_read_stall(uint32_t lba) {
+
+  begin("READ data phase stalled", EMU_FAIL_STALL, lba, 1, SENSE_MEDIUM_ERROR);
+  check(read_all() == HAL_SUCCESS);
+  check(memcmp(buf, pattern, sizeof(pattern)) == 0);
+  end();
+  /* the halt is cleared and the CSW read, no reset recovery */
+  check(emu.in_clears == 1);
+  check((errors.failed_commands == 1) && (errors.retries == 1));
+  check((errors.transport_errors == 0) && (emu.bot_resets == 0));
+  check(errors.sense_key == SENSE_MEDIUM_ERROR);
+}
+
+static void test_write_stall(void) {
+
+  begin("WRITE data phase stalled", EMU_FAIL_STALL, 150, 1,
+        SENSE_MEDIUM_ERROR);
+  memset(emu_disk, 0, sizeof(pattern));
+  check(write_all() == HAL_SUCCESS);
+  check(memcmp(emu_disk, pattern, sizeof(pattern)) == 0);
+  end();
+  check(emu.out_clears == 1);
+  check((errors.failed_commands == 1) && (errors.retries == 1));
+  check((errors.transport_errors == 0) && (emu.bot_resets == 0));
+}
+
+static void test_read_short(void) {
+
+  /* LBA 5 is in the first of the two data URBs of the first command, the
+     second one must not receive the CSW */
+  begin("READ data phase ended by a short packet", EMU_FAIL_SHORT, 5, 1,
+        SENSE_MEDIUM_ERROR);
+  check(read_all() == HAL_SUCCESS);
+  check(memcmp(buf, pattern, sizeof(pattern)) == 0);
+  end();
+  check((errors.failed_commands == 1) && (errors.retries == 1));
+  check((errors.transport_errors == 0) && (emu.bot_resets == 0));
+}
+
+static void test_not_retried(void) {
+
+  begin("stalled command not worth a retry", EMU_FAIL_STALL, 200, -1,
+        SENSE_ILLEGAL_REQUEST);
+  check(read_all() == HAL_FAILED);
+  end();
+  check((errors.failed_commands == 1) && (errors.retries == 0));
+  check((errors.unrecovered == 1) && (emu.bot_resets == 0));
+  check(errors.sense_key == SENSE_ILLEGAL_REQUEST);
+  /* the device is still usable */
+  check(read_all() == HAL_SUCCESS);
+  check(memcmp(buf, pattern, sizeof(pattern)) == 0);
+}
+
+static void test_reset(const char *name, emu_fail_t fail) {
+
+  begin(name, fail, 70, 1, 0);
+  check(read_all() == HAL_SUCCESS);
+  check(memcmp(buf, pattern, sizeof(pattern)) == 0);
+  end();
+  check((errors.transport_errors == 1) && (errors.retries == 1));
+  /* the reset recovery clears both pipes */
+  check((emu.bot_resets == 1) && (emu.in_clears == 1) && (emu.out_clears == 1));
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+  unsigned i;
+
+  srand(1);
+  for (i = 0; i < sizeof(pattern); i++)
+    pattern[i] = (uint8_t)rand();
+
+  _msd_init();
+  USBHMSD[0].luns = lunp;
+  lunp->msdp = &USBHMSD[0];
+  emuInit(&USBHMSD[0].epin, &USBHMSD[0].epout);
+  emu.max_transfer = TEST_MAX_TRANSFER;
+  lunp->state = BLK_ACTIVE;
+  if ((usbhmsdLUNConnect(lunp) != HAL_SUCCESS) ||
+      (lunp->max_blocks != TEST_MAX_TRANSFER)) {
+    printf("connection failed\n");
+    return 1;
+  }
+
+  test_clean();
+  test_csw_failed();
+  test_read_stall(100);
+  test_read_stall(64);
+  test_write_stall();
+  test_read_short();
+  test_not_retried();
+  test_reset("CSW phase error", EMU_FAIL_PHASE);
+  test_reset("CSW with a wrong tag", EMU_FAIL_TAG);
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of osal.h. There is a single thread, waiting on
+ * a thread reference runs the emulated bus until the reference is resumed.
+ */
+
+#ifndef OSAL_H
+#define OSAL_H
+
+#include <assert.h>
+
+typedef int32_t                 msg_t;
+typedef uint32_t                systime_t;
+typedef uint32_t                sysinterval_t;
+typedef void *                  thread_reference_t;
+typedef int                     semaphore_t;
+
+#define MSG_OK                  ((msg_t)0)
+#define MSG_TIMEOUT             ((msg_t)-1)
+#define MSG_RESET               ((msg_t)-2)
+
+#define OSAL_MS2I(msec)         ((sysinterval_t)(msec))
+
+#define osalDbgCheck(c)         assert(c)
+#define osalDbgAssert(c, r)     assert(c)
+#define osalDbgCheckClassI()    (void)0
+#define osalDbgCheckClassS()    (void)0
+
+#define osalSysLock()           (void)0
+#define osalSysUnlock()         (void)0
+#define osalSysLockFromISR()    (void)0
+#define osalSysUnlockFromISR()  (void)0
+#define osalOsRescheduleS()     (void)0
+
+#define chSemObjectInit(sp, n)  (void)0
+#define chSemWait(sp)           (void)0
+#define chSemSignal(sp)         (void)0
+
+void osalThreadSleepMilliseconds(uint32_t msec);
+void osalThreadResumeI(thread_reference_t *trp, msg_t msg);
+msg_t osalThreadSuspendTimeoutS(thread_reference_t *trp, sysinterval_t timeout);
+
+#endif /* OSAL_H */
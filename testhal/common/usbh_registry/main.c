@@ -0,0 +1,392 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the USB host class driver registry: the id tables matched
+ * against device, interface association and interface descriptor blobs,
+ * the registration order, unregistration and the load hook. The device
+ * is emulated by ../usbh_core/dev_emulator.c. Run with "make check".
+ */
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "dev_emulator.h"
+
+/* The core is built here to reach its descriptor matching.*/
+#include "hal_usbh.c"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_DEADLINE         3000U
+#define TEST_APP_PERIOD       5U
+
+#define VID                   0x0483U
+#define PID                   0x5740U
+
+/*
+ * Fake class drivers, in load priority order.
+ */
+enum {
+  DRV_DEVX,             /* devices of class 0xDC */
+  DRV_HIDX,             /* interfaces of class 3 */
+  DRV_MSDX,             /* SCSI Bulk-Only interfaces */
+  DRV_VEND,             /* vendor interfaces of VID:PID */
+  DRV_CDCX,             /* interface 3 of VID */
+  DRV_MSD2,             /* SCSI Bulk-Only interfaces, overridden by MSDX */
+  DRV_ANY,              /* no table, never loads */
+  DRV_NUM
+};
+
+/*
+ * One load() per fake driver, so that the driver called is known.
+ */
+#define FAKE_DRIVER(n)                                                      \
+  static usbh_baseclassdriver_t *load_##n(usbh_device_t *dev,               \
+                                          const uint8_t *descriptor,        \
+                                          uint16_t rem) {                   \
+    return fake_load(n, dev, descriptor, rem);                              \
+  }                                                                         \
+  static const usbh_classdriver_vmt_t vmt_##n = {NULL, load_##n, unload}
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+USBHDriver USBHD1;
+
+static const uint8_t composite_device[18] = {
+  18, USBH_DT_DEVICE, 0x00, 0x02, 0x00, 0x00, 0x00, 64,
+  VID & 0xFF, VID >> 8, PID & 0xFF, PID >> 8, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t other_vid_device[18] = {
+  18, USBH_DT_DEVICE, 0x00, 0x02, 0x00, 0x00, 0x00, 64,
+  0x34, 0x12, PID & 0xFF, PID >> 8, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t diagnostic_device[18] = {
+  18, USBH_DT_DEVICE, 0x00, 0x02, 0xDC, 0x01, 0x01, 64,
+  VID & 0xFF, VID >> 8, PID & 0xFF, PID >> 8, 0x00, 0x01, 0, 0, 0, 1
+};
+
+/*
+ * Five interfaces, interface 1 has an alternate setting.
+ */
+static const uint8_t composite_config[9 + 6 * 9] = {
+  9, USBH_DT_CONFIG, 63, 0, 5, 1, 0, 0x80, 50,
+  9, USBH_DT_INTERFACE, 0, 0, 0, 0x03, 0x01, 0x01, 0,
+  9, USBH_DT_INTERFACE, 1, 0, 0, 0x08, 0x06, 0x50, 0,
+  9, USBH_DT_INTERFACE, 1, 1, 0, 0x08, 0x06, 0x50, 0,
+  9, USBH_DT_INTERFACE, 2, 0, 0, 0xFF, 0xFF, 0xFF, 0,
+  9, USBH_DT_INTERFACE, 3, 0, 0, 0x02, 0x02, 0x01, 0,
+  9, USBH_DT_INTERFACE, 4, 0, 0, 0xFE, 0x01, 0x01, 0
+};
+
+static const usbh_device_id_t devx_ids[] = {
+  USBH_ID_DESCRIPTOR(USBH_DT_DEVICE, 0xDC, 0x01, 0x01),
+  USBH_ID_END
+};
+static const usbh_device_id_t hidx_ids[] = {
+  {USBH_MATCH_TYPE | USBH_MATCH_CLASS, 0, 0, USBH_DT_INTERFACE, 0x03, 0, 0, 0},
+  USBH_ID_END
+};
+static const usbh_device_id_t msdx_ids[] = {
+  USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x08, 0x06, 0x50),
+  USBH_ID_END
+};
+static const usbh_device_id_t vend_ids[] = {
+  USBH_ID_VID_PID_DESCRIPTOR(VID, PID, USBH_DT_INTERFACE, 0xFF, 0xFF, 0xFF),
+  USBH_ID_END
+};
+static const usbh_device_id_t cdcx_ids[] = {
+  {USBH_MATCH_VID | USBH_MATCH_IFNUM, VID, 0, 0, 0, 0, 0, 3},
+  USBH_ID_END
+};
+
+static usbh_classdriver_node_t nodes[DRV_NUM];
+static usbh_baseclassdriver_t instances[DRV_NUM];
+static unsigned loads[DRV_NUM];
+static char bound[64];
+static unsigned failures;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static const usbh_classdriverinfo_t drivers[DRV_NUM];
+
+/*
+ * Counts the call and binds the offered descriptor, appending the driver
+ * name and interface number to the bound list. ANY never loads.
+ */
+static usbh_baseclassdriver_t *fake_load(unsigned n, usbh_device_t *dev,
+                                         const uint8_t *descriptor,
+                                         uint16_t rem) {
+  usbh_baseclassdriver_t *drv = &instances[n];
+
+  (void)dev;
+  (void)rem;
+  loads[n]++;
+  if (n == DRV_ANY)
+    return NULL;
+  sprintf(bound + strlen(bound), "%s:%d ", drivers[n].name,
+          (descriptor[1] == USBH_DT_INTERFACE) ? descriptor[2] : -1);
+  drv->info = &drivers[n];
+  return drv;
+}
+
+static void unload(usbh_baseclassdriver_t *drv) {
+
+  drv->info = NULL;
+}
+
+FAKE_DRIVER(DRV_DEVX);
+FAKE_DRIVER(DRV_HIDX);
+FAKE_DRIVER(DRV_MSDX);
+FAKE_DRIVER(DRV_VEND);
+FAKE_DRIVER(DRV_CDCX);
+FAKE_DRIVER(DRV_MSD2);
+FAKE_DRIVER(DRV_ANY);
+
+static const usbh_classdriverinfo_t drivers[DRV_NUM] = {
+  {"DEVX", &vmt_DRV_DEVX, devx_ids},
+  {"HIDX", &vmt_DRV_HIDX, hidx_ids},
+  {"MSDX", &vmt_DRV_MSDX, msdx_ids},
+  {"VEND", &vmt_DRV_VEND, vend_ids},
+  {"CDCX", &vmt_DRV_CDCX, cdcx_ids},
+  {"MSD2", &vmt_DRV_MSD2, msdx_ids},
+  {"ANY", &vmt_DRV_ANY, NULL}
+};
+
+static bool deny_msd2(usbh_device_t *dev, const usbh_classdriverinfo_t *info,
+                      const uint8_t *descriptor, uint16_t rem) {
+
+  (void)dev;
+  (void)descriptor;
+  (void)rem;
+  return info != &drivers[DRV_MSD2];
+}
+
+static bool wait_status(usbh_devstatus_t status) {
+  systime_t start = osalOsGetSystemTimeX();
+
+  while (emuGetDeviceStatus() != status) {
+    if (osalOsGetSystemTimeX() - start > TEST_DEADLINE)
+      return false;
+    usbhMainLoop(&USBHD1);
+    osalThreadSleepMilliseconds(TEST_APP_PERIOD);
+  }
+  return true;
+}
+
+/*
+ * Enumerates a device and returns the load() calls, the bound drivers
+ * are left in bound.
+ */
+static unsigned enumerate(const uint8_t *device) {
+  unsigned i, calls = 0;
+
+  memset(loads, 0, sizeof(loads));
+  bound[0] = '\0';
+  emu.device = device;
+  emu.config = composite_config;
+  emuAttach();
+  check(wait_status(USBH_DEVSTATUS_CONFIGURED));
+  emuDetach();
+  check(wait_status(USBH_DEVSTATUS_DISCONNECTED));
+  for (i = 0; i < DRV_NUM; i++) {
+    check(instances[i].info == NULL);
+    calls += loads[i];
+  }
+  return calls;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Descriptor blobs decoded into the match key, short blobs only give the
+ * fields they hold.
+ */
+static void test_match_key(void) {
+  static const uint8_t iad[8] = {
+    8, USBH_DT_INTERFACE_ASSOCIATION, 2, 2, 0x0E, 0x03, 0x00, 0
+  };
+  _match_key_t key;
+
+  printf("descriptor match keys\n");
+  _classdriver_match_key(&key, diagnostic_device, USBH_DT_DEVICE_SIZE);
+  check((key.type == USBH_DT_DEVICE) && (key._class == 0xDC) &&
+        (key.subclass == 0x01) && (key.protocol == 0x01) && (key.ifnum == -1));
+
+  _classdriver_match_key(&key, &composite_config[9 + 4 * 9], 2 * 9);
+  check((key.type == USBH_DT_INTERFACE) && (key._class == 0x02) &&
+        (key.subclass == 0x02) && (key.protocol == 0x01) && (key.ifnum == 3));
+
+  _classdriver_match_key(&key, iad, sizeof(iad));
+  check((key.type == USBH_DT_INTERFACE_ASSOCIATION) && (key._class == 0x0E) &&
+        (key.subclass == 0x03) && (key.protocol == 0x00) && (key.ifnum == 2));
+
+  /* blob shorter than its descriptor or than the descriptor type size */
+  _classdriver_match_key(&key, &composite_config[9], 8);
+  check((key.type == 0) && (key._class == 0) && (key.ifnum == -1));
+  _classdriver_match_key(&key, iad, 1);
+  check((key.type == 0) && (key.ifnum == -1));
+  _classdriver_match_key(&key, diagnostic_device, 9);
+  check((key.type == 0) && (key._class == 0));
+}
+
+/*
+ * Every match flag is checked, a table matches on any of its entries.
+ */
+static void test_match(void) {
+  static const usbh_device_id_t table[] = {
+    {USBH_MATCH_PID, 0, 0x1111, 0, 0, 0, 0, 0},
+    USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x08, 0x06, 0x50),
+    USBH_ID_END
+  };
+  static const usbh_device_id_t empty[] = {USBH_ID_END};
+  static const struct {
+    usbh_device_id_t id[2];
+    bool match;
+  } cases[] = {
+    {{USBH_ID_VID_PID(VID, PID), USBH_ID_END}, true},
+    {{USBH_ID_VID_PID(VID + 1, PID), USBH_ID_END}, false},
+    {{USBH_ID_VID_PID(VID, PID + 1), USBH_ID_END}, false},
+    {{USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x02, 0x02, 0x01), USBH_ID_END}, true},
+    {{USBH_ID_DESCRIPTOR(USBH_DT_DEVICE, 0x02, 0x02, 0x01), USBH_ID_END}, false},
+    {{USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x03, 0x02, 0x01), USBH_ID_END}, false},
+    {{USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x02, 0x03, 0x01), USBH_ID_END}, false},
+    {{USBH_ID_DESCRIPTOR(USBH_DT_INTERFACE, 0x02, 0x02, 0x02), USBH_ID_END}, false},
+    {{{USBH_MATCH_IFNUM, 0, 0, 0, 0, 0, 0, 3}, USBH_ID_END}, true},
+    {{{USBH_MATCH_IFNUM, 0, 0, 0, 0, 0, 0, 4}, USBH_ID_END}, false},
+    {{USBH_ID_VID_PID_DESCRIPTOR(VID, PID, USBH_DT_INTERFACE, 0x02, 0x02, 0x01),
+      USBH_ID_END}, true}
+  };
+  usbh_device_t dev;
+  _match_key_t key;
+  unsigned i;
+
+  printf("id tables\n");
+  memset(&dev, 0, sizeof(dev));
+  memcpy(&dev.devDesc, composite_device, sizeof(composite_device));
+  _classdriver_match_key(&key, &composite_config[9 + 4 * 9], 2 * 9);
+  for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    check(_classdriver_match(&dev, cases[i].id, &key) == cases[i].match);
+  check(!_classdriver_match(&dev, empty, &key));
+  check(!_classdriver_match(&dev, table, &key));
+  _classdriver_match_key(&key, &composite_config[9 + 9], 9);
+  check(_classdriver_match(&dev, table, &key));
+}
+
+/*
+ * Drivers are offered the device, then each interface once, load() is
+ * only called for matching drivers and for the one without a table.
+ */
+static void test_load(void) {
+
+  printf("driver loading\n");
+  /* DEVX does not match the device, only ANY is offered it */
+  check(enumerate(composite_device) == 6);
+  check(strcmp(bound, "HIDX:0 MSDX:1 VEND:2 CDCX:3 ") == 0);
+  check((loads[DRV_ANY] == 2) && (loads[DRV_MSD2] == 0) &&
+        (loads[DRV_DEVX] == 0));
+
+  /* a device level match leaves the interfaces alone */
+  check(enumerate(diagnostic_device) == 1);
+  check(strcmp(bound, "DEVX:-1 ") == 0);
+
+  /* VID and PID of the device */
+  check(enumerate(other_vid_device) == 6);
+  check(strcmp(bound, "HIDX:0 MSDX:1 ") == 0);
+  check((loads[DRV_VEND] == 0) && (loads[DRV_CDCX] == 0) &&
+        (loads[DRV_ANY] == 4));
+}
+
+/*
+ * Unregistering a driver lets the next one take its interfaces, the hook
+ * can deny a matching driver.
+ */
+static void test_registry(void) {
+
+  printf("unregistration and hook\n");
+  usbhClassDriverUnregister(&nodes[DRV_MSDX]);
+  check(enumerate(composite_device) == 6);
+  check(strcmp(bound, "HIDX:0 MSD2:1 VEND:2 CDCX:3 ") == 0);
+
+  usbhClassDriverSetHook(deny_msd2);
+  check(enumerate(composite_device) == 6);
+  check(strcmp(bound, "HIDX:0 VEND:2 CDCX:3 ") == 0);
+  check((loads[DRV_MSD2] == 0) && (loads[DRV_ANY] == 3));
+  usbhClassDriverSetHook(NULL);
+
+  /* registered again, with the highest priority */
+  usbhClassDriverRegister(&nodes[DRV_MSDX], &drivers[DRV_MSDX]);
+  check(enumerate(composite_device) == 6);
+  check(strcmp(bound, "HIDX:0 MSDX:1 VEND:2 CDCX:3 ") == 0);
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+  int i;
+
+  emuInit();
+  usbhInit();
+  usbhObjectInit(&USBHD1);
+  usbhStart(&USBHD1);
+
+  /* the last registered driver is tried first */
+  for (i = DRV_NUM - 1; i >= 0; i--)
+    usbhClassDriverRegister(&nodes[i], &drivers[i]);
+
+  test_match_key();
+  test_match();
+  test_load();
+  test_registry();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
@@ -0,0 +1,62 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of hal.h, only what the USB host UVC driver
+ * needs.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#endif
+#ifndef FALSE
+#define FALSE                           0
+#endif
+
+#define HAL_SUCCESS                     false
+#define HAL_FAILED                      true
+
+#define PACKED_VAR                      __attribute__((packed))
+
+/*
+ * Driver configuration.
+ */
+#define HAL_USE_USBH                    TRUE
+#define HAL_USBH_USE_UVC                TRUE
+#define HAL_USBHUVC_MAX_INSTANCES       1
+#define HAL_USBHUVC_MAX_MAILBOX_SZ      16
+#define HAL_USBHUVC_WORK_RAM_SIZE       4096
+#define HAL_USBHUVC_STATUS_PACKETS_COUNT 4
+#define HAL_USBHUVC_USE_FRAME_ASSEMBLER TRUE
+#define HAL_USBHUVC_USE_STATS           TRUE
+#define USBH_DEBUG_ENABLE               FALSE
+#define USBHUVC_DEBUG_ENABLE_TRACE      FALSE
+#define USBHUVC_DEBUG_ENABLE_INFO       FALSE
+#define USBHUVC_DEBUG_ENABLE_WARNINGS   FALSE
+#define USBHUVC_DEBUG_ENABLE_ERRORS     FALSE
+
+#include "osal.h"
+#include "hal_usbh.h"
+
+#endif /* HAL_H */
@@ -0,0 +1,743 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host test of the USB host UVC driver frame assembler: synthetic ISO
+ * packet traces are replayed through the driver, the payload is received
+ * in place in the frame buffers and the bytes overwritten by the next
+ * payload header are restored. The stream statistics are checked on the
+ * same traces, then the status messages and the work RAM across stream
+ * stops. The USB host core and the camera are emulated by
+ * uvc_emulator.c. Run with "make check".
+ */
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "uvc_emulator.h"
+
+/* The driver is built here to reach its load and init functions.*/
+#include "hal_usbh_uvc.c"
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+#define TEST_MIN_EP_SIZE      1000U
+#define TEST_MPS              1020U
+#define TEST_ALTERNATE        2U
+#define TEST_FRAMES           3U
+#define TEST_FRAME_SIZE       40000U
+#define TEST_GUARD            64U
+#define TEST_GUARD_BYTE       0xA5U
+#define TEST_REFS             8U
+#define TEST_TRANSFER_TICKS   10U
+
+#define check(c) do {                                                       \
+  if (!(c)) {                                                               \
+    printf("  failed at line %d: %s\n", __LINE__, #c);                     \
+    failures++;                                                             \
+  }                                                                         \
+} while (0)
+
+/*
+ * Packet trace of one frame.
+ */
+typedef struct {
+  uint8_t       hlen;           /* payload header length, 0 for 2 or 12 */
+  int           skip;           /* packets lost before the stream is joined */
+  bool          drop_eof;       /* the packet with EOF is lost */
+  int           err_pkt;        /* packet with the ERR bit, -1 for none */
+  int           urb_err_pkt;    /* packet lost with a URB error, -1 for none */
+  int           bad_pkt;        /* packet followed by one with a bad header */
+} trace_t;
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+/*
+ * Camera function: VC interface with its interrupt endpoint, VS interface
+ * with alternate settings of 512 and 1020 bytes isochronous endpoints.
+ */
+static const uint8_t camera[] = {
+  /* interface association */
+  8, USBH_DT_INTERFACE_ASSOCIATION, 0, 2, 0x0e, 0x03, 0x00, 0,
+  /* VC interface */
+  9, USBH_DT_INTERFACE, 0, 0, 1, 0x0e, 0x01, 0x00, 0,
+  13, 0x24, 0x01, 0x10, 0x01, 13, 0, 0x80, 0x8d, 0x5b, 0x00, 1, 1,
+  7, USBH_DT_ENDPOINT, 0x83, 0x03, 16, 0, 8,
+  /* VS interface */
+  9, USBH_DT_INTERFACE, 1, 0, 0, 0x0e, 0x02, 0x00, 0,
+  14, 0x24, 0x01, 1, 14, 0, 0x81, 0, 0, 0, 0, 0, 0, 0,
+  9, USBH_DT_INTERFACE, 1, 1, 1, 0x0e, 0x02, 0x00, 0,
+  7, USBH_DT_ENDPOINT, 0x81, 0x05, 0x00, 0x02, 1,
+  9, USBH_DT_INTERFACE, 1, TEST_ALTERNATE, 1, 0x0e, 0x02, 0x00, 0,
+  7, USBH_DT_ENDPOINT, 0x81, 0x05, TEST_MPS & 0xff, TEST_MPS >> 8, 1,
+  /* the descriptor iterators read the length byte past the last one */
+  0
+};
+
+static usbh_device_t device;
+static USBHUVCDriver *const uvcdp = &USBHUVCD[0];
+static uint8_t frame_buffers[TEST_FRAMES][TEST_FRAME_SIZE + TEST_GUARD];
+static usbhuvc_frame_t frames[TEST_FRAMES];
+static uint8_t refs[TEST_REFS][TEST_FRAME_SIZE * 2];
+static uint32_t ref_lengths[TEST_REFS];
+static uint32_t seed = 12345U;
+static uint8_t fid;
+static unsigned in_place, scratch;
+static unsigned failures;
+
+static const trace_t clean = {12, 0, false, -1, -1, -1};
+static const trace_t mixed = {0, 0, false, -1, -1, -1};
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static uint32_t rnd(void) {
+
+  seed = seed * 1103515245U + 12345U;
+  return seed >> 8;
+}
+
+/*
+ * ISO packet written where the URB points, in a frame buffer when the
+ * driver receives in place or in the work RAM.
+ */
+static void deliver(const uint8_t *pkt, uint32_t len,
+                    usbh_urbstatus_t status) {
+  const uint8_t *const buff = emu.pending_iso->buff;
+  const uint32_t window = emu.pending_iso->requestedLength;
+  bool inside = false;
+  unsigned i;
+
+  if (buff == uvcdp->mp_data_buffer) {
+    scratch++;
+  } else {
+    for (i = 0; i < TEST_FRAMES; i++) {
+      if ((buff >= frame_buffers[i]) &&
+          (buff + window <= frame_buffers[i] + TEST_FRAME_SIZE))
+        inside = true;
+    }
+    check(inside);
+    in_place++;
+  }
+  emuComplete(USBH_EPTYPE_ISO, pkt, len, status);
+}
+
+/*
+ * Sends reference frame k of len bytes split in ISO packets, with random
+ * short packets, empty transfers and header-only packets.
+ */
+static void send_frame(unsigned k, uint32_t len, const trace_t *t) {
+  uint8_t pkt[TEST_MPS], bad[TEST_MPS];
+  uint32_t off = 0;
+  uint32_t i;
+  int n = 0;
+
+  for (i = 0; i < len; i++)
+    refs[k][i] = (uint8_t)rnd();
+  ref_lengths[k] = len;
+
+  do {
+    const uint8_t hlen = t->hlen ? t->hlen : ((rnd() & 1) ? 12 : 2);
+    uint32_t sz = TEST_MPS - hlen;
+    bool eof;
+
+    if (rnd() % 5 == 0)
+      sz = rnd() % sz;
+    if (sz > len - off)
+      sz = len - off;
+    eof = (off + sz == len);
+
+    pkt[0] = hlen;
+    pkt[1] = UVC_HDR_EOH | fid | (eof ? UVC_HDR_EOF : 0);
+    if (hlen == 12) {
+      const uint32_t pts = 1000U + k;
+      const uint32_t stc = 5000U + k + n;
+      const uint16_t sof = k;
+
+      pkt[1] |= UVC_HDR_PT | UVC_HDR_SCR;
+      memcpy(&pkt[2], &pts, 4);
+      memcpy(&pkt[6], &stc, 4);
+      memcpy(&pkt[10], &sof, 2);
+    }
+    if (n == t->err_pkt)
+      pkt[1] |= UVC_HDR_ERR;
+    memcpy(&pkt[hlen], &refs[k][off], sz);
+
+    if ((n >= t->skip) && !(eof && t->drop_eof)) {
+      if (n == t->urb_err_pkt)
+        deliver(pkt, 0, USBH_URBSTATUS_ERROR);
+      else
+        deliver(pkt, hlen + sz, USBH_URBSTATUS_OK);
+    }
+    if (n == t->bad_pkt) {
+      memset(bad, 0xEE, sizeof(bad));
+      bad[0] = 0;
+      deliver(bad, sizeof(bad), USBH_URBSTATUS_OK);
+    }
+    off += sz;
+    n++;
+
+    if (rnd() % 7 == 0)
+      deliver(pkt, 0, USBH_URBSTATUS_OK);
+  } while (off < len);
+
+  if (rnd() % 3 == 0) {
+    pkt[0] = 2;
+    pkt[1] = UVC_HDR_EOH | fid;
+    deliver(pkt, 2, USBH_URBSTATUS_OK);
+  }
+  fid ^= UVC_HDR_FID;
+}
+
+static void start(void) {
+
+  check(usbhuvcStreamStart(uvcdp, TEST_MIN_EP_SIZE) == HAL_SUCCESS);
+  check(emu.alternate == TEST_ALTERNATE);
+  check(emu.pending_iso != NULL);
+}
+
+static void stop(void) {
+
+  check(usbhuvcStreamStop(uvcdp) == HAL_SUCCESS);
+  check(emu.alternate == 0);
+  check(emu.pending_iso == NULL);
+}
+
+static usbhuvc_frame_t *fetch(void) {
+  msg_t msg;
+
+  if (usbhuvcLockAndFetch(uvcdp, &msg, TIME_IMMEDIATE) != MSG_OK)
+    return NULL;
+  usbhuvcUnlock(uvcdp);
+  check(((usbhuvc_message_base_t *)msg)->type == USBHUVC_MESSAGETYPE_FRAME);
+  return (usbhuvc_frame_t *)msg;
+}
+
+/*
+ * The first frame after the start can't be told whole, it is only used to
+ * sync on FID.
+ */
+static void sync_fid(void) {
+
+  send_frame(TEST_REFS - 1, 3000, &clean);
+  check(fetch() == NULL);
+}
+
+static unsigned busy_frames(void) {
+  unsigned i, n = 0;
+
+  for (i = 0; i < TEST_FRAMES; i++) {
+    if (frames[i].busy)
+      n++;
+  }
+  return n;
+}
+
+static bool guards_ok(void) {
+  unsigned i, j;
+
+  for (i = 0; i < TEST_FRAMES; i++) {
+    for (j = 0; j < TEST_GUARD; j++) {
+      if (frame_buffers[i][TEST_FRAME_SIZE + j] != TEST_GUARD_BYTE)
+        return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Frame holds reference k with the flags, PTS and SCR aside.
+ */
+static bool frame_ok(const usbhuvc_frame_t *f, unsigned k, uint8_t flags) {
+  const uint8_t mask = USBHUVC_FRAME_FLAG_PTS | USBHUVC_FRAME_FLAG_SCR;
+
+  return (f != NULL) && f->busy && (f->datalen == ref_lengths[k]) &&
+         (memcmp(f->buf, refs[k], f->datalen) == 0) &&
+         ((f->flags & ~mask) == flags) && guards_ok();
+}
+
+static uint16_t pool_used(void) {
+  usbhuvc_stats_t stats;
+
+  usbhuvcGetStats(uvcdp, &stats, false);
+  return stats.pool_used;
+}
+
+/*
+ * Frees or releases every message in the mailbox.
+ */
+static unsigned drain(void) {
+  msg_t msg;
+  unsigned n = 0;
+
+  while (usbhuvcLockAndFetch(uvcdp, &msg, TIME_IMMEDIATE) == MSG_OK) {
+    const uint16_t type = ((usbhuvc_message_base_t *)msg)->type;
+
+    if (type == USBHUVC_MESSAGETYPE_DATA)
+      usbhuvcFreeDataMessage(uvcdp, (usbhuvc_message_data_t *)msg);
+    else if (type == USBHUVC_MESSAGETYPE_FRAME)
+      usbhuvcReleaseFrame(uvcdp, (usbhuvc_frame_t *)msg);
+    usbhuvcUnlock(uvcdp);
+    n++;
+  }
+  return n;
+}
+
+/*
+ * One transfer each 1ms, the payload content is not checked.
+ */
+static void transfer(uint32_t len, uint8_t info, usbh_urbstatus_t status,
+                     bool consume) {
+  uint8_t pkt[TEST_MPS];
+
+  memset(pkt, 0x5A, len);
+  if (len >= 2) {
+    pkt[0] = 2;
+    pkt[1] = info;
+  }
+  emu.now += TEST_TRANSFER_TICKS;
+  emuComplete(USBH_EPTYPE_ISO, pkt, len, status);
+  if (consume)
+    drain();
+}
+
+/*
+ * Frame of n full packets, the last with EOF, then idle header-only
+ * transfers.
+ */
+static void stream_frame(unsigned n, unsigned idle, bool consume) {
+  unsigned i;
+
+  for (i = 0; i < n; i++) {
+    transfer(TEST_MPS, UVC_HDR_EOH | fid | ((i == n - 1) ? UVC_HDR_EOF : 0),
+             USBH_URBSTATUS_OK, consume);
+  }
+  for (i = 0; i < idle; i++)
+    transfer(2, UVC_HDR_EOH | fid, USBH_URBSTATUS_OK, consume);
+  fid ^= UVC_HDR_FID;
+}
+
+/*
+ ******************************************************************************
+ * TESTS
+ ******************************************************************************
+ */
+
+/*
+ * Clean streams with 12 byte and mixed 2/12 byte headers, the payload is
+ * received in place and the data under the next header restored.
+ */
+static void test_clean(void) {
+  usbhuvc_frame_t *f;
+  unsigned k;
+
+  printf("clean stream\n");
+  start();
+  sync_fid();
+  in_place = scratch = 0;
+  for (k = 0; k < 200; k++) {
+    send_frame(k % TEST_REFS, 5000 + rnd() % 30000, &clean);
+    f = fetch();
+    check(frame_ok(f, k % TEST_REFS, 0));
+    check((f != NULL) && (f->seq == k) && (f->dropped == 0));
+    check((f != NULL) && (f->pts == 1000U + k % TEST_REFS) &&
+          (f->scr_sof == k % TEST_REFS));
+    if (f != NULL)
+      usbhuvcReleaseFrame(uvcdp, f);
+  }
+  for (k = 0; k < 200; k++) {
+    send_frame(k % TEST_REFS, 5000 + rnd() % 30000, &mixed);
+    f = fetch();
+    check(frame_ok(f, k % TEST_REFS, 0));
+    if (f != NULL)
+      usbhuvcReleaseFrame(uvcdp, f);
+  }
+  check(fetch() == NULL);
+  check(busy_frames() == 0);
+  printf("  %u packets in place, %u through the work RAM\n",
+         in_place, scratch);
+  check(in_place > 10 * scratch);
+  stop();
+}
+
+/*
+ * Lost packets, ERR bit, transfer errors and overflow.
+ */
+static void test_errors(void) {
+  const trace_t join = {12, 5, false, -1, -1, -1};
+  const trace_t no_eof = {12, 0, true, -1, -1, -1};
+  const trace_t err = {12, 0, false, 3, -1, -1};
+  const trace_t urb_err = {12, 0, false, -1, 4, -1};
+  const trace_t bad = {12, 0, false, -1, -1, 6};
+  usbhuvc_frame_t *f;
+
+  printf("errors\n");
+  start();
+
+  /* joined mid-frame, the partial frame is not delivered */
+  send_frame(0, 20000, &join);
+  send_frame(1, 20000, &clean);
+  f = fetch();
+  check(frame_ok(f, 1, 0));
+  check(fetch() == NULL);
+  usbhuvcReleaseFrame(uvcdp, f);
+
+  /* EOF lost, the frame ends on the FID toggle */
+  send_frame(2, 20000, &no_eof);
+  send_frame(3, 20000, &clean);
+  f = fetch();
+  check((f != NULL) && (f->flags & USBHUVC_FRAME_FLAG_INCOMPLETE) &&
+        (f->datalen < ref_lengths[2]) &&
+        (memcmp(f->buf, refs[2], f->datalen) == 0));
+  usbhuvcReleaseFrame(uvcdp, f);
+  f = fetch();
+  check(frame_ok(f, 3, 0));
+  usbhuvcReleaseFrame(uvcdp, f);
+
+  /* ERR bit in a payload header */
+  send_frame(4, 20000, &err);
+  f = fetch();
+  check(frame_ok(f, 4, USBHUVC_FRAME_FLAG_ERROR));
+  usbhuvcReleaseFrame(uvcdp, f);
+
+  /* packet lost in a failed transfer */
+  send_frame(5, 20000, &urb_err);
+  f = fetch();
+  check((f != NULL) && (f->flags == (USBHUVC_FRAME_FLAG_ERROR |
+                                     USBHUVC_FRAME_FLAG_PTS |
+                                     USBHUVC_FRAME_FLAG_SCR)));
+  usbhuvcReleaseFrame(uvcdp, f);
+
+  /* packet with a bad header dropped, the data it overwrote put back */
+  send_frame(5, 20000, &bad);
+  f = fetch();
+  check(frame_ok(f, 5, USBHUVC_FRAME_FLAG_ERROR));
+  usbhuvcReleaseFrame(uvcdp, f);
+
+  /* frame larger than the buffer, truncated and nothing written past it */
+  send_frame(6, TEST_FRAME_SIZE + 3000, &clean);
+  f = fetch();
+  check((f != NULL) && (f->flags & USBHUVC_FRAME_FLAG_OVERFLOW) &&
+        (f->datalen == TEST_FRAME_SIZE) &&
+        (memcmp(f->buf, refs[6], TEST_FRAME_SIZE) == 0));
+  check(guards_ok());
+  usbhuvcReleaseFrame(uvcdp, f);
+  send_frame(7, 100, &clean);
+  f = fetch();
+  check(frame_ok(f, 7, 0));
+  usbhuvcReleaseFrame(uvcdp, f);
+
+  check(busy_frames() == 0);
+  stop();
+}
+
+/*
+ * The application holds every buffer, frames are dropped and reported.
+ */
+static void test_held(void) {
+  usbhuvc_frame_t *held[TEST_FRAMES];
+  usbhuvc_frame_t *f;
+  uint32_t seq;
+  unsigned i;
+
+  printf("all frames held\n");
+  start();
+  sync_fid();
+  for (i = 0; i < TEST_FRAMES; i++) {
+    send_frame(i, 10000, &clean);
+    held[i] = fetch();
+    check(frame_ok(held[i], i, 0));
+  }
+  for (i = 0; i < 4; i++)
+    send_frame(TEST_FRAMES, 10000, &clean);
+  check(fetch() == NULL);
+  for (i = 0; i < TEST_FRAMES; i++)
+    check(frame_ok(held[i], i, 0));
+
+  seq = held[TEST_FRAMES - 1]->seq;
+  usbhuvcReleaseFrame(uvcdp, held[0]);
+  send_frame(TEST_FRAMES, 10000, &clean);
+  f = fetch();
+  check(frame_ok(f, TEST_FRAMES, 0));
+  check((f != NULL) && (f->dropped == 4) && (f->seq == seq + 5));
+  usbhuvcReleaseFrame(uvcdp, f);
+  for (i = 1; i < TEST_FRAMES; i++)
+    usbhuvcReleaseFrame(uvcdp, held[i]);
+  check(pool_used() == 0);
+  stop();
+}
+
+/*
+ * A frame held by the application across a stream restart stays busy, the
+ * frames posted but not fetched and the one being filled are reclaimed.
+ */
+static void test_restart(void) {
+  usbhuvc_frame_t *held, *f[TEST_FRAMES];
+  const trace_t no_eof = {12, 0, true, -1, -1, -1};
+  unsigned i;
+
+  printf("restart with a frame held\n");
+  start();
+  sync_fid();
+  send_frame(0, 10000, &clean);
+  held = fetch();
+  check(frame_ok(held, 0, 0));
+  send_frame(1, 10000, &clean);
+  send_frame(2, 10000, &no_eof);
+  check(busy_frames() == 3);
+  stop();
+  check(busy_frames() == 1);
+  check(frame_ok(held, 0, 0));
+
+  start();
+  check(fetch() == NULL);
+  check(pool_used() == 1);
+  sync_fid();
+
+  /* the two free buffers are filled, the held one is never reused */
+  for (i = 0; i < TEST_FRAMES - 1; i++) {
+    send_frame(3 + i, 10000, &clean);
+    f[i] = fetch();
+    check(frame_ok(f[i], 3 + i, 0));
+    check(f[i] != held);
+  }
+  send_frame(5, 10000, &clean);
+  check(fetch() == NULL);
+  check(frame_ok(held, 0, 0));
+
+  usbhuvcReleaseFrame(uvcdp, held);
+  send_frame(6, 10000, &clean);
+  f[2] = fetch();
+  check(frame_ok(f[2], 6, 0));
+  check((f[2] != NULL) && (f[2]->dropped == 1));
+  for (i = 0; i < TEST_FRAMES; i++) {
+    if (f[i] != NULL)
+      usbhuvcReleaseFrame(uvcdp, f[i]);
+  }
+  check(pool_used() == 0);
+  stop();
+}
+
+/*
+ * Statistics of a packet mode stream: rates, frame intervals and jitter,
+ * data pool exhaustion and invalid transfers.
+ */
+static void test_stats_packets(void) {
+  const uint32_t data_sz =
+      (TEST_MPS + sizeof(usbhuvc_message_data_t) + 3) & ~3;
+  const uint32_t datapackets = HAL_USBHUVC_WORK_RAM_SIZE / data_sz;
+  const uint8_t bad[4] = {12, UVC_HDR_EOH, 0, 0};
+  usbhuvc_stats_t stats;
+  unsigned k;
+
+  printf("statistics, packet mode\n");
+  check(usbhuvcSetFrames(uvcdp, NULL, 0) == HAL_SUCCESS);
+  start();
+
+  /* 30 frames of 20 packets each 33ms, the consumer keeps up */
+  for (k = 0; k < 30; k++)
+    stream_frame(20, 13, true);
+  usbhuvcGetStats(uvcdp, &stats, true);
+  check(stats.elapsed == 30 * 33 * TEST_TRANSFER_TICKS);
+  check(stats.packets == 30 * 33);
+  check(stats.bytes == 30 * 20 * (TEST_MPS - 2));
+  check(stats.frames == 30);
+  check(usbhuvcStatsRate(&stats, stats.frames) == 30);
+  check(usbhuvcStatsRate(&stats, stats.packets) == 1000);
+  check((stats.interval_min == 33 * TEST_TRANSFER_TICKS) &&
+        (stats.interval_max == 33 * TEST_TRANSFER_TICKS));
+  check(stats.jitter[0] == 28);
+  check((stats.drop_pool == 0) && (stats.drop_mailbox == 0) &&
+        (stats.drop_header == 0) && (stats.drop_urb == 0));
+  check((stats.pool_used == 1) && (stats.mb_used == 0));
+
+  /* the consumer stalls for a frame, the data pool runs out */
+  stream_frame(30, 3, false);
+  usbhuvcGetStats(uvcdp, &stats, false);
+  check(stats.pool_hwm == datapackets);
+  check(stats.mb_used == datapackets - 1);
+  check(stats.drop_pool == 30 - (datapackets - 1));
+  check(drain() == datapackets - 1);
+
+  /* EOF to EOF 23, 33, 38 and 33ms: deviations of 10, 5 and 5ms */
+  stream_frame(20, 13, true);
+  stream_frame(20, 18, true);
+  stream_frame(20, 13, true);
+  stream_frame(20, 30, true);
+  usbhuvcGetStats(uvcdp, &stats, true);
+  check(stats.frames == 5);
+  check((stats.interval_min == 23 * TEST_TRANSFER_TICKS) &&
+        (stats.interval_max == 38 * TEST_TRANSFER_TICKS));
+  check((stats.jitter[3] == 2) && (stats.jitter[4] == 1));
+
+  /* failed transfer, header longer than the packet, one byte transfer */
+  transfer(0, 0, USBH_URBSTATUS_ERROR, true);
+  emuComplete(USBH_EPTYPE_ISO, bad, sizeof(bad), USBH_URBSTATUS_OK);
+  transfer(1, 0, USBH_URBSTATUS_OK, true);
+  usbhuvcGetStats(uvcdp, &stats, true);
+  check((stats.drop_urb == 1) && (stats.drop_header == 2));
+  check((stats.packets == 0) && (stats.pool_used == 1));
+  stop();
+}
+
+/*
+ * Statistics of a frame mode stream while the application holds every
+ * frame buffer.
+ */
+static void test_stats_frames(void) {
+  usbhuvc_stats_t stats;
+  unsigned k;
+
+  printf("statistics, frame mode\n");
+  check(usbhuvcSetFrames(uvcdp, frames, TEST_FRAMES) == HAL_SUCCESS);
+  start();
+  stream_frame(20, 13, true);
+  for (k = 0; k < 10; k++)
+    stream_frame(20, 13, true);
+  for (k = 0; k < 8; k++)
+    stream_frame(20, 13, false);
+  usbhuvcGetStats(uvcdp, &stats, false);
+  check(stats.frames == 18);
+  check((stats.pool_hwm == TEST_FRAMES) && (stats.pool_used == TEST_FRAMES));
+  check(stats.drop_frames == 8 - TEST_FRAMES);
+  check((stats.mb_hwm == TEST_FRAMES) && (stats.mb_used == TEST_FRAMES));
+  check(drain() == TEST_FRAMES);
+  check(pool_used() == 0);
+  stop();
+}
+
+/*
+ * Status interrupt of the camera, bStatusType 1 (VideoControl interface)
+ * with the event in bOriginator.
+ */
+static void status(uint8_t event) {
+  const uint8_t pkt[4] = {1, event, 0, 0};
+
+  emuComplete(USBH_EPTYPE_INT, pkt, sizeof(pkt), USBH_URBSTATUS_OK);
+}
+
+static unsigned fetch_status(uint8_t first) {
+  msg_t m;
+  unsigned n = 0;
+
+  while (usbhuvcFetchStatus(uvcdp, &m, TIME_IMMEDIATE) == MSG_OK) {
+    usbhuvc_message_status_t *const msg = (usbhuvc_message_status_t *)m;
+
+    check(msg->type == USBHUVC_MESSAGETYPE_STATUS);
+    check((msg->length == 4) && (msg->data[1] == (uint8_t)(first + n)));
+    usbhuvcFreeStatusMessage(uvcdp, msg);
+    n++;
+  }
+  return n;
+}
+
+/*
+ * Status messages are not purged by a stream stop, the work RAM is
+ * allocated once and freed on unload.
+ */
+static void test_status(void) {
+  const unsigned allocs = emu.heap_allocs;
+  const void *const ram = uvcdp->mp_data_buffer;
+  usbhuvc_stats_t stats;
+  unsigned k;
+
+  printf("status and work RAM across stops\n");
+  check(ram != NULL);
+  for (k = 0; k < 20; k++) {
+    start();
+    sync_fid();
+    status(k);
+    send_frame(0, 10000, &clean);
+    stop();
+    check(fetch_status(k) == 1);
+    check(uvcdp->mp_data_buffer == ram);
+  }
+  check((emu.heap_allocs == allocs) && (emu.heap_frees == 0));
+
+  /* the status pool minus the buffer of the pending URB can be queued */
+  start();
+  for (k = 0; k < HAL_USBHUVC_STATUS_PACKETS_COUNT; k++)
+    status(k);
+  usbhuvcGetStats(uvcdp, &stats, false);
+  check(stats.drop_status == 1);
+  stop();
+  check(fetch_status(0) == HAL_USBHUVC_STATUS_PACKETS_COUNT - 1);
+  status(7);
+  check(fetch_status(7) == 1);
+
+  /* also received while not streaming */
+  status(8);
+  status(9);
+  check(fetch_status(8) == 2);
+
+  _uvc_unload((usbh_baseclassdriver_t *)uvcdp);
+  check(uvcdp->state == USBHUVC_STATE_STOP);
+  check((emu.pending_int == NULL) && (emu.pending_iso == NULL));
+  check((emu.heap_frees == 1) && (uvcdp->mp_data_buffer == NULL));
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+int main(void) {
+  unsigned i;
+
+  emuInit();
+  _uvc_init();
+  check(_uvc_load(&device, camera, sizeof(camera) - 1) ==
+        (usbh_baseclassdriver_t *)uvcdp);
+  /* the core records the device after load */
+  uvcdp->dev = &device;
+  check(usbhuvcCommit(uvcdp) == HAL_SUCCESS);
+  check(uvcdp->state == USBHUVC_STATE_READY);
+
+  for (i = 0; i < TEST_FRAMES; i++) {
+    usbhuvcFrameObjectInit(&frames[i], frame_buffers[i], TEST_FRAME_SIZE);
+    memset(&frame_buffers[i][TEST_FRAME_SIZE], TEST_GUARD_BYTE, TEST_GUARD);
+  }
+  check(usbhuvcSetFrames(uvcdp, frames, TEST_FRAMES) == HAL_SUCCESS);
+
+  test_clean();
+  test_errors();
+  test_held();
+  test_restart();
+  test_stats_packets();
+  test_stats_frames();
+  test_status();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}
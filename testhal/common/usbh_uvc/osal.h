@@ -0,0 +1,168 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host build replacement of osal.h and of the kernel objects used by the
+ * UVC driver. There is a single thread, the ISO and interrupt completions
+ * are run by the test; systime_t is driven by the emulator.
+ */
+
+#ifndef OSAL_H
+#define OSAL_H
+
+#include <stdlib.h>
+#include <assert.h>
+
+typedef intptr_t                msg_t;
+typedef uint32_t                systime_t;
+typedef uint32_t                sysinterval_t;
+typedef struct osal_waiter      *thread_reference_t;
+
+#define MSG_OK                  ((msg_t)0)
+#define MSG_TIMEOUT             ((msg_t)-1)
+#define MSG_RESET               ((msg_t)-2)
+
+#define TIME_IMMEDIATE          ((sysinterval_t)0)
+#define OSAL_ST_FREQUENCY       10000U
+#define OSAL_MS2I(msec)         ((sysinterval_t)((msec) * 10U))
+
+#define osalDbgCheck(c)         assert(c)
+#define osalDbgAssert(c, r)     assert(c)
+#define osalDbgCheckClassI()    (void)0
+#define osalDbgCheckClassS()    (void)0
+#define osalSysLock()           (void)0
+#define osalSysUnlock()         (void)0
+#define osalOsRescheduleS()     (void)0
+#define chHeapAlloc(h, size)    emuHeapAlloc(size)
+#define chHeapFree(p)           emuHeapFree(p)
+
+/*
+ * Memory pool, mailbox and mutex, never waiting.
+ */
+typedef struct {
+  void          *next;
+  size_t        size;
+} memory_pool_t;
+
+typedef struct {
+  msg_t         *buffer;
+  size_t        size;
+  size_t        rd;
+  size_t        cnt;
+  bool          reset;
+} mailbox_t;
+
+typedef struct {
+  int           cnt;
+} mutex_t;
+
+static inline void chPoolObjectInit(memory_pool_t *mp, size_t size,
+                                    void *provider) {
+  (void)provider;
+  mp->next = NULL;
+  mp->size = size;
+}
+
+static inline void chPoolFreeI(memory_pool_t *mp, void *objp) {
+  *(void **)objp = mp->next;
+  mp->next = objp;
+}
+
+static inline void *chPoolAllocI(memory_pool_t *mp) {
+  void *objp = mp->next;
+
+  if (objp != NULL)
+    mp->next = *(void **)objp;
+  return objp;
+}
+
+#define chPoolFree(mp, objp)    chPoolFreeI(mp, objp)
+#define chPoolAlloc(mp)         chPoolAllocI(mp)
+
+static inline void chMBObjectInit(mailbox_t *mbp, msg_t *buf, size_t n) {
+  mbp->buffer = buf;
+  mbp->size = n;
+  mbp->rd = 0;
+  mbp->cnt = 0;
+  mbp->reset = false;
+}
+
+static inline msg_t chMBPostI(mailbox_t *mbp, msg_t msg) {
+  if (mbp->reset)
+    return MSG_RESET;
+  if (mbp->cnt == mbp->size)
+    return MSG_TIMEOUT;
+  mbp->buffer[(mbp->rd + mbp->cnt++) % mbp->size] = msg;
+  return MSG_OK;
+}
+
+static inline msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
+  if (mbp->reset)
+    return MSG_RESET;
+  if (mbp->cnt == 0)
+    return MSG_TIMEOUT;
+  *msgp = mbp->buffer[mbp->rd];
+  mbp->rd = (mbp->rd + 1) % mbp->size;
+  mbp->cnt--;
+  return MSG_OK;
+}
+
+#define chMBFetchTimeoutS(mbp, msgp, timeout)                               \
+  ((void)(timeout), chMBFetchI(mbp, msgp))
+#define chMBFetchTimeout(mbp, msgp, timeout)                                \
+  ((void)(timeout), chMBFetchI(mbp, msgp))
+
+static inline size_t chMBGetUsedCountI(const mailbox_t *mbp) {
+  return mbp->cnt;
+}
+
+static inline void chMBResetI(mailbox_t *mbp) {
+  mbp->rd = 0;
+  mbp->cnt = 0;
+  mbp->reset = true;
+}
+
+static inline void chMBResumeX(mailbox_t *mbp) {
+  mbp->reset = false;
+}
+
+static inline void chMtxObjectInit(mutex_t *mp) {
+  mp->cnt = 0;
+}
+
+static inline void chMtxLockS(mutex_t *mp) {
+  mp->cnt++;
+}
+
+static inline void chMtxUnlockS(mutex_t *mp) {
+  assert(mp->cnt > 0);
+  mp->cnt--;
+}
+
+#define chMtxLock(mp)           chMtxLockS(mp)
+#define chMtxUnlock(mp)         chMtxUnlockS(mp)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  systime_t osalOsGetSystemTimeX(void);
+  void *emuHeapAlloc(size_t size);
+  void emuHeapFree(void *p);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_H */
@@ -0,0 +1,225 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host emulation of the USB host core calls made by the UVC driver and of
+ * the camera endpoints. Control requests always succeed, URBs wait on
+ * their endpoint until the test completes them with emuComplete(), as the
+ * LLD interrupt handler does.
+ */
+
+#include "hal.h"
+#include "usbh/internal.h"
+#include "uvc_emulator.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL VARIABLES
+ ******************************************************************************
+ */
+
+uvc_emulator_t emu;
+
+/*
+ ******************************************************************************
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+static usbh_urb_t **pending(usbh_eptype_t type) {
+
+  assert((type == USBH_EPTYPE_INT) || (type == USBH_EPTYPE_ISO));
+  return (type == USBH_EPTYPE_INT) ? &emu.pending_int : &emu.pending_iso;
+}
+
+static void complete(usbh_urb_t *urb, usbh_urbstatus_t status) {
+
+  urb->status = status;
+  if (urb->callback != NULL)
+    urb->callback(urb);
+}
+
+/*
+ ******************************************************************************
+ * OSAL
+ ******************************************************************************
+ */
+
+systime_t osalOsGetSystemTimeX(void) {
+
+  return emu.now;
+}
+
+void *emuHeapAlloc(size_t size) {
+
+  emu.heap_allocs++;
+  return calloc(1, size);
+}
+
+void emuHeapFree(void *p) {
+
+  emu.heap_frees++;
+  free(p);
+}
+
+/*
+ ******************************************************************************
+ * USB HOST CORE
+ ******************************************************************************
+ */
+
+bool _usbh_match_descriptor(const uint8_t *descriptor, uint16_t rem,
+                            int16_t type, int16_t _class, int16_t subclass,
+                            int16_t protocol) {
+  const usbh_ia_descriptor_t *const desc =
+      (const usbh_ia_descriptor_t *)descriptor;
+
+  /* the UVC driver only matches its interface association */
+  if ((rem < USBH_DT_INTERFACE_ASSOCIATION_SIZE) ||
+      (descriptor[1] != USBH_DT_INTERFACE_ASSOCIATION) ||
+      (type != USBH_DT_INTERFACE_ASSOCIATION))
+    return HAL_FAILED;
+  if ((desc->bFunctionClass != _class) ||
+      (desc->bFunctionSubClass != subclass) ||
+      (desc->bFunctionProtocol != protocol))
+    return HAL_FAILED;
+  return HAL_SUCCESS;
+}
+
+usbh_urbstatus_t usbhControlRequest(usbh_device_t *dev, uint8_t bmRequestType,
+                                    uint8_t bRequest, uint16_t wValue,
+                                    uint16_t wIndex, uint16_t wLength,
+                                    uint8_t *buff) {
+
+  (void)dev;
+  (void)bRequest;
+  (void)wValue;
+  (void)wIndex;
+  emu.ctrl_requests++;
+  if ((bmRequestType & 0x80) != 0)
+    memset(buff, 0, wLength);
+  return USBH_URBSTATUS_OK;
+}
+
+bool usbhStdReqSetInterface(usbh_device_t *dev, uint8_t bInterfaceNumber,
+                            uint8_t bAlternateSetting) {
+
+  (void)dev;
+  (void)bInterfaceNumber;
+  emu.alternate = bAlternateSetting;
+  return HAL_SUCCESS;
+}
+
+void usbhEPObjectInit(usbh_ep_t *ep, usbh_device_t *dev,
+                      const usbh_endpoint_descriptor_t *desc) {
+
+  memset(ep, 0, sizeof(*ep));
+  ep->device = dev;
+  ep->wMaxPacketSize = desc->wMaxPacketSize;
+  ep->address = desc->bEndpointAddress & 0x0F;
+  ep->type = (usbh_eptype_t)(desc->bmAttributes & 0x03);
+  ep->in = (desc->bEndpointAddress & 0x80) ? TRUE : FALSE;
+  ep->bInterval = desc->bInterval;
+  ep->status = USBH_EPSTATUS_CLOSED;
+}
+
+void usbhURBObjectInit(usbh_urb_t *urb, usbh_ep_t *ep,
+                       usbh_completion_cb callback, void *user, void *buff,
+                       uint32_t len) {
+
+  memset(urb, 0, sizeof(*urb));
+  urb->ep = ep;
+  urb->callback = callback;
+  urb->userData = user;
+  urb->buff = buff;
+  urb->requestedLength = len;
+  urb->status = USBH_URBSTATUS_INITIALIZED;
+}
+
+void usbhURBObjectResetI(usbh_urb_t *urb) {
+
+  assert(urb->status != USBH_URBSTATUS_PENDING);
+  urb->actualLength = 0;
+  urb->status = USBH_URBSTATUS_INITIALIZED;
+}
+
+void usbhURBSubmitI(usbh_urb_t *urb) {
+  usbh_urb_t **const p = pending(urb->ep->type);
+
+  assert(urb->status == USBH_URBSTATUS_INITIALIZED);
+  if (urb->ep->status != USBH_EPSTATUS_OPEN) {
+    complete(urb, USBH_URBSTATUS_DISCONNECTED);
+    return;
+  }
+  assert(*p == NULL);
+  urb->status = USBH_URBSTATUS_PENDING;
+  *p = urb;
+}
+
+/*
+ ******************************************************************************
+ * LOW LEVEL DRIVER
+ ******************************************************************************
+ */
+
+void usbh_lld_ep_open(usbh_ep_t *ep) {
+
+  ep->status = USBH_EPSTATUS_OPEN;
+}
+
+/*
+ * Closing an endpoint cancels its pending URB.
+ */
+void usbh_lld_ep_close(usbh_ep_t *ep) {
+  usbh_urb_t **const p = pending(ep->type);
+  usbh_urb_t *const urb = *p;
+
+  ep->status = USBH_EPSTATUS_CLOSED;
+  if ((urb != NULL) && (urb->ep == ep)) {
+    *p = NULL;
+    complete(urb, USBH_URBSTATUS_CANCELLED);
+  }
+}
+
+/*
+ ******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************
+ */
+
+void emuInit(void) {
+
+  memset(&emu, 0, sizeof(emu));
+}
+
+/*
+ * Completes the URB pending on the endpoint type with a transfer of len
+ * bytes written where the URB points, as the host controller does.
+ */
+void emuComplete(usbh_eptype_t type, const uint8_t *data, uint32_t len,
+                 usbh_urbstatus_t status) {
+  usbh_urb_t **const p = pending(type);
+  usbh_urb_t *const urb = *p;
+
+  assert(urb != NULL);
+  assert(len <= urb->requestedLength);
+  *p = NULL;
+  memcpy(urb->buff, data, len);
+  urb->actualLength = len;
+  complete(urb, status);
+}
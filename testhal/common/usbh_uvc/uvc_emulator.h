@@ -0,0 +1,63 @@
+/*
+    ChibiOS - Copyright (C) 2026 ChibiOS-Contrib contributors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef UVC_EMULATOR_H
+#define UVC_EMULATOR_H
+
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+
+/*
+ * USB host core and camera emulator.
+ */
+typedef struct {
+  systime_t     now;            /* system time */
+  uint8_t       alternate;      /* last VS alternate setting selected */
+  unsigned      heap_allocs;
+  unsigned      heap_frees;
+  unsigned      ctrl_requests;
+  usbh_urb_t    *pending_int;   /* URB waiting on the interrupt endpoint */
+  usbh_urb_t    *pending_iso;   /* URB waiting on the isochronous endpoint */
+} uvc_emulator_t;
+
+/*
+ ******************************************************************************
+ * EXTERNS
+ ******************************************************************************
+ */
+
+extern uvc_emulator_t emu;
+
+/*
+ ******************************************************************************
+ * PROTOTYPES
+ ******************************************************************************
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void emuInit(void);
+  void emuComplete(usbh_eptype_t type, const uint8_t *data, uint32_t len,
+                   usbh_urbstatus_t status);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UVC_EMULATOR_H */
@@ -0,0 +1,352 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+__author__ = 'Michael D. Spradling'
+__version__ = '0.1'
+
+"""
+Generates the lookup tables used by the software CRC driver
+(os/various/crcsw.c).
+
+Without arguments the built-in CRC32/CRC16 tables header is produced. Every
+built-in table is made of 16 slices of 256 entries, slice 0 is the classic
+byte-at-a-time table, slice k holds the CRC of a byte followed by k zero
+bytes and is only compiled in when CRCSW_SLICE_BY is large enough to use it.
+
+With --preset or --width/--poly a header holding a table and a matching
+CRCConfig is produced for any other CRC, so that CRCSW_PROGRAMMABLE users
+get the table speed instead of the bit-at-a-time loop.
+"""
+
+from argparse import ArgumentParser
+from sys import exit
+
+parser = ArgumentParser(description='Generate crcsw lookup tables headers')
+parser.add_argument('-o', '--output', default='../os/various/crcsw_tables.h',
+                    type=str, help='Output header file')
+parser.add_argument('-p', '--preset', type=str,
+                    help='Catalogue CRC to generate, see --list')
+parser.add_argument('-n', '--name', type=str,
+                    help='C identifiers prefix, defaults to the preset name')
+parser.add_argument('--width', type=int, help='Polynomial size in bits')
+parser.add_argument('--poly', type=lambda x: int(x, 0),
+                    help='Polynomial, normal representation')
+parser.add_argument('--init', default=0, type=lambda x: int(x, 0),
+                    help='Initial value')
+parser.add_argument('--xorout', default=0, type=lambda x: int(x, 0),
+                    help='Final XOR value')
+parser.add_argument('--refin', action='store_true', help='Reflect data')
+parser.add_argument('--refout', action='store_true',
+                    help='Reflect final remainder')
+parser.add_argument('--slices', default=1, type=int, choices=[1, 4, 8, 16],
+                    help='Number of slices, reflected CRCs only')
+parser.add_argument('--list', action='store_true',
+                    help='List the catalogue presets')
+parser.add_argument('--check', action='store_true',
+                    help='Verify the table algorithm against the whole '
+                         'catalogue and exit')
+
+LICENSE = '''/*
+    ChibiOS - Copyright (C) 2015 Michael D. Spradling
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+'''
+
+MAX_SLICES = 16
+
+# Supported CRCSW_SLICE_BY values, slices are grouped by the smallest
+# value making use of them.
+SLICE_BY_VALUES = [1, 4, 8, 16]
+
+# Catalogue of common CRCs:
+# name: (width, poly, init, refin, refout, xorout, check)
+# The check value is the CRC of the ASCII string "123456789".
+CATALOGUE = {
+    'crc8':             (8, 0x07, 0x00, False, False, 0x00, 0xF4),
+    'crc8_maxim':       (8, 0x31, 0x00, True, True, 0x00, 0xA1),
+    'crc8_autosar':     (8, 0x2F, 0xFF, False, False, 0xFF, 0xDF),
+    'crc12_umts':       (12, 0x80F, 0x000, False, True, 0x000, 0xDAF),
+    'crc16_arc':        (16, 0x8005, 0x0000, True, True, 0x0000, 0xBB3D),
+    'crc16_ccitt_false': (16, 0x1021, 0xFFFF, False, False, 0x0000, 0x29B1),
+    'crc16_kermit':     (16, 0x1021, 0x0000, True, True, 0x0000, 0x2189),
+    'crc16_xmodem':     (16, 0x1021, 0x0000, False, False, 0x0000, 0x31C3),
+    'crc16_modbus':     (16, 0x8005, 0xFFFF, True, True, 0x0000, 0x4B37),
+    'crc16_usb':        (16, 0x8005, 0xFFFF, True, True, 0xFFFF, 0xB4C8),
+    'crc16_x25':        (16, 0x1021, 0xFFFF, True, True, 0xFFFF, 0x906E),
+    'crc24_openpgp':    (24, 0x864CFB, 0xB704CE, False, False, 0x000000,
+                         0x21CF02),
+    'crc32':            (32, 0x04C11DB7, 0xFFFFFFFF, True, True, 0xFFFFFFFF,
+                         0xCBF43926),
+    'crc32_bzip2':      (32, 0x04C11DB7, 0xFFFFFFFF, False, False,
+                         0xFFFFFFFF, 0xFC891918),
+    'crc32_mpeg2':      (32, 0x04C11DB7, 0xFFFFFFFF, False, False,
+                         0x00000000, 0x0376E6E7),
+    'crc32c':           (32, 0x1EDC6F41, 0xFFFFFFFF, True, True, 0xFFFFFFFF,
+                         0xE3069283),
+}
+
+CHECK_DATA = b'123456789'
+
+# (name, C guard, width, polynomial, entries per line, entry format)
+BUILTIN_TABLES = [
+    ('crc32_table', 'CRCSW_CRC32_TABLE', 32, 0x04C11DB7, 4, '0x{0:08x}'),
+    ('crc16_table', 'CRCSW_CRC16_TABLE', 16, 0x8005, 8, '0x{0:04X}'),
+]
+
+
+def reflect(value, width):
+    result = 0
+    for bit in range(width):
+        if value & (1 << bit):
+            result |= 1 << (width - 1 - bit)
+    return result
+
+
+def reflected_slices(width, poly, count=MAX_SLICES):
+    """Slice tables for a reflected (LSB first) CRC of the given width."""
+    rpoly = reflect(poly, width)
+    base = []
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ rpoly if crc & 1 else crc >> 1
+        base.append(crc)
+
+    slices = [base]
+    for k in range(1, count):
+        prev = slices[k - 1]
+        slices.append([(v >> 8) ^ base[v & 0xFF] for v in prev])
+    return slices
+
+
+def normal_table(width, poly):
+    """Table for a non reflected (MSB first) CRC, width must be >= 8."""
+    mask = (1 << width) - 1
+    top = 1 << (width - 1)
+    table = []
+    for i in range(256):
+        crc = i << (width - 8)
+        for _ in range(8):
+            crc = ((crc << 1) ^ poly) & mask if crc & top else (crc << 1) & mask
+        table.append(crc)
+    return table
+
+
+def table_crc(width, poly, init, refin, refout, xorout, data):
+    """Mirrors the table driven path of crc_lld_calc()."""
+    mask = (1 << width) - 1
+    if refin:
+        table = reflected_slices(width, poly, 1)[0]
+        crc = reflect(init, width)
+        for b in data:
+            crc = table[(crc ^ b) & 0xFF] ^ (crc >> 8)
+    else:
+        table = normal_table(width, poly)
+        crc = init
+        for b in data:
+            crc = table[((crc >> (width - 8)) ^ b) & 0xFF] ^ (crc << 8)
+    if refin != refout:
+        crc = reflect(crc & mask, width)
+    return (crc ^ xorout) & mask
+
+
+def bitwise_crc(width, poly, init, refin, refout, xorout, data):
+    """Mirrors the bit-at-a-time path of crc_lld_calc()."""
+    mask = (1 << width) - 1
+    crc = init
+    for b in data:
+        if refin:
+            b = reflect(b, 8)
+        crc ^= b << (width - 8)
+        for _ in range(8):
+            crc = (crc << 1) ^ poly if crc & (1 << (width - 1)) else crc << 1
+    crc &= mask
+    if refout:
+        crc = reflect(crc, width)
+    return (crc ^ xorout) & mask
+
+
+def check_catalogue():
+    failures = 0
+    for name in sorted(CATALOGUE):
+        width, poly, init, refin, refout, xorout, check = CATALOGUE[name]
+        params = (width, poly, init, refin, refout, xorout)
+        table = table_crc(*params, data=CHECK_DATA)
+        bitwise = bitwise_crc(*params, data=CHECK_DATA)
+        sliced = table
+        if refin:
+            sliced = sliced_crc(*params, data=CHECK_DATA)
+        ok = table == bitwise == sliced == check
+        failures += 0 if ok else 1
+        print('{0:20} check 0x{1:X} table 0x{2:X} bitwise 0x{3:X} {4}'.format(
+            name, check, table, bitwise, 'OK' if ok else 'FAILED'))
+    return failures
+
+
+def sliced_crc(width, poly, init, refin, refout, xorout, data, slices=4):
+    """Mirrors calc_table_sliced(), reflected CRCs only."""
+    mask = (1 << width) - 1
+    t = reflected_slices(width, poly, slices)
+    crc = reflect(init, width)
+    n = len(data) - len(data) % slices
+    for i in range(0, n, slices):
+        for k in range(slices // 4):
+            if k == 0:
+                w = crc ^ int.from_bytes(data[i:i + 4], 'little')
+                crc = 0
+            else:
+                w = int.from_bytes(data[i + 4 * k:i + 4 * k + 4], 'little')
+            base = slices - 4 * (k + 1)
+            crc ^= t[base + 3][w & 0xFF] ^ t[base + 2][(w >> 8) & 0xFF] ^ \
+                t[base + 1][(w >> 16) & 0xFF] ^ t[base][w >> 24]
+    for b in data[n:]:
+        crc = t[0][(crc ^ b) & 0xFF] ^ (crc >> 8)
+    if refin != refout:
+        crc = reflect(crc & mask, width)
+    return (crc ^ xorout) & mask
+
+
+def format_slice(values, per_line, fmt):
+    lines = []
+    for i in range(0, len(values), per_line):
+        chunk = values[i:i + per_line]
+        lines.append('    ' + ', '.join(fmt.format(v) for v in chunk))
+    return ',\n'.join(lines) + '\n'
+
+
+def format_table(name, guard, width, poly, per_line, fmt):
+    slices = reflected_slices(width, poly)
+    out = '#if ({0} == TRUE) || defined(__DOXYGEN__)\n'.format(guard)
+    out += '/**\n'
+    out += ' * @brief   CRC{0} lookup table, reflected polynomial 0x{1:X}.\n'.format(
+        width, poly)
+    out += ' */\n'
+    out += 'static const uint32_t {0}[CRCSW_SLICE_BY][256] = {{\n'.format(name)
+    for slice_by in SLICE_BY_VALUES:
+        first = SLICE_BY_VALUES[SLICE_BY_VALUES.index(slice_by) - 1] \
+            if slice_by > 1 else 0
+        if slice_by > 1:
+            out += '#if CRCSW_SLICE_BY >= {0}\n'.format(slice_by)
+        for k in range(first, slice_by):
+            out += '  {\n'
+            out += format_slice(slices[k], per_line, fmt)
+            out += '  },\n'
+        if slice_by > 1:
+            out += '#endif\n'
+    out += '};\n'
+    out += '#endif\n'
+    return out
+
+
+def generate_custom(name, width, poly, init, refin, refout, xorout, slices):
+    if not refin and width < 8:
+        print('Non reflected tables require a width of at least 8 bits')
+        exit(1)
+    if not refin and slices != 1:
+        print('Slices are only supported by reflected CRCs')
+        exit(1)
+
+    if refin:
+        table = reflected_slices(width, poly, slices)
+    else:
+        table = [normal_table(width, poly)]
+    digits = (width + 3) // 4
+    per_line = 8 if width <= 16 else 4
+    fmt = '0x{0:0' + str(digits) + 'X}'
+    guard = name.upper() + '_TABLE_H'
+
+    out = '/**\n'
+    out += ' * @file    {0}_table.h\n'.format(name)
+    out += ' * @brief   {0} lookup table for the CRC software driver.\n'.format(
+        name.upper())
+    out += ' * @note    Generated by tools/crcsw_tables.py, do not edit.\n'
+    out += ' */\n\n'
+    out += '#ifndef {0}\n'.format(guard)
+    out += '#define {0}\n\n'.format(guard)
+    out += '/**\n'
+    out += ' * @brief   {0} lookup table.\n'.format(name.upper())
+    out += ' */\n'
+    out += 'static const uint32_t {0}_table[{1}][256] = {{\n'.format(
+        name, len(table))
+    for values in table:
+        out += '  {\n'
+        out += format_slice(values, per_line, fmt)
+        out += '  },\n'
+    out += '};\n\n'
+    out += '/**\n'
+    out += ' * @brief   {0} configuration.\n'.format(name.upper())
+    out += ' */\n'
+    out += 'static const CRCConfig {0}_config = {{\n'.format(name)
+    out += '  .poly_size         = {0},\n'.format(width)
+    out += '  .poly              = 0x{0:X},\n'.format(poly)
+    out += '  .initial_val       = 0x{0:X},\n'.format(init)
+    out += '  .final_val         = 0x{0:X},\n'.format(xorout)
+    out += '  .reflect_data      = {0},\n'.format(int(refin))
+    out += '  .reflect_remainder = {0},\n'.format(int(refout))
+    out += '  .table             = {0}_table[0],\n'.format(name)
+    out += '  .table_slices      = {0}\n'.format(len(table))
+    out += '};\n\n'
+    out += '#endif /* {0} */\n'.format(guard)
+    return out
+
+
+def generate():
+    out = LICENSE + '\n'
+    out += '/**\n'
+    out += ' * @file    crcsw_tables.h\n'
+    out += ' * @brief   CRC software driver lookup tables.\n'
+    out += ' * @note    Generated by tools/crcsw_tables.py, do not edit.\n'
+    out += ' *\n'
+    out += ' * @addtogroup CRC\n'
+    out += ' * @{\n'
+    out += ' */\n\n'
+    out += '#ifndef CRCSW_TABLES_H\n'
+    out += '#define CRCSW_TABLES_H\n\n'
+    for table in BUILTIN_TABLES:
+        out += format_table(*table) + '\n'
+    out += '#endif /* CRCSW_TABLES_H */\n\n'
+    out += '/** @} */\n'
+    return out
+
+
+if __name__ == '__main__':
+    args = parser.parse_args()
+
+    if args.list:
+        for name in sorted(CATALOGUE):
+            print(name)
+        exit(0)
+
+    if args.check:
+        exit(1 if check_catalogue() else 0)
+
+    if args.preset:
+        if args.preset not in CATALOGUE:
+            print('Unknown preset ' + args.preset)
+            exit(1)
+        params = CATALOGUE[args.preset][:6]
+        name = args.name or args.preset
+    elif args.width and args.poly is not None:
+        params = (args.width, args.poly, args.init, args.refin, args.refout,
+                  args.xorout)
+        name = args.name or 'crc{0}'.format(args.width)
+    else:
+        params = None
+
+    with open(args.output, 'w') as header:
+        if params is None:
+            header.write(generate())
+        else:
+            header.write(generate_custom(name, *params, slices=args.slices))
+
+    print('File generated at ' + args.output)
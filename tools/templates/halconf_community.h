@@ -168,6 +168,19 @@
  */
 #define EEPROM_USE_EE25XX FALSE
 
+/*===========================================================================*/
+/* USB_MSD driver related settings.                                          */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the user supplied data buffer in blocks.
+ * @note    With 2 or more blocks bulk transfers are overlapped with medium
+ *          accesses.
+ */
+#if !defined(USB_MSD_BLKBUF_BLOCKS) || defined(__DOXYGEN__)
+#define USB_MSD_BLKBUF_BLOCKS       1
+#endif
+
 #endif /* HALCONF_COMMUNITY_H */
 
 /** @} */